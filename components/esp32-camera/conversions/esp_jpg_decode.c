@@ -11,7 +11,10 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <string.h>
 #include "esp_jpg_decode.h"
+#include "pixconv.h"
+#include "esp_heap_caps.h"
 
 #include "esp_system.h"
 #if ESP_IDF_VERSION_MAJOR >= 4 // IDF 4+
@@ -42,11 +45,28 @@ typedef struct {
         jpg_scale_t scale;
         jpg_reader_cb reader;
         jpg_writer_cb writer;
-        void * arg;
+        void * reader_arg;
+        void * writer_arg;
         size_t len;
         size_t index;
 } esp_jpg_decoder_t;
 
+struct esp_jpg_dec {
+    JDEC decoder;
+    esp_jpg_decoder_t jpeg;
+    bool used;
+    // decode_stripes state
+    uint16_t *stripe;
+    bool swap_bytes;
+    jpg_stripe_cb sink;
+    void * sink_arg;
+    uint16_t out_width;
+};
+
+#define ESP_JPG_DEC_STATE_SIZE ((sizeof(struct esp_jpg_dec) + 3) & ~3)
+_Static_assert(ESP_JPG_DEC_STATE_SIZE + ESP_JPG_DECODE_POOL_SIZE <= ESP_JPG_DECODE_WORK_SIZE,
+               "ESP_JPG_DECODE_WORK_SIZE too small for the decoder state");
+
 static const char * jd_errors[] = {
     "Succeeded",
     "Interrupted by output function",
@@ -70,7 +90,7 @@ static unsigned int _jpg_write(JDEC *decoder, void *bitmap, JRECT *rect)
     esp_jpg_decoder_t * jpeg = (esp_jpg_decoder_t *)decoder->device;
 
     if (jpeg->writer) {
-        return jpeg->writer(jpeg->arg, x, y, w, h, data);
+        return jpeg->writer(jpeg->writer_arg, x, y, w, h, data);
     }
     return 0;
 }
@@ -82,7 +102,7 @@ static unsigned int _jpg_read(JDEC *decoder, uint8_t *buf, unsigned int len)
         len = jpeg->len - jpeg->index;
     }
     if (len) {
-        len = jpeg->reader(jpeg->arg, jpeg->index, buf, len);
+        len = jpeg->reader(jpeg->reader_arg, jpeg->index, buf, len);
         if (!len) {
             ESP_LOGE(TAG, "Read Fail at %u/%u", jpeg->index, jpeg->len);
         }
@@ -91,32 +111,65 @@ static unsigned int _jpg_read(JDEC *decoder, uint8_t *buf, unsigned int len)
     return len;
 }
 
-esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void * arg)
+esp_err_t esp_jpg_dec_open(void *work, size_t work_size, size_t len, jpg_reader_cb reader, void * arg, esp_jpg_dec_handle_t *out_dec)
 {
-    static uint8_t work[3100];
-    JDEC decoder;
-    esp_jpg_decoder_t jpeg;
+    if(!work || !reader || !out_dec || ((uintptr_t)work & 3)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(work_size < ESP_JPG_DECODE_WORK_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
 
-    jpeg.len = len;
-    jpeg.reader = reader;
-    jpeg.writer = writer;
-    jpeg.arg = arg;
-    jpeg.scale = scale;
-    jpeg.index = 0;
+    esp_jpg_dec_handle_t dec = (esp_jpg_dec_handle_t)work;
+    memset(dec, 0, sizeof(*dec));
+    dec->jpeg.len = len;
+    dec->jpeg.reader = reader;
+    dec->jpeg.reader_arg = arg;
 
-    JRESULT jres = jd_prepare(&decoder, _jpg_read, work, 3100, &jpeg);
+    uint8_t *pool = (uint8_t *)work + ESP_JPG_DEC_STATE_SIZE;
+    JRESULT jres = jd_prepare(&dec->decoder, _jpg_read, pool, work_size - ESP_JPG_DEC_STATE_SIZE, &dec->jpeg);
     if(jres != JDR_OK){
         ESP_LOGE(TAG, "JPG Header Parse Failed! %s", jd_errors[jres]);
         return ESP_FAIL;
     }
+    *out_dec = dec;
+    return ESP_OK;
+}
+
+esp_err_t esp_jpg_dec_get_info(esp_jpg_dec_handle_t dec, jpg_scale_t scale, esp_jpg_dec_info_t *info)
+{
+    if(!dec || !info || scale > JPG_SCALE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    info->width = dec->decoder.width >> scale;
+    info->height = dec->decoder.height >> scale;
+    // An MCU is msy 8x8 blocks tall; at 1/8 each block becomes one pixel
+    info->stripe_height = (dec->decoder.msy * 8) >> scale;
+    return ESP_OK;
+}
 
-    uint16_t output_width = decoder.width / (1 << (uint8_t)(jpeg.scale));
-    uint16_t output_height = decoder.height / (1 << (uint8_t)(jpeg.scale));
+esp_err_t esp_jpg_dec_decode(esp_jpg_dec_handle_t dec, jpg_scale_t scale, jpg_writer_cb writer, void * arg)
+{
+    if(!dec || !writer || scale > JPG_SCALE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(dec->used) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    dec->used = true;
+    dec->jpeg.writer = writer;
+    dec->jpeg.writer_arg = arg;
+    dec->jpeg.scale = scale;
+
+    uint16_t output_width = dec->decoder.width / (1 << (uint8_t)(scale));
+    uint16_t output_height = dec->decoder.height / (1 << (uint8_t)(scale));
 
     //output start
-    writer(arg, 0, 0, output_width, output_height, NULL);
+    if(!writer(arg, 0, 0, output_width, output_height, NULL)) {
+        return ESP_FAIL;
+    }
     //output write
-    jres = jd_decomp(&decoder, _jpg_write, (uint8_t)jpeg.scale);
+    JRESULT jres = jd_decomp(&dec->decoder, _jpg_write, (uint8_t)scale);
     //output end
     writer(arg, output_width, output_height, output_width, output_height, NULL);
 
@@ -125,10 +178,71 @@ esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jp
         return ESP_FAIL;
     }
     //check if all data has been consumed.
-    if (len && jpeg.index < len) {
-        _jpg_read(&decoder, NULL, len - jpeg.index);
+    if (dec->jpeg.len && dec->jpeg.index < dec->jpeg.len) {
+        _jpg_read(&dec->decoder, NULL, dec->jpeg.len - dec->jpeg.index);
     }
 
     return ESP_OK;
 }
 
+// tjpgd emits MCU blocks left to right, one MCU row at a time; collect a row
+// into the stripe and hand it to the sink once its right-most block arrives.
+static bool _stripe_write(void * arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data)
+{
+    esp_jpg_dec_handle_t dec = (esp_jpg_dec_handle_t)arg;
+    if(!data) {
+        return true;
+    }
+
+    uint16_t *dst = dec->stripe + x;
+    for(uint16_t row=0; row<h; row++) {
+        pixconv_rgb888_to_rgb565le(data, (uint8_t *)dst, w);
+        data += w * 3;
+        dst += dec->out_width;
+    }
+
+    if(x + w < dec->out_width) {
+        return true;
+    }
+    if(dec->swap_bytes) {
+        pixconv_rgb565_byteswap((const uint8_t *)dec->stripe, (uint8_t *)dec->stripe, dec->out_width * h);
+    }
+    return dec->sink(dec->sink_arg, y, dec->out_width, h, dec->stripe);
+}
+
+esp_err_t esp_jpg_dec_decode_stripes(esp_jpg_dec_handle_t dec, jpg_scale_t scale, uint16_t *stripe, size_t stripe_pixels,
+                                     bool swap_bytes, jpg_stripe_cb sink, void * arg)
+{
+    esp_jpg_dec_info_t info;
+    if(!stripe || !sink || esp_jpg_dec_get_info(dec, scale, &info) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if(stripe_pixels < (size_t)info.width * info.stripe_height) {
+        ESP_LOGE(TAG, "Stripe too small: %u < %u x %u", stripe_pixels, info.width, info.stripe_height);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    dec->stripe = stripe;
+    dec->swap_bytes = swap_bytes;
+    dec->sink = sink;
+    dec->sink_arg = arg;
+    dec->out_width = info.width;
+    return esp_jpg_dec_decode(dec, scale, _stripe_write, dec);
+}
+
+esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void * arg)
+{
+    // Was a function-static buffer, which made concurrent decodes corrupt each other
+    void *work = heap_caps_malloc(ESP_JPG_DECODE_WORK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if(!work) {
+        ESP_LOGE(TAG, "JPG work memory allocation failed");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_jpg_dec_handle_t dec = NULL;
+    esp_err_t err = esp_jpg_dec_open(work, ESP_JPG_DECODE_WORK_SIZE, len, reader, arg, &dec);
+    if(err == ESP_OK) {
+        err = esp_jpg_dec_decode(dec, scale, writer, arg);
+    }
+    heap_caps_free(work);
+    return err;
+}
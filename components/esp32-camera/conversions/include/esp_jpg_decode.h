@@ -34,8 +34,87 @@ typedef enum {
 typedef size_t (* jpg_reader_cb)(void * arg, size_t index, uint8_t *buf, size_t len);
 typedef bool (* jpg_writer_cb)(void * arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data);
 
+/**
+ * @brief Decode a JPEG, reporting MCU blocks through writer
+ *
+ * Reentrant: work memory is allocated per call.
+ */
 esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader, jpg_writer_cb writer, void * arg);
 
+/**
+ * Caller provided work memory for one decoder context: the tjpgd pool plus
+ * the session state. Must be 4-byte aligned; internal RAM decodes fastest.
+ */
+#define ESP_JPG_DECODE_POOL_SIZE    3100
+#define ESP_JPG_DECODE_WORK_SIZE    (ESP_JPG_DECODE_POOL_SIZE + 64 * sizeof(void *))
+
+typedef struct esp_jpg_dec * esp_jpg_dec_handle_t;
+
+typedef struct {
+    uint16_t width;         /*!< Output width after scaling */
+    uint16_t height;        /*!< Output height after scaling */
+    uint16_t stripe_height; /*!< Output rows per MCU row */
+} esp_jpg_dec_info_t;
+
+/**
+ * @brief Stripe sink: one decoded MCU row
+ *
+ * @param arg     User argument
+ * @param y       First output row of the stripe
+ * @param w       Output width (the stripe always spans the full width)
+ * @param h       Rows in the stripe, stripe_height except for the last one
+ * @param pixels  w * h RGB565 pixels, only valid during the call
+ *
+ * @return false to abort the decode
+ */
+typedef bool (* jpg_stripe_cb)(void * arg, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels);
+
+/**
+ * @brief Parse the JPEG header into a decoder context
+ *
+ * Contexts share no state, so any number of decodes can run concurrently.
+ * A context decodes its stream once; open it again to decode again.
+ *
+ * @param work       ESP_JPG_DECODE_WORK_SIZE bytes, owned by the caller until the decode returns
+ * @param work_size  Size of work
+ * @param len        JPEG length, 0 if unknown (reader signals the end)
+ * @param reader     Input callback
+ * @param arg        Input callback argument
+ * @param out_dec    Context, lives inside work
+ *
+ * @return ESP_ERR_INVALID_ARG / ESP_ERR_INVALID_SIZE on bad work memory, ESP_FAIL on a header error
+ */
+esp_err_t esp_jpg_dec_open(void *work, size_t work_size, size_t len, jpg_reader_cb reader, void * arg, esp_jpg_dec_handle_t *out_dec);
+
+/**
+ * @brief Output geometry for a scale, used to size the stripe buffer
+ */
+esp_err_t esp_jpg_dec_get_info(esp_jpg_dec_handle_t dec, jpg_scale_t scale, esp_jpg_dec_info_t *info);
+
+/**
+ * @brief Decode an opened context, reporting RGB888 MCU blocks through writer
+ */
+esp_err_t esp_jpg_dec_decode(esp_jpg_dec_handle_t dec, jpg_scale_t scale, jpg_writer_cb writer, void * arg);
+
+/**
+ * @brief Decode an opened context to RGB565 one MCU row at a time
+ *
+ * Memory use is one stripe (width * stripe_height pixels) instead of a frame,
+ * so the sink can push each stripe straight to a panel or into a canvas.
+ *
+ * @param dec            Opened context
+ * @param scale          Downscale applied while decoding
+ * @param stripe         At least width * stripe_height pixels (see esp_jpg_dec_get_info)
+ * @param stripe_pixels  Size of stripe in pixels
+ * @param swap_bytes     Emit byte-swapped RGB565 (SPI panels, LV_COLOR_16_SWAP)
+ * @param sink           Called once per MCU row, top to bottom
+ * @param arg            Sink argument
+ *
+ * @return ESP_ERR_INVALID_SIZE if the stripe is too small, ESP_FAIL on a decode error or sink abort
+ */
+esp_err_t esp_jpg_dec_decode_stripes(esp_jpg_dec_handle_t dec, jpg_scale_t scale, uint16_t *stripe, size_t stripe_pixels,
+                                     bool swap_bytes, jpg_stripe_cb sink, void * arg);
+
 #ifdef __cplusplus
 }
 #endif
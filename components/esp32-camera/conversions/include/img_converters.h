@@ -54,6 +54,58 @@ bool fmt2jpg_cb(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, p
  */
 bool frame2jpg_cb(camera_fb_t * fb, uint8_t quality, jpg_out_cb cb, void * arg);
 
+/**
+ * @brief Output ring for the chunked JPEG encoder
+ *
+ * The encoder copies its output into the ring and calls cb with every full
+ * chunk_len piece (the last one may be shorter), so a snapshot can be written
+ * to a file or an HTTP response without holding the whole JPEG in RAM.
+ * A chunk stays untouched until the ring wraps back to it: with a ring of N
+ * chunks the callback may keep up to N-1 of them in flight.
+ * The callback must return len, anything else aborts the encode.
+ */
+typedef struct {
+    uint8_t *ring;      /*!< Ring storage, or NULL to allocate ring_len bytes (internal DMA-capable RAM first) for the call */
+    size_t ring_len;    /*!< Ring size in bytes, a multiple of chunk_len */
+    size_t chunk_len;   /*!< Callback granularity, e.g. 512 for SD sectors or 1436 for one TCP segment */
+    jpg_out_cb cb;      /*!< Called with each chunk; index is its offset in the JPEG */
+    void *arg;          /*!< Passed to cb */
+} jpg_chunk_config_t;
+
+#define JPG_CHUNK_CONFIG_DEFAULT(out_cb, out_arg) { \
+    .ring = NULL, \
+    .ring_len = 4096, \
+    .chunk_len = 2048, \
+    .cb = (out_cb), \
+    .arg = (out_arg), \
+}
+
+/**
+ * @brief Convert image buffer to JPEG, streamed through a fixed ring buffer
+ *
+ * @param src       Source buffer in RGB565, RGB888, YUYV or GRAYSCALE format
+ * @param src_len   Length in bytes of the source buffer
+ * @param width     Width in pixels of the source image
+ * @param height    Height in pixels of the source image
+ * @param format    Format of the source image
+ * @param quality   JPEG quality of the resulting image
+ * @param config    Ring buffer and chunk callback
+ *
+ * @return true on success
+ */
+bool fmt2jpg_chunked(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality, const jpg_chunk_config_t *config);
+
+/**
+ * @brief Convert camera frame buffer to JPEG, streamed through a fixed ring buffer
+ *
+ * @param fb        Source camera frame buffer
+ * @param quality   JPEG quality of the resulting image
+ * @param config    Ring buffer and chunk callback
+ *
+ * @return true on success
+ */
+bool frame2jpg_chunked(camera_fb_t * fb, uint8_t quality, const jpg_chunk_config_t *config);
+
 /**
  * @brief Convert image buffer to JPEG buffer
  *
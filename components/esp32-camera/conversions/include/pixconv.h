@@ -0,0 +1,121 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _PIXCONV_H_
+#define _PIXCONV_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Line conversion kernel implementations
+ *
+ * All implementations produce bit-identical output. SCALAR is the original
+ * per-pixel code and is kept as a benchmark/reference baseline.
+ */
+typedef enum {
+    PIXCONV_IMPL_SCALAR,    /*!< Original per-pixel loops */
+    PIXCONV_IMPL_PORTABLE,  /*!< Pair/word-at-a-time C, any target */
+    PIXCONV_IMPL_PIE,       /*!< ESP32-S3 128-bit PIE for byte-swap, gray and YUV422->RGB565, PORTABLE for the rest */
+    PIXCONV_IMPL_MAX,
+} pixconv_impl_t;
+
+/**
+ * @brief Select the implementation used by the pixconv_* calls
+ *
+ * The fastest available one is active by default.
+ *
+ * @param impl  Requested implementation
+ *
+ * @return true if it is available on this target and is now active
+ */
+bool pixconv_select(pixconv_impl_t impl);
+
+/**
+ * @brief Currently active implementation
+ */
+pixconv_impl_t pixconv_active(void);
+
+/**
+ * @brief Printable name of an implementation
+ */
+const char *pixconv_impl_name(pixconv_impl_t impl);
+
+/**
+ * @brief YUYV (YUV422) to RGB565, camera byte order (high byte first)
+ *
+ * @param src     YUYV line, 2 bytes per pixel
+ * @param dst     Output, 2 bytes per pixel
+ * @param pixels  Pixel count, must be even
+ */
+void pixconv_yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels);
+
+/**
+ * @brief YUYV (YUV422) to RGB888
+ *
+ * @param src     YUYV line, 2 bytes per pixel
+ * @param dst     Output, 3 bytes per pixel
+ * @param pixels  Pixel count, must be even
+ * @param bgr     Write B,G,R (BMP/RGB888 frame order) instead of R,G,B
+ */
+void pixconv_yuv422_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr);
+
+/**
+ * @brief RGB565 (camera byte order, high byte first) to RGB888
+ *
+ * @param src     RGB565 line, 2 bytes per pixel
+ * @param dst     Output, 3 bytes per pixel
+ * @param pixels  Pixel count
+ * @param bgr     Write B,G,R instead of R,G,B
+ */
+void pixconv_rgb565_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr);
+
+/**
+ * @brief RGB888 (R,G,B) to little-endian RGB565
+ *
+ * @param src     RGB888 line, 3 bytes per pixel
+ * @param dst     Output, 2 bytes per pixel
+ * @param pixels  Pixel count
+ */
+void pixconv_rgb888_to_rgb565le(const uint8_t *src, uint8_t *dst, size_t pixels);
+
+/**
+ * @brief Swap the bytes of every RGB565 pixel
+ *
+ * Converts between camera/panel byte order and CPU order. src and dst may be equal.
+ *
+ * @param src     RGB565 line
+ * @param dst     Output
+ * @param pixels  Pixel count
+ */
+void pixconv_rgb565_byteswap(const uint8_t *src, uint8_t *dst, size_t pixels);
+
+/**
+ * @brief Extract the Y plane of a YUYV line
+ *
+ * @param src     YUYV line, 2 bytes per pixel
+ * @param dst     Output, 1 byte per pixel
+ * @param pixels  Pixel count
+ */
+void pixconv_yuv422_to_gray(const uint8_t *src, uint8_t *dst, size_t pixels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PIXCONV_H_ */
@@ -0,0 +1,294 @@
+// Copyright 2015-2016 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "pixconv.h"
+#include "yuv.h"
+#include "esp_attr.h"
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+typedef struct {
+    void (*yuv422_to_rgb565)(const uint8_t *src, uint8_t *dst, size_t pixels);
+    void (*yuv422_to_rgb888)(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr);
+    void (*rgb565_to_rgb888)(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr);
+    void (*rgb888_to_rgb565le)(const uint8_t *src, uint8_t *dst, size_t pixels);
+    void (*rgb565_byteswap)(const uint8_t *src, uint8_t *dst, size_t pixels);
+    void (*yuv422_to_gray)(const uint8_t *src, uint8_t *dst, size_t pixels);
+} pixconv_ops_t;
+
+/*
+ * Scalar: the loops that used to live at the call sites, one pixel per step
+ */
+
+static void scalar_yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    uint8_t r, g, b;
+    for(size_t i=0; i<pixels; i+=2) {
+        for(int k=0; k<2; k++) {
+            yuv2rgb(src[k*2], src[1], src[3], &r, &g, &b);
+            uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+            *dst++ = c >> 8;
+            *dst++ = c & 0xFF;
+        }
+        src += 4;
+    }
+}
+
+static void scalar_yuv422_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr)
+{
+    uint8_t r, g, b;
+    for(size_t i=0; i<pixels; i+=2) {
+        for(int k=0; k<2; k++) {
+            yuv2rgb(src[k*2], src[1], src[3], &r, &g, &b);
+            *dst++ = bgr ? b : r;
+            *dst++ = g;
+            *dst++ = bgr ? r : b;
+        }
+        src += 4;
+    }
+}
+
+static void scalar_rgb565_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr)
+{
+    uint8_t hb, lb;
+    for(size_t i=0; i<pixels; i++) {
+        hb = *src++;
+        lb = *src++;
+        *dst++ = bgr ? (lb & 0x1F) << 3 : hb & 0xF8;
+        *dst++ = (hb & 0x07) << 5 | (lb & 0xE0) >> 3;
+        *dst++ = bgr ? hb & 0xF8 : (lb & 0x1F) << 3;
+    }
+}
+
+static void IRAM_ATTR scalar_rgb888_to_rgb565le(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    for(size_t i=0; i<pixels; i++) {
+        uint16_t r = src[0];
+        uint16_t g = src[1];
+        uint16_t b = src[2];
+        uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        dst[1] = c >> 8;
+        dst[0] = c & 0xff;
+        src += 3;
+        dst += 2;
+    }
+}
+
+static void IRAM_ATTR scalar_rgb565_byteswap(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    for(size_t i=0; i<pixels; i++) {
+        uint8_t hb = src[0];
+        dst[0] = src[1];
+        dst[1] = hb;
+        src += 2;
+        dst += 2;
+    }
+}
+
+static void IRAM_ATTR scalar_yuv422_to_gray(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    for(size_t i=0; i<pixels; i++) {
+        dst[i] = src[i*2];
+    }
+}
+
+/*
+ * Portable: pair-at-a-time chroma (yuv.c) and 32-bit word shuffles.
+ * Word paths assume a little-endian CPU, which every supported target is.
+ * The byte swap has no portable variant: masking and shifting words measured
+ * slower than the scalar byte loop, so the table uses the scalar one.
+ */
+
+static inline void rgb565_to_rgb888_line(const uint8_t *src, uint8_t *dst, size_t pixels, const int ri, const int bi)
+{
+    for(size_t i=0; i<pixels; i++) {
+        uint32_t c = (src[0] << 8) | src[1];
+        dst[ri] = (c >> 8) & 0xF8;
+        dst[1] = (c >> 3) & 0xFC;
+        dst[bi] = (c << 3) & 0xF8;
+        src += 2;
+        dst += 3;
+    }
+}
+
+static void IRAM_ATTR portable_rgb565_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr)
+{
+    if(bgr) {
+        rgb565_to_rgb888_line(src, dst, pixels, 2, 0);
+    } else {
+        rgb565_to_rgb888_line(src, dst, pixels, 0, 2);
+    }
+}
+
+static void IRAM_ATTR portable_yuv422_to_gray(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    size_t i = 0;
+    if((((uintptr_t)src | (uintptr_t)dst) & 3) == 0) {
+        // Y0 U Y1 V | Y2 U Y3 V -> Y0 Y1 Y2 Y3
+        const uint32_t *s = (const uint32_t *)src;
+        uint32_t *d = (uint32_t *)dst;
+        for(; i+4<=pixels; i+=4) {
+            uint32_t w0 = s[0];
+            uint32_t w1 = s[1];
+            *d++ = (w0 & 0xFF) | ((w0 >> 8) & 0xFF00) | ((w1 & 0xFF) << 16) | ((w1 << 8) & 0xFF000000);
+            s += 2;
+        }
+        src = (const uint8_t *)s;
+        dst = (uint8_t *)d;
+    }
+    scalar_yuv422_to_gray(src, dst, pixels - i);
+}
+
+/*
+ * PIE: pixconv_esp32s3.S, 16 pixels per step. Byte-swap and gray are 128-bit
+ * unzip/zip shuffles; YUV422->RGB565 evaluates the yuv_table columns in 16-bit
+ * lanes. The RGB888 outputs stay on the portable code: PIE has no 3-way byte
+ * interleave, so packing 3-byte pixels would take a scalar pass that costs as
+ * much as the portable loop. Heads and tails run on the fastest C kernel,
+ * which for the byte swap and RGB888->RGB565 is the scalar loop (the word
+ * versions are slower).
+ */
+
+#if CONFIG_CAMERA_CONVERSION_PIE
+#define PIXCONV_HAS_PIE 1
+
+// 32 source bytes per block, src and dst 16-byte aligned
+extern void pixconv_pie_rgb565_byteswap(const uint8_t *src, uint8_t *dst, size_t blocks);
+extern void pixconv_pie_yuv422_to_gray(const uint8_t *src, uint8_t *dst, size_t blocks);
+extern void pixconv_pie_yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t blocks, const int16_t *k);
+
+// yuv_table column c is trunc(c * d / 8192); loaded in this order by the kernel
+static DRAM_ATTR const int16_t pie_yuv_k[] = {
+    128, 6656, 16531, 13075, 3204,  // chroma bias, -Ug, Ub, Vr, -Vg
+    16, 9535,                       // luma bias, Y
+    255, 0xF800, 255, 0x07E0, 255, 0x001F,
+};
+
+static void IRAM_ATTR pie_yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    size_t blocks = 0;
+    if((((uintptr_t)src | (uintptr_t)dst) & 15) == 0) {
+        blocks = pixels / 16;
+        pixconv_pie_yuv422_to_rgb565(src, dst, blocks, pie_yuv_k);
+    }
+    yuv422_to_rgb565(src + blocks * 32, dst + blocks * 32, pixels - blocks * 16);
+}
+
+static void IRAM_ATTR pie_rgb565_byteswap(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    size_t blocks = 0;
+    if((((uintptr_t)src | (uintptr_t)dst) & 15) == 0) {
+        blocks = pixels / 16;
+        pixconv_pie_rgb565_byteswap(src, dst, blocks);
+    }
+    scalar_rgb565_byteswap(src + blocks * 32, dst + blocks * 32, pixels - blocks * 16);
+}
+
+static void IRAM_ATTR pie_yuv422_to_gray(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    size_t blocks = 0;
+    if((((uintptr_t)src | (uintptr_t)dst) & 15) == 0) {
+        blocks = pixels / 16;
+        pixconv_pie_yuv422_to_gray(src, dst, blocks);
+    }
+    portable_yuv422_to_gray(src + blocks * 32, dst + blocks * 16, pixels - blocks * 16);
+}
+#else
+#define PIXCONV_HAS_PIE 0
+#endif
+
+static DRAM_ATTR const pixconv_ops_t pixconv_ops[PIXCONV_IMPL_MAX] = {
+    [PIXCONV_IMPL_SCALAR] = {
+        scalar_yuv422_to_rgb565,
+        scalar_yuv422_to_rgb888,
+        scalar_rgb565_to_rgb888,
+        scalar_rgb888_to_rgb565le,
+        scalar_rgb565_byteswap,
+        scalar_yuv422_to_gray,
+    },
+    [PIXCONV_IMPL_PORTABLE] = {
+        yuv422_to_rgb565,
+        yuv422_to_rgb888,
+        portable_rgb565_to_rgb888,
+        scalar_rgb888_to_rgb565le,
+        scalar_rgb565_byteswap,
+        portable_yuv422_to_gray,
+    },
+#if PIXCONV_HAS_PIE
+    [PIXCONV_IMPL_PIE] = {
+        pie_yuv422_to_rgb565,
+        yuv422_to_rgb888,
+        portable_rgb565_to_rgb888,
+        scalar_rgb888_to_rgb565le,
+        pie_rgb565_byteswap,
+        pie_yuv422_to_gray,
+    },
+#endif
+};
+
+static DRAM_ATTR const pixconv_ops_t *s_ops = &pixconv_ops[PIXCONV_HAS_PIE ? PIXCONV_IMPL_PIE : PIXCONV_IMPL_PORTABLE];
+
+bool pixconv_select(pixconv_impl_t impl)
+{
+    if(impl >= PIXCONV_IMPL_MAX || (impl == PIXCONV_IMPL_PIE && !PIXCONV_HAS_PIE)) {
+        return false;
+    }
+    s_ops = &pixconv_ops[impl];
+    return true;
+}
+
+pixconv_impl_t pixconv_active(void)
+{
+    return (pixconv_impl_t)(s_ops - pixconv_ops);
+}
+
+const char *pixconv_impl_name(pixconv_impl_t impl)
+{
+    switch(impl) {
+    case PIXCONV_IMPL_SCALAR:   return "scalar";
+    case PIXCONV_IMPL_PORTABLE: return "portable";
+    case PIXCONV_IMPL_PIE:      return "pie";
+    default:                    return "unknown";
+    }
+}
+
+void IRAM_ATTR pixconv_yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    s_ops->yuv422_to_rgb565(src, dst, pixels);
+}
+
+void IRAM_ATTR pixconv_yuv422_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr)
+{
+    s_ops->yuv422_to_rgb888(src, dst, pixels, bgr);
+}
+
+void IRAM_ATTR pixconv_rgb565_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr)
+{
+    s_ops->rgb565_to_rgb888(src, dst, pixels, bgr);
+}
+
+void IRAM_ATTR pixconv_rgb888_to_rgb565le(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    s_ops->rgb888_to_rgb565le(src, dst, pixels);
+}
+
+void IRAM_ATTR pixconv_rgb565_byteswap(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    s_ops->rgb565_byteswap(src, dst, pixels);
+}
+
+void IRAM_ATTR pixconv_yuv422_to_gray(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    s_ops->yuv422_to_gray(src, dst, pixels);
+}
@@ -18,9 +18,14 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 void yuv2rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b);
+// Line kernels over YUYV pairs; output matches yuv2rgb exactly
+void yuv422_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr);
+void yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels);
 
 #ifdef __cplusplus
 }
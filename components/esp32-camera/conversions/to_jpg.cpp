@@ -19,7 +19,7 @@
 #include "esp_camera.h"
 #include "img_converters.h"
 #include "jpge.h"
-#include "yuv.h"
+#include "pixconv.h"
 
 #if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"
@@ -43,6 +43,16 @@ static void *_malloc(size_t size)
     return NULL;
 }
 
+// Chunked path only: its line and ring buffers are touched for every pixel/byte, keep them out of PSRAM when possible
+static void *_malloc_internal(size_t size)
+{
+    void * res = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    if(res) {
+        return res;
+    }
+    return _malloc(size);
+}
+
 static IRAM_ATTR void convert_line_format(uint8_t * src, pixformat_t format, uint8_t * dst, size_t width, size_t in_channels, size_t line)
 {
     int i=0, o=0, l=0;
@@ -57,38 +67,13 @@ static IRAM_ATTR void convert_line_format(uint8_t * src, pixformat_t format, uin
             dst[o++] = src[i];
         }
     } else if(format == PIXFORMAT_RGB565) {
-        l = width * 2;
-        src += l * line;
-        for(i=0; i<l; i+=2) {
-            dst[o++] = src[i] & 0xF8;
-            dst[o++] = (src[i] & 0x07) << 5 | (src[i+1] & 0xE0) >> 3;
-            dst[o++] = (src[i+1] & 0x1F) << 3;
-        }
+        pixconv_rgb565_to_rgb888(src + width * 2 * line, dst, width, false);
     } else if(format == PIXFORMAT_YUV422) {
-        uint8_t y0, y1, u, v;
-        uint8_t r, g, b;
-        l = width * 2;
-        src += l * line;
-        for(i=0; i<l; i+=4) {
-            y0 = src[i];
-            u = src[i+1];
-            y1 = src[i+2];
-            v = src[i+3];
-
-            yuv2rgb(y0, u, v, &r, &g, &b);
-            dst[o++] = r;
-            dst[o++] = g;
-            dst[o++] = b;
-
-            yuv2rgb(y1, u, v, &r, &g, &b);
-            dst[o++] = r;
-            dst[o++] = g;
-            dst[o++] = b;
-        }
+        pixconv_yuv422_to_rgb888(src + width * 2 * line, dst, width, false);
     }
 }
 
-bool convert_image(uint8_t *src, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality, jpge::output_stream *dst_stream)
+bool convert_image(uint8_t *src, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality, jpge::output_stream *dst_stream, bool internal_line)
 {
     int num_channels = 3;
     jpge::subsampling_t subsampling = jpge::H2V2;
@@ -115,7 +100,7 @@ bool convert_image(uint8_t *src, uint16_t width, uint16_t height, pixformat_t fo
         return false;
     }
 
-    uint8_t* line = (uint8_t*)_malloc(width * num_channels);
+    uint8_t* line = (uint8_t*)(internal_line ? _malloc_internal(width * num_channels) : _malloc(width * num_channels));
     if(!line) {
         ESP_LOGE(TAG, "Scan line malloc failed");
         return false;
@@ -162,7 +147,7 @@ public:
 bool fmt2jpg_cb(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality, jpg_out_cb cb, void * arg)
 {
     callback_stream dst_stream(cb, arg);
-    return convert_image(src, width, height, format, quality, &dst_stream);
+    return convert_image(src, width, height, format, quality, &dst_stream, false);
 }
 
 bool frame2jpg_cb(camera_fb_t * fb, uint8_t quality, jpg_out_cb cb, void * arg)
@@ -171,6 +156,96 @@ bool frame2jpg_cb(camera_fb_t * fb, uint8_t quality, jpg_out_cb cb, void * arg)
 }
 
 
+// Collects the encoder output in a fixed ring and hands it to the callback in
+// chunk_len pieces. A chunk is not overwritten until the ring wraps back to it,
+// so the callback may queue it (e.g. to a DMA write) instead of copying.
+class ring_stream : public jpge::output_stream {
+protected:
+    jpg_out_cb ocb;
+    void * oarg;
+    uint8_t *ring;
+    size_t ring_len, chunk_len;
+    size_t chunk_start, fill;
+    size_t index;
+    bool ok;
+
+    void emit(size_t len)
+    {
+        if(ocb(oarg, index, ring + chunk_start, len) != len) {
+            ok = false;
+        }
+        index += len;
+        chunk_start += chunk_len;
+        if(chunk_start >= ring_len) {
+            chunk_start = 0;
+        }
+        fill = 0;
+    }
+
+public:
+    ring_stream(const jpg_chunk_config_t *config, uint8_t *buf)
+        : ocb(config->cb), oarg(config->arg), ring(buf), ring_len(config->ring_len), chunk_len(config->chunk_len),
+          chunk_start(0), fill(0), index(0), ok(true) { }
+    virtual ~ring_stream() { }
+    virtual bool put_buf(const void* data, int len)
+    {
+        if (!data) {
+            //end of image, flush the partial chunk
+            if (fill) {
+                emit(fill);
+            }
+            return ok;
+        }
+        const uint8_t *src = static_cast<const uint8_t*>(data);
+        while (len > 0 && ok) {
+            size_t n = chunk_len - fill;
+            if (n > (size_t)len) {
+                n = len;
+            }
+            memcpy(ring + chunk_start + fill, src, n);
+            fill += n;
+            src += n;
+            len -= n;
+            if (fill == chunk_len) {
+                emit(chunk_len);
+            }
+        }
+        return ok;
+    }
+    virtual size_t get_size() const
+    {
+        return index + fill;
+    }
+};
+
+bool fmt2jpg_chunked(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixformat_t format, uint8_t quality, const jpg_chunk_config_t *config)
+{
+    if(!config || !config->cb || !config->chunk_len || config->ring_len < config->chunk_len || (config->ring_len % config->chunk_len)) {
+        ESP_LOGE(TAG, "Invalid JPG chunk config");
+        return false;
+    }
+
+    uint8_t *ring = config->ring;
+    if(!ring) {
+        ring = (uint8_t *)_malloc_internal(config->ring_len);
+        if(!ring) {
+            ESP_LOGE(TAG, "JPG ring malloc failed");
+            return false;
+        }
+    }
+
+    ring_stream dst_stream(config, ring);
+    bool ret = convert_image(src, width, height, format, quality, &dst_stream, true);
+    if(ring != config->ring) {
+        free(ring);
+    }
+    return ret;
+}
+
+bool frame2jpg_chunked(camera_fb_t * fb, uint8_t quality, const jpg_chunk_config_t *config)
+{
+    return fmt2jpg_chunked(fb->buf, fb->len, fb->width, fb->height, fb->format, quality, config);
+}
 
 class memory_stream : public jpge::output_stream {
 protected:
@@ -219,7 +294,7 @@ bool fmt2jpg(uint8_t *src, size_t src_len, uint16_t width, uint16_t height, pixf
     }
     memory_stream dst_stream(jpg_buf, jpg_buf_len);
 
-    if(!convert_image(src, width, height, format, quality, &dst_stream)) {
+    if(!convert_image(src, width, height, format, quality, &dst_stream, false)) {
         free(jpg_buf);
         return false;
     }
@@ -296,3 +296,68 @@ void IRAM_ATTR yuv2rgb(uint8_t y, uint8_t u, uint8_t v, uint8_t *r, uint8_t *g,
     *g = YUYV_CONSTRAIN(gi);
     *b = YUYV_CONSTRAIN(bi);
 }
+
+// Same table as yuv2rgb, but the chroma terms are looked up once per YUYV pair
+// and the clamp is a single range test in the common case.
+static inline uint8_t yuv_clamp(int v)
+{
+    return (v & ~0xFF) ? (uint8_t)(~v >> 31) : (uint8_t)v;
+}
+
+static inline void yuv422_pair(const uint8_t *src, int *y0, int *y1, int *dr, int *dg, int *db)
+{
+    const yuv_table_row *tu = &yuv_table[src[1]];
+    const yuv_table_row *tv = &yuv_table[src[3]];
+    *y0 = yuv_table[src[0]].vY;
+    *y1 = yuv_table[src[2]].vY;
+    *dr = tv->vVr;
+    *dg = tu->vUg + tv->vVg;
+    *db = tu->vUb;
+}
+
+static inline void yuv422_to_rgb888_line(const uint8_t *src, uint8_t *dst, size_t pixels, const int ri, const int bi)
+{
+    int y0, y1, dr, dg, db;
+    for(size_t i=0; i<pixels/2; i++) {
+        yuv422_pair(src, &y0, &y1, &dr, &dg, &db);
+        dst[ri] = yuv_clamp(y0 + dr);
+        dst[1] = yuv_clamp(y0 + dg);
+        dst[bi] = yuv_clamp(y0 + db);
+        dst[3 + ri] = yuv_clamp(y1 + dr);
+        dst[4] = yuv_clamp(y1 + dg);
+        dst[3 + bi] = yuv_clamp(y1 + db);
+        src += 4;
+        dst += 6;
+    }
+}
+
+void IRAM_ATTR yuv422_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels, bool bgr)
+{
+    if(bgr) {
+        yuv422_to_rgb888_line(src, dst, pixels, 2, 0);
+    } else {
+        yuv422_to_rgb888_line(src, dst, pixels, 0, 2);
+    }
+}
+
+static inline uint16_t yuv_rgb565(int r, int g, int b)
+{
+    return ((yuv_clamp(r) & 0xF8) << 8) | ((yuv_clamp(g) & 0xFC) << 3) | (yuv_clamp(b) >> 3);
+}
+
+void IRAM_ATTR yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    int y0, y1, dr, dg, db;
+    for(size_t i=0; i<pixels/2; i++) {
+        yuv422_pair(src, &y0, &y1, &dr, &dg, &db);
+        uint16_t c0 = yuv_rgb565(y0 + dr, y0 + dg, y0 + db);
+        uint16_t c1 = yuv_rgb565(y1 + dr, y1 + dg, y1 + db);
+        // Camera byte order: high byte first
+        dst[0] = c0 >> 8;
+        dst[1] = c0 & 0xFF;
+        dst[2] = c1 >> 8;
+        dst[3] = c1 & 0xFF;
+        src += 4;
+        dst += 4;
+    }
+}
@@ -0,0 +1,4 @@
+// Host build stand-in for the IDF header, see pixconv_bench.c
+#pragma once
+#define IRAM_ATTR
+#define DRAM_ATTR
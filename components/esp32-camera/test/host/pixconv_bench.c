@@ -0,0 +1,118 @@
+// Host microbenchmark for conversions/pixconv.c. Checks every implementation
+// against the scalar reference and reports MPix/s for a QVGA frame.
+//
+// From components/esp32-camera:
+//   cc -O2 -Itest/host -Iconversions/include -Iconversions/private_include conversions/yuv.c conversions/pixconv.c test/host/pixconv_bench.c -o pixconv_bench
+//   ./pixconv_bench
+//
+// The PIE implementation only exists on target; see test/test_pixconv.c.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pixconv.h"
+
+#define BENCH_WIDTH  320
+#define BENCH_HEIGHT 240
+#define BENCH_ROUNDS 50
+
+typedef void (*bench_kernel_t)(const uint8_t *src, uint8_t *dst, size_t pixels);
+
+static void bench_yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_yuv422_to_rgb565(src, dst, pixels);
+}
+
+static void bench_yuv422_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_yuv422_to_rgb888(src, dst, pixels, true);
+}
+
+static void bench_rgb565_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_rgb565_to_rgb888(src, dst, pixels, false);
+}
+
+static void bench_rgb888_to_rgb565le(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_rgb888_to_rgb565le(src, dst, pixels);
+}
+
+static const struct {
+    const char *name;
+    bench_kernel_t run;
+    size_t out_bpp;
+} bench_kernels[] = {
+    { "yuv422->rgb565", bench_yuv422_to_rgb565, 2 },
+    { "yuv422->rgb888", bench_yuv422_to_rgb888, 3 },
+    { "rgb565->rgb888", bench_rgb565_to_rgb888, 3 },
+    { "rgb888->rgb565", bench_rgb888_to_rgb565le, 2 },
+    { "rgb565 swap", pixconv_rgb565_byteswap, 2 },
+    { "yuv422->gray", pixconv_yuv422_to_gray, 1 },
+};
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double bench_frame_us(bench_kernel_t run, const uint8_t *src, uint8_t *dst, size_t out_bpp)
+{
+    double best = 1e30;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        double t0 = now_us();
+        for (int y = 0; y < BENCH_HEIGHT; y++) {
+            run(src + y * BENCH_WIDTH * 3, dst + y * BENCH_WIDTH * out_bpp, BENCH_WIDTH);
+        }
+        double t = now_us() - t0;
+        if (t < best) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+int main(void)
+{
+    size_t frame = BENCH_WIDTH * BENCH_HEIGHT * 3;
+    uint8_t *src = aligned_alloc(16, frame);
+    uint8_t *ref = aligned_alloc(16, frame);
+    uint8_t *out = aligned_alloc(16, frame);
+    int failed = 0;
+    if (!src || !ref || !out) {
+        return 1;
+    }
+    srand(1);
+    for (size_t i = 0; i < frame; i++) {
+        src[i] = rand();
+    }
+
+    for (size_t k = 0; k < sizeof(bench_kernels) / sizeof(bench_kernels[0]); k++) {
+        double scalar_us = 0;
+        for (pixconv_impl_t impl = PIXCONV_IMPL_SCALAR; impl < PIXCONV_IMPL_MAX; impl++) {
+            if (!pixconv_select(impl)) {
+                continue;
+            }
+            uint8_t *dst = (impl == PIXCONV_IMPL_SCALAR) ? ref : out;
+            double us = bench_frame_us(bench_kernels[k].run, src, dst, bench_kernels[k].out_bpp);
+            const char *check = "";
+            if (impl == PIXCONV_IMPL_SCALAR) {
+                scalar_us = us;
+            } else if (memcmp(ref, out, BENCH_WIDTH * BENCH_HEIGHT * bench_kernels[k].out_bpp) != 0) {
+                check = "  MISMATCH";
+                failed = 1;
+            }
+            printf("%-15s %-8s %8.1f MPix/s  x%.2f%s\n", bench_kernels[k].name, pixconv_impl_name(impl),
+                   BENCH_WIDTH * BENCH_HEIGHT / us, scalar_us / us, check);
+        }
+    }
+
+    free(src);
+    free(ref);
+    free(out);
+    return failed;
+}
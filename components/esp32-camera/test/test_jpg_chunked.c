@@ -0,0 +1,166 @@
+
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "img_converters.h"
+
+static const char *TAG = "test_jpg_chunked";
+
+#define CHUNK_BENCH_TIMES 4
+#define CHUNK_LEN         1024
+#define CHUNK_RING_LEN    (4 * CHUNK_LEN)
+
+typedef struct {
+    size_t total;
+    size_t chunks;
+    size_t short_chunks;
+    uint32_t sum;
+    bool in_order;
+} chunk_sink_t;
+
+static void chunk_sink_feed(chunk_sink_t *sink, size_t index, const uint8_t *data, size_t len)
+{
+    if (index != sink->total) {
+        sink->in_order = false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        sink->sum = sink->sum * 31 + data[i];
+    }
+    sink->total += len;
+    sink->chunks++;
+    if (len != CHUNK_LEN) {
+        sink->short_chunks++;
+    }
+}
+
+static size_t chunk_cb(void *arg, size_t index, const void *data, size_t len)
+{
+    chunk_sink_feed((chunk_sink_t *)arg, index, (const uint8_t *)data, len);
+    return len;
+}
+
+static size_t abort_cb(void *arg, size_t index, const void *data, size_t len)
+{
+    size_t *calls = (size_t *)arg;
+    (*calls)++;
+    return 0;
+}
+
+// Smooth gradients with some edges, compresses roughly like a real scene
+static uint8_t *make_frame(uint16_t width, uint16_t height, pixformat_t format)
+{
+    uint8_t *buf = heap_caps_malloc((size_t)width * height * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        return NULL;
+    }
+    uint8_t *p = buf;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t r = (x * 255) / width;
+            uint8_t g = (y * 255) / height;
+            uint8_t b = ((x / 32 + y / 32) & 1) ? 200 : 40;
+            if (format == PIXFORMAT_RGB565) {
+                uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+                *p++ = c >> 8;
+                *p++ = c & 0xFF;
+            } else {
+                *p++ = (r + g + b) / 3;
+                *p++ = (x & 1) ? r : b;
+            }
+        }
+    }
+    return buf;
+}
+
+TEST_CASE("Conversions jpeg chunked encode matches callback encode", "[camera]")
+{
+    uint8_t *frame = make_frame(320, 240, PIXFORMAT_RGB565);
+    TEST_ASSERT_NOT_NULL(frame);
+
+    chunk_sink_t ref = {.in_order = true};
+    TEST_ASSERT_TRUE(fmt2jpg_cb(frame, 320 * 240 * 2, 320, 240, PIXFORMAT_RGB565, 80, chunk_cb, &ref));
+
+    chunk_sink_t sink = {.in_order = true};
+    jpg_chunk_config_t config = {
+        .ring = NULL,
+        .ring_len = CHUNK_RING_LEN,
+        .chunk_len = CHUNK_LEN,
+        .cb = chunk_cb,
+        .arg = &sink,
+    };
+    TEST_ASSERT_TRUE(fmt2jpg_chunked(frame, 320 * 240 * 2, 320, 240, PIXFORMAT_RGB565, 80, &config));
+    TEST_ASSERT_TRUE(sink.in_order);
+    TEST_ASSERT_EQUAL(ref.total, sink.total);
+    TEST_ASSERT_EQUAL_HEX32(ref.sum, sink.sum);
+    // Only the tail may be short
+    TEST_ASSERT_EQUAL((sink.total + CHUNK_LEN - 1) / CHUNK_LEN, sink.chunks);
+    TEST_ASSERT_LESS_OR_EQUAL(1, sink.short_chunks);
+
+    // A failing callback stops the encoder at the first chunk
+    size_t calls = 0;
+    config.cb = abort_cb;
+    config.arg = &calls;
+    TEST_ASSERT_FALSE(fmt2jpg_chunked(frame, 320 * 240 * 2, 320, 240, PIXFORMAT_RGB565, 80, &config));
+    TEST_ASSERT_EQUAL(1, calls);
+
+    // Bad geometry is rejected
+    config.ring_len = CHUNK_LEN + 1;
+    TEST_ASSERT_FALSE(fmt2jpg_chunked(frame, 320 * 240 * 2, 320, 240, PIXFORMAT_RGB565, 80, &config));
+    heap_caps_free(frame);
+}
+
+TEST_CASE("Conversions jpeg chunked encode benchmark", "[camera]")
+{
+    static const struct {
+        const char *name;
+        uint16_t width;
+        uint16_t height;
+    } sizes[] = {
+        { "QVGA", 320, 240 },
+        { "VGA", 640, 480 },
+        { "SVGA", 800, 600 },
+    };
+    static const pixformat_t formats[] = { PIXFORMAT_RGB565, PIXFORMAT_YUV422 };
+    static const uint8_t qualities[] = { 60, 80, 90 };
+
+    uint8_t *ring = heap_caps_malloc(CHUNK_RING_LEN, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+            uint16_t w = sizes[s].width, h = sizes[s].height;
+            uint8_t *frame = make_frame(w, h, formats[f]);
+            TEST_ASSERT_NOT_NULL(frame);
+            for (size_t q = 0; q < sizeof(qualities) / sizeof(qualities[0]); q++) {
+                chunk_sink_t sink;
+                jpg_chunk_config_t config = {
+                    .ring = ring,
+                    .ring_len = CHUNK_RING_LEN,
+                    .chunk_len = CHUNK_LEN,
+                    .cb = chunk_cb,
+                    .arg = &sink,
+                };
+                int64_t total = 0;
+                for (int i = 0; i < CHUNK_BENCH_TIMES; i++) {
+                    memset(&sink, 0, sizeof(sink));
+                    sink.in_order = true;
+                    int64_t t1 = esp_timer_get_time();
+                    TEST_ASSERT_TRUE(fmt2jpg_chunked(frame, (size_t)w * h * 2, w, h, formats[f], qualities[q], &config));
+                    total += esp_timer_get_time() - t1;
+                    TEST_ASSERT_TRUE(sink.in_order);
+                }
+                float ms = total / 1000.0f / CHUNK_BENCH_TIMES;
+                ESP_LOGI(TAG, "%-4s %s q%-2u: %7.2f ms/frame %5.2f MPix/s %6u bytes",
+                         sizes[s].name, formats[f] == PIXFORMAT_RGB565 ? "rgb565" : "yuv422", qualities[q],
+                         ms, (w * h) / (ms * 1000.0f), (unsigned)sink.total);
+            }
+            heap_caps_free(frame);
+        }
+    }
+    ESP_LOGI(TAG, "peak output buffering: %u bytes (ring) vs full-frame fmt2jpg: 131072 bytes", (unsigned)CHUNK_RING_LEN);
+    heap_caps_free(ring);
+}
@@ -0,0 +1,190 @@
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "esp_jpg_decode.h"
+#include "img_converters.h"
+
+static const char *TAG = "test_jpg_stripe";
+
+#define STRIPE_BENCH_TIMES 8
+// tjpgd refills its input from the reader in chunks of this size (JD_SZBUF)
+#define STRIPE_JD_INPUT_BUF 512
+
+extern const uint8_t outside_jpg_start[] asm("_binary_test_outside_jpeg_start");
+extern const uint8_t outside_jpg_end[]   asm("_binary_test_outside_jpeg_end");
+
+typedef struct {
+    const uint8_t *jpg;
+    size_t len;
+    jpg_scale_t scale;
+    uint32_t sum;
+    uint32_t rows;
+    size_t read;
+    uint16_t *frame;
+    bool swap_bytes;
+    esp_err_t err;
+    SemaphoreHandle_t done;
+} stripe_job_t;
+
+static size_t stripe_read(void *arg, size_t index, uint8_t *buf, size_t len)
+{
+    stripe_job_t *job = (stripe_job_t *)arg;
+    if (index + len > job->len) {
+        return 0;
+    }
+    if (buf) {
+        memcpy(buf, job->jpg + index, len);
+    }
+    job->read += len;
+    return len;
+}
+
+static bool stripe_sink(void *arg, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels)
+{
+    stripe_job_t *job = (stripe_job_t *)arg;
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+        job->sum = job->sum * 31 + pixels[i];
+    }
+    if (job->frame) {
+        memcpy(job->frame + (size_t)y * w, pixels, (size_t)w * h * 2);
+    }
+    job->rows += h;
+    return true;
+}
+
+// Context and stripe are the only memory a decode needs
+static void stripe_decode(stripe_job_t *job)
+{
+    job->sum = 0;
+    job->rows = 0;
+    job->read = 0;
+    job->err = ESP_ERR_NO_MEM;
+    void *work = heap_caps_malloc(ESP_JPG_DECODE_WORK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!work) {
+        return;
+    }
+
+    esp_jpg_dec_handle_t dec = NULL;
+    esp_jpg_dec_info_t info = {0};
+    job->err = esp_jpg_dec_open(work, ESP_JPG_DECODE_WORK_SIZE, job->len, stripe_read, job, &dec);
+    if (job->err == ESP_OK) {
+        esp_jpg_dec_get_info(dec, job->scale, &info);
+        size_t stripe_pixels = (size_t)info.width * info.stripe_height;
+        uint16_t *stripe = heap_caps_malloc(stripe_pixels * 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+        if (stripe) {
+            job->err = esp_jpg_dec_decode_stripes(dec, job->scale, stripe, stripe_pixels, job->swap_bytes, stripe_sink, job);
+            heap_caps_free(stripe);
+        } else {
+            job->err = ESP_ERR_NO_MEM;
+        }
+    }
+    heap_caps_free(work);
+}
+
+TEST_CASE("Conversions jpeg stripe decode benchmark", "[camera]")
+{
+    stripe_job_t job = {
+        .jpg = outside_jpg_start,
+        .len = outside_jpg_end - outside_jpg_start,
+        .swap_bytes = true,
+    };
+
+    for (jpg_scale_t scale = JPG_SCALE_NONE; scale <= JPG_SCALE_2X; scale++) {
+        job.scale = scale;
+        int64_t total = 0;
+        for (int i = 0; i < STRIPE_BENCH_TIMES; i++) {
+            int64_t t1 = esp_timer_get_time();
+            stripe_decode(&job);
+            total += esp_timer_get_time() - t1;
+            TEST_ASSERT_EQUAL(ESP_OK, job.err);
+        }
+        TEST_ASSERT_EQUAL(320 >> scale, job.rows);
+        ESP_LOGI(TAG, "480x320 1/%d stripes: %.2f ms/frame, %u bytes", 1 << scale,
+                 total / 1000.0f / STRIPE_BENCH_TIMES, (unsigned)(ESP_JPG_DECODE_WORK_SIZE + (480 >> scale) * (16 >> scale) * 2));
+    }
+
+    // Same image through the full-frame path for comparison
+    uint8_t *frame = heap_caps_malloc(480 * 320 * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(frame);
+    int64_t total = 0;
+    for (int i = 0; i < STRIPE_BENCH_TIMES; i++) {
+        int64_t t1 = esp_timer_get_time();
+        TEST_ASSERT_TRUE(jpg2rgb565(job.jpg, job.len, frame, JPG_SCALE_NONE));
+        total += esp_timer_get_time() - t1;
+    }
+    ESP_LOGI(TAG, "480x320 jpg2rgb565 full frame: %.2f ms/frame, %u bytes", total / 1000.0f / STRIPE_BENCH_TIMES,
+             (unsigned)(ESP_JPG_DECODE_WORK_SIZE + 480 * 320 * 2));
+    heap_caps_free(frame);
+}
+
+TEST_CASE("Conversions jpeg stripe decode matches full frame", "[camera]")
+{
+    stripe_job_t job = {
+        .jpg = outside_jpg_start,
+        .len = outside_jpg_end - outside_jpg_start,
+    };
+    // The image must outgrow one input buffer so the reader is called mid-decode
+    TEST_ASSERT_GREATER_THAN(STRIPE_JD_INPUT_BUF, job.len);
+
+    uint8_t *ref = heap_caps_malloc(480 * 320 * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    job.frame = heap_caps_calloc(480 * 320, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(job.frame);
+    TEST_ASSERT_TRUE(jpg2rgb565(job.jpg, job.len, ref, JPG_SCALE_NONE));
+
+    stripe_decode(&job);
+    TEST_ASSERT_EQUAL(ESP_OK, job.err);
+    TEST_ASSERT_EQUAL(320, job.rows);
+    TEST_ASSERT_EQUAL(job.len, job.read);
+    TEST_ASSERT_EQUAL_MEMORY(ref, job.frame, 480 * 320 * 2);
+
+    heap_caps_free(job.frame);
+    heap_caps_free(ref);
+}
+
+static void stripe_decode_task(void *arg)
+{
+    stripe_job_t *job = (stripe_job_t *)arg;
+    for (int i = 0; i < STRIPE_BENCH_TIMES && job->err == ESP_OK; i++) {
+        uint32_t expected = job->sum;
+        stripe_decode(job);
+        if (job->err == ESP_OK && job->sum != expected) {
+            job->err = ESP_ERR_INVALID_CRC;
+        }
+    }
+    xSemaphoreGive(job->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Conversions jpeg concurrent stripe decode test", "[camera]")
+{
+    stripe_job_t ref = {
+        .jpg = outside_jpg_start,
+        .len = outside_jpg_end - outside_jpg_start,
+        .swap_bytes = true,
+    };
+    stripe_decode(&ref);
+    TEST_ASSERT_EQUAL(ESP_OK, ref.err);
+
+    // Two decoders of the same image on both cores must not disturb each other
+    stripe_job_t jobs[2] = {ref, ref};
+    for (int i = 0; i < 2; i++) {
+        jobs[i].done = xSemaphoreCreateBinary();
+        TEST_ASSERT_NOT_NULL(jobs[i].done);
+        xTaskCreatePinnedToCore(stripe_decode_task, "jpg_stripe", 4096, &jobs[i], 5, NULL, i);
+    }
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_TRUE(xSemaphoreTake(jobs[i].done, pdMS_TO_TICKS(10000)));
+        vSemaphoreDelete(jobs[i].done);
+        TEST_ASSERT_EQUAL(ESP_OK, jobs[i].err);
+        TEST_ASSERT_EQUAL_HEX32(ref.sum, jobs[i].sum);
+    }
+}
@@ -0,0 +1,147 @@
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_heap_caps.h"
+
+#include "pixconv.h"
+
+static const char *TAG = "test_pixconv";
+
+#define BENCH_WIDTH  320
+#define BENCH_HEIGHT 240
+#define BENCH_ROUNDS 4
+
+typedef void (*bench_kernel_t)(const uint8_t *src, uint8_t *dst, size_t pixels);
+
+static void bench_yuv422_to_rgb565(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_yuv422_to_rgb565(src, dst, pixels);
+}
+
+static void bench_yuv422_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_yuv422_to_rgb888(src, dst, pixels, true);
+}
+
+static void bench_rgb565_to_rgb888(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_rgb565_to_rgb888(src, dst, pixels, false);
+}
+
+static void bench_rgb888_to_rgb565le(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    pixconv_rgb888_to_rgb565le(src, dst, pixels);
+}
+
+static const struct {
+    const char *name;
+    bench_kernel_t run;
+    size_t out_bpp;
+} bench_kernels[] = {
+    { "yuv422->rgb565", bench_yuv422_to_rgb565, 2 },
+    { "yuv422->rgb888", bench_yuv422_to_rgb888, 3 },
+    { "rgb565->rgb888", bench_rgb565_to_rgb888, 3 },
+    { "rgb888->rgb565", bench_rgb888_to_rgb565le, 2 },
+    { "rgb565 swap", pixconv_rgb565_byteswap, 2 },
+    { "yuv422->gray", pixconv_yuv422_to_gray, 1 },
+};
+
+// One QVGA frame converted line by line, as the call sites do
+static uint32_t bench_frame_us(bench_kernel_t run, const uint8_t *src, uint8_t *dst, size_t out_bpp)
+{
+    int64_t best = INT64_MAX;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        int64_t t0 = esp_timer_get_time();
+        for (int y = 0; y < BENCH_HEIGHT; y++) {
+            run(src + y * BENCH_WIDTH * 3, dst + y * BENCH_WIDTH * out_bpp, BENCH_WIDTH);
+        }
+        int64_t t = esp_timer_get_time() - t0;
+        if (t < best) {
+            best = t;
+        }
+    }
+    return (uint32_t)best;
+}
+
+TEST_CASE("Conversions pixel kernel benchmark", "[camera]")
+{
+    pixconv_impl_t saved = pixconv_active();
+    size_t frame = BENCH_WIDTH * BENCH_HEIGHT * 3;
+    uint8_t *src = heap_caps_aligned_alloc(16, frame, MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    uint8_t *ref = heap_caps_aligned_alloc(16, frame, MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    uint8_t *out = heap_caps_aligned_alloc(16, frame, MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(out);
+    esp_fill_random(src, frame);
+
+    for (int k = 0; k < sizeof(bench_kernels) / sizeof(bench_kernels[0]); k++) {
+        uint32_t scalar_us = 0;
+        for (pixconv_impl_t impl = PIXCONV_IMPL_SCALAR; impl < PIXCONV_IMPL_MAX; impl++) {
+            if (!pixconv_select(impl)) {
+                continue;
+            }
+            uint8_t *dst = (impl == PIXCONV_IMPL_SCALAR) ? ref : out;
+            uint32_t us = bench_frame_us(bench_kernels[k].run, src, dst, bench_kernels[k].out_bpp);
+            if (impl == PIXCONV_IMPL_SCALAR) {
+                scalar_us = us;
+            } else {
+                TEST_ASSERT_EQUAL_HEX8_ARRAY(ref, out, BENCH_WIDTH * BENCH_HEIGHT * bench_kernels[k].out_bpp);
+            }
+            uint32_t kpix_per_s = (uint32_t)((uint64_t)BENCH_WIDTH * BENCH_HEIGHT * 1000 / us);
+            ESP_LOGI(TAG, "%-15s %-8s %3lu.%02lu MPix/s  x%lu.%02lu", bench_kernels[k].name, pixconv_impl_name(impl),
+                     (unsigned long)(kpix_per_s / 1000), (unsigned long)(kpix_per_s % 1000 / 10),
+                     (unsigned long)(scalar_us / us), (unsigned long)(scalar_us * 100 / us % 100));
+        }
+    }
+
+    pixconv_select(saved);
+    heap_caps_free(src);
+    heap_caps_free(ref);
+    heap_caps_free(out);
+}
+
+// The PIE kernels only take 16-byte aligned blocks; everything else goes to the C kernels
+TEST_CASE("Conversions pixel kernels on unaligned and short lines", "[camera]")
+{
+    static const size_t offsets[] = { 0, 2, 4, 16 };
+    static const size_t lengths[] = { 2, 14, 16, 18, 46, 320 };
+    pixconv_impl_t saved = pixconv_active();
+    size_t line = 320 * 3 + 32;
+    uint8_t *src = heap_caps_aligned_alloc(16, line, MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    uint8_t *ref = heap_caps_aligned_alloc(16, line, MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    uint8_t *out = heap_caps_aligned_alloc(16, line, MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(out);
+    esp_fill_random(src, line);
+
+    for (int k = 0; k < sizeof(bench_kernels) / sizeof(bench_kernels[0]); k++) {
+        for (int o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++) {
+            for (int n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+                size_t bytes = lengths[n] * bench_kernels[k].out_bpp;
+                pixconv_select(PIXCONV_IMPL_SCALAR);
+                bench_kernels[k].run(src + offsets[o], ref + offsets[o], lengths[n]);
+                for (pixconv_impl_t impl = PIXCONV_IMPL_PORTABLE; impl < PIXCONV_IMPL_MAX; impl++) {
+                    if (!pixconv_select(impl)) {
+                        continue;
+                    }
+                    memset(out, 0, line);
+                    bench_kernels[k].run(src + offsets[o], out + offsets[o], lengths[n]);
+                    TEST_ASSERT_EQUAL_HEX8_ARRAY(ref + offsets[o], out + offsets[o], bytes);
+                }
+            }
+        }
+    }
+
+    pixconv_select(saved);
+    heap_caps_free(src);
+    heap_caps_free(ref);
+    heap_caps_free(out);
+}
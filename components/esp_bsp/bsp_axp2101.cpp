@@ -3,13 +3,16 @@
 #include "sdkconfig.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_attr.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 #include "driver/i2c_master.h"
 
 #include "bsp_i2c.h"
+#include "bsp_axp2101.h"
 
 #define XPOWERS_CHIP_AXP2101
 #include "XPowersLib.h"
@@ -18,14 +21,26 @@ static const char *TAG = "AXP2101";
 XPowersPMU power;
 i2c_master_dev_handle_t i2c_device;
 
+#define PMU_SERVICE_STACK_SIZE (3 * 1024)
+#define PMU_SERVICE_PRIORITY 2
+#define PMU_ADC_BURST_LEN (XPOWERS_AXP2101_ADC_DATA_RELUST9 - XPOWERS_AXP2101_ADC_DATA_RELUST0 + 1)
+
+static TaskHandle_t s_pmu_task = NULL;
+static QueueHandle_t s_pmu_events = NULL;
+static TaskHandle_t volatile s_pmu_event_notify = NULL;
+static volatile uint32_t s_pmu_period_ms = BSP_PMU_SERVICE_DEFAULT_PERIOD_MS;
+static portMUX_TYPE s_pmu_snapshot_lock = portMUX_INITIALIZER_UNLOCKED;
+static bsp_axp2101_snapshot_t s_pmu_snapshot = {};
+static uint32_t s_pmu_events_dropped = 0;
+
 static esp_err_t i2c_init(i2c_master_bus_handle_t bus_handle)
 {
-    i2c_device_config_t i2c_dev_conf = {};
+    bsp_i2c_dev_config_t i2c_dev_conf = {};
 
-    i2c_dev_conf.dev_addr_length = I2C_ADDR_BIT_LEN_7;
-    i2c_dev_conf.device_address = 0X34;
-    i2c_dev_conf.scl_speed_hz = 400 * 1000;
-    return i2c_master_bus_add_device(bus_handle, &i2c_dev_conf, &i2c_device);
+    i2c_dev_conf.name = "axp2101";
+    i2c_dev_conf.addr = 0X34;
+    i2c_dev_conf.max_hz = BSP_I2C_SPEED_FM_HZ;
+    return bsp_i2c_add_device(bus_handle, &i2c_dev_conf, &i2c_device);
 }
 
 static int pmu_register_read(uint8_t devAddr, uint8_t regAddr, uint8_t *data, uint8_t len)
@@ -42,7 +57,7 @@ static int pmu_register_read(uint8_t devAddr, uint8_t regAddr, uint8_t *data, ui
 
     if (bsp_i2c_lock(0))
     {
-        ret = i2c_master_transmit_receive(i2c_device, (const uint8_t *)&regAddr, 1, data, len, pdMS_TO_TICKS(1000));
+        ret = bsp_i2c_transmit_receive(i2c_device, (const uint8_t *)&regAddr, 1, data, len, pdMS_TO_TICKS(1000));
         bsp_i2c_unlock();
     }
     return (ret == ESP_OK) ? 0 : -1;
@@ -64,7 +79,12 @@ static int pmu_register_write_byte(uint8_t devAddr, uint8_t regAddr, uint8_t *da
     write_buffer[0] = regAddr;
     memcpy(write_buffer + 1, data, len);
 
-    ret = i2c_master_transmit(i2c_device, write_buffer, len + 1, -1);
+    ret = ESP_FAIL;
+    if (bsp_i2c_lock(0))
+    {
+        ret = bsp_i2c_transmit(i2c_device, write_buffer, len + 1, -1);
+        bsp_i2c_unlock();
+    }
     free(write_buffer);
     return ret == ESP_OK ? 0 : -1;
 }
@@ -495,6 +515,287 @@ esp_err_t esp_axp2101_port_init1(i2c_master_bus_handle_t bus_handle)
     return ESP_OK;
 }
 
+static esp_err_t pmu_burst_read(uint8_t reg, uint8_t *data, size_t len)
+{
+    return bsp_i2c_transmit_receive(i2c_device, &reg, 1, data, len, pdMS_TO_TICKS(100));
+}
+
+static void pmu_post_event(bsp_pmu_event_type_t type, uint32_t now_ms)
+{
+    bsp_pmu_event_t evt = {};
+    evt.type = type;
+    evt.time_ms = now_ms;
+    if (xQueueSend(s_pmu_events, &evt, 0) != pdTRUE)
+    {
+        s_pmu_events_dropped++;
+        ESP_LOGW(TAG, "event queue full, dropped %s (%lu total)", bsp_axp2101_event_name(type),
+                 (unsigned long)s_pmu_events_dropped);
+        return;
+    }
+
+    TaskHandle_t consumer = s_pmu_event_notify;
+    if (consumer != NULL)
+    {
+        xTaskNotifyGive(consumer);
+    }
+}
+
+// One service tick: four burst transactions under a single bus lock instead of
+// the ~20 single-register reads the XPowersLib getters would issue.
+static esp_err_t pmu_service_sample(void)
+{
+    uint8_t status[2] = {0};
+    uint8_t adc[PMU_ADC_BURST_LEN] = {0};
+    uint8_t irq[XPOWERS_AXP2101_INTSTS_CNT] = {0};
+    uint8_t percent = 0;
+
+    if (!bsp_i2c_lock(200))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = pmu_burst_read(XPOWERS_AXP2101_STATUS1, status, sizeof(status));
+    if (ret == ESP_OK)
+    {
+        ret = pmu_burst_read(XPOWERS_AXP2101_ADC_DATA_RELUST0, adc, sizeof(adc));
+    }
+    if (ret == ESP_OK)
+    {
+        ret = pmu_burst_read(XPOWERS_AXP2101_INTSTS1, irq, sizeof(irq));
+    }
+    if (ret == ESP_OK)
+    {
+        ret = pmu_burst_read(XPOWERS_AXP2101_BAT_PERCENT_DATA, &percent, 1);
+    }
+    if (ret == ESP_OK && (irq[0] | irq[1] | irq[2]) != 0)
+    {
+        // Status bits are write-1-to-clear; ack exactly what we are about to report
+        uint8_t ack[1 + XPOWERS_AXP2101_INTSTS_CNT] = {XPOWERS_AXP2101_INTSTS1, irq[0], irq[1], irq[2]};
+        ret = bsp_i2c_transmit(i2c_device, ack, sizeof(ack), pdMS_TO_TICKS(100));
+    }
+    bsp_i2c_unlock();
+
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    bsp_axp2101_snapshot_t snap = {};
+    snap.battery_present = (status[0] & (1 << 3)) != 0;
+    snap.vbus_present = (status[0] & (1 << 5)) != 0 && (status[1] & (1 << 3)) == 0;
+    snap.charging = (status[1] >> 5) == 0x01;
+    snap.charge_state = status[1] & 0x07;
+    snap.vbat_mv = snap.battery_present ? (uint16_t)(((adc[0] & 0x1F) << 8) | adc[1]) : 0;
+    snap.vbus_mv = snap.vbus_present ? (uint16_t)(((adc[4] & 0x3F) << 8) | adc[5]) : 0;
+    snap.vsys_mv = (uint16_t)(((adc[6] & 0x3F) << 8) | adc[7]);
+    int32_t tdie_raw = ((adc[8] & 0x3F) << 8) | adc[9];
+    snap.die_temp_c_x10 = (int16_t)(220 + (7274 - tdie_raw) / 2);   // XPOWERS_AXP2101_CONVERSION in 0.1 C
+    snap.battery_percent = snap.battery_present ? percent : -1;
+    snap.updated_ms = now_ms;
+
+    taskENTER_CRITICAL(&s_pmu_snapshot_lock);
+    snap.seq = s_pmu_snapshot.seq + 1;
+    s_pmu_snapshot = snap;
+    taskEXIT_CRITICAL(&s_pmu_snapshot_lock);
+
+    // Same bit layout as the XPOWERS_AXP2101_*_IRQ enable masks
+    uint32_t irq_bits = (uint32_t)irq[0] | ((uint32_t)irq[1] << 8) | ((uint32_t)irq[2] << 16);
+    if (irq_bits & XPOWERS_AXP2101_VBUS_INSERT_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_VBUS_INSERT, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_VBUS_REMOVE_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_VBUS_REMOVE, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_BAT_INSERT_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_BATTERY_INSERT, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_BAT_REMOVE_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_BATTERY_REMOVE, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_BAT_CHG_START_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_CHARGE_START, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_BAT_CHG_DONE_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_CHARGE_DONE, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_WARNING_LEVEL1_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_LOW_BATTERY, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_WARNING_LEVEL2_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_CRITICAL_BATTERY, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_PKEY_SHORT_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_PKEY_SHORT, now_ms);
+    }
+    if (irq_bits & XPOWERS_AXP2101_PKEY_LONG_IRQ)
+    {
+        pmu_post_event(BSP_PMU_EVENT_PKEY_LONG, now_ms);
+    }
+
+    return ESP_OK;
+}
+
+static void IRAM_ATTR pmu_irq_gpio_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    if (s_pmu_task != NULL)
+    {
+        vTaskNotifyGiveFromISR(s_pmu_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void pmu_service_task(void *arg)
+{
+    (void)arg;
+    uint32_t fail_count = 0;
+
+    while (true)
+    {
+        if (pmu_service_sample() != ESP_OK)
+        {
+            if ((fail_count++ % 10) == 0)
+            {
+                ESP_LOGW(TAG, "PMU sample failed (%lu)", (unsigned long)fail_count);
+            }
+        }
+        else
+        {
+            fail_count = 0;
+        }
+
+        // Period wait doubles as the IRQ wait: the GPIO ISR (when wired) cuts it short
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(s_pmu_period_ms));
+    }
+}
+
+esp_err_t bsp_axp2101_service_start(uint32_t period_ms)
+{
+    if (s_pmu_task != NULL)
+    {
+        bsp_axp2101_service_set_period(period_ms);
+        return ESP_OK;
+    }
+    if (i2c_device == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_pmu_events = xQueueCreate(BSP_PMU_EVENT_QUEUE_LEN, sizeof(bsp_pmu_event_t));
+    if (s_pmu_events == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    bsp_axp2101_service_set_period(period_ms);
+
+    // Die temperature ADC and gauge warning levels are off after bsp_axp2101_init
+    power.enableTemperatureMeasure();
+    power.setLowBatWarnThreshold(BSP_PMU_LOW_BATTERY_WARN_PCT);
+    power.setLowBatShutdownThreshold(BSP_PMU_LOW_BATTERY_CRIT_PCT);
+    power.enableIRQ(XPOWERS_AXP2101_WARNING_LEVEL1_IRQ | XPOWERS_AXP2101_WARNING_LEVEL2_IRQ);
+
+    if (xTaskCreate(pmu_service_task, "pmu_service", PMU_SERVICE_STACK_SIZE, NULL, PMU_SERVICE_PRIORITY, &s_pmu_task) != pdPASS)
+    {
+        vQueueDelete(s_pmu_events);
+        s_pmu_events = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (BSP_PMU_IRQ_GPIO != GPIO_NUM_NC)
+    {
+        gpio_config_t io_conf = {};
+        io_conf.pin_bit_mask = 1ULL << BSP_PMU_IRQ_GPIO;
+        io_conf.mode = GPIO_MODE_INPUT;
+        io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+        io_conf.intr_type = GPIO_INTR_NEGEDGE;
+        ESP_ERROR_CHECK(gpio_config(&io_conf));
+        esp_err_t ret = gpio_install_isr_service(0);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+        {
+            ESP_LOGW(TAG, "GPIO ISR service unavailable, polling only: %s", esp_err_to_name(ret));
+        }
+        else
+        {
+            gpio_isr_handler_add(BSP_PMU_IRQ_GPIO, pmu_irq_gpio_isr, NULL);
+        }
+    }
+
+    ESP_LOGI(TAG, "PMU service started (%lu ms, irq gpio %d)", (unsigned long)s_pmu_period_ms, (int)BSP_PMU_IRQ_GPIO);
+    return ESP_OK;
+}
+
+void bsp_axp2101_service_set_period(uint32_t period_ms)
+{
+    s_pmu_period_ms = (period_ms == 0) ? BSP_PMU_SERVICE_DEFAULT_PERIOD_MS : period_ms;
+}
+
+// The consumer can then block on its task notification instead of polling the queue
+void bsp_axp2101_service_set_event_notify(TaskHandle_t task)
+{
+    s_pmu_event_notify = task;
+}
+
+bool bsp_axp2101_get_snapshot(bsp_axp2101_snapshot_t *out)
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL(&s_pmu_snapshot_lock);
+    *out = s_pmu_snapshot;
+    taskEXIT_CRITICAL(&s_pmu_snapshot_lock);
+    return out->seq != 0;
+}
+
+bool bsp_axp2101_get_event(bsp_pmu_event_t *out, uint32_t timeout_ms)
+{
+    if (out == NULL || s_pmu_events == NULL)
+    {
+        return false;
+    }
+    return xQueueReceive(s_pmu_events, out, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+const char *bsp_axp2101_event_name(bsp_pmu_event_type_t type)
+{
+    switch (type)
+    {
+    case BSP_PMU_EVENT_VBUS_INSERT:
+        return "vbus-insert";
+    case BSP_PMU_EVENT_VBUS_REMOVE:
+        return "vbus-remove";
+    case BSP_PMU_EVENT_BATTERY_INSERT:
+        return "battery-insert";
+    case BSP_PMU_EVENT_BATTERY_REMOVE:
+        return "battery-remove";
+    case BSP_PMU_EVENT_CHARGE_START:
+        return "charge-start";
+    case BSP_PMU_EVENT_CHARGE_DONE:
+        return "charge-done";
+    case BSP_PMU_EVENT_LOW_BATTERY:
+        return "low-battery";
+    case BSP_PMU_EVENT_CRITICAL_BATTERY:
+        return "critical-battery";
+    case BSP_PMU_EVENT_PKEY_SHORT:
+        return "pkey-short";
+    case BSP_PMU_EVENT_PKEY_LONG:
+        return "pkey-long";
+    default:
+        break;
+    }
+    return "?";
+}
+
 void pmu_isr_handler(void)
 {
     // Get PMU Interrupt Status Register
@@ -1,12 +1,66 @@
 #pragma once
 
 #include <stdio.h>
+#include "driver/gpio.h"
 #include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #define XPOWERS_CHIP_AXP2101
 #include "XPowersLib.h"
 
 // extern XPowersPMU power;
 
+#ifndef BSP_PMU_IRQ_GPIO
+#define BSP_PMU_IRQ_GPIO GPIO_NUM_NC // AXP2101 IRQ is not routed on this board; status is polled
+#endif
+
+#define BSP_PMU_SERVICE_DEFAULT_PERIOD_MS 2000
+#define BSP_PMU_EVENT_QUEUE_LEN 8
+#define BSP_PMU_LOW_BATTERY_WARN_PCT 15
+#define BSP_PMU_LOW_BATTERY_CRIT_PCT 5
+
+typedef struct
+{
+    uint16_t vbat_mv;
+    uint16_t vbus_mv;
+    uint16_t vsys_mv;
+    int16_t die_temp_c_x10;
+    int battery_percent;
+    uint8_t charge_state;   // STATUS2[2:0], see xpowers_chg_status_t
+    bool battery_present;
+    bool vbus_present;
+    bool charging;
+    uint32_t updated_ms;
+    uint32_t seq;
+} bsp_axp2101_snapshot_t;
+
+typedef enum
+{
+    BSP_PMU_EVENT_VBUS_INSERT = 0,
+    BSP_PMU_EVENT_VBUS_REMOVE,
+    BSP_PMU_EVENT_BATTERY_INSERT,
+    BSP_PMU_EVENT_BATTERY_REMOVE,
+    BSP_PMU_EVENT_CHARGE_START,
+    BSP_PMU_EVENT_CHARGE_DONE,
+    BSP_PMU_EVENT_LOW_BATTERY,
+    BSP_PMU_EVENT_CRITICAL_BATTERY,
+    BSP_PMU_EVENT_PKEY_SHORT,
+    BSP_PMU_EVENT_PKEY_LONG,
+    BSP_PMU_EVENT_COUNT,
+} bsp_pmu_event_type_t;
+
+typedef struct
+{
+    bsp_pmu_event_type_t type;
+    uint32_t time_ms;
+} bsp_pmu_event_t;
+
 esp_err_t bsp_axp2101_init(i2c_master_bus_handle_t bus_handle);
-void pmu_isr_handler(void);
\ No newline at end of file
+esp_err_t bsp_axp2101_service_start(uint32_t period_ms);
+void bsp_axp2101_service_set_period(uint32_t period_ms);
+void bsp_axp2101_service_set_event_notify(TaskHandle_t task);
+bool bsp_axp2101_get_snapshot(bsp_axp2101_snapshot_t *out);
+bool bsp_axp2101_get_event(bsp_pmu_event_t *out, uint32_t timeout_ms);
+const char *bsp_axp2101_event_name(bsp_pmu_event_type_t type);
+void pmu_isr_handler(void);
@@ -61,7 +61,7 @@ static void bme280_release_device(void)
 {
     if (s_dev_handle != NULL)
     {
-        i2c_master_bus_rm_device(s_dev_handle);
+        bsp_i2c_rm_device(s_dev_handle);
         s_dev_handle = NULL;
     }
     s_available = false;
@@ -86,7 +86,7 @@ static esp_err_t bme280_reg_read(uint8_t reg_addr, uint8_t *data, size_t len)
     esp_err_t ret = ESP_FAIL;
     if (bsp_i2c_lock(BME280_I2C_LOCK_TIMEOUT_MS))
     {
-        ret = i2c_master_transmit_receive(s_dev_handle, &reg_addr, 1, data, len, BME280_I2C_XFER_TIMEOUT_MS);
+        ret = bsp_i2c_transmit_receive(s_dev_handle, &reg_addr, 1, data, len, BME280_I2C_XFER_TIMEOUT_MS);
         bsp_i2c_unlock();
     }
     else
@@ -107,7 +107,7 @@ static esp_err_t bme280_reg_write_u8(uint8_t reg_addr, uint8_t value)
     esp_err_t ret = ESP_FAIL;
     if (bsp_i2c_lock(BME280_I2C_LOCK_TIMEOUT_MS))
     {
-        ret = i2c_master_transmit(s_dev_handle, buf, sizeof(buf), BME280_I2C_XFER_TIMEOUT_MS);
+        ret = bsp_i2c_transmit(s_dev_handle, buf, sizeof(buf), BME280_I2C_XFER_TIMEOUT_MS);
         bsp_i2c_unlock();
     }
     else
@@ -182,6 +182,18 @@ static esp_err_t bme280_configure(void)
     return bme280_reg_write_u8(BME280_REG_CONFIG, 0xA0); // 1000ms standby
 }
 
+static esp_err_t bme280_verify(i2c_master_dev_handle_t dev)
+{
+    uint8_t reg = BME280_REG_CHIP_ID;
+    uint8_t chip_id = 0;
+    esp_err_t ret = i2c_master_transmit_receive(dev, &reg, 1, &chip_id, 1, BME280_I2C_XFER_TIMEOUT_MS);
+    if (ret == ESP_OK && chip_id != BME280_CHIP_ID)
+    {
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+    return ret;
+}
+
 static bool bme280_probe_addr(i2c_master_bus_handle_t bus_handle, uint8_t addr)
 {
     for (int attempt = 0; attempt < BME280_PROBE_RETRIES; ++attempt)
@@ -257,15 +269,17 @@ esp_err_t bsp_bme280_init(i2c_master_bus_handle_t bus_handle)
             ESP_LOGW(TAG, "probe miss @0x%02X, trying direct chip-id read", addr);
         }
 
-        i2c_device_config_t dev_cfg = {
-            .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-            .device_address = addr,
-            .scl_speed_hz = 100000,
+        // Rated above the bus cap, so the whole ladder is tried; the chip id qualifies each speed
+        bsp_i2c_dev_config_t dev_cfg = {
+            .name = "bme280",
+            .addr = addr,
+            .max_hz = BSP_I2C_BUS_MAX_HZ,
             .scl_wait_us = 2000,
+            .verify = bme280_verify,
         };
 
         i2c_master_dev_handle_t candidate = NULL;
-        esp_err_t ret = i2c_master_bus_add_device(bus_handle, &dev_cfg, &candidate);
+        esp_err_t ret = bsp_i2c_add_device(bus_handle, &dev_cfg, &candidate);
         if (ret != ESP_OK)
         {
             ESP_LOGW(TAG, "add_device 0x%02X failed: %s", addr, esp_err_to_name(ret));
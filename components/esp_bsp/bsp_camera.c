@@ -1,5 +1,5 @@
 
-#include "esp_camera.h"
+#include "bsp_camera.h"
 #include "driver/i2c_master.h"
 
 
@@ -24,7 +24,7 @@
 #define CAM_LEDC_TIMER      LEDC_TIMER_1
 #define CAM_LEDC_CHANNEL    LEDC_CHANNEL_0
 
-void bsp_camera_init(i2c_port_num_t i2c_port) 
+esp_err_t bsp_camera_init(i2c_port_num_t i2c_port)
 {
     camera_config_t config;
     config.ledc_channel = CAM_LEDC_CHANNEL;
@@ -50,10 +50,12 @@ void bsp_camera_init(i2c_port_num_t i2c_port)
     config.frame_size = FRAMESIZE_320X480;
     config.pixel_format = PIXFORMAT_RGB565; // for streaming
     // config.pixel_format = PIXFORMAT_RGB565; // for face detection/recognition
-    config.grab_mode = CAMERA_GRAB_WHEN_EMPTY;
+    // Several PSRAM buffers so capture overlaps the panel transfer of the previous frame;
+    // GRAB_LATEST hands out the freshest one when the consumer falls behind.
+    config.grab_mode = CAMERA_GRAB_LATEST;
     config.fb_location = CAMERA_FB_IN_PSRAM;
     config.jpeg_quality = 12;
-    config.fb_count = 1;
+    config.fb_count = BSP_CAMERA_FB_COUNT;
 
     esp_err_t err = esp_camera_init(&config);
     
@@ -61,8 +63,13 @@ void bsp_camera_init(i2c_port_num_t i2c_port)
     if (err != ESP_OK)
     {
         printf("Camera init failed with error 0x%x", err);
-        return;
+        return err;
     }
     sensor_t *s = esp_camera_sensor_get();
+    if (s == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
     s->set_vflip(s, 1);
+    return ESP_OK;
 }
\ No newline at end of file
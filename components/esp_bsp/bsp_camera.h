@@ -3,12 +3,13 @@
 #include "esp_camera.h"
 #include "driver/i2c_master.h"
 
+#define BSP_CAMERA_FB_COUNT 3 // 320x480 RGB565 frames in PSRAM: one filling, one queued, one on the panel
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void bsp_camera_init(i2c_port_num_t i2c_port);
+esp_err_t bsp_camera_init(i2c_port_num_t i2c_port);
 
 #ifdef __cplusplus
 }
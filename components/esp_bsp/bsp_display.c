@@ -11,10 +11,22 @@
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_log.h"
+#include "esp_lcd_panel_commands.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "bsp_display";
 
 static uint8_t g_brightness = 0;
+static bool g_fade_installed = false;
+static bool g_panel_sleeping = false;
+static esp_lcd_panel_io_handle_t g_panel_io = NULL;
+static SemaphoreHandle_t g_te_sem = NULL;
+
+#define LCD_QSPI_OPCODE_WRITE_CMD (0x02)
+#define LCD_QSPI_CMD(cmd) ((LCD_QSPI_OPCODE_WRITE_CMD << 24) | (((cmd) & 0xff) << 8))
 
 
 static const axs15231b_lcd_init_cmd_t lcd_init_cmds[] = {
@@ -75,6 +87,7 @@ void bsp_display_init(esp_lcd_panel_io_handle_t *io_handle, esp_lcd_panel_handle
     io_config.pclk_hz = EXAMPLE_LCD_PIXEL_CLOCK_HZ;
     // Attach the LCD to the SPI bus
     ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)EXAMPLE_SPI_HOST, &io_config, io_handle));
+    g_panel_io = *io_handle;
 
 
     axs15231b_vendor_config_t vendor_config = {};
@@ -120,6 +133,19 @@ void bsp_display_brightness_init(void)
     ledc_channel.duty = 0, // Set duty to 0%
         ledc_channel.hpoint = 0;
     ESP_ERROR_CHECK(ledc_channel_config(&ledc_channel));
+
+    // Hardware fade lets the power manager ramp the backlight without a polling task
+    esp_err_t ret = ledc_fade_func_install(0);
+    g_fade_installed = (ret == ESP_OK || ret == ESP_ERR_INVALID_STATE);
+    if (!g_fade_installed)
+    {
+        ESP_LOGW(TAG, "LEDC fade unavailable: %s", esp_err_to_name(ret));
+    }
+}
+
+static uint32_t brightness_to_duty(uint8_t brightness)
+{
+    return (brightness * (LCD_BL_LEDC_DUTY - 1)) / 100;
 }
 
 void bsp_display_set_brightness(uint8_t brightness)
@@ -131,7 +157,7 @@ void bsp_display_set_brightness(uint8_t brightness)
     }
 
     g_brightness = brightness;
-    uint32_t duty = (brightness * (LCD_BL_LEDC_DUTY - 1)) / 100;
+    uint32_t duty = brightness_to_duty(brightness);
 
     ESP_ERROR_CHECK(ledc_set_duty(LCD_BL_LEDC_MODE, LCD_BL_LEDC_CHANNEL, duty));
     ESP_ERROR_CHECK(ledc_update_duty(LCD_BL_LEDC_MODE, LCD_BL_LEDC_CHANNEL));
@@ -142,4 +168,132 @@ void bsp_display_set_brightness(uint8_t brightness)
 uint8_t bsp_display_get_brightness(void)
 {
     return g_brightness;
-}
\ No newline at end of file
+}
+
+void bsp_display_fade_brightness(uint8_t brightness, uint32_t fade_ms)
+{
+    if (brightness > 100)
+    {
+        brightness = 100;
+    }
+
+    if (!g_fade_installed || fade_ms == 0)
+    {
+        g_brightness = brightness;
+        ESP_ERROR_CHECK(ledc_set_duty(LCD_BL_LEDC_MODE, LCD_BL_LEDC_CHANNEL, brightness_to_duty(brightness)));
+        ESP_ERROR_CHECK(ledc_update_duty(LCD_BL_LEDC_MODE, LCD_BL_LEDC_CHANNEL));
+        return;
+    }
+
+    g_brightness = brightness;
+    ESP_ERROR_CHECK(ledc_set_fade_time_and_start(LCD_BL_LEDC_MODE, LCD_BL_LEDC_CHANNEL,
+                                                 brightness_to_duty(brightness), fade_ms, LEDC_FADE_NO_WAIT));
+    ESP_LOGD(TAG, "LCD brightness fading to %d%% over %lu ms", brightness, (unsigned long)fade_ms);
+}
+
+esp_err_t bsp_display_sleep(bool sleep)
+{
+    if (g_panel_io == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sleep == g_panel_sleeping)
+    {
+        return ESP_OK;
+    }
+
+    esp_err_t ret;
+    if (sleep)
+    {
+        // DISPOFF first so the panel does not latch a half-refreshed frame on the way down
+        ret = esp_lcd_panel_io_tx_param(g_panel_io, LCD_QSPI_CMD(LCD_CMD_DISPOFF), NULL, 0);
+        if (ret == ESP_OK)
+        {
+            ret = esp_lcd_panel_io_tx_param(g_panel_io, LCD_QSPI_CMD(LCD_CMD_SLPIN), NULL, 0);
+        }
+    }
+    else
+    {
+        ret = esp_lcd_panel_io_tx_param(g_panel_io, LCD_QSPI_CMD(LCD_CMD_SLPOUT), NULL, 0);
+        if (ret == ESP_OK)
+        {
+            vTaskDelay(pdMS_TO_TICKS(LCD_SLEEP_OUT_DELAY_MS));
+            ret = esp_lcd_panel_io_tx_param(g_panel_io, LCD_QSPI_CMD(LCD_CMD_DISPON), NULL, 0);
+        }
+    }
+
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Panel sleep %s failed: %s", sleep ? "in" : "out", esp_err_to_name(ret));
+        return ret;
+    }
+
+    g_panel_sleeping = sleep;
+    ESP_LOGI(TAG, "Panel %s", sleep ? "sleeping" : "awake");
+    return ESP_OK;
+}
+
+bool bsp_display_is_sleeping(void)
+{
+    return g_panel_sleeping;
+}
+
+static void IRAM_ATTR lcd_te_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(g_te_sem, &woken);
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+esp_err_t bsp_display_te_init(void)
+{
+    if (EXAMPLE_PIN_LCD_TE == GPIO_NUM_NC)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (g_panel_io == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (g_te_sem != NULL)
+    {
+        return ESP_OK;
+    }
+
+    g_te_sem = xSemaphoreCreateBinary();
+    if (g_te_sem == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    gpio_config_t io_conf = {};
+    io_conf.pin_bit_mask = 1ULL << EXAMPLE_PIN_LCD_TE;
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.intr_type = GPIO_INTR_POSEDGE;
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+    {
+        return ret;
+    }
+    ESP_ERROR_CHECK(gpio_isr_handler_add(EXAMPLE_PIN_LCD_TE, lcd_te_isr, NULL));
+
+    uint8_t te_mode = 0x00; // V-blank only
+    ret = esp_lcd_panel_io_tx_param(g_panel_io, LCD_QSPI_CMD(LCD_CMD_TEON), &te_mode, 1);
+    ESP_LOGI(TAG, "Panel TE on GPIO %d: %s", (int)EXAMPLE_PIN_LCD_TE, esp_err_to_name(ret));
+    return ret;
+}
+
+bool bsp_display_wait_te(void *user_ctx)
+{
+    (void)user_ctx;
+    if (g_te_sem == NULL)
+    {
+        return false;
+    }
+    // Drop an edge latched while the frame was still rendering; wait for a fresh blank
+    xSemaphoreTake(g_te_sem, 0);
+    return xSemaphoreTake(g_te_sem, pdMS_TO_TICKS(LCD_TE_WAIT_TIMEOUT_MS)) == pdTRUE;
+}
@@ -20,6 +20,10 @@
 
 #define EXAMPLE_PIN_LCD_RST GPIO_NUM_NC
 #define EXAMPLE_PIN_LCD_BL GPIO_NUM_6
+// AXS15231B tearing-effect output. Not routed to the S3 on this board; set the GPIO here
+// on a revision that wires it and flushes will wait for vertical blanking.
+#define EXAMPLE_PIN_LCD_TE GPIO_NUM_NC
+#define LCD_TE_WAIT_TIMEOUT_MS 25              // one 40 Hz frame plus margin
 
 #define LCD_BL_LEDC_TIMER LEDC_TIMER_0
 #define LCD_BL_LEDC_MODE LEDC_LOW_SPEED_MODE
@@ -28,6 +32,8 @@
 #define LCD_BL_LEDC_DUTY (1024)                // Set duty to 50%. 1024 * 50% = 4096
 #define LCD_BL_LEDC_FREQUENCY (5000)          // Frequency in Hertz. Set frequency at 5 kHz
 
+#define LCD_SLEEP_OUT_DELAY_MS (120)           // Panel needs 120 ms after SLPOUT before accepting pixels
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +43,14 @@ void bsp_display_init(esp_lcd_panel_io_handle_t *io_handle, esp_lcd_panel_handle
 void bsp_display_brightness_init(void);
 void bsp_display_set_brightness(uint8_t brightness);
 uint8_t bsp_display_get_brightness(void);
+void bsp_display_fade_brightness(uint8_t brightness, uint32_t fade_ms);
+esp_err_t bsp_display_sleep(bool sleep);
+bool bsp_display_is_sleeping(void);
+// Enables the panel TE line (V-blank only) and its GPIO interrupt. ESP_ERR_NOT_SUPPORTED
+// when EXAMPLE_PIN_LCD_TE is not wired. Call after bsp_display_init.
+esp_err_t bsp_display_te_init(void);
+// LVGL port draw_wait_cb: blocks until the next V-blank edge, false on timeout.
+bool bsp_display_wait_te(void *user_ctx);
 
 #ifdef __cplusplus
 }
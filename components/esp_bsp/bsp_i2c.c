@@ -2,13 +2,45 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+#include <string.h>
 
 SemaphoreHandle_t  bsp_i2c_mux;
 
+static const char *TAG = "bsp_i2c";
+
+typedef struct
+{
+    i2c_master_dev_handle_t handle;
+    bsp_i2c_dev_stats_t stats;
+} bsp_i2c_slot_t;
+
+static i2c_master_bus_handle_t s_bus = NULL;
+static bsp_i2c_slot_t s_slots[BSP_I2C_MAX_DEVICES];
+static size_t s_slot_count = 0;
+static uint32_t s_recoveries = 0;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#define TOPOLOGY_STACK_SIZE 3072
+#define TOPOLOGY_PRIORITY (tskIDLE_PRIORITY + 1)
+#define TOPOLOGY_PROBE_TIMEOUT_MS 20
+
+static TaskHandle_t s_topo_task = NULL;
+static QueueHandle_t s_topo_events = NULL;
+static volatile uint32_t s_topo_period_ms = BSP_I2C_TOPOLOGY_DEFAULT_PERIOD_MS;
+static volatile bool s_topo_full_pending = true;
+static bsp_i2c_topology_t s_topo;
+static uint8_t s_topo_hot[128];
+static uint8_t s_topo_sweep = BSP_I2C_SCAN_FIRST;
+static uint32_t s_topo_events_dropped = 0;
+static portMUX_TYPE s_topo_lock = portMUX_INITIALIZER_UNLOCKED;
+
 bool bsp_i2c_lock(uint32_t timeout_ms)
 {
     assert(bsp_i2c_mux && "lvgl_port_init must be called first");
@@ -36,7 +68,418 @@ i2c_master_bus_handle_t bsp_i2c_init(void)
     i2c_mst_config.flags.enable_internal_pullup = 1;
 
     ESP_ERROR_CHECK(i2c_new_master_bus(&i2c_mst_config, &i2c_bus_handle));
+    s_bus = i2c_bus_handle;
 
     bsp_i2c_mux = xSemaphoreCreateRecursiveMutex();
     return i2c_bus_handle;
-}
\ No newline at end of file
+}
+
+// Call with s_stats_lock held: bsp_i2c_rm_device() moves slots around under it
+static bsp_i2c_slot_t *bsp_i2c_find_slot(i2c_master_dev_handle_t dev)
+{
+    for (size_t i = 0; i < s_slot_count; ++i)
+    {
+        if (s_slots[i].handle == dev)
+        {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void bsp_i2c_account(i2c_master_dev_handle_t dev, size_t bytes, int64_t start_us, esp_err_t ret)
+{
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    taskENTER_CRITICAL(&s_stats_lock);
+    bsp_i2c_slot_t *slot = bsp_i2c_find_slot(dev);
+    if (slot != NULL)
+    {
+        slot->stats.transfers++;
+        slot->stats.bytes += (uint32_t)bytes;
+        slot->stats.bus_us += elapsed_us;
+        if (ret != ESP_OK)
+        {
+            slot->stats.errors++;
+        }
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+    // A timeout or a controller stuck in a bad state usually means a slave is holding SDA
+    if (ret == ESP_ERR_TIMEOUT || ret == ESP_ERR_INVALID_STATE)
+    {
+        bsp_i2c_recover();
+    }
+}
+
+esp_err_t bsp_i2c_transmit(i2c_master_dev_handle_t dev, const uint8_t *write, size_t write_len, int timeout_ms)
+{
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = i2c_master_transmit(dev, write, write_len, timeout_ms);
+    bsp_i2c_account(dev, write_len, start_us, ret);
+    return ret;
+}
+
+esp_err_t bsp_i2c_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *write, size_t write_len,
+                                   uint8_t *read, size_t read_len, int timeout_ms)
+{
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = i2c_master_transmit_receive(dev, write, write_len, read, read_len, timeout_ms);
+    bsp_i2c_account(dev, write_len + read_len, start_us, ret);
+    return ret;
+}
+
+static esp_err_t bsp_i2c_recover_bus(bool only_if_stuck)
+{
+    if (s_bus == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!bsp_i2c_lock(100))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    // Sampled under the lock so another device's transfer is not mistaken for a stuck bus
+    bool sda_stuck = gpio_get_level(EXAMPLE_PIN_I2C_SDA) == 0;
+    if (only_if_stuck && !sda_stuck)
+    {
+        bsp_i2c_unlock();
+        return ESP_OK;
+    }
+    // i2c_master_bus_reset() drives the hardware clear-bus sequence (9 SCL pulses, then
+    // a STOP) before resetting the FSM, which releases a slave caught mid-byte
+    esp_err_t ret = i2c_master_bus_reset(s_bus);
+    bool sda_free = gpio_get_level(EXAMPLE_PIN_I2C_SDA) != 0;
+    bsp_i2c_unlock();
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_recoveries++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+    if (ret != ESP_OK || !sda_free)
+    {
+        ESP_LOGE(TAG, "bus recovery failed (%s), SDA %s", esp_err_to_name(ret), sda_free ? "released" : "still low");
+        return (ret != ESP_OK) ? ret : ESP_FAIL;
+    }
+    ESP_LOGW(TAG, "bus recovered%s", sda_stuck ? " (SDA was held low)" : "");
+    return ESP_OK;
+}
+
+esp_err_t bsp_i2c_recover(void)
+{
+    return bsp_i2c_recover_bus(false);
+}
+
+esp_err_t bsp_i2c_recover_if_stuck(void)
+{
+    return bsp_i2c_recover_bus(true);
+}
+
+static esp_err_t bsp_i2c_verify_default(i2c_master_dev_handle_t dev)
+{
+    uint8_t reg = 0x00;
+    uint8_t value = 0;
+    return i2c_master_transmit_receive(dev, &reg, 1, &value, 1, 20);
+}
+
+esp_err_t bsp_i2c_add_device(i2c_master_bus_handle_t bus, const bsp_i2c_dev_config_t *config,
+                             i2c_master_dev_handle_t *out)
+{
+    ESP_RETURN_ON_FALSE(bus != NULL && config != NULL && out != NULL, ESP_ERR_INVALID_ARG, TAG, "bad args");
+    ESP_RETURN_ON_FALSE(s_slot_count < BSP_I2C_MAX_DEVICES, ESP_ERR_NO_MEM, TAG, "device table full");
+
+    // No Fm+ rung: verify reads passing at 1 MHz say nothing about the timing margin of
+    // the other devices that have to follow the same clock (see BSP_I2C_BUS_MAX_HZ)
+    static const uint32_t ladder[] = {BSP_I2C_SPEED_FM_HZ, BSP_I2C_SPEED_SM_HZ};
+    bsp_i2c_verify_fn verify = (config->verify != NULL) ? config->verify : bsp_i2c_verify_default;
+
+    for (size_t step = 0; step < sizeof(ladder) / sizeof(ladder[0]); ++step)
+    {
+        uint32_t speed_hz = ladder[step];
+        if ((speed_hz > config->max_hz || speed_hz > BSP_I2C_BUS_MAX_HZ) && speed_hz != BSP_I2C_SPEED_SM_HZ)
+        {
+            continue;
+        }
+
+        i2c_device_config_t dev_cfg = {
+            .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+            .device_address = config->addr,
+            .scl_speed_hz = speed_hz,
+            .scl_wait_us = config->scl_wait_us,
+        };
+        i2c_master_dev_handle_t dev = NULL;
+        esp_err_t ret = i2c_master_bus_add_device(bus, &dev_cfg, &dev);
+        if (ret != ESP_OK)
+        {
+            return ret;
+        }
+
+        int passed = 0;
+        if (bsp_i2c_lock(200))
+        {
+            for (; passed < BSP_I2C_VERIFY_ROUNDS; ++passed)
+            {
+                ret = verify(dev);
+                if (ret != ESP_OK)
+                {
+                    break;
+                }
+            }
+            bsp_i2c_unlock();
+        }
+        else
+        {
+            ret = ESP_ERR_TIMEOUT;
+        }
+
+        if (passed == BSP_I2C_VERIFY_ROUNDS)
+        {
+            taskENTER_CRITICAL(&s_stats_lock);
+            bsp_i2c_slot_t *slot = &s_slots[s_slot_count];
+            memset(slot, 0, sizeof(*slot));
+            slot->handle = dev;
+            slot->stats.name = config->name;
+            slot->stats.addr = config->addr;
+            slot->stats.speed_hz = speed_hz;
+            s_slot_count++;
+            taskEXIT_CRITICAL(&s_stats_lock);
+            *out = dev;
+            ESP_LOGI(TAG, "%s @0x%02X: %u kHz", config->name, config->addr, (unsigned)(speed_hz / 1000));
+            return ESP_OK;
+        }
+
+        ESP_LOGW(TAG, "%s @0x%02X: %u kHz failed after %d/%d rounds (%s)", config->name, config->addr,
+                 (unsigned)(speed_hz / 1000), passed, BSP_I2C_VERIFY_ROUNDS, esp_err_to_name(ret));
+        i2c_master_bus_rm_device(dev);
+        if (ret == ESP_ERR_TIMEOUT || ret == ESP_ERR_INVALID_STATE)
+        {
+            bsp_i2c_recover();
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t bsp_i2c_rm_device(i2c_master_dev_handle_t dev)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    bsp_i2c_slot_t *slot = bsp_i2c_find_slot(dev);
+    if (slot != NULL)
+    {
+        *slot = s_slots[--s_slot_count];
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+    return i2c_master_bus_rm_device(dev);
+}
+
+size_t bsp_i2c_get_stats(bsp_i2c_dev_stats_t *out, size_t max_count, uint32_t *recoveries)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    size_t count = (s_slot_count < max_count) ? s_slot_count : max_count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = s_slots[i].stats;
+    }
+    if (recoveries != NULL)
+    {
+        *recoveries = s_recoveries;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+    return count;
+}
+
+static bool topology_bit(const uint8_t *map, uint8_t addr)
+{
+    return (map[addr >> 3] & (1U << (addr & 7))) != 0;
+}
+
+// Only an ACK or a clean NACK changes the map; a busy or wedged bus leaves the
+// address as it was instead of reporting every device as gone.
+static void topology_probe(uint8_t addr, uint8_t *map, uint32_t *probes, uint64_t *probe_us)
+{
+    if (!bsp_i2c_lock(50))
+    {
+        return;
+    }
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = i2c_master_probe(s_bus, addr, TOPOLOGY_PROBE_TIMEOUT_MS);
+    *probe_us += (uint64_t)(esp_timer_get_time() - start_us);
+    bsp_i2c_unlock();
+    (*probes)++;
+
+    if (ret == ESP_OK)
+    {
+        map[addr >> 3] |= (uint8_t)(1U << (addr & 7));
+    }
+    else if (ret == ESP_ERR_NOT_FOUND)
+    {
+        map[addr >> 3] &= (uint8_t)~(1U << (addr & 7));
+    }
+}
+
+static void topology_round(bool full)
+{
+    // Only this task writes s_topo.map, so reading it here needs no lock
+    uint8_t map[sizeof(s_topo.map)];
+    memcpy(map, s_topo.map, sizeof(map));
+    uint32_t probes = 0;
+    uint64_t probe_us = 0;
+
+    if (full)
+    {
+        for (uint8_t addr = BSP_I2C_SCAN_FIRST; addr <= BSP_I2C_SCAN_LAST; ++addr)
+        {
+            topology_probe(addr, map, &probes, &probe_us);
+        }
+    }
+    else
+    {
+        for (uint8_t addr = BSP_I2C_SCAN_FIRST; addr <= BSP_I2C_SCAN_LAST; ++addr)
+        {
+            if (topology_bit(map, addr) || s_topo_hot[addr] > 0)
+            {
+                topology_probe(addr, map, &probes, &probe_us);
+            }
+        }
+        for (int i = 0; i < BSP_I2C_TOPOLOGY_SWEEP_PER_ROUND; ++i)
+        {
+            uint8_t addr = s_topo_sweep;
+            s_topo_sweep = (addr >= BSP_I2C_SCAN_LAST) ? BSP_I2C_SCAN_FIRST : (uint8_t)(addr + 1);
+            if (!topology_bit(map, addr) && s_topo_hot[addr] == 0)
+            {
+                topology_probe(addr, map, &probes, &probe_us);
+            }
+        }
+    }
+
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    bool boot_scan = (s_topo.seq == 0);
+    bool changed = boot_scan;
+    uint8_t count = 0;
+    for (uint8_t addr = BSP_I2C_SCAN_FIRST; addr <= BSP_I2C_SCAN_LAST; ++addr)
+    {
+        bool present = topology_bit(map, addr);
+        count += present ? 1 : 0;
+        if (s_topo_hot[addr] > 0)
+        {
+            s_topo_hot[addr]--;
+        }
+        if (boot_scan || present == topology_bit(s_topo.map, addr))
+        {
+            continue;
+        }
+
+        changed = true;
+        s_topo_hot[addr] = BSP_I2C_TOPOLOGY_HOT_ROUNDS;
+        ESP_LOGI(TAG, "0x%02X %s", addr, present ? "appeared" : "gone");
+        bsp_i2c_topology_event_t evt = {
+            .addr = addr,
+            .present = present,
+            .time_ms = now_ms,
+        };
+        if (xQueueSend(s_topo_events, &evt, 0) != pdTRUE)
+        {
+            s_topo_events_dropped++;
+            ESP_LOGW(TAG, "topology event queue full (%lu dropped)", (unsigned long)s_topo_events_dropped);
+        }
+    }
+
+    taskENTER_CRITICAL(&s_topo_lock);
+    if (changed)
+    {
+        memcpy(s_topo.map, map, sizeof(map));
+        s_topo.count = count;
+        s_topo.seq++;
+    }
+    s_topo.updated_ms = now_ms;
+    s_topo.rounds++;
+    s_topo.full_scans += full ? 1 : 0;
+    s_topo.probes += probes;
+    s_topo.probe_us += probe_us;
+    taskEXIT_CRITICAL(&s_topo_lock);
+
+    if (boot_scan)
+    {
+        ESP_LOGI(TAG, "topology: %u device(s) after full scan (%lu us)", count, (unsigned long)probe_us);
+    }
+}
+
+static void topology_task(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        bool full = s_topo_full_pending;
+        s_topo_full_pending = false;
+        topology_round(full);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(s_topo_period_ms));
+    }
+}
+
+esp_err_t bsp_i2c_topology_start(uint32_t period_ms)
+{
+    if (s_topo_task != NULL)
+    {
+        bsp_i2c_topology_set_period(period_ms);
+        return ESP_OK;
+    }
+    if (s_bus == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_topo_events = xQueueCreate(BSP_I2C_TOPOLOGY_EVENT_QUEUE_LEN, sizeof(bsp_i2c_topology_event_t));
+    if (s_topo_events == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    s_topo_period_ms = (period_ms == 0) ? BSP_I2C_TOPOLOGY_DEFAULT_PERIOD_MS : period_ms;
+    if (xTaskCreate(topology_task, "i2c_topology", TOPOLOGY_STACK_SIZE, NULL, TOPOLOGY_PRIORITY, &s_topo_task) != pdPASS)
+    {
+        vQueueDelete(s_topo_events);
+        s_topo_events = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void bsp_i2c_topology_set_period(uint32_t period_ms)
+{
+    uint32_t next = (period_ms == 0) ? BSP_I2C_TOPOLOGY_DEFAULT_PERIOD_MS : period_ms;
+    if (next == s_topo_period_ms)
+    {
+        return;
+    }
+    s_topo_period_ms = next;
+    // Run a round now so a shorter period takes effect without waiting out the old one
+    if (s_topo_task != NULL)
+    {
+        xTaskNotifyGive(s_topo_task);
+    }
+}
+
+void bsp_i2c_topology_rescan(void)
+{
+    s_topo_full_pending = true;
+    if (s_topo_task != NULL)
+    {
+        xTaskNotifyGive(s_topo_task);
+    }
+}
+
+bool bsp_i2c_topology_get(bsp_i2c_topology_t *out)
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL(&s_topo_lock);
+    *out = s_topo;
+    taskEXIT_CRITICAL(&s_topo_lock);
+    return out->seq != 0;
+}
+
+bool bsp_i2c_topology_get_event(bsp_i2c_topology_event_t *out, uint32_t timeout_ms)
+{
+    if (out == NULL || s_topo_events == NULL)
+    {
+        return false;
+    }
+    return xQueueReceive(s_topo_events, out, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
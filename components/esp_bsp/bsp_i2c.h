@@ -8,6 +8,71 @@
 #define EXAMPLE_PIN_I2C_SCL GPIO_NUM_7
 #define I2C_PORT_NUM 0
 
+// Speed ladder tried by bsp_i2c_add_device(), fastest first, never above the bus cap.
+#define BSP_I2C_SPEED_FM_HZ 400000
+#define BSP_I2C_SPEED_SM_HZ 100000
+// Every device on a bus decodes each START and address byte, so the bus runs no faster
+// than its slowest part. Touch, PMU, RTC and IMU here are 400 kHz parts and the bus only
+// has the internal pull-ups, so a device that allows Fm+ (BME280) still gets Fm.
+#define BSP_I2C_BUS_MAX_HZ BSP_I2C_SPEED_FM_HZ
+#define BSP_I2C_VERIFY_ROUNDS 8
+#define BSP_I2C_MAX_DEVICES 8
+
+// Bus topology service: one full probe of BSP_I2C_SCAN_FIRST..LAST at start, then each
+// round re-probes only present and recently changed addresses plus a rotating slice of
+// the empty ones. A new device at an empty address is found within 117 / SWEEP_PER_ROUND
+// rounds (15 rounds, 15 min at a 60 s period). bsp_i2c_topology_rescan() queues one full
+// probe, e.g. when the result comes on screen.
+#define BSP_I2C_SCAN_FIRST 0x03
+#define BSP_I2C_SCAN_LAST 0x77
+#define BSP_I2C_TOPOLOGY_SWEEP_PER_ROUND 8
+#define BSP_I2C_TOPOLOGY_HOT_ROUNDS 3       // rounds a changed address keeps being probed
+#define BSP_I2C_TOPOLOGY_DEFAULT_PERIOD_MS 10000
+#define BSP_I2C_TOPOLOGY_EVENT_QUEUE_LEN 16
+
+// One known-good transfer used to qualify a speed, called with the bus lock held.
+// NULL reads register 0x00 and only checks for an ACK.
+typedef esp_err_t (*bsp_i2c_verify_fn)(i2c_master_dev_handle_t dev);
+
+typedef struct
+{
+    const char *name;
+    uint8_t addr;
+    uint32_t max_hz;        // datasheet limit; the ladder starts at or below this
+    uint32_t scl_wait_us;   // clock-stretch allowance, 0 = driver default
+    bsp_i2c_verify_fn verify;
+} bsp_i2c_dev_config_t;
+
+typedef struct
+{
+    const char *name;
+    uint8_t addr;
+    uint32_t speed_hz;
+    uint32_t transfers;
+    uint32_t errors;
+    uint32_t bytes;
+    uint64_t bus_us;        // time spent inside transfers, lock wait excluded
+} bsp_i2c_dev_stats_t;
+
+typedef struct
+{
+    uint8_t map[16];        // presence bitmap, bit (addr & 7) of byte (addr >> 3)
+    uint8_t count;
+    uint32_t seq;           // bumped on every change, 0 until the boot scan finished
+    uint32_t updated_ms;    // time of the last completed round
+    uint32_t rounds;
+    uint32_t full_scans;
+    uint32_t probes;
+    uint64_t probe_us;      // bus time spent probing, lock wait excluded
+} bsp_i2c_topology_t;
+
+typedef struct
+{
+    uint8_t addr;
+    bool present;
+    uint32_t time_ms;
+} bsp_i2c_topology_event_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +81,29 @@ i2c_master_bus_handle_t bsp_i2c_init(void);
 void bsp_i2c_unlock(void);
 bool bsp_i2c_lock(uint32_t timeout_ms);
 
+// Adds a device at the fastest ladder speed that passes BSP_I2C_VERIFY_ROUNDS verify
+// transfers. Returns ESP_ERR_NOT_FOUND if it fails even at 100 kHz.
+esp_err_t bsp_i2c_add_device(i2c_master_bus_handle_t bus, const bsp_i2c_dev_config_t *config,
+                             i2c_master_dev_handle_t *out);
+esp_err_t bsp_i2c_rm_device(i2c_master_dev_handle_t dev);
+// Drop-in replacements for i2c_master_transmit/_receive that feed the per-device
+// counters and recover the bus after a timeout. Call with the bus lock held.
+esp_err_t bsp_i2c_transmit(i2c_master_dev_handle_t dev, const uint8_t *write, size_t write_len, int timeout_ms);
+esp_err_t bsp_i2c_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *write, size_t write_len,
+                                   uint8_t *read, size_t read_len, int timeout_ms);
+// Frees a slave holding SDA low: 9 SCL pulses and a STOP, then resets the controller.
+esp_err_t bsp_i2c_recover(void);
+// Same, but only when SDA reads low; a free bus is left alone and ESP_OK returned.
+esp_err_t bsp_i2c_recover_if_stuck(void);
+size_t bsp_i2c_get_stats(bsp_i2c_dev_stats_t *out, size_t max_count, uint32_t *recoveries);
+
+esp_err_t bsp_i2c_topology_start(uint32_t period_ms);
+void bsp_i2c_topology_set_period(uint32_t period_ms);
+// Runs a full scan at once, e.g. after re-seating a sensor by hand.
+void bsp_i2c_topology_rescan(void);
+bool bsp_i2c_topology_get(bsp_i2c_topology_t *out);
+bool bsp_i2c_topology_get_event(bsp_i2c_topology_event_t *out, uint32_t timeout_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,9 +20,13 @@ static esp_err_t bsp_pcf85063_reg_read(uint8_t reg_addr, uint8_t *data, size_t l
 {
     // bsp_i2c_reg8_read(PCF85063_DEVICE_ADDR, reg_addr, data, len);
     esp_err_t ret = ESP_FAIL;
+    if (dev_handle == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
     if (bsp_i2c_lock(0))
     {
-        ret = i2c_master_transmit_receive(dev_handle, &reg_addr, 1, data, len, pdMS_TO_TICKS(100));
+        ret = bsp_i2c_transmit_receive(dev_handle, &reg_addr, 1, data, len, pdMS_TO_TICKS(100));
         bsp_i2c_unlock();
     }
     
@@ -37,9 +41,13 @@ static esp_err_t bsp_pcf85063_reg_write_byte(uint8_t reg_addr, uint8_t *data, si
     uint8_t buf[len + 1];
     buf[0] = reg_addr;
     memcpy(buf + 1, data, len);
+    if (dev_handle == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
     if (bsp_i2c_lock(0))
     {
-        ret = i2c_master_transmit(dev_handle, buf, len + 1, pdMS_TO_TICKS(100));
+        ret = bsp_i2c_transmit(dev_handle, buf, len + 1, pdMS_TO_TICKS(100));
         bsp_i2c_unlock();
     }
     return ret;
@@ -49,12 +57,19 @@ void bsp_pcf85063_init(i2c_master_bus_handle_t bus_handle)
 {
     uint8_t seconds = 0;
 
-    i2c_device_config_t dev_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = PCF85063_DEVICE_ADDR,
-        .scl_speed_hz = 400000,
+    bsp_i2c_dev_config_t dev_cfg = {
+        .name = "pcf85063",
+        .addr = PCF85063_DEVICE_ADDR,
+        .max_hz = BSP_I2C_SPEED_FM_HZ,
     };
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(bus_handle, &dev_cfg, &dev_handle));
+    esp_err_t ret = bsp_i2c_add_device(bus_handle, &dev_cfg, &dev_handle);
+    if (ret != ESP_OK)
+    {
+        // Keep booting without the RTC; time then comes from NTP only
+        ESP_LOGE(TAG, "RTC not found (%s), running without it", esp_err_to_name(ret));
+        dev_handle = NULL;
+        return;
+    }
 
     bsp_pcf85063_reg_read(PCF85063_SECONDS, (uint8_t *)&seconds, 1);
     if (seconds & 0x80)
@@ -3,16 +3,63 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
 
 #include "bsp_i2c.h"
 
 static const char *TAG = "bsp_qmi8658";
 #define ACC_SENSITIVITY (4 / 32768.0f) // 每LSB对应的加速度（单位为g）
 
+// CTRL9 host commands and FIFO_CTRL fields (QMI8658 datasheet, sections 5.10 and 8.4)
+#define QMI8658_CTRL9_CMD_ACK 0x00
+#define QMI8658_CTRL9_CMD_RST_FIFO 0x04
+#define QMI8658_CTRL9_CMD_REQ_FIFO 0x05
+#define QMI8658_STATUSINT_CMD_DONE 0x80
+#define QMI8658_FIFO_CTRL_RD_MODE 0x80
+#define QMI8658_FIFO_CTRL_SIZE_128 0x0C
+#define QMI8658_FIFO_CTRL_MODE_STREAM 0x02
+#define QMI8658_CTRL1_INT2_EN 0x10
+// Frames per burst; keeps each I2C transaction around 5 ms at 400 kHz so touch polling is not starved.
+#define QMI8658_FIFO_CHUNK_FRAMES 16
+
+#define QMI8658_SERVICE_STACK_SIZE (3 * 1024)
+#define QMI8658_SERVICE_PRIORITY 2
+#define QMI8658_SERVICE_BATCH_MS (BSP_QMI8658_SERVICE_WATERMARK * 1000 / BSP_QMI8658_SERVICE_ODR_HZ)
+// Slow polls keep a period's worth of frames under half the FIFO, leaving margin for a late wakeup
+#define QMI8658_SLOW_POLL_MAX_FRAMES (QMI8658_FIFO_MAX_FRAMES / 2)
+// Complementary filter: accel weight per frame, Q15 (0.02 -> gyro trusted 98%)
+#define QMI8658_CF_ACC_GAIN_Q15 655
+
+// Service output data rates, fastest first; CTRL2/CTRL3 ODR code with accel and gyro both on
+typedef struct
+{
+    uint16_t odr_dhz;
+    uint8_t code;
+} qmi8658_odr_t;
+
+static const qmi8658_odr_t s_service_odrs[] = {
+    {4484, 0x04},
+    {2242, 0x05},
+    {1121, 0x06},
+    {561, 0x07},
+    {280, 0x08},
+};
+
 static i2c_master_dev_handle_t dev_handle;
+static bool g_present = false;
+
+static TaskHandle_t s_imu_task = NULL;
+static volatile uint32_t s_imu_period_ms = 0;
+static bool s_imu_int_enabled = false;
+// Seqlock: odd while the service task is writing. Readers copy and retry, never block the writer.
+static atomic_uint s_att_seq = 0;
+static bsp_qmi8658_attitude_t s_att = {0};
 
 // 读取QMI8658寄存器的值
 static esp_err_t bsp_qmi8658_reg_read(uint8_t reg_addr, uint8_t *data, size_t len)
@@ -22,7 +69,7 @@ static esp_err_t bsp_qmi8658_reg_read(uint8_t reg_addr, uint8_t *data, size_t le
 
     if (bsp_i2c_lock(0))
     {
-        ret = i2c_master_transmit_receive(dev_handle, &reg_addr, 1, data, len, pdMS_TO_TICKS(1000));
+        ret = bsp_i2c_transmit_receive(dev_handle, &reg_addr, 1, data, len, pdMS_TO_TICKS(1000));
         bsp_i2c_unlock();
     }
     return ret;
@@ -38,7 +85,7 @@ static esp_err_t bsp_qmi8658_reg_write_byte(uint8_t reg_addr, uint8_t *data, siz
 
     if (bsp_i2c_lock(0))
     {
-        ret = i2c_master_transmit(dev_handle, buf, len + 1, pdMS_TO_TICKS(1000));
+        ret = bsp_i2c_transmit(dev_handle, buf, len + 1, pdMS_TO_TICKS(1000));
         bsp_i2c_unlock();
     }
     return ret;
@@ -80,24 +127,133 @@ bool bsp_qmi8658_read_data(qmi8658_data_t *data)
     return false;
 }
 
-void bsp_qmi8658_init(i2c_master_bus_handle_t bus_handle)
+// CTRL9 handshake: issue the command, wait for CmdDone, then acknowledge it.
+static esp_err_t bsp_qmi8658_ctrl9_cmd(uint8_t cmd)
+{
+    esp_err_t ret = bsp_qmi8658_reg_write_byte(QMI8658_CTRL9, &cmd, 1);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+
+    uint8_t status = 0;
+    int tries = 0;
+    for (; tries < 20; ++tries)
+    {
+        ret = bsp_qmi8658_reg_read(QMI8658_STATUSINT, &status, 1);
+        if (ret == ESP_OK && (status & QMI8658_STATUSINT_CMD_DONE))
+        {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+
+    uint8_t ack = QMI8658_CTRL9_CMD_ACK;
+    bsp_qmi8658_reg_write_byte(QMI8658_CTRL9, &ack, 1);
+    return (tries < 20) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t bsp_qmi8658_fifo_enable(uint8_t watermark_frames)
+{
+    if (!g_present)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t fifo_ctrl = QMI8658_FIFO_CTRL_SIZE_128 | QMI8658_FIFO_CTRL_MODE_STREAM;
+    esp_err_t ret = bsp_qmi8658_reg_write_byte(QMI8658_FIFO_WTM_TH, &watermark_frames, 1);
+    if (ret == ESP_OK)
+    {
+        ret = bsp_qmi8658_reg_write_byte(QMI8658_FIFO_CTRL, &fifo_ctrl, 1);
+    }
+    if (ret == ESP_OK)
+    {
+        ret = bsp_qmi8658_ctrl9_cmd(QMI8658_CTRL9_CMD_RST_FIFO);
+    }
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "FIFO enable failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+int bsp_qmi8658_fifo_read(qmi8658_fifo_frame_t *frames, int max_frames)
+{
+    _Static_assert(sizeof(qmi8658_fifo_frame_t) == QMI8658_FIFO_FRAME_BYTES, "FIFO frame layout");
+
+    if (!g_present || frames == NULL || max_frames <= 0)
+    {
+        return -1;
+    }
+
+    uint8_t cnt[2] = {0}; // FIFO_SMPL_CNT, FIFO_STATUS
+    if (bsp_qmi8658_reg_read(QMI8658_FIFO_SMPL_CNT, cnt, sizeof(cnt)) != ESP_OK)
+    {
+        return -1;
+    }
+    int fifo_bytes = 2 * ((((int)cnt[1] & 0x03) << 8) | cnt[0]);
+    int available = fifo_bytes / QMI8658_FIFO_FRAME_BYTES;
+    if (available == 0)
+    {
+        return 0;
+    }
+    int want = (available < max_frames) ? available : max_frames;
+
+    if (bsp_qmi8658_ctrl9_cmd(QMI8658_CTRL9_CMD_REQ_FIFO) != ESP_OK)
+    {
+        return -1;
+    }
+
+    // FIFO_DATA does not auto-increment while FIFO read mode is set, so each chunk
+    // continues where the previous one stopped.
+    int done = 0;
+    esp_err_t ret = ESP_OK;
+    while (done < want && ret == ESP_OK)
+    {
+        int chunk = want - done;
+        if (chunk > QMI8658_FIFO_CHUNK_FRAMES)
+        {
+            chunk = QMI8658_FIFO_CHUNK_FRAMES;
+        }
+        ret = bsp_qmi8658_reg_read(QMI8658_FIFO_DATA, (uint8_t *)&frames[done], (size_t)chunk * QMI8658_FIFO_FRAME_BYTES);
+        if (ret == ESP_OK)
+        {
+            done += chunk;
+        }
+    }
+
+    uint8_t fifo_ctrl = QMI8658_FIFO_CTRL_SIZE_128 | QMI8658_FIFO_CTRL_MODE_STREAM; // clears FIFO_CTRL_RD_MODE
+    bsp_qmi8658_reg_write_byte(QMI8658_FIFO_CTRL, &fifo_ctrl, 1);
+    return (ret == ESP_OK) ? done : -1;
+}
+
+static esp_err_t bsp_qmi8658_verify(i2c_master_dev_handle_t dev)
+{
+    uint8_t reg = QMI8658_WHO_AM_I;
+    uint8_t id = 0;
+    esp_err_t ret = i2c_master_transmit_receive(dev, &reg, 1, &id, 1, 20);
+    return (ret == ESP_OK && id != 0x05) ? ESP_ERR_INVALID_RESPONSE : ret;
+}
+
+esp_err_t bsp_qmi8658_init(i2c_master_bus_handle_t bus_handle)
 {
     uint8_t id = 0;
     ESP_LOGI(TAG, "QMI8658 Initialize");
     vTaskDelay(pdMS_TO_TICKS(100));
-    i2c_device_config_t dev_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = QMI8658_SENSOR_ADDR,
-        .scl_speed_hz = 400000,
+    bsp_i2c_dev_config_t dev_cfg = {
+        .name = "qmi8658",
+        .addr = QMI8658_SENSOR_ADDR,
+        .max_hz = BSP_I2C_SPEED_FM_HZ,
+        .verify = bsp_qmi8658_verify,
     };
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(bus_handle, &dev_cfg, &dev_handle));
+    ESP_RETURN_ON_ERROR(bsp_i2c_add_device(bus_handle, &dev_cfg, &dev_handle), TAG, "add device failed");
 
-    ESP_ERROR_CHECK(bsp_qmi8658_reg_read(QMI8658_WHO_AM_I, &id, 1));
+    ESP_RETURN_ON_ERROR(bsp_qmi8658_reg_read(QMI8658_WHO_AM_I, &id, 1), TAG, "WHO_AM_I read failed");
 
     if (0x05 != id)
     {
         // ESP_LOGI(TAG, "QMI8658 not found");
-        return;
+        return ESP_ERR_NOT_FOUND;
     }
     ESP_LOGI(TAG, "Find QMI8658");
     bsp_qmi8658_reg_write_byte(QMI8658_RESET, (uint8_t[]){0xb0}, 1); // 复位
@@ -106,6 +262,8 @@ void bsp_qmi8658_init(i2c_master_bus_handle_t bus_handle)
     bsp_qmi8658_reg_write_byte(QMI8658_CTRL7, (uint8_t[]){0x03}, 1); // CTRL7 允许加速度和陀螺仪
     bsp_qmi8658_reg_write_byte(QMI8658_CTRL2, (uint8_t[]){0x95}, 1); // CTRL2 设置ACC 4g 250Hz
     bsp_qmi8658_reg_write_byte(QMI8658_CTRL3, (uint8_t[]){0xd5}, 1); // CTRL3 设置GRY 512dps 250Hz
+    g_present = true;
+    return ESP_OK;
 }
 
 static void qmi8658_test_task(void *arg)
@@ -126,4 +284,309 @@ static void qmi8658_test_task(void *arg)
 void bsp_qmi8658_test(void)
 {
     xTaskCreate(qmi8658_test_task, "qmi8658_test", 4096, NULL, tskIDLE_PRIORITY + 1, NULL);
-}
\ No newline at end of file
+}
+
+// atan(z) for z in [0, 1] (Q15) in millidegrees: 45z + 15.64z(1 - z), max error about 0.2 degree
+static int32_t qmi8658_atan_unit_mdeg(int32_t z_q15)
+{
+    int64_t lin = (int64_t)45000 * z_q15;
+    int64_t corr = ((int64_t)15640 * z_q15 * (32768 - z_q15)) >> 15;
+    return (int32_t)((lin + corr) >> 15);
+}
+
+static int32_t qmi8658_atan2_mdeg(int32_t y, int32_t x)
+{
+    int32_t abs_y = abs(y);
+    int32_t abs_x = abs(x);
+    if (abs_x == 0 && abs_y == 0)
+    {
+        return 0;
+    }
+
+    int32_t a;
+    if (abs_y <= abs_x)
+    {
+        a = qmi8658_atan_unit_mdeg((int32_t)(((int64_t)abs_y << 15) / abs_x));
+    }
+    else
+    {
+        a = 90000 - qmi8658_atan_unit_mdeg((int32_t)(((int64_t)abs_x << 15) / abs_y));
+    }
+    if (x < 0)
+    {
+        a = 180000 - a;
+    }
+    return (y < 0) ? -a : a;
+}
+
+static uint32_t qmi8658_isqrt(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > v)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (v >= root + bit)
+        {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static uint32_t qmi8658_sq(int32_t v)
+{
+    return (uint32_t)(v * v);
+}
+
+static void qmi8658_publish(const bsp_qmi8658_attitude_t *att)
+{
+    unsigned seq = atomic_load_explicit(&s_att_seq, memory_order_relaxed);
+    atomic_store_explicit(&s_att_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&s_att, att, sizeof(s_att));
+    atomic_store_explicit(&s_att_seq, seq + 2, memory_order_release);
+}
+
+// Gyro is integrated per frame; the accel correction runs once on the batch average,
+// with the per-frame gain scaled by the batch length. Angles are kept in microdegrees.
+static void qmi8658_filter_batch(const qmi8658_fifo_frame_t *frames, int n, int32_t frame_dt_us, bool reseed,
+                                 int32_t angle_udeg[2], bsp_qmi8658_attitude_t *att)
+{
+    int32_t sum[3] = {0, 0, 0};
+    for (int i = 0; i < n; ++i)
+    {
+        sum[0] += frames[i].acc[0];
+        sum[1] += frames[i].acc[1];
+        sum[2] += frames[i].acc[2];
+        // d(angle X)/dt = -gyro Y, d(angle Y)/dt = +gyro X near level
+        angle_udeg[0] -= frames[i].gyr[1] * frame_dt_us / QMI8658_GYR_LSB_PER_DPS;
+        angle_udeg[1] += frames[i].gyr[0] * frame_dt_us / QMI8658_GYR_LSB_PER_DPS;
+    }
+    int32_t ax = sum[0] / n;
+    int32_t ay = sum[1] / n;
+    int32_t az = sum[2] / n;
+
+    int32_t acc_udeg[2];
+    acc_udeg[0] = qmi8658_atan2_mdeg(ax, (int32_t)qmi8658_isqrt(qmi8658_sq(ay) + qmi8658_sq(az))) * 1000;
+    acc_udeg[1] = qmi8658_atan2_mdeg(ay, (int32_t)qmi8658_isqrt(qmi8658_sq(ax) + qmi8658_sq(az))) * 1000;
+
+    int32_t gain = QMI8658_CF_ACC_GAIN_Q15 * n;
+    if (reseed || gain > 32768)
+    {
+        gain = 32768;
+    }
+    for (int k = 0; k < 2; ++k)
+    {
+        angle_udeg[k] += (int32_t)(((int64_t)(acc_udeg[k] - angle_udeg[k]) * gain) >> 15);
+        att->angle_mdeg[k] = angle_udeg[k] / 1000;
+    }
+    att->angle_mdeg[2] = qmi8658_atan2_mdeg((int32_t)qmi8658_isqrt(qmi8658_sq(ax) + qmi8658_sq(ay)), az);
+
+    att->acc_mg[0] = (int16_t)(ax * 1000 / QMI8658_ACC_LSB_PER_G);
+    att->acc_mg[1] = (int16_t)(ay * 1000 / QMI8658_ACC_LSB_PER_G);
+    att->acc_mg[2] = (int16_t)(az * 1000 / QMI8658_ACC_LSB_PER_G);
+    memcpy(att->acc, frames[n - 1].acc, sizeof(att->acc));
+    memcpy(att->gyr, frames[n - 1].gyr, sizeof(att->gyr));
+    att->batch_frames = (uint16_t)n;
+}
+
+// Fastest rate for which one poll period fits the FIFO margin; watermark mode (0) runs at full rate
+static int qmi8658_odr_for_period(uint32_t period_ms)
+{
+    int count = (int)(sizeof(s_service_odrs) / sizeof(s_service_odrs[0]));
+    if (period_ms == 0)
+    {
+        return 0;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        if ((uint64_t)period_ms * s_service_odrs[i].odr_dhz <= (uint64_t)QMI8658_SLOW_POLL_MAX_FRAMES * 10000U)
+        {
+            return i;
+        }
+    }
+    return count - 1;
+}
+
+// Switch accel and gyro together, then drop frames sampled at the old rate
+static esp_err_t qmi8658_set_odr(int index)
+{
+    uint8_t ctrl2 = 0x90 | s_service_odrs[index].code; // ACC 4g
+    uint8_t ctrl3 = 0xd0 | s_service_odrs[index].code; // GYR 512dps
+    esp_err_t ret = bsp_qmi8658_reg_write_byte(QMI8658_CTRL2, &ctrl2, 1);
+    if (ret == ESP_OK)
+    {
+        ret = bsp_qmi8658_reg_write_byte(QMI8658_CTRL3, &ctrl3, 1);
+    }
+    if (ret == ESP_OK)
+    {
+        ret = bsp_qmi8658_ctrl9_cmd(QMI8658_CTRL9_CMD_RST_FIFO);
+    }
+    return ret;
+}
+
+static void IRAM_ATTR qmi8658_int_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    if (s_imu_task != NULL)
+    {
+        vTaskNotifyGiveFromISR(s_imu_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void qmi8658_service_task(void *arg)
+{
+    (void)arg;
+    static qmi8658_fifo_frame_t frames[QMI8658_FIFO_MAX_FRAMES];
+    bsp_qmi8658_attitude_t att = {0};
+    int32_t angle_udeg[2] = {0, 0};
+    bool reseed = true;
+    uint32_t fail_count = 0;
+    int odr_index = 0;
+
+    while (true)
+    {
+        uint32_t period_ms = s_imu_period_ms;
+        // At full rate a 1 s poll would find the FIFO overflowed every time; slow polls
+        // run the sensor at a rate whose whole period fits instead
+        int want_odr = qmi8658_odr_for_period(period_ms);
+        if (want_odr != odr_index && qmi8658_set_odr(want_odr) == ESP_OK)
+        {
+            ESP_LOGD(TAG, "ODR %u.%u Hz", s_service_odrs[want_odr].odr_dhz / 10U, s_service_odrs[want_odr].odr_dhz % 10U);
+            odr_index = want_odr;
+            reseed = true;
+        }
+        if (period_ms == 0)
+        {
+            // With INT2 wired the watermark interrupt ends the wait; the timeout is a safety net
+            period_ms = s_imu_int_enabled ? QMI8658_SERVICE_BATCH_MS * 2 : QMI8658_SERVICE_BATCH_MS;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(period_ms));
+
+        int n = bsp_qmi8658_fifo_read(frames, QMI8658_FIFO_MAX_FRAMES);
+        if (n < 0)
+        {
+            if ((fail_count++ % 20) == 0)
+            {
+                ESP_LOGW(TAG, "FIFO read failed (%lu)", (unsigned long)fail_count);
+            }
+            reseed = true;
+            continue;
+        }
+        fail_count = 0;
+        if (n == 0)
+        {
+            continue;
+        }
+
+        // A full FIFO means stream mode dropped frames, so the gyro integral has a gap
+        if (n >= QMI8658_FIFO_MAX_FRAMES)
+        {
+            reseed = true;
+        }
+        qmi8658_filter_batch(frames, n, 10000000 / s_service_odrs[odr_index].odr_dhz, reseed, angle_udeg, &att);
+        reseed = false;
+        att.batches++;
+        att.updated_us = esp_timer_get_time();
+        qmi8658_publish(&att);
+    }
+}
+
+esp_err_t bsp_qmi8658_service_start(void)
+{
+    if (s_imu_task != NULL)
+    {
+        return ESP_OK;
+    }
+    if (!g_present)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Higher ODR than the single-sample path: the FIFO batches it, so bus load stays per batch
+    qmi8658_set_odr(0); // ACC 4g, GYR 512dps, 448.4Hz
+    ESP_RETURN_ON_ERROR(bsp_qmi8658_fifo_enable(BSP_QMI8658_SERVICE_WATERMARK), TAG, "FIFO enable failed");
+
+    if (xTaskCreate(qmi8658_service_task, "imu_service", QMI8658_SERVICE_STACK_SIZE, NULL, QMI8658_SERVICE_PRIORITY,
+                    &s_imu_task) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (BSP_QMI8658_INT_GPIO != GPIO_NUM_NC)
+    {
+        gpio_config_t io_conf = {
+            .pin_bit_mask = 1ULL << BSP_QMI8658_INT_GPIO,
+            .mode = GPIO_MODE_INPUT,
+            .intr_type = GPIO_INTR_POSEDGE,
+        };
+        ESP_ERROR_CHECK(gpio_config(&io_conf));
+        esp_err_t ret = gpio_install_isr_service(0);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+        {
+            ESP_LOGW(TAG, "GPIO ISR service unavailable, polling only: %s", esp_err_to_name(ret));
+        }
+        else
+        {
+            // FIFO watermark routed to INT2 (CTRL1.FIFO_INT_SEL = 0)
+            bsp_qmi8658_reg_write_byte(QMI8658_CTRL1, (uint8_t[]){0x40 | QMI8658_CTRL1_INT2_EN}, 1);
+            gpio_isr_handler_add(BSP_QMI8658_INT_GPIO, qmi8658_int_isr, NULL);
+            s_imu_int_enabled = true;
+        }
+    }
+
+    ESP_LOGI(TAG, "IMU service started (%d Hz, %d frames/batch, int gpio %d)", BSP_QMI8658_SERVICE_ODR_HZ,
+             BSP_QMI8658_SERVICE_WATERMARK, (int)BSP_QMI8658_INT_GPIO);
+    return ESP_OK;
+}
+
+void bsp_qmi8658_service_set_period(uint32_t period_ms)
+{
+    s_imu_period_ms = period_ms;
+    if (s_imu_int_enabled)
+    {
+        // Slow polling ignores the watermark so the CPU is not woken per batch
+        if (period_ms == 0)
+        {
+            gpio_intr_enable(BSP_QMI8658_INT_GPIO);
+        }
+        else
+        {
+            gpio_intr_disable(BSP_QMI8658_INT_GPIO);
+        }
+    }
+}
+
+bool bsp_qmi8658_get_attitude(bsp_qmi8658_attitude_t *out)
+{
+    if (out == NULL)
+    {
+        return false;
+    }
+    for (int tries = 0; tries < 8; ++tries)
+    {
+        unsigned seq = atomic_load_explicit(&s_att_seq, memory_order_acquire);
+        if (seq & 1U)
+        {
+            continue;
+        }
+        memcpy(out, &s_att, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s_att_seq, memory_order_relaxed) == seq)
+        {
+            return seq != 0;
+        }
+    }
+    return false;
+}
@@ -1,9 +1,22 @@
 #pragma once
 #include <stdio.h>
+#include "driver/gpio.h"
 #include "driver/i2c_master.h"
 
 #define QMI8658_SENSOR_ADDR 0x6B
 
+// FIFO holds 1536 bytes; with accel and gyro both enabled each frame is 12 bytes.
+#define QMI8658_FIFO_FRAME_BYTES 12
+#define QMI8658_FIFO_MAX_FRAMES 128
+#define QMI8658_ACC_LSB_PER_G 8192 // +-4g full scale
+#define QMI8658_GYR_LSB_PER_DPS 64 // +-512 dps full scale
+
+#ifndef BSP_QMI8658_INT_GPIO
+#define BSP_QMI8658_INT_GPIO GPIO_NUM_NC // INT2 (FIFO watermark) is not routed on this board; FIFO is polled
+#endif
+#define BSP_QMI8658_SERVICE_ODR_HZ 448 // nominal 448.4 Hz, accel and gyro; slow polls step down (see set_period)
+#define BSP_QMI8658_SERVICE_WATERMARK 32 // frames per batch, about 71 ms
+
 typedef enum
 {
     QMI8658_WHO_AM_I,
@@ -86,15 +99,46 @@ typedef struct{
     float temp;
 }qmi8658_data_t;
 
+// One FIFO frame, raw little-endian as it leaves the sensor (accel then gyro).
+typedef struct
+{
+    int16_t acc[3];
+    int16_t gyr[3];
+} qmi8658_fifo_frame_t;
+
+// Published by the IMU service after each FIFO batch. Angles follow qmi8658_data_t:
+// [0]/[1] are the X/Y tilt fused with the gyro, [2] is the accel-only tilt from vertical.
+typedef struct
+{
+    int32_t angle_mdeg[3];
+    int16_t acc_mg[3];      // batch-average gravity vector
+    int16_t acc[3];         // newest raw frame
+    int16_t gyr[3];
+    uint16_t batch_frames;
+    uint32_t batches;
+    int64_t updated_us;
+} bsp_qmi8658_attitude_t;
+
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-void bsp_qmi8658_init(i2c_master_bus_handle_t bus_handle);
+esp_err_t bsp_qmi8658_init(i2c_master_bus_handle_t bus_handle);
 void bsp_qmi8658_test(void);
 bool bsp_qmi8658_read_data(qmi8658_data_t *data);
+// Put the FIFO in stream mode (oldest frames are dropped when full).
+esp_err_t bsp_qmi8658_fifo_enable(uint8_t watermark_frames);
+// Drain up to max_frames from the FIFO. Returns the number of frames read, or -1 on bus error.
+int bsp_qmi8658_fifo_read(qmi8658_fifo_frame_t *frames, int max_frames);
+// Background task that owns the FIFO: drains a batch per watermark and runs the attitude filter.
+esp_err_t bsp_qmi8658_service_start(void);
+// 0 = one batch per watermark (interrupt-driven when BSP_QMI8658_INT_GPIO is wired); otherwise poll every period_ms,
+// with the ODR lowered so a whole period fits in half the FIFO (56 Hz at 1 s).
+void bsp_qmi8658_service_set_period(uint32_t period_ms);
+// Lock-free read of the newest attitude; false until the first batch.
+bool bsp_qmi8658_get_attitude(bsp_qmi8658_attitude_t *out);
 
 #ifdef __cplusplus
 }
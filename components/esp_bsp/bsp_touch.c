@@ -7,6 +7,8 @@
 #include "bsp_touch.h"
 #include "bsp_i2c.h"
 
+static const char *TAG = "bsp_touch";
+
 static uint16_t g_rotation = 0;
 static uint16_t g_width = 0;
 static uint16_t g_height = 0;
@@ -15,18 +17,23 @@ static i2c_master_dev_handle_t dev_handle;
 
 touch_data_t g_touch_data;
 
+static const uint8_t s_read_cmd[11] = {0xb5, 0xab, 0xa5, 0x5a, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00};
+
 void bsp_touch_read(void)
 {
     uint8_t data[14] = {0}; /*1 Point:8;  2 Point: 14 */
-    uint8_t read_cmd[11] = {0xb5, 0xab, 0xa5, 0x5a, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00};
     g_touch_data.touch_num = 0;
+    if (dev_handle == NULL)
+    {
+        return;
+    }
 
     esp_err_t err = ESP_OK;
     if (bsp_i2c_lock(10))
     {
         // i2c_master_transmit(dev_handle, read_cmd, 11, pdMS_TO_TICKS(1000));
         // i2c_master_receive(dev_handle, data, 14, pdMS_TO_TICKS(1000));
-        err = i2c_master_transmit_receive(dev_handle, read_cmd, 11, data, 14, pdMS_TO_TICKS(1000));
+        err = bsp_i2c_transmit_receive(dev_handle, s_read_cmd, sizeof(s_read_cmd), data, 14, pdMS_TO_TICKS(1000));
         bsp_i2c_unlock();
         if (err != ESP_OK)
         {
@@ -93,18 +100,40 @@ bool bsp_touch_get_coordinates(touch_data_t *touch_data)
     return true;
 }
 
+// Must be called from the task that polls bsp_touch_read/bsp_touch_get_coordinates.
+void bsp_touch_set_rotation(uint16_t width, uint16_t height, uint16_t rotation)
+{
+    g_rotation = rotation;
+    g_width = width;
+    g_height = height;
+    g_touch_data.touch_num = 0;
+}
+
+static esp_err_t bsp_touch_verify(i2c_master_dev_handle_t dev)
+{
+    uint8_t data[14] = {0};
+    return i2c_master_transmit_receive(dev, s_read_cmd, sizeof(s_read_cmd), data, sizeof(data), 20);
+}
+
 void bsp_touch_init(i2c_master_bus_handle_t bus_handle, uint16_t width, uint16_t height, uint16_t rotation)
 {
     g_rotation = rotation;
     g_width = width;
     g_height = height;
-    i2c_device_config_t dev_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = I2C_AXS15231B_ADDRESS,
-        .scl_speed_hz = 100000,
-        // .flags.disable_ack_check = true,
+    // The 25-byte report read runs every UI tick, so it gains the most from a faster clock
+    bsp_i2c_dev_config_t dev_cfg = {
+        .name = "axs15231b",
+        .addr = I2C_AXS15231B_ADDRESS,
+        .max_hz = BSP_I2C_SPEED_FM_HZ,
+        .verify = bsp_touch_verify,
     };
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(bus_handle, &dev_cfg, &dev_handle));
+    // A controller that never answers leaves the device without touch instead of aborting boot
+    esp_err_t ret = bsp_i2c_add_device(bus_handle, &dev_cfg, &dev_handle);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGE(TAG, "touch controller not found (%s), touch disabled", esp_err_to_name(ret));
+        dev_handle = NULL;
+    }
 }
 
 // void bsp_touch_init(esp_lcd_touch_handle_t *touch_handle, i2c_master_bus_handle_t bus_handle, uint16_t xmax, uint16_t ymax, uint16_t rotation)
@@ -29,6 +29,7 @@ extern "C" {
 #endif
 // void bsp_touch_init(esp_lcd_touch_handle_t *touch_handle, i2c_master_bus_handle_t bus_handle, uint16_t xmax, uint16_t ymax, uint16_t rotation);
 void bsp_touch_init(i2c_master_bus_handle_t bus_handle, uint16_t width, uint16_t height, uint16_t rotation);
+void bsp_touch_set_rotation(uint16_t width, uint16_t height, uint16_t rotation);
 void bsp_touch_read(void);
 bool bsp_touch_get_coordinates(touch_data_t *touch_data);
 #ifdef __cplusplus
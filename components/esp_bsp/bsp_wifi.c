@@ -9,83 +9,390 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
+#include "nvs.h"
 
 #include "lwip/err.h"
 #include "lwip/sys.h"
+#include "lwip/inet.h"
 
-/* The examples use WiFi configuration that you can set via project configuration menu
+#define DEFAULT_SCAN_LIST_SIZE 10
 
-   If you'd rather not, just change the below entries to strings with
-   the config you want - ie #define EXAMPLE_WIFI_SSID "mywifissid"
-*/
-#define EXAMPLE_ESP_MAXIMUM_RETRY 5
+// Last good link, kept in NVS so the next connect can skip the all-channel scan
+#define WIFI_CACHE_NAMESPACE "bsp_wifi"
+#define WIFI_CACHE_KEY "link"
+#define WIFI_CACHE_VERSION 1
+// Deferred so the flash write never sits between association and the first request
+#define WIFI_CACHE_SAVE_DELAY_MS 2000
+#define WIFI_CACHE_SAVE_EVENT 0
 
-#define DEFAULT_SCAN_LIST_SIZE 10
+typedef struct
+{
+    uint8_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t ssid_hash;
+    uint32_t ip; // last address, network order; only used to report lease reuse
+} wifi_link_cache_t;
 
-/* FreeRTOS event group to signal when we are connected*/
 static EventGroupHandle_t s_wifi_event_group;
 
 SemaphoreHandle_t wifi_scan_Semaphore = NULL;
 SemaphoreHandle_t wifi_connect_Semaphore = NULL;
 
-/* The event group allows multiple bits for each event, but we only care about two events:
- * - we are connected to the AP with an IP
- * - we failed to connect after the maximum amount of retries */
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT BIT1
-
 static const char *TAG = "wifi station";
 
+// Private base for the cache save: the timer posts it, the NVS write runs on the
+// default event loop instead of holding up every other esp_timer callback
+static ESP_EVENT_DEFINE_BASE(BSP_WIFI_CACHE_EVENT);
+
+static bool s_wifi_initialized = false;
+static bool s_wifi_started = false;
+static wifi_ps_type_t s_ps_type = WIFI_PS_MIN_MODEM;
+static uint16_t s_listen_interval = 0;
+
+static esp_netif_t *s_sta_netif = NULL;
+static bool s_static_ip = false;
+static esp_netif_ip_info_t s_static_ip_info;
+static esp_ip4_addr_t s_static_dns;
+
+static wifi_link_cache_t s_cache;
+static bool s_cache_valid = false;
+static uint32_t s_ssid_hash = 0;
+static esp_timer_handle_t s_retry_timer = NULL;
+static esp_timer_handle_t s_save_timer = NULL;
+
+// Connection state below is only written from the default event loop task and the
+// esp_timer task; s_stats_lock covers what other tasks read, and s_cache.
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static bsp_wifi_stats_t s_stats;
+static esp_ip4_addr_t s_ip;
 static int s_retry_num = 0;
+static bool s_fast_active = false;
+static bool s_associated = false;
+static bool s_ever_connected = false;
+static bool s_expect_leave = false;
+static int64_t s_attempt_us = 0;
+static int64_t s_assoc_us = 0;
+static int64_t s_lost_us = 0;
+
+static uint32_t wifi_hash_ssid(const char *ssid)
+{
+    // FNV-1a; the cache only has to tell networks apart
+    uint32_t hash = 2166136261u;
+    for (const char *p = ssid; *p != '\0'; ++p)
+    {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash;
+}
 
-static void event_handler(void *arg, esp_event_base_t event_base,
-                          int32_t event_id, void *event_data)
+static void wifi_cache_load(void)
 {
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_CACHE_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK)
     {
-        esp_wifi_connect();
+        return;
     }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    size_t len = sizeof(s_cache);
+    s_cache_valid = nvs_get_blob(nvs, WIFI_CACHE_KEY, &s_cache, &len) == ESP_OK && len == sizeof(s_cache) &&
+                    s_cache.version == WIFI_CACHE_VERSION && s_cache.channel != 0;
+    nvs_close(nvs);
+}
+
+static void wifi_cache_save_cb(void *arg)
+{
+    (void)arg;
+    wifi_link_cache_t cache;
+    taskENTER_CRITICAL(&s_stats_lock);
+    cache = s_cache;
+    taskEXIT_CRITICAL(&s_stats_lock);
+    if (esp_event_post(BSP_WIFI_CACHE_EVENT, WIFI_CACHE_SAVE_EVENT, &cache, sizeof(cache), 0) != ESP_OK)
     {
-        if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY)
-        {
-            // esp_wifi_connect();
-            // s_retry_num++;
-            ESP_LOGI(TAG, "retry to connect to the AP");
-        }
-        else
+        // Event queue full: try again after another delay
+        esp_timer_start_once(s_save_timer, (uint64_t)WIFI_CACHE_SAVE_DELAY_MS * 1000);
+    }
+}
+
+static void wifi_cache_save_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    (void)arg;
+    (void)event_base;
+    (void)event_id;
+    const wifi_link_cache_t *cache = (const wifi_link_cache_t *)event_data;
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(nvs, WIFI_CACHE_KEY, cache, sizeof(*cache));
+        if (err == ESP_OK)
         {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+            err = nvs_commit(nvs);
         }
-        ESP_LOGI(TAG, "connect to the AP fail");
+        nvs_close(nvs);
     }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
+    if (err != ESP_OK)
     {
-        ESP_LOGI(TAG, "WiFi scan done!!!!!");
-        // 释放信号量
-        xSemaphoreGive(wifi_scan_Semaphore);
+        ESP_LOGW(TAG, "link cache save failed: %s", esp_err_to_name(err));
     }
+}
 
-    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
+// Records the link that just came up; writes NVS only when something changed
+static void wifi_cache_note_link(void)
+{
+    wifi_ap_record_t ap = {};
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK)
     {
-        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
-        ESP_LOGI(TAG, "Got IP:" IPSTR, IP2STR(&event->ip_info.ip));
-        // 释放信号量
-        xSemaphoreGive(wifi_connect_Semaphore);
-        wifi_ap_record_t ap_info;
-        esp_err_t err = esp_wifi_sta_get_ap_info(&ap_info);
+        return;
+    }
+    wifi_link_cache_t next = {};
+    next.version = WIFI_CACHE_VERSION;
+    next.channel = ap.primary;
+    memcpy(next.bssid, ap.bssid, sizeof(next.bssid));
+    next.ssid_hash = s_ssid_hash;
+    next.ip = s_ip.addr;
+
+    if (s_cache_valid && memcmp(&next, &s_cache, sizeof(next)) == 0)
+    {
+        return;
+    }
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_cache = next;
+    taskEXIT_CRITICAL(&s_stats_lock);
+    s_cache_valid = true;
+    esp_timer_stop(s_save_timer);
+    esp_timer_start_once(s_save_timer, (uint64_t)WIFI_CACHE_SAVE_DELAY_MS * 1000);
+}
 
-        if (err == ESP_OK)
+// Fills in the cached BSSID/channel when they belong to this SSID, otherwise asks for
+// a full scan that picks the strongest AP
+static bool wifi_apply_hints(wifi_config_t *config, bool use_cache)
+{
+    bool fast = use_cache && s_cache_valid && s_cache.ssid_hash == s_ssid_hash;
+    if (fast)
+    {
+        config->sta.bssid_set = true;
+        memcpy(config->sta.bssid, s_cache.bssid, sizeof(config->sta.bssid));
+        config->sta.channel = s_cache.channel;
+        config->sta.scan_method = WIFI_FAST_SCAN;
+    }
+    else
+    {
+        config->sta.bssid_set = false;
+        config->sta.channel = 0;
+        config->sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        config->sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+    return fast;
+}
+
+static void wifi_set_bits(EventBits_t set, EventBits_t clear)
+{
+    xEventGroupClearBits(s_wifi_event_group, clear);
+    xEventGroupSetBits(s_wifi_event_group, set);
+}
+
+static void wifi_schedule_retry(void)
+{
+    // 0.5 s, 1 s, 2 s ... capped, reset once an IP is obtained
+    uint32_t delay_ms = BSP_WIFI_RETRY_MIN_MS;
+    for (int i = 0; i < s_retry_num && delay_ms < BSP_WIFI_RETRY_MAX_MS; ++i)
+    {
+        delay_ms *= 2;
+    }
+    if (delay_ms > BSP_WIFI_RETRY_MAX_MS)
+    {
+        delay_ms = BSP_WIFI_RETRY_MAX_MS;
+    }
+    s_retry_num++;
+    esp_timer_stop(s_retry_timer);
+    esp_timer_start_once(s_retry_timer, (uint64_t)delay_ms * 1000);
+    ESP_LOGI(TAG, "retry %d in %u ms", s_retry_num, (unsigned)delay_ms);
+}
+
+static void wifi_connect_now(void)
+{
+    if (s_attempt_us == 0)
+    {
+        s_attempt_us = esp_timer_get_time();
+    }
+    esp_err_t err = esp_wifi_connect();
+    if (err == ESP_OK || err == ESP_ERR_WIFI_CONN)
+    {
+        // ESP_ERR_WIFI_CONN: an attempt is already running and will end in an event
+        return;
+    }
+    // Rejected calls (scan in progress, driver mid-transition) post no STA_DISCONNECTED,
+    // so nothing else would ever try again: keep the backoff going from here
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.connect_errors++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGW(TAG, "esp_wifi_connect failed: %s, rescheduling", esp_err_to_name(err));
+    wifi_schedule_retry();
+}
+
+static void wifi_retry_cb(void *arg)
+{
+    (void)arg;
+    if (bsp_wifi_is_connected())
+    {
+        return;
+    }
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.retries++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+    wifi_connect_now();
+}
+
+static void wifi_handle_disconnect(const wifi_event_sta_disconnected_t *event)
+{
+    bool had_ip = bsp_wifi_is_connected();
+    bool was_associated = s_associated;
+    s_associated = false;
+    wifi_set_bits(BSP_WIFI_DOWN_BIT, BSP_WIFI_CONNECTED_BIT);
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.last_reason = (uint8_t)event->reason;
+    s_stats.connected = false;
+    if (had_ip)
+    {
+        s_stats.disconnects++;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    if (s_expect_leave && event->reason == WIFI_REASON_ASSOC_LEAVE)
+    {
+        // Our own esp_wifi_disconnect() ahead of a reconfigure; that path connects again
+        s_expect_leave = false;
+        return;
+    }
+    if (had_ip)
+    {
+        s_lost_us = esp_timer_get_time();
+        s_attempt_us = 0;
+        s_retry_num = 0;
+    }
+    ESP_LOGI(TAG, "disconnected, reason %d", (int)event->reason);
+
+    if (s_fast_active && !was_associated)
+    {
+        // The cached AP is gone or moved channel: forget the hints and scan at once
+        s_fast_active = false;
+        s_cache_valid = false;
+        wifi_config_t config = {};
+        if (esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK)
         {
-            // Print the SSID
-            ESP_LOGI(TAG, "Connected SSID: %s", ap_info.ssid);
+            wifi_apply_hints(&config, false);
+            esp_wifi_set_config(WIFI_IF_STA, &config);
         }
-        else
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.fast_fallbacks++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGI(TAG, "cached AP not found, falling back to a full scan");
+        wifi_connect_now();
+        return;
+    }
+
+    wifi_schedule_retry();
+}
+
+static void wifi_handle_got_ip(const ip_event_got_ip_t *event)
+{
+    int64_t now_us = esp_timer_get_time();
+    s_ip = event->ip_info.ip;
+    s_retry_num = 0;
+    esp_timer_stop(s_retry_timer);
+
+    uint32_t total_ms = (s_attempt_us != 0) ? (uint32_t)((now_us - s_attempt_us) / 1000) : 0;
+    uint32_t ip_ms = (s_assoc_us != 0) ? (uint32_t)((now_us - s_assoc_us) / 1000) : 0;
+    uint32_t recovery_ms = (s_lost_us != 0) ? (uint32_t)((now_us - s_lost_us) / 1000) : 0;
+    bool lease_reused = s_cache_valid && s_cache.ip == s_ip.addr;
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.connects++;
+    s_stats.connected = true;
+    s_stats.fast = s_fast_active;
+    s_stats.lease_reused = lease_reused;
+    s_stats.last_ip_ms = ip_ms;
+    if (!s_ever_connected)
+    {
+        s_stats.cold_connect_ms = total_ms;
+    }
+    if (s_lost_us != 0)
+    {
+        s_stats.last_recovery_ms = recovery_ms;
+        if (recovery_ms > s_stats.max_recovery_ms)
         {
-            ESP_LOGE(TAG, "Failed to get AP info");
+            s_stats.max_recovery_ms = recovery_ms;
         }
     }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    if (s_lost_us != 0)
+    {
+        ESP_LOGI(TAG, "Got IP:" IPSTR " after link loss, recovered in %u ms", IP2STR(&s_ip), (unsigned)recovery_ms);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Got IP:" IPSTR " in %u ms (dhcp %u ms, %s)", IP2STR(&s_ip), (unsigned)total_ms,
+                 (unsigned)ip_ms, s_fast_active ? "cached AP" : "full scan");
+    }
+
+    s_ever_connected = true;
+    s_attempt_us = 0;
+    s_lost_us = 0;
+    wifi_cache_note_link();
+    wifi_set_bits(BSP_WIFI_CONNECTED_BIT, BSP_WIFI_DOWN_BIT);
+    // 释放信号量
+    xSemaphoreGive(wifi_connect_Semaphore);
+}
+
+static void event_handler(void *arg, esp_event_base_t event_base,
+                          int32_t event_id, void *event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
+    {
+        wifi_connect_now();
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    {
+        const wifi_event_sta_connected_t *event = (const wifi_event_sta_connected_t *)event_data;
+        s_associated = true;
+        s_assoc_us = esp_timer_get_time();
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.channel = event->channel;
+        s_stats.last_assoc_ms = (s_attempt_us != 0) ? (uint32_t)((s_assoc_us - s_attempt_us) / 1000) : 0;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGI(TAG, "Connected SSID: %.*s ch %d", (int)event->ssid_len, (const char *)event->ssid,
+                 (int)event->channel);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    {
+        wifi_handle_disconnect((const wifi_event_sta_disconnected_t *)event_data);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
+    {
+        ESP_LOGD(TAG, "WiFi scan done");
+        // 释放信号量
+        xSemaphoreGive(wifi_scan_Semaphore);
+    }
+    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
+    {
+        wifi_handle_got_ip((const ip_event_got_ip_t *)event_data);
+    }
+    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_LOST_IP)
+    {
+        // Lease expired while still associated; DHCP keeps trying on its own
+        ESP_LOGW(TAG, "lost IP");
+        wifi_set_bits(BSP_WIFI_DOWN_BIT, BSP_WIFI_CONNECTED_BIT);
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.connected = false;
+        s_stats.disconnects++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        s_lost_us = esp_timer_get_time();
+    }
 }
 
 /* Initialize Wi-Fi as sta and set scan method */
@@ -96,6 +403,8 @@ bool bsp_wifi_scan(wifi_ap_record_t *ap_info, uint16_t *scan_number, uint16_t sc
     esp_err_t ret = ESP_OK;
     // memset(ap_info, 0, sizeof(ap_info));
 
+    // SCAN_DONE from a survey scan also gives the semaphore; drop that stale give
+    xSemaphoreTake(wifi_scan_Semaphore, 0);
     ret = esp_wifi_scan_start(NULL, false);
     if (ESP_OK != ret)
         goto scan_err;
@@ -138,36 +447,142 @@ scan_err:
 
 esp_err_t bsp_wifi_sta_connect(const char *ssid, const char *password)
 {
-    esp_wifi_disconnect();
-    // esp_wifi_stop();
+    if (s_wifi_started && esp_wifi_disconnect() == ESP_OK)
+    {
+        s_expect_leave = true;
+    }
+    esp_timer_stop(s_retry_timer);
+    s_retry_num = 0;
+    s_attempt_us = 0;
+
     wifi_config_t wifi_config = {};
     wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-
-    memcpy(wifi_config.sta.ssid, ssid, strlen(ssid));
-    memcpy(wifi_config.sta.password, password, strlen(password));
+    // Only used with WIFI_PS_MAX_MODEM; 0 keeps the driver default of 3 beacons
+    wifi_config.sta.listen_interval = s_listen_interval;
+
+    size_t ssid_len = strnlen(ssid, sizeof(wifi_config.sta.ssid));
+    size_t pass_len = strnlen(password, sizeof(wifi_config.sta.password));
+    memcpy(wifi_config.sta.ssid, ssid, ssid_len);
+    memcpy(wifi_config.sta.password, password, pass_len);
+    s_ssid_hash = wifi_hash_ssid(ssid);
+    s_fast_active = wifi_apply_hints(&wifi_config, true);
+    if (s_fast_active)
+    {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.fast_attempts++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGI(TAG, "fast connect: cached AP " MACSTR " ch %d", MAC2STR(s_cache.bssid), (int)s_cache.channel);
+    }
 
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    wifi_set_bits(BSP_WIFI_DOWN_BIT, BSP_WIFI_CONNECTED_BIT);
 
-    esp_wifi_connect();
-
-    ESP_ERROR_CHECK(esp_wifi_start());
+    if (s_wifi_started)
+    {
+        wifi_connect_now();
+    }
+    else
+    {
+        // WIFI_EVENT_STA_START issues the first connect
+        s_attempt_us = esp_timer_get_time();
+        ESP_ERROR_CHECK(esp_wifi_start());
+        s_wifi_started = true;
+    }
+    esp_wifi_set_ps(s_ps_type);
 
     ESP_LOGI(TAG, "wifi_init_sta finished.");
     return ESP_OK;
-
-    // if (xSemaphoreTake(wifi_connect_Semaphore, pdMS_TO_TICKS(5000)))
-    //     return ESP_OK;
-    // else
-    //     return ESP_FAIL;
 }
 
 
+esp_err_t bsp_wifi_set_power_save(wifi_ps_type_t ps_type, uint16_t listen_interval)
+{
+    s_ps_type = ps_type;
+    s_listen_interval = listen_interval;
+    if (!s_wifi_initialized)
+    {
+        // Applied by bsp_wifi_sta_connect once the driver is up
+        return ESP_OK;
+    }
+
+    // Listen interval is negotiated at association; it takes effect on the next connect
+    esp_err_t ret = esp_wifi_set_ps(ps_type);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "esp_wifi_set_ps(%d) failed: %s", (int)ps_type, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
 void bsp_wifi_get_ip(char *ip)
 {
-    esp_netif_ip_info_t ip_info;
-    esp_netif_get_ip_info(esp_netif_get_handle_from_ifkey("WIFI_STA_DEF"), &ip_info);
-    sprintf(ip, "%d.%d.%d.%d", IP2STR(&ip_info.ip));
+    if (!bsp_wifi_is_connected())
+    {
+        sprintf(ip, "0.0.0.0");
+        return;
+    }
+    sprintf(ip, IPSTR, IP2STR(&s_ip));
+}
+
+EventGroupHandle_t bsp_wifi_events(void)
+{
+    return s_wifi_event_group;
+}
+
+bool bsp_wifi_is_connected(void)
+{
+    return s_wifi_event_group != NULL && (xEventGroupGetBits(s_wifi_event_group) & BSP_WIFI_CONNECTED_BIT) != 0;
+}
+
+bool bsp_wifi_wait_connected(TickType_t timeout_ticks)
+{
+    if (s_wifi_event_group == NULL)
+    {
+        return false;
+    }
+    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group, BSP_WIFI_CONNECTED_BIT, pdFALSE, pdTRUE, timeout_ticks);
+    return (bits & BSP_WIFI_CONNECTED_BIT) != 0;
+}
+
+bool bsp_wifi_scan_allowed(void)
+{
+    // Between attempts the backoff timer is pending and the driver is idle; call from the
+    // esp_timer task so the timer cannot fire in between
+    return bsp_wifi_is_connected() || (s_retry_timer != NULL && esp_timer_is_active(s_retry_timer));
+}
+
+void bsp_wifi_get_stats(bsp_wifi_stats_t *out)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+esp_err_t bsp_wifi_set_static_ip(const char *ip, const char *gateway, const char *netmask, const char *dns)
+{
+    if (ip == NULL || ip[0] == '\0')
+    {
+        s_static_ip = false;
+        return ESP_OK;
+    }
+    esp_netif_ip_info_t info = {};
+    if (esp_netif_str_to_ip4(ip, &info.ip) != ESP_OK ||
+        esp_netif_str_to_ip4((gateway != NULL) ? gateway : "", &info.gw) != ESP_OK ||
+        esp_netif_str_to_ip4((netmask != NULL && netmask[0] != '\0') ? netmask : "255.255.255.0", &info.netmask) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "bad static IP config %s gw %s", ip, (gateway != NULL) ? gateway : "(null)");
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_static_dns.addr = 0;
+    if (dns != NULL && dns[0] != '\0' && esp_netif_str_to_ip4(dns, &s_static_dns) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "bad static DNS %s", dns);
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_static_ip_info = info;
+    s_static_ip = true;
+    return ESP_OK;
 }
 
 void bsp_wifi_init(const char *ssid, const char *pass)
@@ -175,21 +590,55 @@ void bsp_wifi_init(const char *ssid, const char *pass)
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
-    esp_netif_t *sta_netif = esp_netif_create_default_wifi_sta();
-    assert(sta_netif);
+    s_sta_netif = esp_netif_create_default_wifi_sta();
+    assert(s_sta_netif);
 
     esp_netif_t *ap_netif = esp_netif_create_default_wifi_ap();
     assert(ap_netif);
 
+    if (s_static_ip)
+    {
+        // No DHCP round trip: esp_netif posts GOT_IP with this address as soon as we associate
+        esp_netif_dhcpc_stop(s_sta_netif);
+        esp_netif_set_ip_info(s_sta_netif, &s_static_ip_info);
+        if (s_static_dns.addr != 0)
+        {
+            esp_netif_dns_info_t dns_info = {};
+            dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+            dns_info.ip.u_addr.ip4 = s_static_dns;
+            esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns_info);
+        }
+        ESP_LOGI(TAG, "static IP " IPSTR, IP2STR(&s_static_ip_info.ip));
+    }
+
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    // The link cache in NVS replaces the driver's own copy of the config
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+    s_wifi_initialized = true;
 
     s_wifi_event_group = xEventGroupCreate();
+    xEventGroupSetBits(s_wifi_event_group, BSP_WIFI_DOWN_BIT);
     wifi_scan_Semaphore = xSemaphoreCreateBinary();
     wifi_connect_Semaphore = xSemaphoreCreateBinary();
 
+    const esp_timer_create_args_t retry_args = {
+        .callback = wifi_retry_cb,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&retry_args, &s_retry_timer));
+    const esp_timer_create_args_t save_args = {
+        .callback = wifi_cache_save_cb,
+        .name = "wifi_cache",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&save_args, &s_save_timer));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(BSP_WIFI_CACHE_EVENT, WIFI_CACHE_SAVE_EVENT,
+                                                        &wifi_cache_save_handler, NULL, NULL));
+    wifi_cache_load();
+
     esp_event_handler_instance_t instance_any_id;
     esp_event_handler_instance_t instance_got_ip;
+    esp_event_handler_instance_t instance_lost_ip;
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
                                                         ESP_EVENT_ANY_ID,
                                                         &event_handler,
@@ -200,8 +649,13 @@ void bsp_wifi_init(const char *ssid, const char *pass)
                                                         &event_handler,
                                                         NULL,
                                                         &instance_got_ip));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
+                                                        IP_EVENT_STA_LOST_IP,
+                                                        &event_handler,
+                                                        NULL,
+                                                        &instance_lost_ip));
     if (ssid != NULL && pass != NULL)
     {
         bsp_wifi_sta_connect(ssid, pass);
     }
-}
\ No newline at end of file
+}
@@ -3,16 +3,56 @@
 
 #include <stdio.h>
 #include "esp_wifi.h"
+#include "esp_netif.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Event bits on bsp_wifi_events(): exactly one of the two is set at any time
+#define BSP_WIFI_CONNECTED_BIT BIT0 // associated and holding an IPv4 address
+#define BSP_WIFI_DOWN_BIT BIT1      // no IP; the driver is (re)connecting with backoff
+
+#define BSP_WIFI_RETRY_MIN_MS 500
+#define BSP_WIFI_RETRY_MAX_MS 30000
+
+typedef struct
+{
+    uint32_t connects;          // times an IP was obtained
+    uint32_t disconnects;       // link losses after an IP was held
+    uint32_t retries;           // esp_wifi_connect() calls from the backoff timer
+    uint32_t connect_errors;    // esp_wifi_connect() calls the driver rejected; each one re-arms the backoff
+    uint32_t fast_attempts;     // connects started with the cached BSSID/channel
+    uint32_t fast_fallbacks;    // of those, ones that had to fall back to a full scan
+    uint32_t cold_connect_ms;   // first connect after boot: request -> IP
+    uint32_t last_assoc_ms;     // last connect: request -> associated
+    uint32_t last_ip_ms;        // last connect: associated -> IP
+    uint32_t last_recovery_ms;  // last link loss -> IP again
+    uint32_t max_recovery_ms;
+    uint8_t last_reason;        // wifi_err_reason_t of the last disconnect
+    uint8_t channel;
+    bool connected;
+    bool fast;                  // the current link came up on the cached BSSID/channel
+    bool lease_reused;          // the current IP matches the one cached in NVS
+} bsp_wifi_stats_t;
+
+// Optional fixed address, applied before connecting (skips DHCP entirely). Dotted quads;
+// dns may be NULL or "". Call before bsp_wifi_init().
+esp_err_t bsp_wifi_set_static_ip(const char *ip, const char *gateway, const char *netmask, const char *dns);
 void bsp_wifi_init(const char *ssid, const char *pass);
+EventGroupHandle_t bsp_wifi_events(void);
+bool bsp_wifi_is_connected(void);
+bool bsp_wifi_wait_connected(TickType_t timeout_ticks);
+// True while connected, or while disconnected with no connect attempt in flight
+bool bsp_wifi_scan_allowed(void);
+void bsp_wifi_get_stats(bsp_wifi_stats_t *out);
 void bsp_wifi_get_ip(char *ip);
 esp_err_t bsp_wifi_sta_connect(const char *ssid, const char *password);
 bool bsp_wifi_scan(wifi_ap_record_t *ap_info, uint16_t *scan_number, uint16_t scan_max_num);
+esp_err_t bsp_wifi_set_power_save(wifi_ps_type_t ps_type, uint16_t listen_interval);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,351 @@
+#include "bsp_wifi_survey.h"
+#include "bsp_wifi.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+
+// Records fetched per scan; anything beyond is dropped by the driver
+#define SURVEY_SCAN_RECORDS 20
+
+typedef struct
+{
+    bsp_wifi_survey_ap_t ap;
+    int16_t rssi_x16;       // EWMA state, 1/16 dBm
+    bool used;
+} survey_entry_t;
+
+typedef struct
+{
+    uint8_t ap_count;
+    int8_t max_rssi;
+    uint8_t head;
+    uint8_t len;
+    uint8_t ring[BSP_WIFI_SURVEY_HISTORY];
+    uint32_t last_ms;
+} survey_channel_t;
+
+static const char *TAG = "wifi_survey";
+
+static SemaphoreHandle_t s_mutex = NULL;
+static esp_timer_handle_t s_step_timer = NULL;
+static uint32_t s_step_ms = 0;
+static volatile bool s_scanning = false;
+static uint8_t s_channel = 1;
+static uint8_t s_scan_channel = 0;
+
+static survey_entry_t s_table[BSP_WIFI_SURVEY_MAX_APS];
+static survey_channel_t s_channels[BSP_WIFI_SURVEY_CHANNELS];
+static bsp_wifi_survey_stats_t s_stats;
+// Filled from the event task only; static to keep it off that task's small stack
+static wifi_ap_record_t s_records[SURVEY_SCAN_RECORDS];
+
+static uint32_t survey_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static survey_entry_t *survey_slot_for(const uint8_t *bssid, uint32_t now_ms)
+{
+    survey_entry_t *free_slot = NULL;
+    survey_entry_t *oldest = &s_table[0];
+    for (int i = 0; i < BSP_WIFI_SURVEY_MAX_APS; ++i)
+    {
+        survey_entry_t *e = &s_table[i];
+        if (!e->used || (now_ms - e->ap.last_seen_ms) > BSP_WIFI_SURVEY_EXPIRE_MS)
+        {
+            if (free_slot == NULL)
+            {
+                free_slot = e;
+            }
+            continue;
+        }
+        if (memcmp(e->ap.bssid, bssid, sizeof(e->ap.bssid)) == 0)
+        {
+            return e;
+        }
+        if (e->ap.last_seen_ms < oldest->ap.last_seen_ms)
+        {
+            oldest = e;
+        }
+    }
+    if (free_slot != NULL)
+    {
+        free_slot->used = false;
+        return free_slot;
+    }
+    s_stats.evicted++;
+    oldest->used = false;
+    return oldest;
+}
+
+static void survey_merge(uint8_t channel, const wifi_ap_record_t *records, uint16_t count, uint32_t now_ms)
+{
+    int8_t max_rssi = 0;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        const wifi_ap_record_t *rec = &records[i];
+        survey_entry_t *e = survey_slot_for(rec->bssid, now_ms);
+        if (!e->used)
+        {
+            memset(e, 0, sizeof(*e));
+            memcpy(e->ap.bssid, rec->bssid, sizeof(e->ap.bssid));
+            e->rssi_x16 = (int16_t)(rec->rssi * 16);
+            e->used = true;
+        }
+        else
+        {
+            e->rssi_x16 += (int16_t)((rec->rssi * 16 - e->rssi_x16) >> BSP_WIFI_SURVEY_RSSI_WEIGHT_SHIFT);
+        }
+        memcpy(e->ap.ssid, rec->ssid, sizeof(e->ap.ssid) - 1);
+        e->ap.ssid[sizeof(e->ap.ssid) - 1] = '\0';
+        e->ap.rssi = (int8_t)((e->rssi_x16 - 8) / 16);
+        e->ap.rssi_last = rec->rssi;
+        e->ap.channel = rec->primary;
+        e->ap.authmode = (uint8_t)rec->authmode;
+        e->ap.last_seen_ms = now_ms;
+        if (e->ap.sightings < UINT16_MAX)
+        {
+            e->ap.sightings++;
+        }
+        if (max_rssi == 0 || rec->rssi > max_rssi)
+        {
+            max_rssi = rec->rssi;
+        }
+    }
+
+    survey_channel_t *ch = &s_channels[channel - 1];
+    ch->ap_count = (uint8_t)count;
+    ch->max_rssi = max_rssi;
+    ch->last_ms = now_ms;
+    ch->ring[ch->head] = (uint8_t)count;
+    ch->head = (uint8_t)((ch->head + 1) % BSP_WIFI_SURVEY_HISTORY);
+    if (ch->len < BSP_WIFI_SURVEY_HISTORY)
+    {
+        ch->len++;
+    }
+}
+
+static void survey_scan_done(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    (void)arg;
+    (void)event_base;
+    (void)event_id;
+    // Scans started elsewhere (bsp_wifi_scan, connect) also end here; leave those alone
+    if (!s_scanning)
+    {
+        return;
+    }
+    s_scanning = false;
+
+    const wifi_event_sta_scan_done_t *done = (const wifi_event_sta_scan_done_t *)event_data;
+    uint16_t count = SURVEY_SCAN_RECORDS;
+    // get_ap_records also frees the driver's list, so it runs even on a failed scan
+    if (done->status != 0 || esp_wifi_scan_get_ap_records(&count, s_records) != ESP_OK)
+    {
+        esp_wifi_clear_ap_list();
+        count = 0;
+    }
+
+    uint32_t now_ms = survey_now_ms();
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    survey_merge(s_scan_channel, s_records, count, now_ms);
+    s_stats.scans++;
+    s_stats.seq++;
+    if (s_scan_channel == BSP_WIFI_SURVEY_CHANNELS)
+    {
+        s_stats.sweeps++;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+// Readers copy s_stats under s_mutex, so every write takes it too
+static void survey_note_skip(void)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_stats.skipped++;
+    xSemaphoreGive(s_mutex);
+}
+
+static void survey_step_cb(void *arg)
+{
+    (void)arg;
+    // Runs without a link too, so the page can help find a network, but never during a connect
+    if (s_scanning || !bsp_wifi_scan_allowed())
+    {
+        survey_note_skip();
+        return;
+    }
+
+    wifi_scan_config_t cfg = {};
+    cfg.channel = s_channel;
+    cfg.show_hidden = true;
+    cfg.scan_type = WIFI_SCAN_TYPE_PASSIVE;
+    cfg.scan_time.passive = BSP_WIFI_SURVEY_DWELL_MS;
+
+    s_scan_channel = s_channel;
+    s_scanning = true;
+    esp_err_t ret = esp_wifi_scan_start(&cfg, false);
+    if (ret != ESP_OK)
+    {
+        // Driver busy (connect or another scan in flight): retry the same channel next step
+        s_scanning = false;
+        survey_note_skip();
+        ESP_LOGD(TAG, "ch%u scan not started: %s", (unsigned)s_channel, esp_err_to_name(ret));
+        return;
+    }
+    s_channel = (s_channel >= BSP_WIFI_SURVEY_CHANNELS) ? 1 : (uint8_t)(s_channel + 1);
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_stats.next_channel = s_channel;
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t bsp_wifi_survey_start(uint32_t step_ms)
+{
+    if (s_step_timer != NULL)
+    {
+        bsp_wifi_survey_set_step(step_ms);
+        return ESP_OK;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    s_stats.next_channel = s_channel;
+
+    esp_err_t ret = esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, survey_scan_done, NULL, NULL);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+    const esp_timer_create_args_t step_args = {
+        .callback = survey_step_cb,
+        .name = "wifi_survey",
+    };
+    ret = esp_timer_create(&step_args, &s_step_timer);
+    if (ret != ESP_OK)
+    {
+        return ret;
+    }
+    bsp_wifi_survey_set_step(step_ms);
+    ESP_LOGI(TAG, "survey started (%lu ms per channel)", (unsigned long)step_ms);
+    return ESP_OK;
+}
+
+void bsp_wifi_survey_set_step(uint32_t step_ms)
+{
+    if (s_step_timer == NULL || step_ms == s_step_ms)
+    {
+        return;
+    }
+    s_step_ms = step_ms;
+    esp_timer_stop(s_step_timer);
+    if (step_ms != 0)
+    {
+        esp_timer_start_periodic(s_step_timer, (uint64_t)step_ms * 1000ULL);
+    }
+}
+
+uint32_t bsp_wifi_survey_seq(void)
+{
+    return s_stats.seq;
+}
+
+size_t bsp_wifi_survey_get_aps(bsp_wifi_survey_ap_t *out, size_t max_count, size_t *total)
+{
+    size_t live = 0;
+    size_t written = 0;
+    if (s_mutex == NULL)
+    {
+        if (total != NULL)
+        {
+            *total = 0;
+        }
+        return 0;
+    }
+
+    uint32_t now_ms = survey_now_ms();
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < BSP_WIFI_SURVEY_MAX_APS; ++i)
+    {
+        const survey_entry_t *e = &s_table[i];
+        if (!e->used || (now_ms - e->ap.last_seen_ms) > BSP_WIFI_SURVEY_EXPIRE_MS)
+        {
+            continue;
+        }
+        live++;
+        // Insertion into the caller's array, strongest first; weaker overflow falls off
+        size_t pos = written;
+        while (pos > 0 && out[pos - 1].rssi < e->ap.rssi)
+        {
+            if (pos < max_count)
+            {
+                out[pos] = out[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max_count)
+        {
+            out[pos] = e->ap;
+            if (written < max_count)
+            {
+                written++;
+            }
+        }
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (total != NULL)
+    {
+        *total = live;
+    }
+    return written;
+}
+
+void bsp_wifi_survey_get_channels(bsp_wifi_survey_channel_t out[BSP_WIFI_SURVEY_CHANNELS])
+{
+    memset(out, 0, sizeof(bsp_wifi_survey_channel_t) * BSP_WIFI_SURVEY_CHANNELS);
+    if (s_mutex == NULL)
+    {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < BSP_WIFI_SURVEY_CHANNELS; ++i)
+    {
+        const survey_channel_t *ch = &s_channels[i];
+        bsp_wifi_survey_channel_t *dst = &out[i];
+        dst->channel = (uint8_t)(i + 1);
+        dst->ap_count = ch->ap_count;
+        dst->max_rssi = ch->max_rssi;
+        dst->last_ms = ch->last_ms;
+        dst->history_len = ch->len;
+        uint8_t start = (uint8_t)((ch->head + BSP_WIFI_SURVEY_HISTORY - ch->len) % BSP_WIFI_SURVEY_HISTORY);
+        for (uint8_t k = 0; k < ch->len; ++k)
+        {
+            dst->history[k] = ch->ring[(start + k) % BSP_WIFI_SURVEY_HISTORY];
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void bsp_wifi_survey_get_stats(bsp_wifi_survey_stats_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+    if (s_mutex == NULL)
+    {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *out = s_stats;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,70 @@
+#ifndef __BSP_WIFI_SURVEY_H__
+#define __BSP_WIFI_SURVEY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Background survey: one passive single-channel scan per step, walking channels
+// 1..BSP_WIFI_SURVEY_CHANNELS, so the radio leaves the home channel for one dwell
+// at a time instead of a full active sweep. While disconnected, steps run only while
+// the reconnect backoff is waiting so a survey never competes with a connect attempt.
+#define BSP_WIFI_SURVEY_CHANNELS 13
+#define BSP_WIFI_SURVEY_MAX_APS 32
+#define BSP_WIFI_SURVEY_HISTORY 12          // per-channel samples kept, one per visit
+#define BSP_WIFI_SURVEY_DWELL_MS 120
+#define BSP_WIFI_SURVEY_EXPIRE_MS (5 * 60 * 1000)
+#define BSP_WIFI_SURVEY_RSSI_WEIGHT_SHIFT 2 // EWMA weight of a new sample: 1/4
+
+typedef struct
+{
+    uint8_t bssid[6];
+    char ssid[33];
+    int8_t rssi;            // EWMA of every sighting, dBm
+    int8_t rssi_last;
+    uint8_t channel;
+    uint8_t authmode;       // wifi_auth_mode_t
+    uint16_t sightings;
+    uint32_t last_seen_ms;
+} bsp_wifi_survey_ap_t;
+
+typedef struct
+{
+    uint8_t channel;
+    uint8_t ap_count;       // beacons heard on the last visit
+    int8_t max_rssi;        // strongest of those, 0 when none
+    uint8_t history_len;
+    uint8_t history[BSP_WIFI_SURVEY_HISTORY]; // AP counts per visit, oldest first
+    uint32_t last_ms;
+} bsp_wifi_survey_channel_t;
+
+typedef struct
+{
+    uint32_t seq;           // bumped after every merged scan
+    uint32_t scans;
+    uint32_t skipped;       // steps dropped because the link was down or the driver busy
+    uint32_t sweeps;        // full passes over all channels
+    uint32_t evicted;
+    uint8_t next_channel;
+} bsp_wifi_survey_stats_t;
+
+// step_ms is the gap between single-channel scans; 0 pauses the survey.
+esp_err_t bsp_wifi_survey_start(uint32_t step_ms);
+void bsp_wifi_survey_set_step(uint32_t step_ms);
+uint32_t bsp_wifi_survey_seq(void);
+// Live entries, strongest EWMA first. Returns the count written; total (optional)
+// receives the number of live entries before truncation.
+size_t bsp_wifi_survey_get_aps(bsp_wifi_survey_ap_t *out, size_t max_count, size_t *total);
+void bsp_wifi_survey_get_channels(bsp_wifi_survey_channel_t out[BSP_WIFI_SURVEY_CHANNELS]);
+void bsp_wifi_survey_get_stats(bsp_wifi_survey_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -31,10 +31,20 @@ typedef struct {
     int task_priority;      /*!< LVGL task priority */
     int task_stack;         /*!< LVGL task stack size */
     int task_affinity;      /*!< LVGL task pinned to core (-1 is no affinity) */
-    int task_max_sleep_ms;  /*!< Maximum sleep in LVGL task */
-    int timer_period_ms;    /*!< LVGL timer tick period in ms */
+    int task_max_sleep_ms;  /*!< Maximum sleep in LVGL task, 0 = sleep until woken when idle */
+    int frame_period_ms;    /*!< Shortest gap between LVGL passes while timers or animations run */
 } lvgl_port_cfg_t;
 
+/**
+ * @brief LVGL task counters, cumulative since lvgl_port_init
+ */
+typedef struct {
+    uint32_t passes;        /*!< lv_timer_handler() runs */
+    uint32_t wakes;         /*!< passes started by lvgl_port_wake() rather than a timer deadline */
+    uint32_t idle_waits;    /*!< sleeps with nothing scheduled (until woken) */
+    uint64_t busy_us;       /*!< time spent inside lv_timer_handler() */
+} lvgl_port_stats_t;
+
 typedef struct {
     esp_lcd_panel_io_handle_t io_handle;    /*!< LCD panel IO handle */
     esp_lcd_panel_handle_t panel_handle;    /*!< LCD panel handle */
@@ -73,7 +83,7 @@ typedef struct {
         .task_stack = 4096,       \
         .task_affinity = -1,      \
         .task_max_sleep_ms = 500, \
-        .timer_period_ms = 5,     \
+        .frame_period_ms = 5,     \
     }
 
 /**
@@ -100,6 +110,65 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg);
  */
 esp_err_t lvgl_port_deinit(void);
 
+/**
+ * @brief Stop LVGL timers
+ *
+ * @note Disables LVGL timers; the LVGL task blocks until lvgl_port_resume(). Display content is kept.
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if the LVGL task is not created yet
+ */
+esp_err_t lvgl_port_stop(void);
+
+/**
+ * @brief Resume LVGL timers and wake the LVGL task
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_STATE     if the LVGL task is not created yet or already running
+ */
+esp_err_t lvgl_port_resume(void);
+
+/**
+ * @brief Change maximum sleep of the LVGL task
+ *
+ * @note Takes effect after the current sleep of the LVGL task ends.
+ *
+ * @param[in] max_sleep_ms: Maximum sleep in [ms]. 0 restores the init value.
+ */
+void lvgl_port_set_max_sleep(uint32_t max_sleep_ms);
+
+/**
+ * @brief Change the frame floor of the LVGL task
+ *
+ * @note The LVGL tick is derived from the FreeRTOS tick count, so there is no tick timer.
+ * The task sleeps until the next LVGL timer is due but never less than this, and blocks
+ * indefinitely when nothing is scheduled. Longer periods coarsen animations.
+ *
+ * @param[in] period_ms: Frame period in [ms]
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if period_ms is 0
+ */
+esp_err_t lvgl_port_set_frame_period(uint32_t period_ms);
+
+/**
+ * @brief Wake the LVGL task for a pass
+ *
+ * @note lvgl_port_unlock() already does this, so code that changes LVGL objects under the
+ * lock needs no extra call. No-op when called from the LVGL task itself.
+ */
+void lvgl_port_wake(void);
+
+/**
+ * @brief Read the LVGL task counters
+ *
+ * @param[out] out Counters since lvgl_port_init
+ */
+void lvgl_port_get_stats(lvgl_port_stats_t *out);
+
 /**
  * @brief Add display handling to LVGL
  *
@@ -110,6 +179,44 @@ esp_err_t lvgl_port_deinit(void);
  */
 lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg);
 
+/**
+ * @brief Change software rotation of a display at runtime
+ *
+ * @note Must be called with the LVGL mutex held so no flush is in progress. Swaps the
+ * LVGL resolution when switching between portrait and landscape and invalidates the
+ * active screen; the next refresh repaints it once with the new rotation.
+ *
+ * @param disp     Display returned by lvgl_port_add_disp
+ * @param rotation New rotation
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if disp is not valid
+ *      - ESP_ERR_INVALID_STATE     if disp was not added by lvgl_port_add_disp
+ */
+esp_err_t lvgl_port_set_rotation(lv_disp_t *disp, lv_disp_rot_t rotation);
+
+/**
+ * @brief Draw pixels straight to the panel, bypassing LVGL rendering
+ *
+ * @note Must be called with the LVGL mutex held. The area is in panel coordinates (no software
+ * rotation). Rows are staged through the port's DMA transport buffers in stripes, and the call
+ * returns only after the last stripe has been sent, so the caller owns color_map again on return.
+ * The display's draw_wait_cb runs before the first stripe, as for an LVGL flush.
+ * LVGL content in the area is overwritten until LVGL next refreshes it.
+ *
+ * @param disp      Display returned by lvgl_port_add_disp
+ * @param area      Panel area to write
+ * @param color_map Pixels for area, row-major, in LVGL color format (with LV_COLOR_16_SWAP, RGB565
+ *                  high byte first, which is also the camera's RGB565 order)
+ *
+ * @return
+ *      - ESP_OK                    on success
+ *      - ESP_ERR_INVALID_ARG       if an argument or the area is not valid
+ *      - ESP_ERR_NOT_SUPPORTED     if the display was added without transport buffers
+ */
+esp_err_t lvgl_port_draw_direct(lv_disp_t *disp, const lv_area_t *area, const lv_color_t *color_map);
+
 /**
  * @brief Remove display handling from LVGL
  *
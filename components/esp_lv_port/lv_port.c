@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include "esp_system.h"
 #include "esp_log.h"
 #include "esp_err.h"
@@ -37,9 +38,13 @@ static const char *TAG = "LVGL";
 
 typedef struct lvgl_port_ctx_s {
     SemaphoreHandle_t   lvgl_mux;
-    esp_timer_handle_t  tick_timer;
+    TaskHandle_t        task;
     bool                running;
+    bool                stopped;
     int                 task_max_sleep_ms;
+    int                 task_max_sleep_init_ms;
+    TickType_t          last_tick;          /* FreeRTOS tick already handed to lv_tick_inc() */
+    lvgl_port_stats_t   stats;
 } lvgl_port_ctx_t;
 
 typedef struct {
@@ -69,13 +74,14 @@ typedef struct {
 * Local variables
 *******************************************************************************/
 static lvgl_port_ctx_t lvgl_port_ctx;
-static int lvgl_port_timer_period_ms = 5;
+static int lvgl_port_frame_period_ms = 5;
+static portMUX_TYPE lvgl_port_stats_lock = portMUX_INITIALIZER_UNLOCKED;
 
 /*******************************************************************************
 * Function definitions
 *******************************************************************************/
+static void lvgl_port_tick_sync(void);
 static void lvgl_port_task(void *arg);
-static esp_err_t lvgl_port_tick_init(void);
 static void lvgl_port_task_deinit(void);
 
 // LVGL callbacks
@@ -100,22 +106,20 @@ esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
 
     /* LVGL init */
     lv_init();
-    /* Tick init */
-    lvgl_port_timer_period_ms = cfg->timer_period_ms;
-    ESP_RETURN_ON_ERROR(lvgl_port_tick_init(), TAG, "");
+    /* No tick timer: lvgl_port_tick_sync() feeds LVGL from the FreeRTOS tick count */
+    lvgl_port_ctx.last_tick = xTaskGetTickCount();
+    lvgl_port_frame_period_ms = (cfg->frame_period_ms > 0) ? cfg->frame_period_ms : 1;
     /* Create task */
     lvgl_port_ctx.task_max_sleep_ms = cfg->task_max_sleep_ms;
-    if (lvgl_port_ctx.task_max_sleep_ms == 0) {
-        lvgl_port_ctx.task_max_sleep_ms = 500;
-    }
+    lvgl_port_ctx.task_max_sleep_init_ms = lvgl_port_ctx.task_max_sleep_ms;
     lvgl_port_ctx.lvgl_mux = xSemaphoreCreateRecursiveMutex();
     ESP_GOTO_ON_FALSE(lvgl_port_ctx.lvgl_mux, ESP_ERR_NO_MEM, err, TAG, "Create LVGL mutex fail!");
 
     BaseType_t res;
     if (cfg->task_affinity < 0) {
-        res = xTaskCreate(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, NULL);
+        res = xTaskCreate(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, &lvgl_port_ctx.task);
     } else {
-        res = xTaskCreatePinnedToCore(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, NULL, cfg->task_affinity);
+        res = xTaskCreatePinnedToCore(lvgl_port_task, "LVGL task", cfg->task_stack, NULL, cfg->task_priority, &lvgl_port_ctx.task, cfg->task_affinity);
     }
     ESP_GOTO_ON_FALSE(res == pdPASS, ESP_FAIL, err, TAG, "Create LVGL task fail!");
 
@@ -129,40 +133,60 @@ err:
 
 esp_err_t lvgl_port_resume(void)
 {
-    esp_err_t ret = ESP_ERR_INVALID_STATE;
-
-    if (lvgl_port_ctx.tick_timer != NULL) {
-        lv_timer_enable(true);
-        ret = esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_timer_period_ms * 1000);
-    }
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.task, ESP_ERR_INVALID_STATE, TAG, "LVGL task not created");
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.stopped, ESP_ERR_INVALID_STATE, TAG, "LVGL already running");
 
-    return ret;
+    lvgl_port_ctx.stopped = false;
+    lv_timer_enable(true);
+    lvgl_port_wake();
+    return ESP_OK;
 }
 
 esp_err_t lvgl_port_stop(void)
 {
-    esp_err_t ret = ESP_ERR_INVALID_STATE;
+    ESP_RETURN_ON_FALSE(lvgl_port_ctx.task, ESP_ERR_INVALID_STATE, TAG, "LVGL task not created");
 
-    if (lvgl_port_ctx.tick_timer != NULL) {
-        lv_timer_enable(false);
-        ret = esp_timer_stop(lvgl_port_ctx.tick_timer);
+    /* With timers disabled the task finds no deadline and blocks until lvgl_port_resume() */
+    lvgl_port_ctx.stopped = true;
+    lv_timer_enable(false);
+    return ESP_OK;
+}
+
+void lvgl_port_set_max_sleep(uint32_t max_sleep_ms)
+{
+    if (max_sleep_ms == 0) {
+        max_sleep_ms = lvgl_port_ctx.task_max_sleep_init_ms;
     }
+    lvgl_port_ctx.task_max_sleep_ms = max_sleep_ms;
+}
 
-    return ret;
+esp_err_t lvgl_port_set_frame_period(uint32_t period_ms)
+{
+    ESP_RETURN_ON_FALSE(period_ms > 0, ESP_ERR_INVALID_ARG, TAG, "invalid frame period");
+    lvgl_port_frame_period_ms = period_ms;
+    return ESP_OK;
 }
 
-esp_err_t lvgl_port_deinit(void)
+void lvgl_port_wake(void)
 {
-    /* Stop and delete timer */
-    if (lvgl_port_ctx.tick_timer != NULL) {
-        esp_timer_stop(lvgl_port_ctx.tick_timer);
-        esp_timer_delete(lvgl_port_ctx.tick_timer);
-        lvgl_port_ctx.tick_timer = NULL;
+    if (lvgl_port_ctx.task != NULL && xTaskGetCurrentTaskHandle() != lvgl_port_ctx.task) {
+        xTaskNotifyGive(lvgl_port_ctx.task);
     }
+}
+
+void lvgl_port_get_stats(lvgl_port_stats_t *out)
+{
+    taskENTER_CRITICAL(&lvgl_port_stats_lock);
+    *out = lvgl_port_ctx.stats;
+    taskEXIT_CRITICAL(&lvgl_port_stats_lock);
+}
 
+esp_err_t lvgl_port_deinit(void)
+{
     /* Stop running task */
     if (lvgl_port_ctx.running) {
         lvgl_port_ctx.running = false;
+        xTaskNotifyGive(lvgl_port_ctx.task);
     } else {
         lvgl_port_task_deinit();
     }
@@ -170,6 +194,69 @@ esp_err_t lvgl_port_deinit(void)
     return ESP_OK;
 }
 
+esp_err_t lvgl_port_set_rotation(lv_disp_t *disp, lv_disp_rot_t rotation)
+{
+    ESP_RETURN_ON_FALSE(disp && disp->driver, ESP_ERR_INVALID_ARG, TAG, "invalid display");
+    lv_disp_drv_t *drv = disp->driver;
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)drv->user_data;
+    ESP_RETURN_ON_FALSE(disp_ctx, ESP_ERR_INVALID_STATE, TAG, "display not added by lvgl_port");
+
+    if (disp_ctx->sw_rotate == rotation) {
+        return ESP_OK;
+    }
+
+    bool was_landscape = (disp_ctx->sw_rotate == LV_DISP_ROT_90 || disp_ctx->sw_rotate == LV_DISP_ROT_270);
+    bool landscape = (rotation == LV_DISP_ROT_90 || rotation == LV_DISP_ROT_270);
+    disp_ctx->sw_rotate = rotation;
+
+    if (was_landscape != landscape) {
+        /* Resolution swap: lv_disp_drv_update() re-lays out and invalidates every screen */
+        lv_coord_t hor_res = drv->hor_res;
+        drv->hor_res = drv->ver_res;
+        drv->ver_res = hor_res;
+        lv_disp_drv_update(disp, drv);
+    } else {
+        lv_obj_invalidate(lv_disp_get_scr_act(disp));
+    }
+    return ESP_OK;
+}
+
+esp_err_t lvgl_port_draw_direct(lv_disp_t *disp, const lv_area_t *area, const lv_color_t *color_map)
+{
+    ESP_RETURN_ON_FALSE(disp && disp->driver && area && color_map, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    lvgl_port_display_ctx_t *disp_ctx = (lvgl_port_display_ctx_t *)disp->driver->user_data;
+    ESP_RETURN_ON_FALSE(disp_ctx && disp_ctx->trans_size && disp_ctx->trans_done_sem, ESP_ERR_NOT_SUPPORTED, TAG, "transport buffers required");
+
+    const int width = area->x2 - area->x1 + 1;
+    const int height = area->y2 - area->y1 + 1;
+    ESP_RETURN_ON_FALSE(width > 0 && height > 0 && (uint32_t)width <= disp_ctx->trans_size, ESP_ERR_INVALID_ARG, TAG, "invalid area");
+
+    const int stripe_rows = disp_ctx->trans_size / width;
+    lv_color_t *to = disp_ctx->trans_buf_1;
+
+    /* Wait for the last stripe of the previous flush or direct draw; the semaphore is created given */
+    xSemaphoreTake(disp_ctx->trans_done_sem, portMAX_DELAY);
+    xSemaphoreGive(disp_ctx->trans_done_sem);
+
+    for (int y = 0; y < height; y += stripe_rows) {
+        const int rows = (height - y) > stripe_rows ? stripe_rows : (height - y);
+        to = (to == disp_ctx->trans_buf_1) ? disp_ctx->trans_buf_2 : disp_ctx->trans_buf_1;
+        /* Stage through internal DMA memory; the buffer used two stripes ago is already done */
+        memcpy(to, color_map + (size_t)y * width, (size_t)rows * width * sizeof(lv_color_t));
+        if (0 == y && disp_ctx->draw_wait_cb) {
+            /* Same hook as the flush path (e.g. tearing effect sync), right before the first stripe */
+            disp_ctx->draw_wait_cb(disp_ctx->panel_handle->user_data);
+        }
+        xSemaphoreTake(disp_ctx->trans_done_sem, portMAX_DELAY);
+        esp_lcd_panel_draw_bitmap(disp_ctx->panel_handle, area->x1, area->y1 + y, area->x2 + 1, area->y1 + y + rows, to);
+    }
+
+    /* Caller may release color_map once we return: wait for the final stripe, leave the port idle */
+    xSemaphoreTake(disp_ctx->trans_done_sem, portMAX_DELAY);
+    xSemaphoreGive(disp_ctx->trans_done_sem);
+    return ESP_OK;
+}
+
 lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
 {
     esp_err_t ret = ESP_OK;
@@ -219,7 +306,8 @@ lv_disp_t *lvgl_port_add_disp(const lvgl_port_display_cfg_t *disp_cfg)
         ESP_GOTO_ON_FALSE(buf3, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for buffer(transport) allocation!");
         disp_ctx->trans_buf_2 = buf3;
 
-        trans_done_sem = xSemaphoreCreateCounting(1, 0);
+        /* Given while the transport is idle, so it starts given */
+        trans_done_sem = xSemaphoreCreateCounting(1, 1);
         ESP_GOTO_ON_FALSE(trans_done_sem, ESP_ERR_NO_MEM, err, TAG, "Failed to create transport counting Semaphore");
         disp_ctx->trans_done_sem = trans_done_sem;
     }
@@ -350,13 +438,20 @@ bool lvgl_port_lock(uint32_t timeout_ms)
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
 
     const TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    return xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) == pdTRUE;
+    if (xSemaphoreTakeRecursive(lvgl_port_ctx.lvgl_mux, timeout_ticks) != pdTRUE) {
+        return false;
+    }
+    /* Callers outside the LVGL task (lv_anim_start, lv_tick_get) must see the current time */
+    lvgl_port_tick_sync();
+    return true;
 }
 
 void lvgl_port_unlock(void)
 {
     assert(lvgl_port_ctx.lvgl_mux && "lvgl_port_init must be called first");
     xSemaphoreGiveRecursive(lvgl_port_ctx.lvgl_mux);
+    /* Anything changed under the lock (state publish, input) may need a frame: wake the task */
+    lvgl_port_wake();
 }
 
 void lvgl_port_flush_ready(lv_disp_t *disp)
@@ -370,23 +465,93 @@ void lvgl_port_flush_ready(lv_disp_t *disp)
 * Private functions
 *******************************************************************************/
 
-static void lvgl_port_task(void *arg)
+static void lvgl_port_tick_sync(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    TickType_t elapsed = now - lvgl_port_ctx.last_tick;
+    if (elapsed != 0) {
+        lvgl_port_ctx.last_tick = now;
+        lv_tick_inc(elapsed * portTICK_PERIOD_MS);
+    }
+}
+
+/* Time until the next LVGL timer is due, ignoring display refresh timers while nothing is
+ * invalidated: those fire every LV_DISP_DEF_REFR_PERIOD but have no work on a static screen.
+ * The animation timer pauses itself when no animation runs, so a static page yields
+ * LV_NO_TIMER_READY and the task blocks until it is woken. */
+static uint32_t lvgl_port_next_deadline(void)
 {
-    uint32_t task_delay_ms = lvgl_port_ctx.task_max_sleep_ms;
+    uint32_t next = LV_NO_TIMER_READY;
+    if (lvgl_port_ctx.stopped) {
+        return next;
+    }
+    for (lv_timer_t *timer = lv_timer_get_next(NULL); timer != NULL; timer = lv_timer_get_next(timer)) {
+        if (timer->paused) {
+            continue;
+        }
+        bool idle_refresh = false;
+        for (lv_disp_t *disp = lv_disp_get_next(NULL); disp != NULL; disp = lv_disp_get_next(disp)) {
+            if (disp->refr_timer == timer && disp->inv_p == 0) {
+                idle_refresh = true;
+                break;
+            }
+        }
+        if (idle_refresh) {
+            continue;
+        }
+        uint32_t elapsed = lv_tick_elaps(timer->last_run);
+        uint32_t remaining = (elapsed >= timer->period) ? 0 : timer->period - elapsed;
+        if (remaining < next) {
+            next = remaining;
+        }
+    }
+    return next;
+}
 
+static void lvgl_port_task(void *arg)
+{
     ESP_LOGI(TAG, "Starting LVGL task");
     lvgl_port_ctx.running = true;
     while (lvgl_port_ctx.running) {
+        uint32_t next_ms = LV_NO_TIMER_READY;
         if (lvgl_port_lock(0)) {
-            task_delay_ms = lv_timer_handler();
+            int64_t start_us = esp_timer_get_time();
+            lv_timer_handler();
+            next_ms = lvgl_port_next_deadline();
+            uint32_t busy_us = (uint32_t)(esp_timer_get_time() - start_us);
             lvgl_port_unlock();
+
+            taskENTER_CRITICAL(&lvgl_port_stats_lock);
+            lvgl_port_ctx.stats.passes++;
+            lvgl_port_ctx.stats.busy_us += busy_us;
+            if (next_ms == LV_NO_TIMER_READY) {
+                lvgl_port_ctx.stats.idle_waits++;
+            }
+            taskEXIT_CRITICAL(&lvgl_port_stats_lock);
         }
-        if ((task_delay_ms > lvgl_port_ctx.task_max_sleep_ms) || (1 == task_delay_ms)) {
-            task_delay_ms = lvgl_port_ctx.task_max_sleep_ms;
-        } else if (task_delay_ms < 1) {
-            task_delay_ms = 1;
+
+        /* Frame floor while busy; optional cap, otherwise sleep until lvgl_port_wake() */
+        TickType_t wait = portMAX_DELAY;
+        if (next_ms != LV_NO_TIMER_READY) {
+            if (next_ms < (uint32_t)lvgl_port_frame_period_ms) {
+                next_ms = lvgl_port_frame_period_ms;
+            }
+            wait = pdMS_TO_TICKS(next_ms);
+            if (wait == 0) {
+                wait = 1;
+            }
+        }
+        if (lvgl_port_ctx.task_max_sleep_ms > 0) {
+            TickType_t cap = pdMS_TO_TICKS(lvgl_port_ctx.task_max_sleep_ms);
+            if (wait > cap) {
+                wait = cap;
+            }
+        }
+        if (ulTaskNotifyTake(pdTRUE, wait) != 0) {
+            taskENTER_CRITICAL(&lvgl_port_stats_lock);
+            lvgl_port_ctx.stats.wakes++;
+            taskEXIT_CRITICAL(&lvgl_port_stats_lock);
         }
-        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
     }
 
     lvgl_port_task_deinit();
@@ -603,20 +768,3 @@ static void lvgl_port_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *
     }
 }
 #endif
-
-static void lvgl_port_tick_increment(void *arg)
-{
-    /* Tell LVGL how many milliseconds have elapsed */
-    lv_tick_inc(lvgl_port_timer_period_ms);
-}
-
-static esp_err_t lvgl_port_tick_init(void)
-{
-    // Tick interface for LVGL (using esp_timer to generate 2ms periodic event)
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &lvgl_port_tick_increment,
-        .name = "LVGL tick",
-    };
-    ESP_RETURN_ON_ERROR(esp_timer_create(&lvgl_tick_timer_args, &lvgl_port_ctx.tick_timer), TAG, "Creating LVGL timer filed!");
-    return esp_timer_start_periodic(lvgl_port_ctx.tick_timer, lvgl_port_timer_period_ms * 1000);
-}
@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+/*
+ * LVGL heap. Set CONFIG_LV_MEM_CUSTOM=y and CONFIG_LV_MEM_CUSTOM_INCLUDE="lv_port_mem.h";
+ * the project CMakeLists then points LV_MEM_CUSTOM_ALLOC/FREE/REALLOC at the functions
+ * below. Included by lvgl itself, so this header must not pull in lvgl.h or IDF headers,
+ * and the component must not depend on lvgl (lvgl links it).
+ *
+ * Two TLSF pools (IDF multi_heap):
+ *  - hot: small, in internal RAM, for blocks up to LVGL_PORT_MEM_HOT_MAX_BYTES. Label text,
+ *    style arrays and timer/animation records are re-allocated on every update and are
+ *    read on every refresh, so they stay out of PSRAM.
+ *  - bulk: a region reserved once from PSRAM for everything else (objects, draw buffers).
+ * A full hot pool spills to bulk; a full bulk pool falls back to the system heap.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LVGL_PORT_MEM_HOT_BYTES
+#define LVGL_PORT_MEM_HOT_BYTES         (16 * 1024)
+#endif
+#ifndef LVGL_PORT_MEM_HOT_MAX_BYTES
+#define LVGL_PORT_MEM_HOT_MAX_BYTES     64
+#endif
+#ifndef LVGL_PORT_MEM_BULK_BYTES
+#define LVGL_PORT_MEM_BULK_BYTES        (192 * 1024)
+#endif
+
+/**
+ * @brief One pool, from multi_heap_get_info()
+ */
+typedef struct {
+    uint32_t size;          /*!< Usable bytes when empty, 0 if the pool could not be created */
+    uint32_t used;          /*!< Bytes allocated now */
+    uint32_t peak;          /*!< Highest allocated since creation */
+    uint32_t largest_free;  /*!< Largest block that can be allocated now */
+    uint32_t blocks;        /*!< Live allocations */
+    uint8_t frag_pct;       /*!< 100 - largest_free * 100 / free: 0 means one contiguous free block */
+} lvgl_port_mem_pool_stats_t;
+
+/**
+ * @brief LVGL heap counters, cumulative since the first allocation
+ */
+typedef struct {
+    lvgl_port_mem_pool_stats_t hot;
+    lvgl_port_mem_pool_stats_t bulk;
+    uint32_t allocs;        /*!< lv_mem_alloc() calls, including reallocs of NULL */
+    uint32_t frees;
+    uint32_t reallocs;
+    uint32_t moves;         /*!< reallocs that copied the block elsewhere (outgrew hot, or no room in place) */
+    uint32_t spills;        /*!< small blocks placed in bulk because hot was full */
+    uint32_t fallbacks;     /*!< blocks placed in the system heap because bulk was full */
+    uint32_t failures;      /*!< allocations that returned NULL */
+} lvgl_port_mem_stats_t;
+
+void *lvgl_port_mem_alloc(size_t size);
+void lvgl_port_mem_free(void *ptr);
+void *lvgl_port_mem_realloc(void *ptr, size_t size);
+
+/**
+ * @brief Read the LVGL heap counters and pool state
+ *
+ * @note Safe from any task without the LVGL port lock; the counters and pools have their own spinlocks.
+ *
+ * @param[out] out Counters and pool state
+ */
+void lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
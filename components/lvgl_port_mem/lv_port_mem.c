@@ -0,0 +1,233 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "multi_heap.h"
+#include "freertos/FreeRTOS.h"
+
+#include "lv_port_mem.h"
+
+static const char *TAG = "LVGL_MEM";
+
+/*******************************************************************************
+* Types definitions
+*******************************************************************************/
+
+typedef struct {
+    multi_heap_handle_t heap;
+    uintptr_t           start;
+    uintptr_t           end;
+    size_t              size;       /* Free bytes right after registration */
+    portMUX_TYPE        lock;
+} lvgl_port_mem_pool_t;
+
+/*******************************************************************************
+* Local variables
+*******************************************************************************/
+
+/* Internal RAM; 8-byte aligned for the TLSF block headers */
+static uint8_t lvgl_port_mem_hot_area[LVGL_PORT_MEM_HOT_BYTES] __attribute__((aligned(8)));
+
+static lvgl_port_mem_pool_t lvgl_port_mem_hot = { .lock = portMUX_INITIALIZER_UNLOCKED };
+static lvgl_port_mem_pool_t lvgl_port_mem_bulk = { .lock = portMUX_INITIALIZER_UNLOCKED };
+static bool lvgl_port_mem_ready = false;
+
+/* Bumped from lv_mem_* calls (port mutex held) but read by lvgl_port_mem_get_stats() from any
+ * task without it, e.g. httpd; the spinlock keeps that copy consistent */
+static lvgl_port_mem_stats_t lvgl_port_mem_counters;
+static portMUX_TYPE lvgl_port_mem_counters_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*******************************************************************************
+* Private functions
+*******************************************************************************/
+
+static void lvgl_port_mem_count(uint32_t *counter)
+{
+    portENTER_CRITICAL(&lvgl_port_mem_counters_lock);
+    (*counter)++;
+    portEXIT_CRITICAL(&lvgl_port_mem_counters_lock);
+}
+
+static void lvgl_port_mem_pool_register(lvgl_port_mem_pool_t *pool, void *area, size_t size)
+{
+    pool->heap = multi_heap_register(area, size);
+    if (pool->heap == NULL) {
+        return;
+    }
+    multi_heap_set_lock(pool->heap, &pool->lock);
+    pool->start = (uintptr_t)area;
+    pool->end = (uintptr_t)area + size;
+    pool->size = multi_heap_free_size(pool->heap);
+}
+
+static void lvgl_port_mem_init(void)
+{
+    lvgl_port_mem_ready = true;
+
+    lvgl_port_mem_pool_register(&lvgl_port_mem_hot, lvgl_port_mem_hot_area, sizeof(lvgl_port_mem_hot_area));
+
+    void *bulk = heap_caps_malloc(LVGL_PORT_MEM_BULK_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (bulk != NULL) {
+        lvgl_port_mem_pool_register(&lvgl_port_mem_bulk, bulk, LVGL_PORT_MEM_BULK_BYTES);
+    }
+    if (lvgl_port_mem_bulk.heap == NULL) {
+        ESP_LOGW(TAG, "No PSRAM pool (%d bytes), large LVGL blocks use the system heap", LVGL_PORT_MEM_BULK_BYTES);
+        heap_caps_free(bulk);
+    }
+    ESP_LOGI(TAG, "LVGL heap: hot %u bytes internal (<= %d byte blocks), bulk %u bytes PSRAM",
+             (unsigned)lvgl_port_mem_hot.size, LVGL_PORT_MEM_HOT_MAX_BYTES, (unsigned)lvgl_port_mem_bulk.size);
+}
+
+static lvgl_port_mem_pool_t *lvgl_port_mem_pool_of(const void *ptr)
+{
+    uintptr_t addr = (uintptr_t)ptr;
+    if (lvgl_port_mem_hot.heap != NULL && addr >= lvgl_port_mem_hot.start && addr < lvgl_port_mem_hot.end) {
+        return &lvgl_port_mem_hot;
+    }
+    if (lvgl_port_mem_bulk.heap != NULL && addr >= lvgl_port_mem_bulk.start && addr < lvgl_port_mem_bulk.end) {
+        return &lvgl_port_mem_bulk;
+    }
+    return NULL;
+}
+
+static size_t lvgl_port_mem_size_of(const void *ptr)
+{
+    lvgl_port_mem_pool_t *pool = lvgl_port_mem_pool_of(ptr);
+    if (pool != NULL) {
+        return multi_heap_get_allocated_size(pool->heap, (void *)ptr);
+    }
+    return heap_caps_get_allocated_size((void *)ptr);
+}
+
+static void *lvgl_port_mem_place(size_t size)
+{
+    void *ptr = NULL;
+    if (size <= LVGL_PORT_MEM_HOT_MAX_BYTES && lvgl_port_mem_hot.heap != NULL) {
+        ptr = multi_heap_malloc(lvgl_port_mem_hot.heap, size);
+        if (ptr != NULL) {
+            return ptr;
+        }
+        lvgl_port_mem_count(&lvgl_port_mem_counters.spills);
+    }
+    if (lvgl_port_mem_bulk.heap != NULL) {
+        ptr = multi_heap_malloc(lvgl_port_mem_bulk.heap, size);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+    lvgl_port_mem_count(&lvgl_port_mem_counters.fallbacks);
+    ptr = heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_DEFAULT);
+    if (ptr == NULL) {
+        lvgl_port_mem_count(&lvgl_port_mem_counters.failures);
+    }
+    return ptr;
+}
+
+static void lvgl_port_mem_release(void *ptr)
+{
+    lvgl_port_mem_pool_t *pool = lvgl_port_mem_pool_of(ptr);
+    if (pool != NULL) {
+        multi_heap_free(pool->heap, ptr);
+    } else {
+        heap_caps_free(ptr);
+    }
+}
+
+static void lvgl_port_mem_pool_stats(const lvgl_port_mem_pool_t *pool, lvgl_port_mem_pool_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (pool->heap == NULL) {
+        return;
+    }
+
+    multi_heap_info_t info;
+    multi_heap_get_info(pool->heap, &info);
+    out->size = pool->size;
+    out->used = (uint32_t)info.total_allocated_bytes;
+    out->peak = (uint32_t)(pool->size - info.minimum_free_bytes);
+    out->largest_free = (uint32_t)info.largest_free_block;
+    out->blocks = (uint32_t)info.allocated_blocks;
+    if (info.total_free_bytes > 0) {
+        out->frag_pct = (uint8_t)(100 - (info.largest_free_block * 100) / info.total_free_bytes);
+    }
+}
+
+/*******************************************************************************
+* Public API functions
+*******************************************************************************/
+
+void *lvgl_port_mem_alloc(size_t size)
+{
+    if (!lvgl_port_mem_ready) {
+        lvgl_port_mem_init();
+    }
+    lvgl_port_mem_count(&lvgl_port_mem_counters.allocs);
+    return lvgl_port_mem_place(size);
+}
+
+void lvgl_port_mem_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    lvgl_port_mem_count(&lvgl_port_mem_counters.frees);
+    lvgl_port_mem_release(ptr);
+}
+
+void *lvgl_port_mem_realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return lvgl_port_mem_alloc(size);
+    }
+    if (size == 0) {
+        lvgl_port_mem_free(ptr);
+        return NULL;
+    }
+    lvgl_port_mem_count(&lvgl_port_mem_counters.reallocs);
+
+    lvgl_port_mem_pool_t *pool = lvgl_port_mem_pool_of(ptr);
+    bool small = (size <= LVGL_PORT_MEM_HOT_MAX_BYTES);
+    /* Resize in place while the block still belongs where it is; bulk blocks never move back to hot */
+    if (pool == &lvgl_port_mem_hot && small) {
+        void *p = multi_heap_realloc(pool->heap, ptr, size);
+        if (p != NULL) {
+            return p;
+        }
+    } else if (pool == &lvgl_port_mem_bulk) {
+        void *p = multi_heap_realloc(pool->heap, ptr, size);
+        if (p != NULL) {
+            return p;
+        }
+    } else if (pool == NULL && !small) {
+        void *p = heap_caps_realloc(ptr, size, MALLOC_CAP_8BIT);
+        if (p != NULL) {
+            return p;
+        }
+    }
+
+    /* Outgrew the hot threshold or out of room: copy into whichever pool fits now */
+    size_t old_size = lvgl_port_mem_size_of(ptr);
+    void *p = lvgl_port_mem_place(size);
+    if (p == NULL) {
+        return NULL;
+    }
+    memcpy(p, ptr, (old_size < size) ? old_size : size);
+    lvgl_port_mem_release(ptr);
+    lvgl_port_mem_count(&lvgl_port_mem_counters.moves);
+    return p;
+}
+
+void lvgl_port_mem_get_stats(lvgl_port_mem_stats_t *out)
+{
+    portENTER_CRITICAL(&lvgl_port_mem_counters_lock);
+    *out = lvgl_port_mem_counters;
+    portEXIT_CRITICAL(&lvgl_port_mem_counters_lock);
+    lvgl_port_mem_pool_stats(&lvgl_port_mem_hot, &out->hot);
+    lvgl_port_mem_pool_stats(&lvgl_port_mem_bulk, &out->bulk);
+}
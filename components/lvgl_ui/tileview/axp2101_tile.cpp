@@ -2,11 +2,12 @@
 #include "axp2101_tile.h"
 static lv_obj_t *list;
 
-#define XPOWERS_CHIP_AXP2101
-#include "XPowersLib.h"
+#include "bsp_axp2101.h"
 
 extern XPowersPMU power;
 
+static uint32_t s_last_seq = 0;
+
 lv_obj_t *label_charging;
 lv_obj_t *label_battery_connect;
 lv_obj_t *label_vbus_in;
@@ -22,20 +23,23 @@ lv_obj_t *label_bldo2_voltage;
 
 
 
+// Runs on the LVGL thread: only reads the PMU service snapshot, never the bus.
 static void axp2101_time_cb(lv_timer_t *timer)
 {
-    lv_label_set_text(label_charging, power.isCharging() ? "YES" : "NO");
-    lv_label_set_text(label_battery_connect, power.isBatteryConnect() ?  "YES" : "NO");
-    lv_label_set_text(label_vbus_in, power.isVbusIn() ?  "YES" : "NO");
-    lv_label_set_text_fmt(label_battery_percent, "%d %%", power.getBatteryPercent());
-    lv_label_set_text_fmt(label_battery_voltage, "%d mV", power.getBattVoltage());
-    lv_label_set_text_fmt(label_vbus_voltage, "%d mV", power.getVbusVoltage());
-    lv_label_set_text_fmt(label_system_voltage, "%d mV", power.getSystemVoltage());
-    lv_label_set_text_fmt(label_dc1_voltage, "%d mV", power.getDC1Voltage());
-    lv_label_set_text_fmt(label_aldo1_voltage, "%d mV", power.getALDO1Voltage());
-    lv_label_set_text_fmt(label_bldo1_voltage, "%d mV", power.getBLDO1Voltage());
-    lv_label_set_text_fmt(label_bldo2_voltage, "%d mV", power.getBLDO2Voltage());
-    
+    bsp_axp2101_snapshot_t snap = {};
+    if (!bsp_axp2101_get_snapshot(&snap) || snap.seq == s_last_seq)
+    {
+        return;
+    }
+    s_last_seq = snap.seq;
+
+    lv_label_set_text(label_charging, snap.charging ? "YES" : "NO");
+    lv_label_set_text(label_battery_connect, snap.battery_present ?  "YES" : "NO");
+    lv_label_set_text(label_vbus_in, snap.vbus_present ?  "YES" : "NO");
+    lv_label_set_text_fmt(label_battery_percent, "%d %%", snap.battery_percent);
+    lv_label_set_text_fmt(label_battery_voltage, "%d mV", snap.vbat_mv);
+    lv_label_set_text_fmt(label_vbus_voltage, "%d mV", snap.vbus_mv);
+    lv_label_set_text_fmt(label_system_voltage, "%d mV", snap.vsys_mv);
 }
 
 void axp2101_tile_init(lv_obj_t *parent) 
@@ -54,31 +58,31 @@ void axp2101_tile_init(lv_obj_t *parent)
 
     list_item = lv_list_add_btn(list, NULL, "isCharging");
     label_charging = lv_label_create(list_item);
-    lv_label_set_text(label_charging, power.isCharging() ? "YES" : "NO");
+    lv_label_set_text(label_charging, "--");
 
     list_item = lv_list_add_btn(list, NULL, "isBatteryConnect");
     label_battery_connect = lv_label_create(list_item);
-    lv_label_set_text(label_battery_connect, power.isBatteryConnect() ?  "YES" : "NO");
+    lv_label_set_text(label_battery_connect, "--");
 
     list_item = lv_list_add_btn(list, NULL, "isVbusIn");
     label_vbus_in = lv_label_create(list_item);
-    lv_label_set_text(label_vbus_in, power.isVbusIn() ?  "YES" : "NO");
+    lv_label_set_text(label_vbus_in, "--");
 
     list_item = lv_list_add_btn(list, NULL, "BatteryPercent");
     label_battery_percent = lv_label_create(list_item);
-    lv_label_set_text_fmt(label_battery_percent, "%d %%", power.getBatteryPercent());
+    lv_label_set_text(label_battery_percent, "--");
 
     list_item = lv_list_add_btn(list, NULL, "BatteryVoltage");
     label_battery_voltage = lv_label_create(list_item);
-    lv_label_set_text_fmt(label_battery_voltage, "%d mV", power.getBattVoltage());
+    lv_label_set_text(label_battery_voltage, "--");
     
     list_item = lv_list_add_btn(list, NULL, "VbusVoltage");
     label_vbus_voltage = lv_label_create(list_item);
-    lv_label_set_text_fmt(label_vbus_voltage, "%d mV", power.getVbusVoltage());
+    lv_label_set_text(label_vbus_voltage, "--");
 
     list_item = lv_list_add_btn(list, NULL, "SystemVoltage");
     label_system_voltage = lv_label_create(list_item);
-    lv_label_set_text_fmt(label_system_voltage, "%d mV", power.getSystemVoltage());
+    lv_label_set_text(label_system_voltage, "--");
 
     list_item = lv_list_add_btn(list, NULL, "DC1Voltage");
     label_dc1_voltage = lv_label_create(list_item);
@@ -97,5 +101,6 @@ void axp2101_tile_init(lv_obj_t *parent)
     lv_label_set_text_fmt(label_bldo2_voltage, "%d mV", power.getBLDO2Voltage());
 
 
-    lv_timer_create(axp2101_time_cb, 3000, NULL);
+    // Rail set-points above are static and read once; live values come from the PMU service
+    lv_timer_create(axp2101_time_cb, 1000, NULL);
 }
\ No newline at end of file
@@ -1,52 +1,143 @@
 
 #include "camera_tile.h"
 #include "esp_camera.h"
+#include "esp_log.h"
+#include "esp_timer.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
+#include "freertos/queue.h"
 
+#include "bsp_camera.h"
 #include "lv_port.h"
 
-lv_obj_t *cam_ing;
+static const char *TAG = "camera_tile";
 
-void camera_task(void *arg)
+#define CAMERA_FPS_LOG_MS 5000
+// One buffer filling in the driver and one on the panel; the rest may wait in the queue
+#define CAMERA_QUEUE_DEPTH ((BSP_CAMERA_FB_COUNT > 2) ? (BSP_CAMERA_FB_COUNT - 2) : 1)
+
+// Frame buffer ownership: camera driver -> capture task -> s_frame_queue -> display task
+// -> panel (until lvgl_port_draw_direct returns) -> esp_camera_fb_return().
+// The queue holds fb_count - 2 frames: with one more on the panel the driver still keeps
+// one to fill, and a full queue drops its oldest frame back to the driver.
+static QueueHandle_t s_frame_queue;
+static lv_obj_t *cam_tile;
+static volatile bool s_preview_visible;
+static uint32_t s_frames_dropped;
+
+static bool camera_tile_is_active(void)
+{
+    lv_obj_t *tileview = lv_obj_get_parent(cam_tile);
+    return tileview != NULL && lv_tileview_get_tile_act(tileview) == cam_tile;
+}
+
+static void camera_capture_task(void *arg)
 {
-    camera_fb_t *pic;
-    lv_img_dsc_t img_dsc;
-    img_dsc.header.always_zero = 0;
-    img_dsc.header.w = 320;
-    img_dsc.header.h = 480;
-    img_dsc.data_size = 320 * 480 * 2;
-    img_dsc.header.cf = LV_IMG_CF_TRUE_COLOR;
-    img_dsc.data = NULL;
     while (1)
     {
-        pic = esp_camera_fb_get();
+        if (!s_preview_visible)
+        {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        camera_fb_t *pic = esp_camera_fb_get();
+        if (pic == NULL)
+        {
+            continue;
+        }
+
+        // Display is behind: return the oldest queued frame and keep the fresh one
+        if (xQueueSend(s_frame_queue, &pic, 0) != pdTRUE)
+        {
+            camera_fb_t *stale = NULL;
+            if (xQueueReceive(s_frame_queue, &stale, 0) == pdTRUE)
+            {
+                esp_camera_fb_return(stale);
+                s_frames_dropped++;
+            }
+            xQueueSend(s_frame_queue, &pic, portMAX_DELAY);
+        }
+    }
+}
 
-        if (NULL != pic)
+static void camera_display_task(void *arg)
+{
+    lv_disp_t *disp = lv_obj_get_disp(cam_tile);
+    uint32_t frames = 0;
+    int64_t draw_us = 0;
+    int64_t window_start_us = esp_timer_get_time();
+
+    while (1)
+    {
+        camera_fb_t *pic = NULL;
+        // Hidden: poll the tileview often enough that swiping in starts the preview promptly
+        TickType_t wait = pdMS_TO_TICKS(s_preview_visible ? CAMERA_FPS_LOG_MS : 100);
+        if (xQueueReceive(s_frame_queue, &pic, wait) == pdTRUE)
         {
-            // printf("pic->len = %d\n", pic->len);
-            img_dsc.data = pic->buf;
+            bool drawn = false;
+            int64_t t0 = esp_timer_get_time();
             if (lvgl_port_lock(0))
             {
-                lv_img_set_src(cam_ing, &img_dsc);
+                // Re-checked under the lock: a swipe away must win over a late frame
+                s_preview_visible = camera_tile_is_active();
+                if (s_preview_visible && pic->format == PIXFORMAT_RGB565)
+                {
+                    lv_area_t area = {0, 0, (lv_coord_t)(pic->width - 1), (lv_coord_t)(pic->height - 1)};
+                    drawn = (lvgl_port_draw_direct(disp, &area, (const lv_color_t *)pic->buf) == ESP_OK);
+                }
                 lvgl_port_unlock();
             }
+            // Every stripe has been sent, the driver may refill this buffer now
+            esp_camera_fb_return(pic);
+
+            if (drawn)
+            {
+                frames++;
+                draw_us += esp_timer_get_time() - t0;
+            }
+        }
+        else if (lvgl_port_lock(0))
+        {
+            s_preview_visible = camera_tile_is_active();
+            lvgl_port_unlock();
         }
-        esp_camera_fb_return(pic);
 
-        vTaskDelay(pdMS_TO_TICKS(1));
+        int64_t now_us = esp_timer_get_time();
+        int64_t window_us = now_us - window_start_us;
+        if (window_us >= (int64_t)CAMERA_FPS_LOG_MS * 1000)
+        {
+            if (frames > 0)
+            {
+                ESP_LOGI(TAG, "preview %lu.%lu fps, draw %lu ms/frame, dropped %lu",
+                         (unsigned long)(frames * 10000000LL / window_us / 10),
+                         (unsigned long)(frames * 10000000LL / window_us % 10),
+                         (unsigned long)(draw_us / frames / 1000),
+                         (unsigned long)s_frames_dropped);
+            }
+            frames = 0;
+            draw_us = 0;
+            s_frames_dropped = 0;
+            window_start_us = now_us;
+        }
     }
 }
 
 void camera_tile_init(lv_obj_t *parent)
 {
-    cam_ing = lv_img_create(parent);
-    lv_obj_set_size(cam_ing, lv_pct(100), lv_pct(100));
+    cam_tile = parent;
     sensor_t *s = esp_camera_sensor_get();
-    if (s != NULL)
+    if (s == NULL)
     {
-        xTaskCreatePinnedToCore(camera_task, "camera_task", 1024 * 2, NULL, 1, NULL, 1);
+        return;
     }
-}
\ No newline at end of file
+
+    s_frame_queue = xQueueCreate(CAMERA_QUEUE_DEPTH, sizeof(camera_fb_t *));
+    if (s_frame_queue == NULL)
+    {
+        return;
+    }
+    xTaskCreatePinnedToCore(camera_capture_task, "camera_capture", 1024 * 2, NULL, 2, NULL, 0);
+    xTaskCreatePinnedToCore(camera_display_task, "camera_display", 1024 * 3, NULL, 1, NULL, 1);
+}
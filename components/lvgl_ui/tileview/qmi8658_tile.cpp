@@ -3,6 +3,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "bsp_qmi8658.h"
+#include <stdlib.h>
 
 static lv_obj_t *list;
 
@@ -18,24 +19,27 @@ lv_obj_t *label_angle_x;
 lv_obj_t *label_angle_y;
 lv_obj_t *label_angle_z;
 
+static void qmi8658_format_mdeg(lv_obj_t *label, int32_t mdeg)
+{
+    int32_t tenths = mdeg / 100;
+    lv_label_set_text_fmt(label, "%s%ld.%ld", (tenths < 0) ? "-" : "", (long)(abs(tenths) / 10), (long)(abs(tenths) % 10));
+}
+
+// Reads the attitude the IMU service already computed; no I2C or trig on the LVGL thread
 static void qmi8658_time_cb(lv_timer_t *timer)
 {
-    char buf[32];
-    qmi8658_data_t data;
-    if (bsp_qmi8658_read_data(&data))
+    bsp_qmi8658_attitude_t att;
+    if (bsp_qmi8658_get_attitude(&att))
     {
-        lv_label_set_text_fmt(label_accel_x, "%d", data.acc_x);
-        lv_label_set_text_fmt(label_accel_y, "%d", data.acc_y);
-        lv_label_set_text_fmt(label_accel_z, "%d", data.acc_z);
-        lv_label_set_text_fmt(label_gyro_x, "%d", data.gyr_x);
-        lv_label_set_text_fmt(label_gyro_y, "%d", data.gyr_y);
-        lv_label_set_text_fmt(label_gyro_z, "%d", data.gyr_z);
-        sprintf(buf, "%.1f", data.AngleX);
-        lv_label_set_text(label_angle_x, buf);
-        sprintf(buf, "%.1f", data.AngleY);
-        lv_label_set_text(label_angle_y, buf);
-        sprintf(buf, "%.1f", data.AngleZ);
-        lv_label_set_text(label_angle_z, buf);
+        lv_label_set_text_fmt(label_accel_x, "%d", att.acc[0]);
+        lv_label_set_text_fmt(label_accel_y, "%d", att.acc[1]);
+        lv_label_set_text_fmt(label_accel_z, "%d", att.acc[2]);
+        lv_label_set_text_fmt(label_gyro_x, "%d", att.gyr[0]);
+        lv_label_set_text_fmt(label_gyro_y, "%d", att.gyr[1]);
+        lv_label_set_text_fmt(label_gyro_z, "%d", att.gyr[2]);
+        qmi8658_format_mdeg(label_angle_x, att.angle_mdeg[0]);
+        qmi8658_format_mdeg(label_angle_y, att.angle_mdeg[1]);
+        qmi8658_format_mdeg(label_angle_z, att.angle_mdeg[2]);
     }
 }
 
@@ -93,5 +97,6 @@ void qmi8658_tile_init(lv_obj_t *parent)
     // label_imu_temp = lv_label_create(list_item);
     // lv_label_set_text(label_imu_temp, "--- C");
 
+    bsp_qmi8658_service_start();
     lv_timer_create(qmi8658_time_cb, 2000, NULL);
 }
\ No newline at end of file
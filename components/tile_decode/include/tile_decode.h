@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    TILE_DECODE_RGBA8888 = 0, // PNG: R,G,B,A bytes
+    TILE_DECODE_RGB565,       // JPEG: one uint16_t per pixel
+} tile_decode_format_t;
+
+// One decoded row, top to bottom. pixels is only valid during the call.
+// Return false to stop decoding (e.g. the rest of the image is clipped away).
+typedef bool (*tile_decode_row_cb_t)(void *arg, int y, int width, const void *pixels, tile_decode_format_t format);
+
+// Decode an in-memory PNG or JPEG a row at a time; no full-image buffer is allocated.
+// PNG: non-interlaced, 8-bit gray/RGB/gray+alpha/RGBA, 16-bit reduced to 8, palette 1/2/4/8-bit with tRNS.
+// JPEG rows are RGB565, byte-swapped when swap_565 is set (LV_COLOR_16_SWAP canvases).
+// Returns ESP_OK also when row_cb stopped the decode early.
+esp_err_t tile_decode(const uint8_t *data, size_t len, bool swap_565, tile_decode_row_cb_t row_cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
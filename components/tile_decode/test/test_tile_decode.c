@@ -0,0 +1,171 @@
+#include <string.h>
+#include "unity.h"
+#include "esp_heap_caps.h"
+
+#include "esp_jpg_decode.h"
+#include "img_converters.h"
+#include "tile_decode.h"
+
+#define TILE_JPG_WIDTH  320
+#define TILE_JPG_HEIGHT 240
+// tjpgd refills its input from the reader in chunks of this size (JD_SZBUF)
+#define TILE_JD_INPUT_BUF 512
+
+extern const uint8_t inside_jpg_start[] asm("_binary_test_inside_jpeg_start");
+extern const uint8_t inside_jpg_end[]   asm("_binary_test_inside_jpeg_end");
+extern const uint8_t png_filters_start[]    asm("_binary_png_filters_png_start");
+extern const uint8_t png_filters_end[]      asm("_binary_png_filters_png_end");
+extern const uint8_t png_split_idat_start[] asm("_binary_png_split_idat_png_start");
+extern const uint8_t png_split_idat_end[]   asm("_binary_png_split_idat_png_end");
+extern const uint8_t png_large_start[]      asm("_binary_png_large_png_start");
+extern const uint8_t png_large_end[]        asm("_binary_png_large_png_end");
+extern const uint8_t png_palette4_start[]   asm("_binary_png_palette4_png_start");
+extern const uint8_t png_palette4_end[]     asm("_binary_png_palette4_png_end");
+extern const uint8_t png_gray2_start[]      asm("_binary_png_gray2_png_start");
+extern const uint8_t png_gray2_end[]        asm("_binary_png_gray2_png_end");
+
+typedef struct {
+    uint16_t *frame;
+    int rows;
+    int stop_after;
+    bool bad_row;
+} tile_rows_t;
+
+static bool tile_row(void *arg, int y, int width, const void *pixels, tile_decode_format_t format)
+{
+    tile_rows_t *out = (tile_rows_t *)arg;
+    if (format != TILE_DECODE_RGB565 || width != TILE_JPG_WIDTH || y != out->rows) {
+        out->bad_row = true;
+        return false;
+    }
+    memcpy(out->frame + (size_t)y * width, pixels, (size_t)width * 2);
+    out->rows++;
+    return out->stop_after == 0 || out->rows < out->stop_after;
+}
+
+TEST_CASE("Tile decode jpeg larger than the decoder input buffer", "[tile_decode]")
+{
+    size_t len = inside_jpg_end - inside_jpg_start;
+    TEST_ASSERT_GREATER_THAN(TILE_JD_INPUT_BUF, len);
+
+    size_t frame_bytes = TILE_JPG_WIDTH * TILE_JPG_HEIGHT * 2;
+    uint8_t *ref = heap_caps_malloc(frame_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    tile_rows_t out = {
+        .frame = heap_caps_calloc(1, frame_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT),
+    };
+    TEST_ASSERT_NOT_NULL(ref);
+    TEST_ASSERT_NOT_NULL(out.frame);
+    TEST_ASSERT_TRUE(jpg2rgb565(inside_jpg_start, len, ref, JPG_SCALE_NONE));
+
+    TEST_ASSERT_EQUAL(ESP_OK, tile_decode(inside_jpg_start, len, false, tile_row, &out));
+    TEST_ASSERT_FALSE(out.bad_row);
+    TEST_ASSERT_EQUAL(TILE_JPG_HEIGHT, out.rows);
+    TEST_ASSERT_EQUAL_MEMORY(ref, out.frame, frame_bytes);
+
+    // A row callback that stops early is not an error
+    out.rows = 0;
+    out.stop_after = 20;
+    TEST_ASSERT_EQUAL(ESP_OK, tile_decode(inside_jpg_start, len, false, tile_row, &out));
+    TEST_ASSERT_FALSE(out.bad_row);
+    TEST_ASSERT_EQUAL(20, out.rows);
+
+    heap_caps_free(out.frame);
+    heap_caps_free(ref);
+}
+
+// The PNG fixtures are generated from closed-form pixels so the expected rows need no
+// reference decoder. Row y of every RGBA fixture uses filter type y % 5.
+typedef enum {
+    TILE_PNG_RGBA,     // 8-bit RGBA
+    TILE_PNG_PALETTE4, // 4-bit palette, 16 entries, tRNS on the first 6
+    TILE_PNG_GRAY2,    // 2-bit gray
+} tile_png_kind_t;
+
+typedef struct {
+    tile_png_kind_t kind;
+    int width;
+    int rows;
+    int bad_pixels;
+    bool bad_row;
+} tile_png_rows_t;
+
+static void tile_png_pixel(tile_png_kind_t kind, int x, int y, uint8_t px[4])
+{
+    switch (kind) {
+    case TILE_PNG_PALETTE4: {
+        int i = (x + 2 * y) % 16;
+        px[0] = i * 17;
+        px[1] = 255 - i * 17;
+        px[2] = i * 9;
+        px[3] = i < 6 ? i * 40 : 255;
+        break;
+    }
+    case TILE_PNG_GRAY2:
+        px[0] = px[1] = px[2] = ((x + y) & 3) * 85;
+        px[3] = 255;
+        break;
+    case TILE_PNG_RGBA:
+    default:
+        px[0] = x * 5 + y * 3;
+        px[1] = x ^ (y * 7);
+        px[2] = x * y;
+        px[3] = 255 - x * 2;
+        break;
+    }
+}
+
+static bool tile_png_row(void *arg, int y, int width, const void *pixels, tile_decode_format_t format)
+{
+    tile_png_rows_t *out = (tile_png_rows_t *)arg;
+    if (format != TILE_DECODE_RGBA8888 || width != out->width || y != out->rows) {
+        out->bad_row = true;
+        return false;
+    }
+    const uint8_t *row = (const uint8_t *)pixels;
+    for (int x = 0; x < width; x++) {
+        uint8_t px[4];
+        tile_png_pixel(out->kind, x, y, px);
+        if (memcmp(row + x * 4, px, 4) != 0) {
+            out->bad_pixels++;
+        }
+    }
+    out->rows++;
+    return true;
+}
+
+static void tile_png_check(const uint8_t *start, const uint8_t *end, tile_png_kind_t kind, int width, int height)
+{
+    tile_png_rows_t out = {
+        .kind = kind,
+        .width = width,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, tile_decode(start, end - start, false, tile_png_row, &out));
+    TEST_ASSERT_FALSE(out.bad_row);
+    TEST_ASSERT_EQUAL(height, out.rows);
+    TEST_ASSERT_EQUAL(0, out.bad_pixels);
+}
+
+TEST_CASE("Tile decode png with all five filter types", "[tile_decode]")
+{
+    tile_png_check(png_filters_start, png_filters_end, TILE_PNG_RGBA, 48, 20);
+}
+
+TEST_CASE("Tile decode png with IDAT split into small chunks", "[tile_decode]")
+{
+    // Same image as png_filters.png with the zlib stream cut into 7-byte IDATs
+    tile_png_check(png_split_idat_start, png_split_idat_end, TILE_PNG_RGBA, 48, 20);
+}
+
+TEST_CASE("Tile decode png that inflates past the 32 KB dictionary", "[tile_decode]")
+{
+    // 64 rows of 1025 bytes: the inflate output wraps the tinfl window twice
+    TEST_ASSERT_GREATER_THAN(32768, 64 * (256 * 4 + 1));
+    tile_png_check(png_large_start, png_large_end, TILE_PNG_RGBA, 256, 64);
+}
+
+TEST_CASE("Tile decode png with sub-byte palette, tRNS and gray", "[tile_decode]")
+{
+    // Odd widths leave padding bits at the end of each packed row
+    tile_png_check(png_palette4_start, png_palette4_end, TILE_PNG_PALETTE4, 13, 6);
+    tile_png_check(png_gray2_start, png_gray2_end, TILE_PNG_GRAY2, 11, 4);
+}
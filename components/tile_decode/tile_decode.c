@@ -0,0 +1,505 @@
+#include "tile_decode.h"
+
+#include <string.h>
+
+#include "esp32s3/rom/miniz.h"
+#include "esp_heap_caps.h"
+#include "esp_jpg_decode.h"
+#include "esp_log.h"
+
+static const char *TAG = "tile_decode";
+
+#define PNG_MAX_WIDTH 2048
+#define PNG_MAX_HEIGHT 2048
+
+#define PNG_COLOR_GRAY 0
+#define PNG_COLOR_RGB 2
+#define PNG_COLOR_PALETTE 3
+#define PNG_COLOR_GRAY_ALPHA 4
+#define PNG_COLOR_RGBA 6
+
+static const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+typedef struct
+{
+    tile_decode_row_cb_t row_cb;
+    void *arg;
+    uint32_t width;
+    uint32_t height;
+    uint8_t bit_depth;
+    uint8_t color_type;
+    size_t stride; // scanline bytes without the filter byte
+    size_t bpp;    // filter distance in bytes
+    uint8_t *cur;  // filter byte + scanline
+    uint8_t *prev;
+    size_t line_fill;
+    uint32_t y;
+    uint8_t *rgba;
+    bool stopped;
+    uint8_t palette[256][4];
+} png_ctx_t;
+
+static void *tile_alloc(size_t size, uint32_t caps)
+{
+    void *p = heap_caps_malloc(size, caps);
+    if (p == NULL)
+    {
+        p = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+static uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    int p = (int)a + (int)b - (int)c;
+    int pa = (p > a) ? p - a : a - p;
+    int pb = (p > b) ? p - b : b - p;
+    int pc = (p > c) ? p - c : c - p;
+    if (pa <= pb && pa <= pc)
+    {
+        return a;
+    }
+    return (pb <= pc) ? b : c;
+}
+
+static bool png_unfilter(png_ctx_t *ctx)
+{
+    uint8_t *line = ctx->cur + 1;
+    const uint8_t *up = ctx->prev + 1;
+    size_t n = ctx->stride;
+    size_t bpp = ctx->bpp;
+
+    switch (ctx->cur[0])
+    {
+    case 0:
+        break;
+    case 1:
+        for (size_t i = bpp; i < n; ++i)
+        {
+            line[i] += line[i - bpp];
+        }
+        break;
+    case 2:
+        for (size_t i = 0; i < n; ++i)
+        {
+            line[i] += up[i];
+        }
+        break;
+    case 3:
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint8_t left = (i >= bpp) ? line[i - bpp] : 0;
+            line[i] += (uint8_t)(((unsigned)left + up[i]) >> 1);
+        }
+        break;
+    case 4:
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint8_t left = (i >= bpp) ? line[i - bpp] : 0;
+            uint8_t up_left = (i >= bpp) ? up[i - bpp] : 0;
+            line[i] += paeth(left, up[i], up_left);
+        }
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+static void png_line_to_rgba(png_ctx_t *ctx)
+{
+    const uint8_t *line = ctx->cur + 1;
+    uint8_t *out = ctx->rgba;
+    uint32_t w = ctx->width;
+
+    if (ctx->bit_depth < 8)
+    {
+        unsigned depth = ctx->bit_depth;
+        unsigned mask = (1u << depth) - 1u;
+        unsigned gray_scale = 255u / mask;
+        for (uint32_t x = 0; x < w; ++x, out += 4)
+        {
+            size_t bit = (size_t)x * depth;
+            unsigned v = (line[bit >> 3] >> (8u - depth - (bit & 7u))) & mask;
+            if (ctx->color_type == PNG_COLOR_PALETTE)
+            {
+                memcpy(out, ctx->palette[v], 4);
+            }
+            else
+            {
+                out[0] = out[1] = out[2] = (uint8_t)(v * gray_scale);
+                out[3] = 255;
+            }
+        }
+        return;
+    }
+
+    // 16-bit samples keep their high byte
+    size_t step = (ctx->bit_depth == 16) ? 2 : 1;
+    for (uint32_t x = 0; x < w; ++x, out += 4)
+    {
+        switch (ctx->color_type)
+        {
+        case PNG_COLOR_PALETTE:
+            memcpy(out, ctx->palette[line[x]], 4);
+            break;
+        case PNG_COLOR_GRAY:
+            out[0] = out[1] = out[2] = line[x * step];
+            out[3] = 255;
+            break;
+        case PNG_COLOR_GRAY_ALPHA:
+            out[0] = out[1] = out[2] = line[x * 2 * step];
+            out[3] = line[(x * 2 + 1) * step];
+            break;
+        case PNG_COLOR_RGB:
+            out[0] = line[x * 3 * step];
+            out[1] = line[(x * 3 + 1) * step];
+            out[2] = line[(x * 3 + 2) * step];
+            out[3] = 255;
+            break;
+        case PNG_COLOR_RGBA:
+        default:
+            out[0] = line[x * 4 * step];
+            out[1] = line[(x * 4 + 1) * step];
+            out[2] = line[(x * 4 + 2) * step];
+            out[3] = line[(x * 4 + 3) * step];
+            break;
+        }
+    }
+}
+
+// Feed inflated bytes; whole scanlines are unfiltered, converted and handed out as they complete.
+static esp_err_t png_push(png_ctx_t *ctx, const uint8_t *bytes, size_t len)
+{
+    size_t line_len = ctx->stride + 1;
+    while (len > 0 && !ctx->stopped && ctx->y < ctx->height)
+    {
+        size_t take = line_len - ctx->line_fill;
+        if (take > len)
+        {
+            take = len;
+        }
+        memcpy(ctx->cur + ctx->line_fill, bytes, take);
+        ctx->line_fill += take;
+        bytes += take;
+        len -= take;
+        if (ctx->line_fill < line_len)
+        {
+            break;
+        }
+
+        if (!png_unfilter(ctx))
+        {
+            ESP_LOGW(TAG, "png: bad filter %u on row %u", (unsigned)ctx->cur[0], (unsigned)ctx->y);
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        png_line_to_rgba(ctx);
+        if (!ctx->row_cb(ctx->arg, (int)ctx->y, (int)ctx->width, ctx->rgba, TILE_DECODE_RGBA8888))
+        {
+            ctx->stopped = true;
+        }
+
+        uint8_t *tmp = ctx->prev;
+        ctx->prev = ctx->cur;
+        ctx->cur = tmp;
+        ctx->line_fill = 0;
+        ctx->y++;
+    }
+    return ESP_OK;
+}
+
+static bool png_parse_ihdr(png_ctx_t *ctx, const uint8_t *d, uint32_t len)
+{
+    if (len != 13)
+    {
+        return false;
+    }
+    ctx->width = be32(d);
+    ctx->height = be32(d + 4);
+    ctx->bit_depth = d[8];
+    ctx->color_type = d[9];
+    if (ctx->width == 0 || ctx->height == 0 || ctx->width > PNG_MAX_WIDTH || ctx->height > PNG_MAX_HEIGHT)
+    {
+        return false;
+    }
+    if (d[10] != 0 || d[11] != 0 || d[12] != 0)
+    {
+        ESP_LOGW(TAG, "png: interlaced or unknown compression/filter method not supported");
+        return false;
+    }
+
+    unsigned channels = 0;
+    switch (ctx->color_type)
+    {
+    case PNG_COLOR_GRAY:
+        channels = 1;
+        break;
+    case PNG_COLOR_PALETTE:
+        channels = 1;
+        break;
+    case PNG_COLOR_GRAY_ALPHA:
+        channels = 2;
+        break;
+    case PNG_COLOR_RGB:
+        channels = 3;
+        break;
+    case PNG_COLOR_RGBA:
+        channels = 4;
+        break;
+    default:
+        return false;
+    }
+
+    bool sub_byte = (ctx->bit_depth == 1 || ctx->bit_depth == 2 || ctx->bit_depth == 4);
+    if (sub_byte && ctx->color_type != PNG_COLOR_GRAY && ctx->color_type != PNG_COLOR_PALETTE)
+    {
+        return false;
+    }
+    if (!sub_byte && ctx->bit_depth != 8 && !(ctx->bit_depth == 16 && ctx->color_type != PNG_COLOR_PALETTE))
+    {
+        return false;
+    }
+
+    size_t bits = (size_t)ctx->width * channels * ctx->bit_depth;
+    ctx->stride = (bits + 7) / 8;
+    ctx->bpp = sub_byte ? 1 : (channels * ctx->bit_depth / 8);
+    return true;
+}
+
+static esp_err_t png_run(png_ctx_t *ctx, tinfl_decompressor *inflator, uint8_t *dict, uint8_t **lines,
+                         const uint8_t *data, size_t len)
+{
+    esp_err_t err = ESP_OK;
+    size_t dict_ofs = 0;
+    bool have_header = false;
+    bool inflate_done = false;
+    size_t pos = sizeof(PNG_SIGNATURE);
+    while (pos + 12 <= len && !ctx->stopped && !inflate_done && (!have_header || ctx->y < ctx->height))
+    {
+        uint32_t chunk_len = be32(data + pos);
+        const uint8_t *type = data + pos + 4;
+        const uint8_t *body = data + pos + 8;
+        if (chunk_len > len - pos - 12)
+        {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        pos += 12 + chunk_len;
+
+        if (memcmp(type, "IHDR", 4) == 0)
+        {
+            if (have_header || !png_parse_ihdr(ctx, body, chunk_len))
+            {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            *lines = (uint8_t *)tile_alloc((ctx->stride + 1) * 2 + (size_t)ctx->width * 4, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (*lines == NULL)
+            {
+                return ESP_ERR_NO_MEM;
+            }
+            ctx->cur = *lines;
+            ctx->prev = *lines + ctx->stride + 1;
+            ctx->rgba = *lines + (ctx->stride + 1) * 2;
+            memset(ctx->prev, 0, ctx->stride + 1);
+            have_header = true;
+        }
+        else if (!have_header)
+        {
+            return ESP_ERR_INVALID_STATE;
+        }
+        else if (memcmp(type, "PLTE", 4) == 0)
+        {
+            for (uint32_t i = 0; i < chunk_len / 3 && i < 256; ++i)
+            {
+                memcpy(ctx->palette[i], body + i * 3, 3);
+            }
+        }
+        else if (memcmp(type, "tRNS", 4) == 0)
+        {
+            // Palette alpha only; gray/RGB colour keys are rare in map tiles and render opaque
+            if (ctx->color_type == PNG_COLOR_PALETTE)
+            {
+                for (uint32_t i = 0; i < chunk_len && i < 256; ++i)
+                {
+                    ctx->palette[i][3] = body[i];
+                }
+            }
+        }
+        else if (memcmp(type, "IDAT", 4) == 0)
+        {
+            // The dictionary doubles as the output window: tinfl wraps within it, rows are copied out as they land.
+            const uint8_t *in_next = body;
+            size_t in_left = chunk_len;
+            while (!ctx->stopped && ctx->y < ctx->height)
+            {
+                size_t in_bytes = in_left;
+                size_t out_bytes = TINFL_LZ_DICT_SIZE - dict_ofs;
+                tinfl_status status = tinfl_decompress(inflator, in_next, &in_bytes, dict, dict + dict_ofs, &out_bytes,
+                                                       TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+                in_next += in_bytes;
+                in_left -= in_bytes;
+                if (out_bytes > 0)
+                {
+                    err = png_push(ctx, dict + dict_ofs, out_bytes);
+                    dict_ofs = (dict_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+                    if (err != ESP_OK)
+                    {
+                        return err;
+                    }
+                }
+                if (status < TINFL_STATUS_DONE)
+                {
+                    ESP_LOGW(TAG, "png: inflate failed (%d) at row %u", (int)status, (unsigned)ctx->y);
+                    return ESP_ERR_INVALID_RESPONSE;
+                }
+                if (status == TINFL_STATUS_DONE)
+                {
+                    inflate_done = true;
+                    break;
+                }
+                if (status == TINFL_STATUS_NEEDS_MORE_INPUT)
+                {
+                    break;
+                }
+            }
+        }
+        else if (memcmp(type, "IEND", 4) == 0)
+        {
+            break;
+        }
+    }
+
+    if (!ctx->stopped && (!have_header || ctx->y < ctx->height))
+    {
+        ESP_LOGW(TAG, "png: truncated after %u rows", have_header ? (unsigned)ctx->y : 0u);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t png_decode(const uint8_t *data, size_t len, tile_decode_row_cb_t row_cb, void *arg)
+{
+    png_ctx_t *ctx = (png_ctx_t *)tile_alloc(sizeof(png_ctx_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    tinfl_decompressor *inflator = (tinfl_decompressor *)tile_alloc(sizeof(tinfl_decompressor), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint8_t *dict = (uint8_t *)tile_alloc(TINFL_LZ_DICT_SIZE, MALLOC_CAP_SPIRAM);
+    uint8_t *lines = NULL;
+    esp_err_t err = ESP_ERR_NO_MEM;
+    if (ctx != NULL && inflator != NULL && dict != NULL)
+    {
+        memset(ctx, 0, sizeof(*ctx));
+        ctx->row_cb = row_cb;
+        ctx->arg = arg;
+        for (int i = 0; i < 256; ++i)
+        {
+            ctx->palette[i][3] = 255;
+        }
+        tinfl_init(inflator);
+        err = png_run(ctx, inflator, dict, &lines, data, len);
+    }
+
+    heap_caps_free(lines);
+    heap_caps_free(dict);
+    heap_caps_free(inflator);
+    heap_caps_free(ctx);
+    return err;
+}
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t len;
+    tile_decode_row_cb_t row_cb;
+    void *arg;
+    bool stopped;
+} jpg_ctx_t;
+
+static size_t jpg_read(void *arg, size_t index, uint8_t *buf, size_t len)
+{
+    jpg_ctx_t *ctx = (jpg_ctx_t *)arg;
+    if (index >= ctx->len)
+    {
+        return 0;
+    }
+    if (len > ctx->len - index)
+    {
+        len = ctx->len - index;
+    }
+    if (buf)
+    {
+        memcpy(buf, ctx->data + index, len);
+    }
+    return len;
+}
+
+static bool jpg_stripe(void *arg, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels)
+{
+    jpg_ctx_t *ctx = (jpg_ctx_t *)arg;
+    for (uint16_t row = 0; row < h; ++row)
+    {
+        if (!ctx->row_cb(ctx->arg, y + row, w, pixels + (size_t)row * w, TILE_DECODE_RGB565))
+        {
+            ctx->stopped = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t jpg_decode(const uint8_t *data, size_t len, bool swap_565, tile_decode_row_cb_t row_cb, void *arg)
+{
+    jpg_ctx_t ctx = {
+        .data = data,
+        .len = len,
+        .row_cb = row_cb,
+        .arg = arg,
+        .stopped = false,
+    };
+
+    void *work = tile_alloc(ESP_JPG_DECODE_WORK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (work == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_jpg_dec_handle_t dec = NULL;
+    esp_err_t err = esp_jpg_dec_open(work, ESP_JPG_DECODE_WORK_SIZE, len, jpg_read, &ctx, &dec);
+    if (err == ESP_OK)
+    {
+        esp_jpg_dec_info_t info = {};
+        esp_jpg_dec_get_info(dec, JPG_SCALE_NONE, &info);
+        size_t stripe_pixels = (size_t)info.width * info.stripe_height;
+        uint16_t *stripe = (uint16_t *)tile_alloc(stripe_pixels * 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (stripe != NULL)
+        {
+            err = esp_jpg_dec_decode_stripes(dec, JPG_SCALE_NONE, stripe, stripe_pixels, swap_565, jpg_stripe, &ctx);
+            heap_caps_free(stripe);
+        }
+        else
+        {
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    heap_caps_free(work);
+    return ctx.stopped ? ESP_OK : err;
+}
+
+esp_err_t tile_decode(const uint8_t *data, size_t len, bool swap_565, tile_decode_row_cb_t row_cb, void *arg)
+{
+    if (data == NULL || row_cb == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len >= sizeof(PNG_SIGNATURE) && memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0)
+    {
+        return png_decode(data, len, row_cb, arg);
+    }
+    if (len >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+    {
+        return jpg_decode(data, len, swap_565, row_cb, arg);
+    }
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -1,6 +1,7 @@
 #include "app_priv.h"
 
 #include <ctype.h>
+#include <stdlib.h>
 
 #include "driver/usb_serial_jtag.h"
 #include "esp_system.h"
@@ -10,6 +11,15 @@ static const char *APP_CFG_KEY_WIFI_SSID = "wifi_ssid";
 static const char *APP_CFG_KEY_WIFI_PASS = "wifi_pass";
 static const char *APP_CFG_KEY_WX_API = "wx_api_key";
 static const char *APP_CFG_KEY_WX_QUERY = "wx_query";
+static const char *APP_CFG_KEY_PWR_PROFILE = "pwr_profile";
+static const char *APP_CFG_KEY_WX_LOCATIONS = "wx_locs";
+static const char *APP_CFG_KEY_LOC_ROTATE = "loc_rotate";
+static const char *APP_CFG_KEY_FC_CACHE = "fc_cache";
+static const char *APP_CFG_KEY_FC_QUERY = "fc_query";
+static const char *APP_CFG_KEY_RADAR_URL = "radar_url";
+static const char *APP_CFG_KEY_MQTT_URI = "mqtt_uri";
+static const char *APP_CFG_KEY_MQTT_TOPIC = "mqtt_topic";
+static const char *APP_CFG_KEY_MQTT_TUNING = "mqtt_tuning";
 
 static const char *skip_ws(const char *text)
 {
@@ -118,6 +128,71 @@ static bool parse_wifi_set_args(const char *args, char *ssid_out, size_t ssid_ou
     return (cursor != NULL && *cursor == '\0');
 }
 
+static esp_err_t app_config_save_str(const char *key, const char *value)
+{
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = nvs_set_str(nvs, key, value);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return err;
+}
+
+// Splits a ';'-separated list into the extra-location slots, skipping blanks and duplicates of slot 0
+static void app_config_parse_locations(const char *list)
+{
+    g_wifi_config.weather_location_count = 0;
+    const char *cursor = list;
+    while (cursor != NULL && *cursor != '\0' && g_wifi_config.weather_location_count < APP_LOCATION_MAX - 1)
+    {
+        cursor = skip_ws(cursor);
+        const char *end = strchr(cursor, ';');
+        size_t len = (end != NULL) ? (size_t)(end - cursor) : strlen(cursor);
+        while (len > 0 && isspace((unsigned char)cursor[len - 1]))
+        {
+            --len;
+        }
+        if (len > 0 && len <= APP_WEATHER_QUERY_MAX_LEN)
+        {
+            char *slot = g_wifi_config.weather_locations[g_wifi_config.weather_location_count];
+            memcpy(slot, cursor, len);
+            slot[len] = '\0';
+            g_wifi_config.weather_location_count++;
+        }
+        cursor = (end != NULL) ? end + 1 : NULL;
+    }
+}
+
+static esp_err_t app_config_save_locations(void)
+{
+    char list[APP_LOCATION_LIST_MAX_LEN + 1] = {0};
+    size_t used = 0;
+    for (uint8_t i = 0; i < g_wifi_config.weather_location_count; ++i)
+    {
+        int n = snprintf(list + used, sizeof(list) - used, "%s%s", (i == 0) ? "" : ";",
+                         g_wifi_config.weather_locations[i]);
+        if (n < 0 || (size_t)n >= sizeof(list) - used)
+        {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        used += (size_t)n;
+    }
+    esp_err_t err = app_config_save_str(APP_CFG_KEY_WX_LOCATIONS, list);
+    if (err == ESP_OK)
+    {
+        g_wifi_config.weather_locations_override_active = true;
+    }
+    return err;
+}
+
 static void app_config_apply_defaults(void)
 {
     snprintf(g_wifi_config.wifi_ssid, sizeof(g_wifi_config.wifi_ssid), "%s", WIFI_SSID_LOCAL);
@@ -127,6 +202,29 @@ static void app_config_apply_defaults(void)
     snprintf(g_wifi_config.weather_query, sizeof(g_wifi_config.weather_query), "%s", WEATHER_QUERY_LOCAL);
     g_wifi_config.weather_api_override_active = false;
     g_wifi_config.weather_query_override_active = false;
+    app_config_parse_locations(WEATHER_LOCATIONS_LOCAL);
+    g_wifi_config.weather_locations_override_active = false;
+    g_wifi_config.location_rotate_s = WEATHER_LOCATION_ROTATE_S_LOCAL;
+    snprintf(g_wifi_config.radar_url, sizeof(g_wifi_config.radar_url), "%s", RADAR_TILE_URL_LOCAL);
+    g_wifi_config.radar_url_override_active = false;
+    snprintf(g_wifi_config.mqtt_uri, sizeof(g_wifi_config.mqtt_uri), "%s", MQTT_BROKER_URI_LOCAL);
+    snprintf(g_wifi_config.mqtt_topic, sizeof(g_wifi_config.mqtt_topic), "%s", MQTT_TOPIC_PREFIX_LOCAL);
+    g_wifi_config.mqtt_override_active = false;
+    g_wifi_config.mqtt_tuning.window_s = APP_MQTT_WINDOW_S_DEFAULT;
+    g_wifi_config.mqtt_tuning.outbox_kb = APP_MQTT_OUTBOX_KB_DEFAULT;
+    g_wifi_config.mqtt_tuning.rate_per_s = APP_MQTT_RATE_DEFAULT;
+    g_wifi_config.mqtt_tuning.inflight = APP_MQTT_INFLIGHT_DEFAULT;
+    g_wifi_config.mqtt_tuning.qos = APP_MQTT_QOS_DEFAULT;
+    g_wifi_config.power_profile = APP_POWER_PROFILE_DEFAULT;
+}
+
+static bool app_config_mqtt_tuning_valid(const app_mqtt_tuning_t *t)
+{
+    return t->window_s >= 5 && t->window_s <= 600 &&
+           t->outbox_kb >= 4 && t->outbox_kb <= 1024 &&
+           t->rate_per_s >= 1 && t->rate_per_s <= 50 &&
+           t->inflight >= 1 && t->inflight <= 16 &&
+           t->qos <= 2;
 }
 
 void app_config_load_from_nvs(void)
@@ -145,15 +243,34 @@ void app_config_load_from_nvs(void)
     char pass[APP_WIFI_PASS_MAX_LEN + 1] = {0};
     char wx_api[APP_WEATHER_API_KEY_MAX_LEN + 1] = {0};
     char wx_query[APP_WEATHER_QUERY_MAX_LEN + 1] = {0};
+    char radar_url[APP_RADAR_URL_MAX_LEN + 1] = {0};
+    char wx_locations[APP_LOCATION_LIST_MAX_LEN + 1] = {0};
+    char mqtt_uri[APP_MQTT_URI_MAX_LEN + 1] = {0};
+    char mqtt_topic[APP_MQTT_TOPIC_MAX_LEN + 1] = {0};
+    app_mqtt_tuning_t mqtt_tuning = {};
     size_t ssid_len = sizeof(ssid);
     size_t pass_len = sizeof(pass);
     size_t wx_api_len = sizeof(wx_api);
     size_t wx_query_len = sizeof(wx_query);
+    size_t radar_url_len = sizeof(radar_url);
+    size_t wx_locations_len = sizeof(wx_locations);
+    size_t mqtt_uri_len = sizeof(mqtt_uri);
+    size_t mqtt_topic_len = sizeof(mqtt_topic);
+    size_t mqtt_tuning_len = sizeof(mqtt_tuning);
 
     esp_err_t ssid_err = nvs_get_str(nvs, APP_CFG_KEY_WIFI_SSID, ssid, &ssid_len);
     esp_err_t pass_err = nvs_get_str(nvs, APP_CFG_KEY_WIFI_PASS, pass, &pass_len);
     esp_err_t api_err = nvs_get_str(nvs, APP_CFG_KEY_WX_API, wx_api, &wx_api_len);
     esp_err_t query_err = nvs_get_str(nvs, APP_CFG_KEY_WX_QUERY, wx_query, &wx_query_len);
+    esp_err_t radar_err = nvs_get_str(nvs, APP_CFG_KEY_RADAR_URL, radar_url, &radar_url_len);
+    esp_err_t locations_err = nvs_get_str(nvs, APP_CFG_KEY_WX_LOCATIONS, wx_locations, &wx_locations_len);
+    uint16_t loc_rotate = 0;
+    esp_err_t loc_rotate_err = nvs_get_u16(nvs, APP_CFG_KEY_LOC_ROTATE, &loc_rotate);
+    esp_err_t mqtt_uri_err = nvs_get_str(nvs, APP_CFG_KEY_MQTT_URI, mqtt_uri, &mqtt_uri_len);
+    esp_err_t mqtt_topic_err = nvs_get_str(nvs, APP_CFG_KEY_MQTT_TOPIC, mqtt_topic, &mqtt_topic_len);
+    esp_err_t mqtt_tuning_err = nvs_get_blob(nvs, APP_CFG_KEY_MQTT_TUNING, &mqtt_tuning, &mqtt_tuning_len);
+    uint8_t pwr_profile = 0;
+    esp_err_t pwr_err = nvs_get_u8(nvs, APP_CFG_KEY_PWR_PROFILE, &pwr_profile);
     nvs_close(nvs);
 
     if (ssid_err == ESP_OK && pass_err == ESP_OK && ssid[0] != '\0')
@@ -190,6 +307,54 @@ void app_config_load_from_nvs(void)
     {
         ESP_LOGI(APP_TAG, "config: no saved weather query override, using default");
     }
+
+    // An empty saved list is a deliberate "primary location only"
+    if (locations_err == ESP_OK)
+    {
+        app_config_parse_locations(wx_locations);
+        g_wifi_config.weather_locations_override_active = true;
+        ESP_LOGI(APP_TAG, "config: loaded %u saved extra location(s)", (unsigned)g_wifi_config.weather_location_count);
+    }
+
+    if (loc_rotate_err == ESP_OK)
+    {
+        g_wifi_config.location_rotate_s = loc_rotate;
+    }
+
+    if (radar_err == ESP_OK && radar_url[0] != '\0')
+    {
+        snprintf(g_wifi_config.radar_url, sizeof(g_wifi_config.radar_url), "%s", radar_url);
+        g_wifi_config.radar_url_override_active = true;
+        ESP_LOGI(APP_TAG, "config: loaded saved radar tile URL '%s'", g_wifi_config.radar_url);
+    }
+
+    if (mqtt_uri_err == ESP_OK && mqtt_uri[0] != '\0')
+    {
+        snprintf(g_wifi_config.mqtt_uri, sizeof(g_wifi_config.mqtt_uri), "%s", mqtt_uri);
+        g_wifi_config.mqtt_override_active = true;
+        ESP_LOGI(APP_TAG, "config: loaded saved MQTT broker '%s'", g_wifi_config.mqtt_uri);
+    }
+
+    if (mqtt_topic_err == ESP_OK && mqtt_topic[0] != '\0')
+    {
+        snprintf(g_wifi_config.mqtt_topic, sizeof(g_wifi_config.mqtt_topic), "%s", mqtt_topic);
+        g_wifi_config.mqtt_override_active = true;
+    }
+
+    // Blob layout is app_mqtt_tuning_t; a size mismatch means an older build wrote it
+    if (mqtt_tuning_err == ESP_OK && mqtt_tuning_len == sizeof(mqtt_tuning) &&
+        app_config_mqtt_tuning_valid(&mqtt_tuning))
+    {
+        g_wifi_config.mqtt_tuning = mqtt_tuning;
+        g_wifi_config.mqtt_override_active = true;
+    }
+
+    if (pwr_err == ESP_OK && pwr_profile < APP_POWER_PROFILE_COUNT)
+    {
+        g_wifi_config.power_profile = (app_power_profile_t)pwr_profile;
+        ESP_LOGI(APP_TAG, "config: loaded saved power profile '%s'",
+                 app_power_profile_name(g_wifi_config.power_profile));
+    }
 }
 
 const char *app_config_wifi_ssid(void)
@@ -412,216 +577,1013 @@ esp_err_t app_config_clear_weather_override(void)
     return ESP_OK;
 }
 
-static void app_console_print_help(void)
+uint8_t app_config_location_count(void)
 {
-    ESP_LOGI(APP_TAG, "commands:");
-    ESP_LOGI(APP_TAG, "  wifi show                  - show Wi-Fi config");
-    ESP_LOGI(APP_TAG, "  wifi set <ssid> <pass>     - set Wi-Fi credentials");
-    ESP_LOGI(APP_TAG, "  wifi clear                 - clear Wi-Fi override");
-    ESP_LOGI(APP_TAG, "  api show                   - show API config");
-    ESP_LOGI(APP_TAG, "  api set-key <key>          - set OpenWeather API key");
-    ESP_LOGI(APP_TAG, "  api set-query <query>      - set location query");
-    ESP_LOGI(APP_TAG, "  api clear                  - clear API overrides");
-    ESP_LOGI(APP_TAG, "  continue                   - exit config, boot normally");
-    ESP_LOGI(APP_TAG, "  wifi reboot / api reboot   - save and reboot");
+    return (uint8_t)(1 + g_wifi_config.weather_location_count);
 }
 
-static void app_console_handle_wifi(const char *args)
+const char *app_config_location_query(uint8_t index)
 {
-    char subcmd[16] = {0};
-    const char *cursor = args;
-    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    if (index == 0)
     {
-        app_console_print_help();
-        return;
+        return g_wifi_config.weather_query;
     }
-
-    if (strcmp(subcmd, "show") == 0)
+    if (index > g_wifi_config.weather_location_count)
     {
-        const size_t pass_len = strlen(app_config_wifi_pass());
-        ESP_LOGI(APP_TAG, "wifi source : %s",
-                 app_config_wifi_override_active() ? "NVS override" : "wifi_local.h defaults");
-        ESP_LOGI(APP_TAG, "wifi ssid   : %s", app_config_wifi_ssid());
-        ESP_LOGI(APP_TAG, "wifi pass   : %s (%u chars)",
-                 pass_len == 0 ? "<empty>" : "********", (unsigned)pass_len);
-        return;
+        return NULL;
     }
+    return g_wifi_config.weather_locations[index - 1];
+}
 
-    if (strcmp(subcmd, "set") == 0)
+esp_err_t app_config_add_location(const char *query)
+{
+    if (query == NULL || query[0] == '\0' || strchr(query, ';') != NULL)
     {
-        char ssid[APP_WIFI_SSID_MAX_LEN + 1] = {0};
-        char pass[APP_WIFI_PASS_MAX_LEN + 1] = {0};
-        if (!parse_wifi_set_args(cursor, ssid, sizeof(ssid), pass, sizeof(pass)))
-        {
-            ESP_LOGW(APP_TAG, "usage: wifi set <ssid> <password>");
-            ESP_LOGW(APP_TAG, "or:    wifi set \"My SSID\" \"My Password\"");
-            return;
-        }
-
-        esp_err_t err = app_config_set_wifi_override(ssid, pass);
-        if (err != ESP_OK)
-        {
-            ESP_LOGE(APP_TAG, "config: save failed: %s", esp_err_to_name(err));
-            return;
-        }
-
-        ESP_LOGI(APP_TAG, "saved: SSID='%s' pass=******** (%u chars)", ssid, (unsigned)strlen(pass));
-        ESP_LOGI(APP_TAG, "type 'wifi reboot' to apply, or 'wifi show' to verify");
-        return;
+        return ESP_ERR_INVALID_ARG;
     }
-
-    if (strcmp(subcmd, "clear") == 0)
+    if (strlen(query) > APP_WEATHER_QUERY_MAX_LEN)
     {
-        esp_err_t err = app_config_clear_wifi_override();
-        if (err != ESP_OK)
-        {
-            ESP_LOGE(APP_TAG, "config: clear failed: %s", esp_err_to_name(err));
-            return;
-        }
-        ESP_LOGI(APP_TAG, "config: Wi-Fi override cleared (defaults restored)");
-        ESP_LOGI(APP_TAG, "config: run 'wifi reboot' to apply now");
-        return;
+        return ESP_ERR_INVALID_SIZE;
     }
-
-    if (strcmp(subcmd, "reboot") == 0)
+    if (g_wifi_config.weather_location_count >= APP_LOCATION_MAX - 1)
     {
-        ESP_LOGW(APP_TAG, "config: rebooting now");
-        vTaskDelay(pdMS_TO_TICKS(100));
-        esp_restart();
-        return;
+        return ESP_ERR_NO_MEM;
     }
 
-    app_console_print_help();
+    uint8_t slot = g_wifi_config.weather_location_count;
+    snprintf(g_wifi_config.weather_locations[slot], sizeof(g_wifi_config.weather_locations[slot]), "%s", query);
+    g_wifi_config.weather_location_count++;
+    esp_err_t err = app_config_save_locations();
+    if (err != ESP_OK)
+    {
+        g_wifi_config.weather_location_count--;
+    }
+    return err;
 }
 
-static void app_console_handle_api(const char *args)
+esp_err_t app_config_remove_location(uint8_t index)
 {
-    char subcmd[20] = {0};
-    const char *cursor = args;
-    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    // Location 1 is the API query; change it with 'api set-query'
+    if (index < 2 || index > g_wifi_config.weather_location_count + 1)
     {
-        app_console_print_help();
-        return;
+        return ESP_ERR_INVALID_ARG;
     }
 
-    if (strcmp(subcmd, "show") == 0)
+    for (uint8_t i = (uint8_t)(index - 2); i + 1 < g_wifi_config.weather_location_count; ++i)
     {
-        const char *key = app_config_weather_api_key();
-        size_t key_len = strlen(key);
-        ESP_LOGI(APP_TAG, "api key source : %s",
-                 app_config_weather_api_override_active() ? "NVS override" : "wifi_local.h defaults");
-        if (key_len == 0)
-        {
-            ESP_LOGI(APP_TAG, "api key value  : <empty>");
-        }
-        else if (key_len <= 4)
-        {
-            ESP_LOGI(APP_TAG, "api key value  : %s (%u chars)", key, (unsigned)key_len);
-        }
-        else
-        {
-            ESP_LOGI(APP_TAG, "api key value  : ****%s (%u chars)", key + key_len - 4, (unsigned)key_len);
-        }
-        ESP_LOGI(APP_TAG, "api query src  : %s",
-                 app_config_weather_query_override_active() ? "NVS override" : "wifi_local.h defaults");
-        ESP_LOGI(APP_TAG, "api query      : %s", app_config_weather_query());
-        return;
+        memcpy(g_wifi_config.weather_locations[i], g_wifi_config.weather_locations[i + 1],
+               sizeof(g_wifi_config.weather_locations[i]));
     }
+    g_wifi_config.weather_location_count--;
+    return app_config_save_locations();
+}
 
-    if (strcmp(subcmd, "set-key") == 0)
+esp_err_t app_config_clear_locations(void)
+{
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
     {
-        char key[APP_WEATHER_API_KEY_MAX_LEN + 1] = {0};
-        if (!parse_next_token(&cursor, key, sizeof(key)) || *skip_ws(cursor) != '\0')
-        {
-            ESP_LOGW(APP_TAG, "usage: api set-key <openweather_api_key>");
-            return;
-        }
-        esp_err_t err = app_config_set_weather_api_key(key);
-        if (err != ESP_OK)
-        {
-            ESP_LOGE(APP_TAG, "config: save API key failed: %s", esp_err_to_name(err));
-            return;
-        }
-        size_t key_len = strlen(key);
-        if (key_len <= 4)
-        {
-            ESP_LOGI(APP_TAG, "saved: api key='%s' (%u chars)", key, (unsigned)key_len);
-        }
-        else
-        {
-            ESP_LOGI(APP_TAG, "saved: api key='****%s' (%u chars)", key + key_len - 4, (unsigned)key_len);
-        }
-        ESP_LOGI(APP_TAG, "type 'api reboot' to apply, or 'api show' to verify");
-        return;
+        return err;
     }
 
-    if (strcmp(subcmd, "set-query") == 0)
+    err = nvs_erase_key(nvs, APP_CFG_KEY_WX_LOCATIONS);
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND)
     {
-        char query[APP_WEATHER_QUERY_MAX_LEN + 1] = {0};
-        if (!parse_next_token(&cursor, query, sizeof(query)) || *skip_ws(cursor) != '\0')
-        {
-            ESP_LOGW(APP_TAG, "usage: api set-query <query_string>");
-            ESP_LOGW(APP_TAG, "example: api set-query \"zip=63301,US\"");
-            return;
-        }
-        esp_err_t err = app_config_set_weather_query(query);
-        if (err != ESP_OK)
-        {
-            ESP_LOGE(APP_TAG, "config: save API query failed: %s", esp_err_to_name(err));
-            return;
-        }
-        ESP_LOGI(APP_TAG, "saved: api query='%s'", query);
-        ESP_LOGI(APP_TAG, "type 'api reboot' to apply, or 'api show' to verify");
-        return;
+        err = nvs_erase_key(nvs, APP_CFG_KEY_LOC_ROTATE);
     }
-
-    if (strcmp(subcmd, "clear") == 0)
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND)
     {
-        esp_err_t err = app_config_clear_weather_override();
-        if (err != ESP_OK)
-        {
-            ESP_LOGE(APP_TAG, "config: clear API override failed: %s", esp_err_to_name(err));
-            return;
-        }
-        ESP_LOGI(APP_TAG, "config: API key/query overrides cleared (defaults restored)");
-        ESP_LOGI(APP_TAG, "config: run 'api reboot' (or 'wifi reboot') to apply now");
-        return;
+        err = nvs_commit(nvs);
     }
-
-    if (strcmp(subcmd, "reboot") == 0)
+    nvs_close(nvs);
+    if (err != ESP_OK)
     {
-        ESP_LOGW(APP_TAG, "config: rebooting now");
-        vTaskDelay(pdMS_TO_TICKS(100));
-        esp_restart();
-        return;
+        return err;
     }
 
-    app_console_print_help();
+    app_config_parse_locations(WEATHER_LOCATIONS_LOCAL);
+    g_wifi_config.weather_locations_override_active = false;
+    g_wifi_config.location_rotate_s = WEATHER_LOCATION_ROTATE_S_LOCAL;
+    return ESP_OK;
 }
 
-// Returns: 0 = empty/continue, 1 = valid command (enter interactive), -1 = exit requested
-static int app_console_process_line(char *line)
+uint16_t app_config_location_rotate_s(void)
 {
-    trim_line(line);
-    const char *cursor = skip_ws(line);
-    if (cursor == NULL || *cursor == '\0')
+    return g_wifi_config.location_rotate_s;
+}
+
+esp_err_t app_config_set_location_rotate_s(uint16_t seconds)
+{
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
     {
-        return 0;
+        return err;
     }
 
-    char command[16] = {0};
-    if (!parse_next_token(&cursor, command, sizeof(command)))
+    err = nvs_set_u16(nvs, APP_CFG_KEY_LOC_ROTATE, seconds);
+    if (err == ESP_OK)
     {
-        return 0;
+        err = nvs_commit(nvs);
     }
+    nvs_close(nvs);
 
-    // Exit commands
-    if (strcmp(command, "continue") == 0 || strcmp(command, "exit") == 0 || strcmp(command, "done") == 0)
+    if (err == ESP_OK)
     {
-        return -1;
+        g_wifi_config.location_rotate_s = seconds;
     }
+    return err;
+}
 
-    if (strcmp(command, "help") == 0 || strcmp(command, "?") == 0)
+// Last forecast for location 1, stored as the raw forecast_payload_t. The query hash
+// keeps a cache from a previous location from showing after `api set-query`.
+bool app_config_load_forecast_cache(uint32_t query_hash, forecast_payload_t *out)
+{
+    nvs_handle_t nvs = 0;
+    if (nvs_open(APP_CFG_NS, NVS_READONLY, &nvs) != ESP_OK)
+    {
+        return false;
+    }
+
+    uint32_t saved_hash = 0;
+    size_t len = sizeof(*out);
+    bool ok = nvs_get_u32(nvs, APP_CFG_KEY_FC_QUERY, &saved_hash) == ESP_OK && saved_hash == query_hash &&
+              nvs_get_blob(nvs, APP_CFG_KEY_FC_CACHE, out, &len) == ESP_OK && len == sizeof(*out) &&
+              out->version == APP_FORECAST_CACHE_VERSION && out->day_count <= APP_FORECAST_ROWS &&
+              out->slot_count <= APP_FORECAST_SLOTS;
+    nvs_close(nvs);
+
+    // Day rows index straight into slots[]; a stale or corrupt blob must not point past them
+    for (uint8_t i = 0; ok && i < out->day_count; ++i)
+    {
+        const forecast_day_t *day = &out->days[i];
+        if ((uint32_t)day->first_slot + day->slot_count > out->slot_count)
+        {
+            ESP_LOGW(APP_TAG, "forecast cache: day %u slots %u+%u past %u, ignoring cache", (unsigned)i,
+                     (unsigned)day->first_slot, (unsigned)day->slot_count, (unsigned)out->slot_count);
+            ok = false;
+        }
+    }
+    if (!ok)
+    {
+        memset(out, 0, sizeof(*out));
+    }
+    return ok;
+}
+
+esp_err_t app_config_save_forecast_cache(uint32_t query_hash, const forecast_payload_t *fc)
+{
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = nvs_set_blob(nvs, APP_CFG_KEY_FC_CACHE, fc, sizeof(*fc));
+    if (err == ESP_OK)
+    {
+        err = nvs_set_u32(nvs, APP_CFG_KEY_FC_QUERY, query_hash);
+    }
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return err;
+}
+
+const char *app_config_radar_url(void)
+{
+    return g_wifi_config.radar_url;
+}
+
+bool app_config_radar_url_override_active(void)
+{
+    return g_wifi_config.radar_url_override_active;
+}
+
+esp_err_t app_config_set_radar_url(const char *url_template)
+{
+    if (url_template == NULL || url_template[0] == '\0')
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t len = strlen(url_template);
+    if (len > APP_RADAR_URL_MAX_LEN)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = nvs_set_str(nvs, APP_CFG_KEY_RADAR_URL, url_template);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    if (err == ESP_OK)
+    {
+        snprintf(g_wifi_config.radar_url, sizeof(g_wifi_config.radar_url), "%s", url_template);
+        g_wifi_config.radar_url_override_active = true;
+    }
+
+    return err;
+}
+
+esp_err_t app_config_clear_radar_url(void)
+{
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = nvs_erase_key(nvs, APP_CFG_KEY_RADAR_URL);
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    snprintf(g_wifi_config.radar_url, sizeof(g_wifi_config.radar_url), "%s", RADAR_TILE_URL_LOCAL);
+    g_wifi_config.radar_url_override_active = false;
+    return ESP_OK;
+}
+
+const char *app_config_mqtt_uri(void)
+{
+    return g_wifi_config.mqtt_uri;
+}
+
+const char *app_config_mqtt_topic(void)
+{
+    return g_wifi_config.mqtt_topic;
+}
+
+bool app_config_mqtt_override_active(void)
+{
+    return g_wifi_config.mqtt_override_active;
+}
+
+const app_mqtt_tuning_t *app_config_mqtt_tuning(void)
+{
+    return &g_wifi_config.mqtt_tuning;
+}
+
+esp_err_t app_config_set_mqtt_uri(const char *uri)
+{
+    if (uri == NULL ||
+        (strncmp(uri, "mqtt://", 7) != 0 && strncmp(uri, "mqtts://", 8) != 0))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(uri) > APP_MQTT_URI_MAX_LEN)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = app_config_save_str(APP_CFG_KEY_MQTT_URI, uri);
+    if (err == ESP_OK)
+    {
+        snprintf(g_wifi_config.mqtt_uri, sizeof(g_wifi_config.mqtt_uri), "%s", uri);
+        g_wifi_config.mqtt_override_active = true;
+    }
+    return err;
+}
+
+esp_err_t app_config_set_mqtt_topic(const char *prefix)
+{
+    if (prefix == NULL || prefix[0] == '\0' || strpbrk(prefix, "#+") != NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(prefix) > APP_MQTT_TOPIC_MAX_LEN)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = app_config_save_str(APP_CFG_KEY_MQTT_TOPIC, prefix);
+    if (err == ESP_OK)
+    {
+        snprintf(g_wifi_config.mqtt_topic, sizeof(g_wifi_config.mqtt_topic), "%s", prefix);
+        g_wifi_config.mqtt_override_active = true;
+    }
+    return err;
+}
+
+esp_err_t app_config_set_mqtt_tuning(const app_mqtt_tuning_t *tuning)
+{
+    if (tuning == NULL || !app_config_mqtt_tuning_valid(tuning))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = nvs_set_blob(nvs, APP_CFG_KEY_MQTT_TUNING, tuning, sizeof(*tuning));
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    if (err == ESP_OK)
+    {
+        g_wifi_config.mqtt_tuning = *tuning;
+        g_wifi_config.mqtt_override_active = true;
+    }
+    return err;
+}
+
+esp_err_t app_config_clear_mqtt(void)
+{
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    const char *keys[] = {APP_CFG_KEY_MQTT_URI, APP_CFG_KEY_MQTT_TOPIC, APP_CFG_KEY_MQTT_TUNING};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]) && (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND); ++i)
+    {
+        err = nvs_erase_key(nvs, keys[i]);
+    }
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    snprintf(g_wifi_config.mqtt_uri, sizeof(g_wifi_config.mqtt_uri), "%s", MQTT_BROKER_URI_LOCAL);
+    snprintf(g_wifi_config.mqtt_topic, sizeof(g_wifi_config.mqtt_topic), "%s", MQTT_TOPIC_PREFIX_LOCAL);
+    g_wifi_config.mqtt_tuning.window_s = APP_MQTT_WINDOW_S_DEFAULT;
+    g_wifi_config.mqtt_tuning.outbox_kb = APP_MQTT_OUTBOX_KB_DEFAULT;
+    g_wifi_config.mqtt_tuning.rate_per_s = APP_MQTT_RATE_DEFAULT;
+    g_wifi_config.mqtt_tuning.inflight = APP_MQTT_INFLIGHT_DEFAULT;
+    g_wifi_config.mqtt_tuning.qos = APP_MQTT_QOS_DEFAULT;
+    g_wifi_config.mqtt_override_active = false;
+    return ESP_OK;
+}
+
+app_power_profile_t app_config_power_profile(void)
+{
+    return g_wifi_config.power_profile;
+}
+
+esp_err_t app_config_set_power_profile(app_power_profile_t profile)
+{
+    if (profile >= APP_POWER_PROFILE_COUNT)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(APP_CFG_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    err = nvs_set_u8(nvs, APP_CFG_KEY_PWR_PROFILE, (uint8_t)profile);
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    if (err == ESP_OK)
+    {
+        g_wifi_config.power_profile = profile;
+    }
+
+    return err;
+}
+
+static void app_console_print_help(void)
+{
+    ESP_LOGI(APP_TAG, "commands:");
+    ESP_LOGI(APP_TAG, "  wifi show                  - show Wi-Fi config");
+    ESP_LOGI(APP_TAG, "  wifi set <ssid> <pass>     - set Wi-Fi credentials");
+    ESP_LOGI(APP_TAG, "  wifi clear                 - clear Wi-Fi override");
+    ESP_LOGI(APP_TAG, "  api show                   - show API config");
+    ESP_LOGI(APP_TAG, "  api set-key <key>          - set OpenWeather API key");
+    ESP_LOGI(APP_TAG, "  api set-query <query>      - set location query");
+    ESP_LOGI(APP_TAG, "  api clear                  - clear API overrides");
+    ESP_LOGI(APP_TAG, "  loc show                   - list weather locations (1 is the API query)");
+    ESP_LOGI(APP_TAG, "  loc add <query>            - add a location, e.g. q=Chicago,US");
+    ESP_LOGI(APP_TAG, "  loc del <n>                - remove location n (2..6)");
+    ESP_LOGI(APP_TAG, "  loc rotate <seconds>       - auto-advance interval, 0 = swipe only");
+    ESP_LOGI(APP_TAG, "  loc clear                  - clear location overrides");
+    ESP_LOGI(APP_TAG, "  radar show                 - show radar tile URL template");
+    ESP_LOGI(APP_TAG, "  radar set-url <template>   - tile URL with {z} {x} {y} {ts}");
+    ESP_LOGI(APP_TAG, "  radar clear                - clear radar URL override");
+    ESP_LOGI(APP_TAG, "  mqtt show                  - show MQTT broker, tuning and outbox stats");
+    ESP_LOGI(APP_TAG, "  mqtt set-uri <uri>         - mqtt://host:1883 or mqtts://host:8883");
+    ESP_LOGI(APP_TAG, "  mqtt set-topic <prefix>    - topics are <prefix>/indoor|outdoor|status");
+    ESP_LOGI(APP_TAG, "  mqtt set <key> <value>     - window 5-600 s, outbox 4-1024 KB, rate 1-50 msg/s,");
+    ESP_LOGI(APP_TAG, "                               inflight 1-16, qos 0-2");
+    ESP_LOGI(APP_TAG, "  mqtt clear                 - clear MQTT overrides");
+    ESP_LOGI(APP_TAG, "  power show                 - show power profile and per-mode drain");
+    ESP_LOGI(APP_TAG, "  power set <profile>        - performance | balanced | saver");
+    ESP_LOGI(APP_TAG, "  lvgl show                  - LVGL heap pools, fragmentation and alloc rate");
+    ESP_LOGI(APP_TAG, "  continue                   - exit config, boot normally");
+    ESP_LOGI(APP_TAG, "  wifi reboot / api reboot   - save and reboot");
+}
+
+static void app_console_handle_wifi(const char *args)
+{
+    char subcmd[16] = {0};
+    const char *cursor = args;
+    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    {
+        app_console_print_help();
+        return;
+    }
+
+    if (strcmp(subcmd, "show") == 0)
+    {
+        const size_t pass_len = strlen(app_config_wifi_pass());
+        ESP_LOGI(APP_TAG, "wifi source : %s",
+                 app_config_wifi_override_active() ? "NVS override" : "wifi_local.h defaults");
+        ESP_LOGI(APP_TAG, "wifi ssid   : %s", app_config_wifi_ssid());
+        ESP_LOGI(APP_TAG, "wifi pass   : %s (%u chars)",
+                 pass_len == 0 ? "<empty>" : "********", (unsigned)pass_len);
+        return;
+    }
+
+    if (strcmp(subcmd, "set") == 0)
+    {
+        char ssid[APP_WIFI_SSID_MAX_LEN + 1] = {0};
+        char pass[APP_WIFI_PASS_MAX_LEN + 1] = {0};
+        if (!parse_wifi_set_args(cursor, ssid, sizeof(ssid), pass, sizeof(pass)))
+        {
+            ESP_LOGW(APP_TAG, "usage: wifi set <ssid> <password>");
+            ESP_LOGW(APP_TAG, "or:    wifi set \"My SSID\" \"My Password\"");
+            return;
+        }
+
+        esp_err_t err = app_config_set_wifi_override(ssid, pass);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: save failed: %s", esp_err_to_name(err));
+            return;
+        }
+
+        ESP_LOGI(APP_TAG, "saved: SSID='%s' pass=******** (%u chars)", ssid, (unsigned)strlen(pass));
+        ESP_LOGI(APP_TAG, "type 'wifi reboot' to apply, or 'wifi show' to verify");
+        return;
+    }
+
+    if (strcmp(subcmd, "clear") == 0)
+    {
+        esp_err_t err = app_config_clear_wifi_override();
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: clear failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "config: Wi-Fi override cleared (defaults restored)");
+        ESP_LOGI(APP_TAG, "config: run 'wifi reboot' to apply now");
+        return;
+    }
+
+    if (strcmp(subcmd, "reboot") == 0)
+    {
+        ESP_LOGW(APP_TAG, "config: rebooting now");
+        vTaskDelay(pdMS_TO_TICKS(100));
+        esp_restart();
+        return;
+    }
+
+    app_console_print_help();
+}
+
+static void app_console_handle_api(const char *args)
+{
+    char subcmd[20] = {0};
+    const char *cursor = args;
+    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    {
+        app_console_print_help();
+        return;
+    }
+
+    if (strcmp(subcmd, "show") == 0)
+    {
+        const char *key = app_config_weather_api_key();
+        size_t key_len = strlen(key);
+        ESP_LOGI(APP_TAG, "api key source : %s",
+                 app_config_weather_api_override_active() ? "NVS override" : "wifi_local.h defaults");
+        if (key_len == 0)
+        {
+            ESP_LOGI(APP_TAG, "api key value  : <empty>");
+        }
+        else if (key_len <= 4)
+        {
+            ESP_LOGI(APP_TAG, "api key value  : %s (%u chars)", key, (unsigned)key_len);
+        }
+        else
+        {
+            ESP_LOGI(APP_TAG, "api key value  : ****%s (%u chars)", key + key_len - 4, (unsigned)key_len);
+        }
+        ESP_LOGI(APP_TAG, "api query src  : %s",
+                 app_config_weather_query_override_active() ? "NVS override" : "wifi_local.h defaults");
+        ESP_LOGI(APP_TAG, "api query      : %s", app_config_weather_query());
+        return;
+    }
+
+    if (strcmp(subcmd, "set-key") == 0)
+    {
+        char key[APP_WEATHER_API_KEY_MAX_LEN + 1] = {0};
+        if (!parse_next_token(&cursor, key, sizeof(key)) || *skip_ws(cursor) != '\0')
+        {
+            ESP_LOGW(APP_TAG, "usage: api set-key <openweather_api_key>");
+            return;
+        }
+        esp_err_t err = app_config_set_weather_api_key(key);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: save API key failed: %s", esp_err_to_name(err));
+            return;
+        }
+        size_t key_len = strlen(key);
+        if (key_len <= 4)
+        {
+            ESP_LOGI(APP_TAG, "saved: api key='%s' (%u chars)", key, (unsigned)key_len);
+        }
+        else
+        {
+            ESP_LOGI(APP_TAG, "saved: api key='****%s' (%u chars)", key + key_len - 4, (unsigned)key_len);
+        }
+        ESP_LOGI(APP_TAG, "type 'api reboot' to apply, or 'api show' to verify");
+        return;
+    }
+
+    if (strcmp(subcmd, "set-query") == 0)
+    {
+        char query[APP_WEATHER_QUERY_MAX_LEN + 1] = {0};
+        if (!parse_next_token(&cursor, query, sizeof(query)) || *skip_ws(cursor) != '\0')
+        {
+            ESP_LOGW(APP_TAG, "usage: api set-query <query_string>");
+            ESP_LOGW(APP_TAG, "example: api set-query \"zip=63301,US\"");
+            return;
+        }
+        esp_err_t err = app_config_set_weather_query(query);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: save API query failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "saved: api query='%s'", query);
+        ESP_LOGI(APP_TAG, "type 'api reboot' to apply, or 'api show' to verify");
+        return;
+    }
+
+    if (strcmp(subcmd, "clear") == 0)
+    {
+        esp_err_t err = app_config_clear_weather_override();
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: clear API override failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "config: API key/query overrides cleared (defaults restored)");
+        ESP_LOGI(APP_TAG, "config: run 'api reboot' (or 'wifi reboot') to apply now");
+        return;
+    }
+
+    if (strcmp(subcmd, "reboot") == 0)
+    {
+        ESP_LOGW(APP_TAG, "config: rebooting now");
+        vTaskDelay(pdMS_TO_TICKS(100));
+        esp_restart();
+        return;
+    }
+
+    app_console_print_help();
+}
+
+static void app_console_handle_loc(const char *args)
+{
+    char subcmd[16] = {0};
+    const char *cursor = args;
+    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    {
+        app_console_print_help();
+        return;
+    }
+
+    if (strcmp(subcmd, "show") == 0)
+    {
+        ESP_LOGI(APP_TAG, "loc source   : %s",
+                 g_wifi_config.weather_locations_override_active ? "NVS override" : "wifi_local.h defaults");
+        for (uint8_t i = 0; i < app_config_location_count(); ++i)
+        {
+            ESP_LOGI(APP_TAG, "loc %u        : %s", (unsigned)(i + 1), app_config_location_query(i));
+        }
+        ESP_LOGI(APP_TAG, "loc rotate   : %u s%s", (unsigned)app_config_location_rotate_s(),
+                 app_config_location_rotate_s() == 0 ? " (swipe only)" : "");
+        uint8_t feeds = 0;
+        uint32_t fetches = 0;
+        uint32_t coalesced = 0;
+        uint32_t budget_waits = 0;
+        app_locations_stats(&feeds, &fetches, &coalesced, &budget_waits);
+        ESP_LOGI(APP_TAG, "loc fetches  : %u feeds, %u fetches, %u coalesced, %u budget waits",
+                 (unsigned)feeds, (unsigned)fetches, (unsigned)coalesced, (unsigned)budget_waits);
+        return;
+    }
+
+    if (strcmp(subcmd, "add") == 0)
+    {
+        char query[APP_WEATHER_QUERY_MAX_LEN + 1] = {0};
+        if (!parse_next_token(&cursor, query, sizeof(query)) || *skip_ws(cursor) != '\0')
+        {
+            ESP_LOGW(APP_TAG, "usage: loc add <query>");
+            ESP_LOGW(APP_TAG, "example: loc add \"q=Saint Charles,US\"");
+            return;
+        }
+        esp_err_t err = app_config_add_location(query);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: add location failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "saved: location %u='%s' (applies on reboot)", (unsigned)app_config_location_count(), query);
+        return;
+    }
+
+    if (strcmp(subcmd, "del") == 0 || strcmp(subcmd, "rotate") == 0)
+    {
+        bool del = (strcmp(subcmd, "del") == 0);
+        char value[8] = {0};
+        char *end = NULL;
+        unsigned long v = 0;
+        if (parse_next_token(&cursor, value, sizeof(value)) && *skip_ws(cursor) == '\0')
+        {
+            v = strtoul(value, &end, 10);
+        }
+        if (end == NULL || end == value || *end != '\0' || v > 0xFFFF)
+        {
+            ESP_LOGW(APP_TAG, "usage: %s", del ? "loc del <n>" : "loc rotate <seconds>");
+            return;
+        }
+        esp_err_t err = del ? app_config_remove_location((uint8_t)(v > 0xFF ? 0 : v))
+                            : app_config_set_location_rotate_s((uint16_t)v);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: %s failed: %s", del ? "remove location" : "save rotate", esp_err_to_name(err));
+            return;
+        }
+        if (del)
+        {
+            ESP_LOGI(APP_TAG, "saved: location %lu removed (applies on reboot)", v);
+        }
+        else
+        {
+            ESP_LOGI(APP_TAG, "saved: rotate every %lu s", v);
+        }
+        return;
+    }
+
+    if (strcmp(subcmd, "clear") == 0)
+    {
+        esp_err_t err = app_config_clear_locations();
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: clear locations failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "config: location overrides cleared (defaults restored)");
+        return;
+    }
+
+    app_console_print_help();
+}
+
+static void app_console_handle_radar(const char *args)
+{
+    char subcmd[16] = {0};
+    const char *cursor = args;
+    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    {
+        app_console_print_help();
+        return;
+    }
+
+    if (strcmp(subcmd, "show") == 0)
+    {
+        ESP_LOGI(APP_TAG, "radar url src  : %s",
+                 app_config_radar_url_override_active() ? "NVS override" : "wifi_local.h defaults");
+        ESP_LOGI(APP_TAG, "radar url      : %s", app_config_radar_url());
+        ESP_LOGI(APP_TAG, "radar center   : %.4f, %.4f zoom %d", (double)RADAR_CENTER_LAT_LOCAL,
+                 (double)RADAR_CENTER_LON_LOCAL, (int)RADAR_ZOOM_LOCAL);
+        return;
+    }
+
+    if (strcmp(subcmd, "set-url") == 0)
+    {
+        char url[APP_RADAR_URL_MAX_LEN + 1] = {0};
+        if (!parse_next_token(&cursor, url, sizeof(url)) || *skip_ws(cursor) != '\0')
+        {
+            ESP_LOGW(APP_TAG, "usage: radar set-url <url_template>");
+            ESP_LOGW(APP_TAG, "example: radar set-url http://192.168.1.20:8080/{z}/{x}/{y}.png");
+            return;
+        }
+        esp_err_t err = app_config_set_radar_url(url);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: save radar URL failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "saved: radar url='%s'", url);
+        return;
+    }
+
+    if (strcmp(subcmd, "clear") == 0)
+    {
+        esp_err_t err = app_config_clear_radar_url();
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: clear radar URL failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "config: radar URL override cleared (default restored)");
+        return;
+    }
+
+    app_console_print_help();
+}
+
+static void app_console_handle_mqtt(const char *args)
+{
+    char subcmd[16] = {0};
+    const char *cursor = args;
+    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    {
+        app_console_print_help();
+        return;
+    }
+
+    if (strcmp(subcmd, "show") == 0)
+    {
+        const app_mqtt_tuning_t *t = app_config_mqtt_tuning();
+        app_mqtt_stats_t stats = {};
+        app_mqtt_stats(&stats);
+        ESP_LOGI(APP_TAG, "mqtt source   : %s",
+                 app_config_mqtt_override_active() ? "NVS override" : "wifi_local.h defaults");
+        ESP_LOGI(APP_TAG, "mqtt broker   : %s", app_config_mqtt_uri()[0] != '\0' ? app_config_mqtt_uri() : "<disabled>");
+        ESP_LOGI(APP_TAG, "mqtt topics   : %s/indoor %s/outdoor %s/status",
+                 app_config_mqtt_topic(), app_config_mqtt_topic(), app_config_mqtt_topic());
+        ESP_LOGI(APP_TAG, "mqtt tuning   : window %u s, outbox %u KB, rate %u msg/s, inflight %u, qos %u",
+                 (unsigned)t->window_s, (unsigned)t->outbox_kb, (unsigned)t->rate_per_s,
+                 (unsigned)t->inflight, (unsigned)t->qos);
+        if (stats.enabled)
+        {
+            ESP_LOGI(APP_TAG, "mqtt link     : %s, %u reconnects",
+                     stats.connected ? "connected" : "down", (unsigned)stats.reconnects);
+            ESP_LOGI(APP_TAG, "mqtt outbox   : %u queued, %u inflight, %u/%u bytes",
+                     (unsigned)stats.queued, (unsigned)stats.inflight,
+                     (unsigned)stats.outbox_used, (unsigned)stats.outbox_size);
+            ESP_LOGI(APP_TAG, "mqtt sent     : %u msgs %u bytes, %u resent, %u dropped, ack avg %u ms max %u ms",
+                     (unsigned)stats.published, (unsigned)stats.published_bytes, (unsigned)stats.resent,
+                     (unsigned)stats.dropped, (unsigned)stats.ack_avg_ms, (unsigned)stats.ack_max_ms);
+        }
+        return;
+    }
+
+    if (strcmp(subcmd, "set-uri") == 0 || strcmp(subcmd, "set-topic") == 0)
+    {
+        bool is_uri = (strcmp(subcmd, "set-uri") == 0);
+        char value[APP_MQTT_URI_MAX_LEN + 1] = {0};
+        if (!parse_next_token(&cursor, value, sizeof(value)) || *skip_ws(cursor) != '\0')
+        {
+            ESP_LOGW(APP_TAG, "usage: %s", is_uri ? "mqtt set-uri <mqtt://host:port>" : "mqtt set-topic <prefix>");
+            return;
+        }
+        esp_err_t err = is_uri ? app_config_set_mqtt_uri(value) : app_config_set_mqtt_topic(value);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: save MQTT %s failed: %s", is_uri ? "URI" : "topic", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "saved: mqtt %s='%s'", is_uri ? "uri" : "topic", value);
+        if (is_uri)
+        {
+            ESP_LOGI(APP_TAG, "type 'wifi reboot' to connect to the new broker");
+        }
+        return;
+    }
+
+    if (strcmp(subcmd, "set") == 0)
+    {
+        char key[16] = {0};
+        char value[16] = {0};
+        if (!parse_next_token(&cursor, key, sizeof(key)) || !parse_next_token(&cursor, value, sizeof(value)) ||
+            *skip_ws(cursor) != '\0')
+        {
+            ESP_LOGW(APP_TAG, "usage: mqtt set <window|outbox|rate|inflight|qos> <value>");
+            return;
+        }
+        char *end = NULL;
+        unsigned long v = strtoul(value, &end, 10);
+        app_mqtt_tuning_t t = *app_config_mqtt_tuning();
+        bool known = true;
+        if (end == value || *end != '\0' || v > 0xFFFF)
+        {
+            known = false;
+        }
+        else if (strcmp(key, "window") == 0)
+        {
+            t.window_s = (uint16_t)v;
+        }
+        else if (strcmp(key, "outbox") == 0)
+        {
+            t.outbox_kb = (uint16_t)v;
+        }
+        else if (strcmp(key, "rate") == 0 && v <= 0xFF)
+        {
+            t.rate_per_s = (uint8_t)v;
+        }
+        else if (strcmp(key, "inflight") == 0 && v <= 0xFF)
+        {
+            t.inflight = (uint8_t)v;
+        }
+        else if (strcmp(key, "qos") == 0 && v <= 0xFF)
+        {
+            t.qos = (uint8_t)v;
+        }
+        else
+        {
+            known = false;
+        }
+
+        esp_err_t err = known ? app_config_set_mqtt_tuning(&t) : ESP_ERR_INVALID_ARG;
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: save MQTT %s failed: %s (see 'help' for ranges)", key, esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "saved: mqtt %s=%lu%s", key, v,
+                 strcmp(key, "outbox") == 0 ? " (applies on reboot)" : "");
+        return;
+    }
+
+    if (strcmp(subcmd, "clear") == 0)
+    {
+        esp_err_t err = app_config_clear_mqtt();
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: clear MQTT failed: %s", esp_err_to_name(err));
+            return;
+        }
+        ESP_LOGI(APP_TAG, "config: MQTT overrides cleared (defaults restored)");
+        return;
+    }
+
+    app_console_print_help();
+}
+
+static void app_console_handle_power(const char *args)
+{
+    char subcmd[16] = {0};
+    const char *cursor = args;
+    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    {
+        app_console_print_help();
+        return;
+    }
+
+    if (strcmp(subcmd, "show") == 0)
+    {
+        ESP_LOGI(APP_TAG, "power profile: %s (saved: %s)",
+                 app_power_profile_name(app_power_profile()),
+                 app_power_profile_name(app_config_power_profile()));
+        app_power_log_stats();
+        return;
+    }
+
+    if (strcmp(subcmd, "set") == 0)
+    {
+        char name[16] = {0};
+        app_power_profile_t profile = APP_POWER_PROFILE_DEFAULT;
+        if (!parse_next_token(&cursor, name, sizeof(name)) || *skip_ws(cursor) != '\0' ||
+            !app_power_profile_from_name(name, &profile))
+        {
+            ESP_LOGW(APP_TAG, "usage: power set <performance|balanced|saver>");
+            return;
+        }
+        esp_err_t err = app_config_set_power_profile(profile);
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(APP_TAG, "config: save power profile failed: %s", esp_err_to_name(err));
+            return;
+        }
+        // Applied by weather_task, which owns the power state, once the console closes
+        app_power_set_profile(profile);
+        ESP_LOGI(APP_TAG, "saved: power profile='%s' (applies on 'continue'; Wi-Fi listen interval on next connect)", name);
+        return;
+    }
+
+    app_console_print_help();
+}
+
+static void app_console_log_lvgl_pool(const char *name, const lvgl_port_mem_pool_stats_t *pool)
+{
+    if (pool->size == 0)
+    {
+        ESP_LOGI(APP_TAG, "lvgl %-5s   : <not created>", name);
+        return;
+    }
+    ESP_LOGI(APP_TAG, "lvgl %-5s   : %u/%u bytes in %u blocks, peak %u, largest free %u, frag %u%%", name,
+             (unsigned)pool->used, (unsigned)pool->size, (unsigned)pool->blocks, (unsigned)pool->peak,
+             (unsigned)pool->largest_free, (unsigned)pool->frag_pct);
+}
+
+static void app_console_handle_lvgl(const char *args)
+{
+    // Rate window runs from the previous 'lvgl show' (or boot) to now
+    static uint32_t s_last_allocs = 0;
+    static uint32_t s_last_ms = 0;
+
+    char subcmd[16] = {0};
+    const char *cursor = args;
+    if (!parse_next_token(&cursor, subcmd, sizeof(subcmd)))
+    {
+        app_console_print_help();
+        return;
+    }
+
+    if (strcmp(subcmd, "show") == 0)
+    {
+        lvgl_port_mem_stats_t stats = {};
+        lvgl_port_mem_get_stats(&stats);
+        uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+        uint32_t window_ms = now_ms - s_last_ms;
+        uint32_t rate = (window_ms > 0) ? (uint32_t)((uint64_t)(stats.allocs - s_last_allocs) * 1000U / window_ms) : 0;
+        s_last_allocs = stats.allocs;
+        s_last_ms = now_ms;
+
+        app_console_log_lvgl_pool("hot", &stats.hot);
+        app_console_log_lvgl_pool("bulk", &stats.bulk);
+        ESP_LOGI(APP_TAG, "lvgl calls   : %u allocs, %u frees, %u reallocs (%u moved)", (unsigned)stats.allocs,
+                 (unsigned)stats.frees, (unsigned)stats.reallocs, (unsigned)stats.moves);
+        ESP_LOGI(APP_TAG, "lvgl rate    : %u allocs/s over the last %u ms", (unsigned)rate, (unsigned)window_ms);
+        ESP_LOGI(APP_TAG, "lvgl overflow: %u spilled to bulk, %u to system heap, %u failed", (unsigned)stats.spills,
+                 (unsigned)stats.fallbacks, (unsigned)stats.failures);
+        return;
+    }
+
+    app_console_print_help();
+}
+
+// Returns: 0 = empty/continue, 1 = valid command (enter interactive), -1 = exit requested
+static int app_console_process_line(char *line)
+{
+    trim_line(line);
+    const char *cursor = skip_ws(line);
+    if (cursor == NULL || *cursor == '\0')
+    {
+        return 0;
+    }
+
+    char command[16] = {0};
+    if (!parse_next_token(&cursor, command, sizeof(command)))
+    {
+        return 0;
+    }
+
+    // Exit commands
+    if (strcmp(command, "continue") == 0 || strcmp(command, "exit") == 0 || strcmp(command, "done") == 0)
+    {
+        return -1;
+    }
+
+    if (strcmp(command, "help") == 0 || strcmp(command, "?") == 0)
     {
         app_console_print_help();
         return 1;
@@ -639,6 +1601,36 @@ static int app_console_process_line(char *line)
         return 1;
     }
 
+    if (strcmp(command, "loc") == 0)
+    {
+        app_console_handle_loc(cursor);
+        return 1;
+    }
+
+    if (strcmp(command, "radar") == 0)
+    {
+        app_console_handle_radar(cursor);
+        return 1;
+    }
+
+    if (strcmp(command, "mqtt") == 0)
+    {
+        app_console_handle_mqtt(cursor);
+        return 1;
+    }
+
+    if (strcmp(command, "power") == 0)
+    {
+        app_console_handle_power(cursor);
+        return 1;
+    }
+
+    if (strcmp(command, "lvgl") == 0)
+    {
+        app_console_handle_lvgl(cursor);
+        return 1;
+    }
+
     ESP_LOGW(APP_TAG, "console: unknown command '%s' (type 'help' or 'continue' to exit)", command);
     return 1; // Stay in interactive mode on error too
 }
@@ -786,6 +1778,8 @@ console_exit:
 void app_config_interactive_console(void)
 {
     g_console_active = true;
+    // USB-Serial-JTAG drops out in light sleep; keep the chip awake while typing.
+    app_power_console_hold(true);
 
     usb_serial_jtag_driver_config_t usb_cfg = {};
     usb_cfg.tx_buffer_size = 512;
@@ -795,6 +1789,7 @@ void app_config_interactive_console(void)
     {
         ESP_LOGW(APP_TAG, "console: usb serial driver install failed: %s", esp_err_to_name(usb_err));
         g_console_active = false;
+        app_power_console_hold(false);
         return;
     }
 
@@ -838,6 +1833,7 @@ void app_config_interactive_console(void)
                     usb_serial_jtag_write_bytes((const uint8_t *)"\r\n", 2, pdMS_TO_TICKS(100));
                     ESP_LOGI(APP_TAG, "console: exiting config mode");
                     g_console_active = false;
+                    app_power_console_hold(false);
                     return;
                 }
 
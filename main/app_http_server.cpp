@@ -0,0 +1,931 @@
+#include "app_priv.h"
+
+#include <stdlib.h>
+
+#include "freertos/semphr.h"
+
+#include "esp_heap_caps.h"
+#include "esp_http_server.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+
+#include "pixconv.h"
+
+// JSON responses are serialised out of this copy of g_app, no cJSON tree, into a
+// per-request PSRAM buffer under s_snap_lock; the socket write happens after the
+// lock is released. The UI task refreshes the copy with a try-lock, so serialising
+// can delay the next copy by a few ms but a slow client delays nothing.
+// Render, radar and weather counters are copied here too: their writers are the UI
+// and LVGL tasks, and httpd must not read them live.
+typedef struct
+{
+    app_state_t app;
+    bool wifi_connected;
+    uint32_t wifi_connected_ms;
+    uint32_t taken_ms;
+    drawing_screen_layer_stats_t layers;
+    drawing_screen_slide_stats_t slide;
+    drawing_screen_icon_anim_stats_t icon;
+    drawing_screen_label_stats_t labels;
+    uint32_t radar_tiles;
+    uint32_t radar_avg_ms;
+    uint32_t radar_max_ms;
+    size_t radar_cache_bytes;
+    uint8_t wx_feeds;
+    uint32_t wx_fetches;
+    uint32_t wx_coalesced;
+    uint32_t wx_budget_waits;
+} http_snapshot_t;
+
+typedef struct
+{
+    esp_err_t err;
+    bool first;
+    size_t used;
+    size_t cap;
+    char *buf;
+} http_json_t;
+
+typedef void (*http_json_writer_t)(http_json_t *j, const http_snapshot_t *snap);
+
+typedef struct
+{
+    const char *uri;
+    http_json_writer_t writer;
+} http_endpoint_t;
+
+typedef struct
+{
+    uint32_t us;
+    uint8_t endpoint;
+} http_latency_t;
+
+static void http_write_state(http_json_t *j, const http_snapshot_t *snap);
+static void http_write_indoor(http_json_t *j, const http_snapshot_t *snap);
+static void http_write_i2c(http_json_t *j, const http_snapshot_t *snap);
+static void http_write_wifi(http_json_t *j, const http_snapshot_t *snap);
+static void http_write_perf(http_json_t *j, const http_snapshot_t *snap);
+
+#define HTTP_ENDPOINT_SCREEN 5
+
+static const http_endpoint_t HTTP_ENDPOINTS[] = {
+    {"/api/state", http_write_state},
+    {"/api/indoor", http_write_indoor},
+    {"/api/i2c", http_write_i2c},
+    {"/api/wifi", http_write_wifi},
+    {"/api/perf", http_write_perf},
+    {"/screen.bmp", NULL},
+};
+
+static httpd_handle_t s_server = NULL;
+static http_snapshot_t *s_snap = NULL;
+static SemaphoreHandle_t s_snap_lock = NULL;
+static uint32_t s_snap_seq = 0;
+static uint32_t s_snap_ms = 0;
+
+// Only touched from the httpd task
+static http_latency_t s_latency[APP_HTTP_LATENCY_SAMPLES];
+static uint32_t s_latency_scratch[APP_HTTP_LATENCY_SAMPLES];
+static uint16_t s_latency_head = 0;
+static uint16_t s_latency_count = 0;
+static uint32_t s_requests = 0;
+static uint32_t s_errors = 0;
+
+static uint32_t http_now_ms(void)
+{
+    return (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static void http_note_request(int endpoint, int64_t start_us, esp_err_t err)
+{
+    http_latency_t *sample = &s_latency[s_latency_head];
+    sample->us = (uint32_t)(esp_timer_get_time() - start_us);
+    sample->endpoint = (uint8_t)endpoint;
+    s_latency_head = (uint16_t)((s_latency_head + 1) % APP_HTTP_LATENCY_SAMPLES);
+    if (s_latency_count < APP_HTTP_LATENCY_SAMPLES)
+    {
+        s_latency_count++;
+    }
+    s_requests++;
+    if (err != ESP_OK)
+    {
+        s_errors++;
+    }
+}
+
+static void json_write(http_json_t *j, const char *data, size_t len)
+{
+    if (j->err != ESP_OK)
+    {
+        return;
+    }
+    if (len > j->cap - j->used)
+    {
+        size_t cap = (j->cap > 0) ? j->cap : APP_HTTP_JSON_BUF_BYTES;
+        while (len > cap - j->used)
+        {
+            cap *= 2;
+        }
+        char *buf = (char *)heap_caps_realloc(j->buf, cap, MALLOC_CAP_SPIRAM);
+        if (buf == NULL)
+        {
+            j->err = ESP_ERR_NO_MEM;
+            return;
+        }
+        j->buf = buf;
+        j->cap = cap;
+    }
+    memcpy(j->buf + j->used, data, len);
+    j->used += len;
+}
+
+static void json_printf(http_json_t *j, const char *fmt, ...)
+{
+    char tmp[48];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(tmp, sizeof(tmp), fmt, args);
+    va_end(args);
+    if (len > 0)
+    {
+        json_write(j, tmp, ((size_t)len < sizeof(tmp)) ? (size_t)len : sizeof(tmp) - 1);
+    }
+}
+
+static void json_string(http_json_t *j, const char *s)
+{
+    json_write(j, "\"", 1);
+    const char *run = s;
+    for (; *s != '\0'; ++s)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        json_write(j, run, (size_t)(s - run));
+        run = s + 1;
+        switch (c)
+        {
+        case '"':
+            json_write(j, "\\\"", 2);
+            break;
+        case '\\':
+            json_write(j, "\\\\", 2);
+            break;
+        case '\n':
+            json_write(j, "\\n", 2);
+            break;
+        default:
+            json_printf(j, "\\u%04x", c);
+            break;
+        }
+    }
+    json_write(j, run, (size_t)(s - run));
+    json_write(j, "\"", 1);
+}
+
+static void json_key(http_json_t *j, const char *key)
+{
+    if (!j->first)
+    {
+        json_write(j, ",", 1);
+    }
+    j->first = false;
+    if (key != NULL)
+    {
+        json_string(j, key);
+        json_write(j, ":", 1);
+    }
+}
+
+static void json_begin(http_json_t *j, const char *key, char open)
+{
+    json_key(j, key);
+    json_write(j, &open, 1);
+    j->first = true;
+}
+
+static void json_end(http_json_t *j, char close)
+{
+    json_write(j, &close, 1);
+    j->first = false;
+}
+
+static void json_str(http_json_t *j, const char *key, const char *value)
+{
+    json_key(j, key);
+    json_string(j, value);
+}
+
+static void json_int(http_json_t *j, const char *key, long value)
+{
+    json_key(j, key);
+    json_printf(j, "%ld", value);
+}
+
+static void json_bool(http_json_t *j, const char *key, bool value)
+{
+    json_key(j, key);
+    json_write(j, value ? "true" : "false", value ? 4 : 5);
+}
+
+static void json_x10(http_json_t *j, const char *key, long value_x10)
+{
+    json_key(j, key);
+    long whole = value_x10 / 10;
+    long frac = labs(value_x10 % 10);
+    json_printf(j, "%s%ld.%ld", (value_x10 < 0 && whole == 0) ? "-" : "", whole, frac);
+}
+
+static void json_age(http_json_t *j, const char *key, uint32_t stamp_ms, uint32_t now_ms)
+{
+    if (stamp_ms == 0)
+    {
+        json_key(j, key);
+        json_write(j, "null", 4);
+        return;
+    }
+    json_int(j, key, (long)(now_ms - stamp_ms));
+}
+
+static void http_write_state(http_json_t *j, const http_snapshot_t *snap)
+{
+    const app_state_t *app = &snap->app;
+
+    json_begin(j, NULL, '{');
+    json_int(j, "seq", (long)app->seq);
+    json_int(j, "age_ms", (long)(http_now_ms() - snap->taken_ms));
+    json_str(j, "view", app_view_name(app->view));
+    json_int(j, "forecast_page", app->forecast_page);
+    json_int(j, "location", app->location_index);
+    json_int(j, "locations", app->location_count);
+    json_bool(j, "has_weather", app->has_weather);
+    json_str(j, "time", app->time_text);
+    json_str(j, "now_time", app->now_time_text);
+    json_str(j, "status", app->status_text);
+    json_str(j, "temp", app->temp_text);
+    json_str(j, "condition", app->condition_text);
+    json_str(j, "weather", app->weather_text);
+    json_int(j, "icon", app->now_icon);
+
+    json_begin(j, "stats", '[');
+    json_str(j, NULL, app->stats_line_1);
+    json_str(j, NULL, app->stats_line_2);
+    json_str(j, NULL, app->stats_line_3);
+    json_end(j, ']');
+
+    json_begin(j, "indoor", '[');
+    json_str(j, NULL, app->indoor_line_1);
+    json_str(j, NULL, app->indoor_line_2);
+    json_str(j, NULL, app->indoor_line_3);
+    json_end(j, ']');
+
+    json_begin(j, "forecast", '{');
+    json_str(j, "title", app->forecast_title_text);
+    json_str(j, "body", app->forecast_body_text);
+    json_str(j, "preview_text", app->forecast_preview_text);
+    json_begin(j, "preview", '[');
+    for (int i = 0; i < app->forecast_preview_count && i < APP_PREVIEW_DAYS; ++i)
+    {
+        json_begin(j, NULL, '{');
+        json_str(j, "day", app->forecast_preview_day[i]);
+        json_str(j, "hi", app->forecast_preview_hi[i]);
+        json_str(j, "low", app->forecast_preview_low[i]);
+        json_int(j, "icon", app->forecast_preview_icon[i]);
+        json_end(j, '}');
+    }
+    json_end(j, ']');
+    json_begin(j, "rows", '[');
+    for (int i = 0; i < app->forecast_row_count && i < APP_FORECAST_ROWS; ++i)
+    {
+        json_begin(j, NULL, '{');
+        json_str(j, "title", app->forecast_row_title[i]);
+        json_str(j, "detail", app->forecast_row_detail[i]);
+        json_str(j, "temp", app->forecast_row_temp[i]);
+        json_int(j, "icon", app->forecast_row_icon[i]);
+        json_end(j, '}');
+    }
+    json_end(j, ']');
+    json_begin(j, "hourly", '{');
+    json_bool(j, "open", app->forecast_hourly_open);
+    if (app->forecast_hourly_open)
+    {
+        json_int(j, "day", app->forecast_hourly_day);
+        json_int(j, "start", app->forecast_hourly_start);
+        json_int(j, "count", app->forecast_hourly_count);
+        // [wday, local hour, temp, feels, wind mph, icon] per slot
+        json_begin(j, "items", '[');
+        for (int i = 0; i < app->forecast_hourly_count && i < APP_FORECAST_SLOTS; ++i)
+        {
+            const drawing_hourly_item_t *item = &app->forecast_hourly_items[i];
+            json_begin(j, NULL, '[');
+            json_int(j, NULL, item->wday);
+            json_int(j, NULL, item->hour);
+            json_int(j, NULL, item->temp_f);
+            json_int(j, NULL, item->feels_f);
+            json_int(j, NULL, item->wind_mph);
+            json_int(j, NULL, item->icon);
+            json_end(j, ']');
+        }
+        json_end(j, ']');
+    }
+    json_end(j, '}');
+    json_end(j, '}');
+
+    json_str(j, "radar", app->radar_text);
+    json_str(j, "bottom", app->bottom_text);
+    json_str(j, "battery", app->battery_text);
+    json_begin(j, "wifi", '{');
+    json_bool(j, "connected", snap->wifi_connected);
+    json_age(j, "connected_for_ms", snap->wifi_connected ? snap->wifi_connected_ms : 0, http_now_ms());
+    json_end(j, '}');
+    json_end(j, '}');
+}
+
+static void http_write_indoor(http_json_t *j, const http_snapshot_t *snap)
+{
+    const app_state_t *app = &snap->app;
+
+    json_begin(j, NULL, '{');
+    json_int(j, "uptime_s", (long)(http_now_ms() / 1000U));
+    json_int(j, "period_s", APP_INDOOR_HISTORY_PERIOD_MS / 1000);
+    json_begin(j, "now", '[');
+    json_str(j, NULL, app->indoor_line_1);
+    json_str(j, NULL, app->indoor_line_2);
+    json_str(j, NULL, app->indoor_line_3);
+    json_end(j, ']');
+
+    // Oldest first
+    json_begin(j, "samples", '[');
+    int start = (app->indoor_history_head + APP_INDOOR_HISTORY_LEN - app->indoor_history_count) % APP_INDOOR_HISTORY_LEN;
+    for (int i = 0; i < app->indoor_history_count; ++i)
+    {
+        const app_indoor_sample_t *sample = &app->indoor_history[(start + i) % APP_INDOOR_HISTORY_LEN];
+        json_begin(j, NULL, '{');
+        json_int(j, "t", (long)sample->uptime_s);
+        json_x10(j, "temp_f", sample->temp_f_x10);
+        json_x10(j, "rh", sample->humidity_x10);
+        json_x10(j, "hpa", sample->pressure_hpa_x10);
+        json_end(j, '}');
+    }
+    json_end(j, ']');
+    json_end(j, '}');
+}
+
+static void http_write_i2c(http_json_t *j, const http_snapshot_t *snap)
+{
+    const app_state_t *app = &snap->app;
+
+    json_begin(j, NULL, '{');
+    json_age(j, "scan_age_ms", app->i2c_scan_ms, http_now_ms());
+    json_int(j, "count", app->i2c_found_count);
+    json_begin(j, "addresses", '[');
+    for (int addr = 0; addr < 128; ++addr)
+    {
+        if (app->i2c_found_map[addr >> 3] & (1U << (addr & 7)))
+        {
+            json_int(j, NULL, addr);
+        }
+    }
+    json_end(j, ']');
+    json_bool(j, "bme280", bsp_bme280_is_available());
+    bsp_i2c_topology_t topo = {};
+    bsp_i2c_topology_get(&topo);
+    json_int(j, "rounds", (long)topo.rounds);
+    json_int(j, "full_scans", (long)topo.full_scans);
+    json_int(j, "probes", (long)topo.probes);
+    json_int(j, "probe_ms", (long)(topo.probe_us / 1000));
+    json_end(j, '}');
+}
+
+static void http_write_wifi(http_json_t *j, const http_snapshot_t *snap)
+{
+    const app_state_t *app = &snap->app;
+
+    json_begin(j, NULL, '{');
+    json_bool(j, "connected", snap->wifi_connected);
+    json_age(j, "scan_age_ms", app->wifi_scan_ms, http_now_ms());
+    json_int(j, "total", app->wifi_ap_total);
+    json_begin(j, "aps", '[');
+    for (int i = 0; i < app->wifi_ap_count; ++i)
+    {
+        const app_wifi_ap_t *ap = &app->wifi_aps[i];
+        char bssid[18];
+        snprintf(bssid, sizeof(bssid), MACSTR, MAC2STR(ap->bssid));
+        json_begin(j, NULL, '{');
+        json_str(j, "ssid", ap->ssid);
+        json_str(j, "bssid", bssid);
+        json_int(j, "rssi", ap->rssi);
+        json_int(j, "channel", ap->channel);
+        json_str(j, "auth", app_wifi_auth_mode_name(ap->authmode));
+        json_age(j, "seen_age_ms", ap->seen_ms, http_now_ms());
+        json_end(j, '}');
+    }
+    json_end(j, ']');
+
+    bsp_wifi_survey_stats_t survey = {};
+    bsp_wifi_survey_channel_t channels[BSP_WIFI_SURVEY_CHANNELS];
+    bsp_wifi_survey_get_stats(&survey);
+    bsp_wifi_survey_get_channels(channels);
+    json_begin(j, "survey", '{');
+    json_int(j, "scans", (long)survey.scans);
+    json_int(j, "skipped", (long)survey.skipped);
+    json_int(j, "sweeps", (long)survey.sweeps);
+    json_int(j, "evicted", (long)survey.evicted);
+    json_end(j, '}');
+    json_begin(j, "channels", '[');
+    for (int i = 0; i < BSP_WIFI_SURVEY_CHANNELS; ++i)
+    {
+        json_begin(j, NULL, '{');
+        json_int(j, "channel", channels[i].channel);
+        json_int(j, "aps", channels[i].ap_count);
+        json_int(j, "max_rssi", channels[i].max_rssi);
+        json_begin(j, "history", '[');
+        for (int k = 0; k < channels[i].history_len; ++k)
+        {
+            json_int(j, NULL, channels[i].history[k]);
+        }
+        json_end(j, ']');
+        json_end(j, '}');
+    }
+    json_end(j, ']');
+    json_end(j, '}');
+}
+
+static int http_cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void http_write_perf(http_json_t *j, const http_snapshot_t *snap)
+{
+    json_begin(j, NULL, '{');
+    json_int(j, "uptime_s", (long)(esp_timer_get_time() / 1000000));
+
+    json_begin(j, "heap", '{');
+    json_int(j, "internal_free", (long)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    json_int(j, "internal_min", (long)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    json_int(j, "internal_largest", (long)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    json_int(j, "psram_free", (long)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    json_int(j, "psram_min", (long)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+    json_end(j, '}');
+
+    json_begin(j, "power", '{');
+    json_str(j, "profile", app_power_profile_name(app_power_profile()));
+    json_int(j, "mode", app_power_mode());
+    json_end(j, '}');
+
+    lvgl_port_stats_t lvgl = {};
+    lvgl_port_get_stats(&lvgl);
+    json_begin(j, "lvgl", '{');
+    json_int(j, "passes", (long)lvgl.passes);
+    json_int(j, "wakes", (long)lvgl.wakes);
+    json_int(j, "idle_waits", (long)lvgl.idle_waits);
+    json_int(j, "busy_ms", (long)(lvgl.busy_us / 1000));
+    json_end(j, '}');
+
+    lvgl_port_mem_stats_t lvmem = {};
+    lvgl_port_mem_get_stats(&lvmem);
+    json_begin(j, "lvgl_mem", '{');
+    json_int(j, "allocs", (long)lvmem.allocs);
+    json_int(j, "frees", (long)lvmem.frees);
+    json_int(j, "reallocs", (long)lvmem.reallocs);
+    json_int(j, "moves", (long)lvmem.moves);
+    json_int(j, "spills", (long)lvmem.spills);
+    json_int(j, "fallbacks", (long)lvmem.fallbacks);
+    json_int(j, "failures", (long)lvmem.failures);
+    const lvgl_port_mem_pool_stats_t *pools[2] = {&lvmem.hot, &lvmem.bulk};
+    const char *pool_names[2] = {"hot", "bulk"};
+    for (int i = 0; i < 2; ++i)
+    {
+        json_begin(j, pool_names[i], '{');
+        json_int(j, "size", (long)pools[i]->size);
+        json_int(j, "used", (long)pools[i]->used);
+        json_int(j, "peak", (long)pools[i]->peak);
+        json_int(j, "largest_free", (long)pools[i]->largest_free);
+        json_int(j, "blocks", (long)pools[i]->blocks);
+        json_int(j, "frag_pct", (long)pools[i]->frag_pct);
+        json_end(j, '}');
+    }
+    json_end(j, '}');
+
+    json_begin(j, "static_layers", '{');
+    json_int(j, "renders", (long)snap->layers.renders);
+    json_int(j, "restores", (long)snap->layers.restores);
+    json_int(j, "render_us_last", (long)snap->layers.render_us_last);
+    json_int(j, "render_us_max", (long)snap->layers.render_us_max);
+    json_int(j, "restore_us_last", (long)snap->layers.restore_us_last);
+    json_int(j, "restore_us_max", (long)snap->layers.restore_us_max);
+    json_int(j, "cache_bytes", (long)snap->layers.cache_bytes);
+    json_end(j, '}');
+
+    json_begin(j, "slides", '{');
+    json_int(j, "done", (long)snap->slide.slides);
+    json_int(j, "cancelled", (long)snap->slide.cancels);
+    json_int(j, "prepare_ms_last", (long)snap->slide.prepare_ms_last);
+    json_int(j, "settle_ms_last", (long)snap->slide.settle_ms_last);
+    json_int(j, "frames_last", (long)snap->slide.frames_last);
+    json_int(j, "fps_last", (long)snap->slide.fps_last);
+    json_int(j, "fps_min", (long)snap->slide.fps_min);
+    json_int(j, "frame_ms_max", (long)snap->slide.frame_ms_max);
+    json_int(j, "surface_bytes", (long)snap->slide.surface_bytes);
+    json_end(j, '}');
+
+    json_begin(j, "icon_anim", '{');
+    json_bool(j, "running", snap->icon.running);
+    json_int(j, "frames", (long)snap->icon.frames);
+    json_int(j, "budget_us", (long)snap->icon.budget_us);
+    json_int(j, "over_budget", (long)snap->icon.over_budget);
+    json_int(j, "apply_us_last", (long)snap->icon.apply_us_last);
+    json_int(j, "apply_us_avg", (long)snap->icon.apply_us_avg);
+    json_int(j, "apply_us_max", (long)snap->icon.apply_us_max);
+    json_int(j, "flush_bytes_last", (long)snap->icon.flush_bytes_last);
+    json_int(j, "flush_bytes_max", (long)snap->icon.flush_bytes_max);
+    json_int(j, "build_us_last", (long)snap->icon.build_us_last);
+    json_int(j, "delta_bytes", (long)snap->icon.delta_bytes);
+    json_end(j, '}');
+
+    json_begin(j, "labels", '{');
+    json_int(j, "applied", (long)snap->labels.applied);
+    json_int(j, "skipped", (long)snap->labels.skipped);
+    json_int(j, "set_us_avg", (long)snap->labels.set_us_avg);
+    // What the skipped updates would have cost at the measured average
+    json_int(j, "saved_ms_est", (long)((uint64_t)snap->labels.skipped * snap->labels.set_us_avg / 1000));
+    json_int(j, "render_us_last", (long)snap->labels.render_us_last);
+    json_int(j, "render_us_avg", (long)snap->labels.render_us_avg);
+    json_int(j, "render_us_max", (long)snap->labels.render_us_max);
+    json_end(j, '}');
+
+    json_begin(j, "radar", '{');
+    json_int(j, "tiles", (long)snap->radar_tiles);
+    json_int(j, "fetch_to_pixel_avg_ms", (long)snap->radar_avg_ms);
+    json_int(j, "fetch_to_pixel_max_ms", (long)snap->radar_max_ms);
+    json_int(j, "cache_bytes", (long)snap->radar_cache_bytes);
+    json_end(j, '}');
+
+    bsp_i2c_dev_stats_t i2c[BSP_I2C_MAX_DEVICES];
+    uint32_t i2c_recoveries = 0;
+    size_t i2c_count = bsp_i2c_get_stats(i2c, BSP_I2C_MAX_DEVICES, &i2c_recoveries);
+    json_begin(j, "i2c", '{');
+    json_int(j, "recoveries", (long)i2c_recoveries);
+    json_begin(j, "devices", '[');
+    for (size_t i = 0; i < i2c_count; ++i)
+    {
+        json_begin(j, NULL, '{');
+        json_str(j, "name", i2c[i].name);
+        json_int(j, "addr", i2c[i].addr);
+        json_int(j, "khz", (long)(i2c[i].speed_hz / 1000));
+        json_int(j, "transfers", (long)i2c[i].transfers);
+        json_int(j, "errors", (long)i2c[i].errors);
+        json_int(j, "bytes", (long)i2c[i].bytes);
+        json_int(j, "bus_ms", (long)(i2c[i].bus_us / 1000));
+        json_end(j, '}');
+    }
+    json_end(j, ']');
+    json_end(j, '}');
+
+    bsp_wifi_stats_t wifi = {};
+    bsp_wifi_get_stats(&wifi);
+    json_begin(j, "wifi", '{');
+    json_bool(j, "connected", wifi.connected);
+    json_bool(j, "fast", wifi.fast);
+    json_bool(j, "lease_reused", wifi.lease_reused);
+    json_int(j, "channel", wifi.channel);
+    json_int(j, "connects", (long)wifi.connects);
+    json_int(j, "disconnects", (long)wifi.disconnects);
+    json_int(j, "retries", (long)wifi.retries);
+    json_int(j, "connect_errors", (long)wifi.connect_errors);
+    json_int(j, "fast_attempts", (long)wifi.fast_attempts);
+    json_int(j, "fast_fallbacks", (long)wifi.fast_fallbacks);
+    json_int(j, "cold_connect_ms", (long)wifi.cold_connect_ms);
+    json_int(j, "assoc_ms", (long)wifi.last_assoc_ms);
+    json_int(j, "dhcp_ms", (long)wifi.last_ip_ms);
+    json_int(j, "recovery_ms", (long)wifi.last_recovery_ms);
+    json_int(j, "recovery_max_ms", (long)wifi.max_recovery_ms);
+    json_int(j, "last_reason", wifi.last_reason);
+    json_end(j, '}');
+
+    json_begin(j, "weather", '{');
+    json_int(j, "feeds", (long)snap->wx_feeds);
+    json_int(j, "fetches", (long)snap->wx_fetches);
+    json_int(j, "coalesced", (long)snap->wx_coalesced);
+    json_int(j, "budget_waits", (long)snap->wx_budget_waits);
+    json_end(j, '}');
+
+    app_mqtt_stats_t mqtt = {};
+    app_mqtt_stats(&mqtt);
+    json_begin(j, "mqtt", '{');
+    json_bool(j, "enabled", mqtt.enabled);
+    json_bool(j, "connected", mqtt.connected);
+    json_int(j, "reconnects", (long)mqtt.reconnects);
+    json_int(j, "published", (long)mqtt.published);
+    json_int(j, "published_bytes", (long)mqtt.published_bytes);
+    json_int(j, "resent", (long)mqtt.resent);
+    json_int(j, "dropped", (long)mqtt.dropped);
+    json_int(j, "queued", (long)mqtt.queued);
+    json_int(j, "inflight", (long)mqtt.inflight);
+    json_int(j, "outbox_used", (long)mqtt.outbox_used);
+    json_int(j, "outbox_size", (long)mqtt.outbox_size);
+    json_int(j, "ack_avg_ms", (long)mqtt.ack_avg_ms);
+    json_int(j, "ack_max_ms", (long)mqtt.ack_max_ms);
+    json_end(j, '}');
+
+    // Server-side time from handler entry to the body handed to the socket,
+    // over the last APP_HTTP_LATENCY_SAMPLES requests.
+    json_begin(j, "http", '{');
+    json_int(j, "requests", (long)s_requests);
+    json_int(j, "errors", (long)s_errors);
+    json_begin(j, "latency", '[');
+    for (size_t e = 0; e < sizeof(HTTP_ENDPOINTS) / sizeof(HTTP_ENDPOINTS[0]); ++e)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < s_latency_count; ++i)
+        {
+            if (s_latency[i].endpoint == e)
+            {
+                s_latency_scratch[n++] = s_latency[i].us;
+            }
+        }
+        if (n == 0)
+        {
+            continue;
+        }
+        qsort(s_latency_scratch, n, sizeof(s_latency_scratch[0]), http_cmp_u32);
+        json_begin(j, NULL, '{');
+        json_str(j, "uri", HTTP_ENDPOINTS[e].uri);
+        json_int(j, "samples", (long)n);
+        json_x10(j, "p50_ms", (long)(s_latency_scratch[n / 2] / 100U));
+        json_x10(j, "p99_ms", (long)(s_latency_scratch[(n * 99) / 100] / 100U));
+        json_x10(j, "max_ms", (long)(s_latency_scratch[n - 1] / 100U));
+        json_end(j, '}');
+    }
+    json_end(j, ']');
+    json_end(j, '}');
+    json_end(j, '}');
+}
+
+static esp_err_t http_json_handler(httpd_req_t *req)
+{
+    int64_t start_us = esp_timer_get_time();
+    const http_endpoint_t *endpoint = (const http_endpoint_t *)req->user_ctx;
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    http_json_t j = {};
+    j.err = ESP_OK;
+    j.first = true;
+    // Only the serialisation runs under the lock; a slow socket must not hold it
+    xSemaphoreTake(s_snap_lock, portMAX_DELAY);
+    endpoint->writer(&j, s_snap);
+    xSemaphoreGive(s_snap_lock);
+    json_write(&j, "\n", 1);
+    if (j.err == ESP_OK)
+    {
+        j.err = httpd_resp_send(req, j.buf, (ssize_t)j.used);
+    }
+    else
+    {
+        ESP_LOGW(APP_TAG, "http: %s: no memory for the response (%u bytes so far)", endpoint->uri, (unsigned)j.used);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "out of memory");
+    }
+    heap_caps_free(j.buf);
+
+    http_note_request((int)(endpoint - HTTP_ENDPOINTS), start_us, j.err);
+    return j.err;
+}
+
+static void http_put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void http_put_le32(uint8_t *p, uint32_t v)
+{
+    http_put_le16(p, (uint16_t)v);
+    http_put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+// Top-down 16-bit BI_BITFIELDS bitmap: the canvas rows only need a byte swap, no colour conversion
+static esp_err_t http_screen_bmp_handler(httpd_req_t *req)
+{
+    int64_t start_us = esp_timer_get_time();
+    int w = 0;
+    int h = 0;
+    bool ready = false;
+    if (lvgl_lock_with_retry(pdMS_TO_TICKS(100), 3, "reading canvas size"))
+    {
+        ready = drawing_screen_canvas_size(&w, &h);
+        lvgl_port_unlock();
+    }
+    if (!ready)
+    {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "canvas not ready", HTTPD_RESP_USE_STRLEN);
+        http_note_request(HTTP_ENDPOINT_SCREEN, start_us, ESP_FAIL);
+        return ESP_OK;
+    }
+
+    size_t row_pixels_bytes = (size_t)w * 2;
+    size_t row_bytes = (row_pixels_bytes + 3) & ~(size_t)3;
+    size_t stripe_bytes = row_bytes * APP_HTTP_BMP_STRIPE_ROWS;
+    uint8_t *stripe = (uint8_t *)heap_caps_malloc(stripe_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (stripe == NULL)
+    {
+        stripe = (uint8_t *)heap_caps_malloc(stripe_bytes, MALLOC_CAP_SPIRAM);
+    }
+    if (stripe == NULL)
+    {
+        httpd_resp_send_500(req);
+        http_note_request(HTTP_ENDPOINT_SCREEN, start_us, ESP_ERR_NO_MEM);
+        return ESP_OK;
+    }
+
+    uint8_t header[66] = {};
+    uint32_t image_bytes = (uint32_t)(row_bytes * (size_t)h);
+    header[0] = 'B';
+    header[1] = 'M';
+    http_put_le32(&header[2], sizeof(header) + image_bytes);
+    http_put_le32(&header[10], sizeof(header));
+    http_put_le32(&header[14], 40);
+    http_put_le32(&header[18], (uint32_t)w);
+    http_put_le32(&header[22], (uint32_t)-h);
+    http_put_le16(&header[26], 1);
+    http_put_le16(&header[28], 16);
+    http_put_le32(&header[30], 3);
+    http_put_le32(&header[34], image_bytes);
+    http_put_le32(&header[38], 2835);
+    http_put_le32(&header[42], 2835);
+    http_put_le32(&header[54], 0xF800);
+    http_put_le32(&header[58], 0x07E0);
+    http_put_le32(&header[62], 0x001F);
+
+    httpd_resp_set_type(req, "image/bmp");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    esp_err_t err = httpd_resp_send_chunk(req, (const char *)header, sizeof(header));
+
+    // The LVGL lock is only held for the copy of each stripe, never across a socket write
+    for (int y = 0; y < h && err == ESP_OK; y += APP_HTTP_BMP_STRIPE_ROWS)
+    {
+        int rows = 0;
+        if (lvgl_lock_with_retry(pdMS_TO_TICKS(100), 3, "copying canvas rows"))
+        {
+            rows = drawing_screen_canvas_copy_rows(y, APP_HTTP_BMP_STRIPE_ROWS, (uint16_t *)stripe);
+            lvgl_port_unlock();
+        }
+        if (rows <= 0)
+        {
+            err = ESP_FAIL;
+            break;
+        }
+#if LV_COLOR_16_SWAP
+        pixconv_rgb565_byteswap(stripe, stripe, (size_t)rows * (size_t)w);
+#endif
+        if (row_bytes != row_pixels_bytes)
+        {
+            for (int r = rows - 1; r >= 0; --r)
+            {
+                memmove(stripe + (size_t)r * row_bytes, stripe + (size_t)r * row_pixels_bytes, row_pixels_bytes);
+                memset(stripe + (size_t)r * row_bytes + row_pixels_bytes, 0, row_bytes - row_pixels_bytes);
+            }
+        }
+        err = httpd_resp_send_chunk(req, (const char *)stripe, (ssize_t)((size_t)rows * row_bytes));
+    }
+    if (err == ESP_OK)
+    {
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    heap_caps_free(stripe);
+
+    http_note_request(HTTP_ENDPOINT_SCREEN, start_us, err);
+    return err;
+}
+
+static esp_err_t http_index_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_sendstr_chunk(req, "weather display status server\n\n");
+    for (size_t i = 0; i < sizeof(HTTP_ENDPOINTS) / sizeof(HTTP_ENDPOINTS[0]); ++i)
+    {
+        httpd_resp_sendstr_chunk(req, HTTP_ENDPOINTS[i].uri);
+        httpd_resp_sendstr_chunk(req, "\n");
+    }
+    return httpd_resp_sendstr_chunk(req, NULL);
+}
+
+// A response is several small writes (headers, chunk framing, body); with Nagle on,
+// the tail waits for the client's delayed ACK and shows up as a ~40 ms p99 step.
+static esp_err_t http_on_open(httpd_handle_t hd, int sockfd)
+{
+    (void)hd;
+    int one = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return ESP_OK;
+}
+
+esp_err_t app_http_server_start(void)
+{
+    if (s_server != NULL)
+    {
+        return ESP_OK;
+    }
+
+    if (s_snap == NULL)
+    {
+        s_snap = (http_snapshot_t *)heap_caps_calloc(1, sizeof(*s_snap), MALLOC_CAP_SPIRAM);
+        s_snap_lock = xSemaphoreCreateMutex();
+        if (s_snap == NULL || s_snap_lock == NULL)
+        {
+            ESP_LOGE(APP_TAG, "http: no memory for the state snapshot");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = HTTP_SERVER_PORT_LOCAL;
+    config.max_open_sockets = APP_HTTP_MAX_SOCKETS;
+    config.max_uri_handlers = sizeof(HTTP_ENDPOINTS) / sizeof(HTTP_ENDPOINTS[0]) + 1;
+    config.stack_size = APP_HTTP_TASK_STACK;
+    // Below the UI and LVGL tasks, on the core they do not use
+    config.task_priority = 2;
+    config.core_id = 0;
+    config.lru_purge_enable = true;
+    config.open_fn = http_on_open;
+
+    esp_err_t err = httpd_start(&s_server, &config);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(APP_TAG, "http: start failed: %s", esp_err_to_name(err));
+        s_server = NULL;
+        return err;
+    }
+
+    httpd_uri_t uri = {};
+    uri.method = HTTP_GET;
+    uri.uri = "/";
+    uri.handler = http_index_handler;
+    httpd_register_uri_handler(s_server, &uri);
+    for (size_t i = 0; i < sizeof(HTTP_ENDPOINTS) / sizeof(HTTP_ENDPOINTS[0]); ++i)
+    {
+        uri.uri = HTTP_ENDPOINTS[i].uri;
+        uri.handler = (HTTP_ENDPOINTS[i].writer != NULL) ? http_json_handler : http_screen_bmp_handler;
+        uri.user_ctx = (void *)&HTTP_ENDPOINTS[i];
+        httpd_register_uri_handler(s_server, &uri);
+    }
+
+    s_snap_seq = g_app.seq - 1;
+    ESP_LOGI(APP_TAG, "http: status server on port %d", (int)config.server_port);
+    return ESP_OK;
+}
+
+void app_http_server_publish(uint32_t now_ms)
+{
+    if (s_server == NULL)
+    {
+        return;
+    }
+    if (s_snap_seq == g_app.seq && (uint32_t)(now_ms - s_snap_ms) < APP_HTTP_SNAPSHOT_MAX_AGE_MS)
+    {
+        return;
+    }
+
+    // The slide and icon animations update their counters from the LVGL task
+    drawing_screen_layer_stats_t layers = {};
+    drawing_screen_slide_stats_t slide = {};
+    drawing_screen_icon_anim_stats_t icon = {};
+    drawing_screen_label_stats_t labels = {};
+    if (!lvgl_port_lock(5))
+    {
+        return;
+    }
+    drawing_screen_layer_stats(&layers);
+    drawing_screen_slide_stats(&slide);
+    drawing_screen_icon_anim_stats(&icon);
+    drawing_screen_label_stats(&labels);
+    lvgl_port_unlock();
+
+    // A response is being serialised from the snapshot; try again next tick
+    if (xSemaphoreTake(s_snap_lock, 0) != pdTRUE)
+    {
+        return;
+    }
+    memcpy(&s_snap->app, &g_app, sizeof(g_app));
+    s_snap->wifi_connected = g_wifi_connected;
+    s_snap->wifi_connected_ms = g_wifi_connected_ms;
+    s_snap->taken_ms = now_ms;
+    s_snap->layers = layers;
+    s_snap->slide = slide;
+    s_snap->icon = icon;
+    s_snap->labels = labels;
+    app_radar_stats(&s_snap->radar_tiles, &s_snap->radar_avg_ms, &s_snap->radar_max_ms, &s_snap->radar_cache_bytes);
+    app_locations_stats(&s_snap->wx_feeds, &s_snap->wx_fetches, &s_snap->wx_coalesced, &s_snap->wx_budget_waits);
+    xSemaphoreGive(s_snap_lock);
+
+    s_snap_seq = g_app.seq;
+    s_snap_ms = now_ms;
+}
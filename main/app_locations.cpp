@@ -0,0 +1,490 @@
+#include "app_priv.h"
+
+#include <ctype.h>
+
+#include "esp_heap_caps.h"
+#include "freertos/semphr.h"
+
+// One feed per distinct query. Locations whose queries normalise to the same key
+// share a feed, so they cost one fetch and one cache slot. Feeds live in PSRAM and
+// hold the last good parse, so switching location is a copy out of the cache.
+typedef struct
+{
+    char query[APP_WEATHER_QUERY_MAX_LEN + 1];
+    char key[APP_WEATHER_QUERY_MAX_LEN + 1];
+    weather_payload_t wx;
+    forecast_payload_t fc;
+    bool has_data;     // wx valid
+    bool has_forecast; // fc valid, possibly restored from NVS or from an earlier fetch
+    uint32_t fetched_ms;
+    // weather_task only
+    uint32_t next_due_ms;
+    uint8_t failures;
+} weather_feed_t;
+
+typedef struct
+{
+    int8_t feed;
+    bool ok;          // current conditions fetched
+    bool forecast_ok; // forecast fetched too; error says why not
+    char error[64];
+} weather_result_t;
+
+// Shared with the fetch task, guarded by s_lock. The task only writes the feed it
+// was asked for, and only while s_in_flight is set.
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static weather_feed_t *s_feeds = NULL;
+static int8_t s_request = -1;
+static weather_result_t s_result = {};
+static volatile bool s_result_ready = false;
+
+// weather_task only
+static uint8_t s_feed_count = 0;
+static uint8_t s_location_count = 0;
+static uint8_t s_location_feed[APP_LOCATION_MAX] = {};
+static uint8_t s_active = 0;
+static bool s_in_flight = false;
+static uint32_t s_budget = 0; // API calls x1000, refilled at APP_WEATHER_CALLS_PER_MIN
+static uint32_t s_budget_ms = 0;
+static bool s_budget_blocked = false;
+static uint32_t s_clock_hold_until_ms = 0;
+static uint32_t s_rotate_ms = 0;
+static uint32_t s_fetches = 0;
+static uint32_t s_coalesced = 0;
+static uint32_t s_budget_waits = 0;
+static bool s_persisted = false;
+static uint32_t s_persisted_ms = 0;
+
+// Each refresh is a current-weather call plus a forecast call
+#define WEATHER_CALLS_PER_FETCH 2
+
+// Lower case, trimmed, no blanks around the separators: "q=Saint Charles, US" and
+// "q=saint charles,US" are one feed.
+static void locations_normalise(const char *query, char *out, size_t out_size)
+{
+    size_t n = 0;
+    const char *p = query;
+    while (*p != '\0' && isspace((unsigned char)*p))
+    {
+        ++p;
+    }
+    for (; *p != '\0' && n + 1 < out_size; ++p)
+    {
+        char c = (char)tolower((unsigned char)*p);
+        if (isspace((unsigned char)c))
+        {
+            const char *next = p;
+            while (*next != '\0' && isspace((unsigned char)*next))
+            {
+                ++next;
+            }
+            bool at_sep = (n > 0 && strchr(",=&", out[n - 1]) != NULL) || *next == '\0' || strchr(",=&", *next) != NULL;
+            p = next - 1;
+            if (at_sep)
+            {
+                continue;
+            }
+            c = ' ';
+        }
+        out[n++] = c;
+    }
+    out[n] = '\0';
+}
+
+// FNV-1a of the normalised query, tags the NVS forecast cache
+static uint32_t locations_key_hash(const char *key)
+{
+    uint32_t hash = 2166136261U;
+    for (const char *p = key; *p != '\0'; ++p)
+    {
+        hash = (hash ^ (uint8_t)*p) * 16777619U;
+    }
+    return hash;
+}
+
+static void weather_fetch_task(void *arg)
+{
+    (void)arg;
+    weather_payload_t *wx = (weather_payload_t *)heap_caps_malloc(sizeof(weather_payload_t), MALLOC_CAP_SPIRAM);
+    forecast_payload_t *fc = (forecast_payload_t *)heap_caps_malloc(sizeof(forecast_payload_t), MALLOC_CAP_SPIRAM);
+    if (wx == NULL || fc == NULL)
+    {
+        ESP_LOGE(APP_TAG, "weather: no memory for the fetch task");
+        heap_caps_free(wx);
+        heap_caps_free(fc);
+        s_task = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    esp_http_client_handle_t client = NULL;
+    char query[APP_WEATHER_QUERY_MAX_LEN + 1];
+    while (true)
+    {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(APP_WEATHER_IDLE_CLOSE_MS)) == 0)
+        {
+            if (client != NULL)
+            {
+                esp_http_client_cleanup(client);
+                client = NULL;
+            }
+            continue;
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        int8_t feed = s_request;
+        if (feed >= 0)
+        {
+            snprintf(query, sizeof(query), "%s", s_feeds[feed].query);
+        }
+        xSemaphoreGive(s_lock);
+        if (feed < 0)
+        {
+            continue;
+        }
+
+        weather_result_t result = {};
+        result.feed = feed;
+        result.ok = weather_fetch_query(&client, query, wx, fc, &result.forecast_ok, result.error, sizeof(result.error));
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (result.ok)
+        {
+            s_feeds[feed].wx = *wx;
+            s_feeds[feed].has_data = true;
+            s_feeds[feed].fetched_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+        }
+        // A failed forecast call keeps the feed's previous forecast
+        if (result.forecast_ok)
+        {
+            s_feeds[feed].fc = *fc;
+            s_feeds[feed].has_forecast = true;
+        }
+        s_result = result;
+        s_request = -1;
+        xSemaphoreGive(s_lock);
+        s_result_ready = true;
+    }
+}
+
+static void locations_show_active(void)
+{
+    weather_feed_t *feed = &s_feeds[s_location_feed[s_active]];
+    g_app.location_index = s_active;
+    g_app.location_count = s_location_count;
+
+    // Current conditions and forecast are cached separately: either can be missing
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool has_data = feed->has_data;
+    bool has_forecast = feed->has_forecast;
+    if (has_data)
+    {
+        app_apply_weather(&feed->wx);
+    }
+    if (has_forecast)
+    {
+        app_apply_forecast_payload(&feed->fc);
+    }
+    xSemaphoreGive(s_lock);
+
+    if (!has_data)
+    {
+        g_app.has_weather = false;
+        snprintf(g_app.temp_text, sizeof(g_app.temp_text), "--\xC2\xB0" "F");
+        snprintf(g_app.condition_text, sizeof(g_app.condition_text), "Waiting for weather");
+        snprintf(g_app.weather_text, sizeof(g_app.weather_text), "%s", feed->query);
+        snprintf(g_app.stats_line_1, sizeof(g_app.stats_line_1), "Feels --");
+        snprintf(g_app.stats_line_2, sizeof(g_app.stats_line_2), "Humidity --");
+        snprintf(g_app.stats_line_3, sizeof(g_app.stats_line_3), "Pressure --");
+    }
+    if (!has_forecast)
+    {
+        app_set_forecast_placeholders();
+    }
+    if (!has_data || !has_forecast)
+    {
+        app_mark_dirty(false, true, true, false);
+    }
+
+    if (s_location_count > 1)
+    {
+        size_t len = strlen(g_app.weather_text);
+        snprintf(g_app.weather_text + len, sizeof(g_app.weather_text) - len, "  %u/%u",
+                 (unsigned)(s_active + 1), (unsigned)s_location_count);
+    }
+}
+
+static void locations_collect_result(uint32_t now_ms)
+{
+    if (!s_result_ready)
+    {
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    weather_result_t result = s_result;
+    s_result_ready = false;
+    xSemaphoreGive(s_lock);
+    s_in_flight = false;
+
+    weather_feed_t *feed = &s_feeds[result.feed];
+    // Status and bottom lines belong to the location on screen; other feeds only log
+    bool active = (result.feed == s_location_feed[s_active]);
+    if (result.ok)
+    {
+        if (active)
+        {
+            locations_show_active();
+        }
+        // The outdoor MQTT topic follows the primary location
+        if (result.feed == s_location_feed[0])
+        {
+            app_mqtt_note_weather(&feed->wx);
+        }
+    }
+    if (result.ok && result.forecast_ok)
+    {
+        feed->failures = 0;
+        feed->next_due_ms = app_power_align_deadline(now_ms + WEATHER_REFRESH_MS);
+        s_fetches++;
+        if (result.feed == s_location_feed[0])
+        {
+            // No fetch is in flight here, so the feed is stable without the lock
+            if (!s_persisted || (uint32_t)(now_ms - s_persisted_ms) >= APP_FORECAST_PERSIST_MS)
+            {
+                esp_err_t err = app_config_save_forecast_cache(locations_key_hash(feed->key), &feed->fc);
+                if (err != ESP_OK)
+                {
+                    ESP_LOGW(APP_TAG, "weather: forecast cache save failed: %s", esp_err_to_name(err));
+                }
+                s_persisted = true;
+                s_persisted_ms = now_ms;
+            }
+        }
+        if (active)
+        {
+            app_set_status_fmt("sync: ok %s %s", feed->wx.city, feed->wx.country);
+            app_set_bottom_fmt("next sync in %u min", (unsigned)(WEATHER_REFRESH_MS / 60000));
+        }
+        return;
+    }
+
+    // Back off per feed so one bad query does not eat the shared budget. A failed
+    // forecast call retries the whole refresh; the current conditions are already applied.
+    if (feed->failures < 3)
+    {
+        feed->failures++;
+    }
+    uint32_t retry_ms = (uint32_t)WEATHER_RETRY_MS << (feed->failures - 1);
+    feed->next_due_ms = app_power_align_deadline(now_ms + retry_ms);
+    if (!active)
+    {
+        ESP_LOGW(APP_TAG, "weather: '%s' %s, retry in %u s", feed->query, result.error, (unsigned)(retry_ms / 1000));
+        return;
+    }
+    app_set_status_fmt("%s", result.error);
+    app_set_bottom_fmt(result.ok ? "forecast retry in %u s" : "retry in %u s", (unsigned)(retry_ms / 1000));
+    if (!feed->has_data)
+    {
+        snprintf(g_app.weather_text, sizeof(g_app.weather_text), "%s", result.error);
+        app_mark_dirty(false, true, false, false);
+    }
+}
+
+static int locations_pick_due(uint32_t now_ms)
+{
+    uint8_t active_feed = s_location_feed[s_active];
+    if ((int32_t)(now_ms - s_feeds[active_feed].next_due_ms) >= 0)
+    {
+        return active_feed;
+    }
+
+    int best = -1;
+    for (uint8_t i = 0; i < s_feed_count; ++i)
+    {
+        if ((int32_t)(now_ms - s_feeds[i].next_due_ms) < 0)
+        {
+            continue;
+        }
+        if (best < 0 || (int32_t)(s_feeds[i].next_due_ms - s_feeds[best].next_due_ms) < 0)
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void locations_rotate(uint32_t now_ms)
+{
+    uint16_t rotate_s = app_config_location_rotate_s();
+    if (rotate_s == 0 || s_location_count < 2 || app_power_display_dark() || g_touch_swipe.pressed ||
+        g_app.forecast_hourly_open)
+    {
+        s_rotate_ms = now_ms;
+        return;
+    }
+    if ((uint32_t)(now_ms - s_rotate_ms) >= (uint32_t)rotate_s * 1000U)
+    {
+        app_locations_step(1, now_ms);
+    }
+}
+
+void app_locations_init(void)
+{
+    if (s_feeds != NULL)
+    {
+        return;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    s_feeds = (weather_feed_t *)heap_caps_calloc(APP_LOCATION_MAX, sizeof(weather_feed_t), MALLOC_CAP_SPIRAM);
+    if (s_lock == NULL || s_feeds == NULL ||
+        xTaskCreate(weather_fetch_task, "weather_fetch", APP_WEATHER_TASK_STACK, NULL, 2, &s_task) != pdPASS)
+    {
+        ESP_LOGE(APP_TAG, "weather: location cache init failed");
+        heap_caps_free(s_feeds);
+        s_feeds = NULL;
+        return;
+    }
+
+    uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+    s_location_count = app_config_location_count();
+    for (uint8_t i = 0; i < s_location_count; ++i)
+    {
+        const char *query = app_config_location_query(i);
+        char key[APP_WEATHER_QUERY_MAX_LEN + 1];
+        locations_normalise(query, key, sizeof(key));
+
+        uint8_t f = 0;
+        while (f < s_feed_count && strcmp(s_feeds[f].key, key) != 0)
+        {
+            ++f;
+        }
+        if (f == s_feed_count)
+        {
+            weather_feed_t *feed = &s_feeds[s_feed_count++];
+            snprintf(feed->query, sizeof(feed->query), "%s", query);
+            snprintf(feed->key, sizeof(feed->key), "%s", key);
+            // Staggered first fetch; refreshes then keep the spacing
+            feed->next_due_ms = now_ms + (uint32_t)f * APP_WEATHER_STAGGER_MS;
+        }
+        else
+        {
+            s_coalesced++;
+        }
+        s_location_feed[i] = f;
+    }
+
+    // Last forecast for location 1 from NVS, shown until the first fetch lands
+    weather_feed_t *primary = &s_feeds[s_location_feed[0]];
+    if (s_location_count > 0 && app_config_load_forecast_cache(locations_key_hash(primary->key), &primary->fc))
+    {
+        primary->has_forecast = true;
+        app_apply_forecast_payload(&primary->fc);
+        ESP_LOGI(APP_TAG, "weather: restored %u-day forecast from NVS", (unsigned)primary->fc.day_count);
+    }
+
+    s_budget = APP_WEATHER_CALLS_PER_MIN * 1000U;
+    s_budget_ms = now_ms;
+    s_rotate_ms = now_ms;
+    g_app.location_index = 0;
+    g_app.location_count = s_location_count;
+    ESP_LOGI(APP_TAG, "weather: %u location(s), %u feed(s), %u B cache (%u B forecast each)",
+             (unsigned)s_location_count, (unsigned)s_feed_count, (unsigned)(APP_LOCATION_MAX * sizeof(weather_feed_t)),
+             (unsigned)sizeof(forecast_payload_t));
+}
+
+void app_locations_poll(uint32_t now_ms, bool online)
+{
+    if (s_feeds == NULL)
+    {
+        return;
+    }
+
+    locations_collect_result(now_ms);
+    locations_rotate(now_ms);
+
+    s_budget += (now_ms - s_budget_ms) * APP_WEATHER_CALLS_PER_MIN / 60U;
+    if (s_budget > APP_WEATHER_CALLS_PER_MIN * 1000U)
+    {
+        s_budget = APP_WEATHER_CALLS_PER_MIN * 1000U;
+    }
+    s_budget_ms = now_ms;
+
+    if (!online || s_in_flight || (int32_t)(now_ms - s_clock_hold_until_ms) < 0)
+    {
+        return;
+    }
+
+    int feed = locations_pick_due(now_ms);
+    if (feed < 0)
+    {
+        return;
+    }
+
+    char local_time[16] = {0};
+    if (!app_format_local_time(local_time, sizeof(local_time)))
+    {
+        app_set_status_fmt("time: waiting for NTP");
+        app_set_bottom_fmt("HTTPS blocked until clock sync");
+        s_clock_hold_until_ms = app_power_align_deadline(now_ms + 10000);
+        return;
+    }
+
+    if (s_budget < WEATHER_CALLS_PER_FETCH * 1000U)
+    {
+        if (!s_budget_blocked)
+        {
+            s_budget_blocked = true;
+            s_budget_waits++;
+            ESP_LOGW(APP_TAG, "weather: API budget (%u calls/min) exhausted, deferring '%s'",
+                     (unsigned)APP_WEATHER_CALLS_PER_MIN, s_feeds[feed].query);
+        }
+        return;
+    }
+    s_budget_blocked = false;
+    s_budget -= WEATHER_CALLS_PER_FETCH * 1000U;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_request = (int8_t)feed;
+    xSemaphoreGive(s_lock);
+    s_in_flight = true;
+    xTaskNotifyGive(s_task);
+
+    if (feed == s_location_feed[s_active])
+    {
+        app_set_status_fmt("https: GET weather (%s)", s_feeds[feed].query);
+        app_set_bottom_fmt("fetching current conditions...");
+    }
+}
+
+void app_locations_step(int dir, uint32_t now_ms)
+{
+    if (s_feeds == NULL || s_location_count < 2)
+    {
+        return;
+    }
+
+    s_active = (uint8_t)((s_active + s_location_count + (dir < 0 ? -1 : 1)) % s_location_count);
+    s_rotate_ms = now_ms;
+
+    weather_feed_t *feed = &s_feeds[s_location_feed[s_active]];
+    if (!feed->has_data && feed->failures == 0)
+    {
+        // Never fetched yet: jump the stagger queue (the fetch itself stays in the background)
+        feed->next_due_ms = now_ms;
+    }
+    locations_show_active();
+    ESP_LOGI(APP_TAG, "weather: location %u/%u %s%s", (unsigned)(s_active + 1), (unsigned)s_location_count,
+             feed->query, feed->has_data ? "" : " (not cached yet)");
+}
+
+// weather_task only, like every other writer of these counters
+void app_locations_stats(uint8_t *feeds, uint32_t *fetches, uint32_t *coalesced, uint32_t *budget_waits)
+{
+    *feeds = s_feed_count;
+    *fetches = s_fetches;
+    *coalesced = s_coalesced;
+    *budget_waits = s_budget_waits;
+}
@@ -0,0 +1,631 @@
+#include "app_priv.h"
+
+#include "freertos/queue.h"
+
+#include "esp_heap_caps.h"
+#include "esp_mac.h"
+#include "mqtt_client.h"
+
+// Messages wait in a PSRAM byte ring until the client is connected and under the
+// inflight and rate limits, then are handed to esp-mqtt one by one. A Wi-Fi drop only
+// stops the hand-off; the ring keeps filling and evicts oldest-first when full.
+// All outbox state belongs to weather_task. The MQTT task just posts events into
+// s_events, so nothing here runs while the client holds its own API lock.
+typedef enum
+{
+    MQTT_TOPIC_INDOOR = 0,
+    MQTT_TOPIC_OUTDOOR,
+    MQTT_TOPIC_STATUS,
+} mqtt_topic_t;
+
+static const char *MQTT_TOPIC_SUFFIX[] = {"indoor", "outdoor", "status"};
+
+typedef enum
+{
+    MQTT_MSG_DONE = 0, // delivered or superseded, bytes reclaimed once it reaches the head
+    MQTT_MSG_PENDING,
+    MQTT_MSG_INFLIGHT,
+} mqtt_msg_state_t;
+
+typedef struct
+{
+    uint32_t offset;
+    uint16_t len;
+    uint8_t topic;
+    uint8_t state;
+    int msg_id;
+    uint32_t sent_ms;
+} mqtt_msg_t;
+
+typedef struct
+{
+    int32_t id;
+    int msg_id;
+} mqtt_event_t;
+
+static esp_mqtt_client_handle_t s_client = NULL;
+static QueueHandle_t s_events = NULL;
+static volatile bool s_connected = false;
+static bool s_ever_connected = false;
+static bool s_link_up = false;
+static char s_status_topic[APP_MQTT_TOPIC_MAX_LEN + 8];
+
+static uint8_t *s_ring = NULL;
+static size_t s_ring_size = 0;
+static size_t s_ring_tail = 0;
+static mqtt_msg_t s_msgs[APP_MQTT_OUTBOX_SLOTS];
+static uint16_t s_msg_head = 0;
+static uint16_t s_msg_count = 0;
+static uint16_t s_inflight = 0;
+static char *s_scratch = NULL;
+
+// Token bucket in 1/1000 message units, refilled at rate_per_s, one second of burst
+static uint32_t s_credit = 0;
+static uint32_t s_credit_ms = 0;
+
+static app_indoor_sample_t s_batch[APP_MQTT_BATCH_MAX];
+static uint16_t s_batch_count = 0;
+static uint32_t s_batch_start_ms = 0;
+
+static app_mqtt_stats_t s_stats = {};
+static uint32_t s_ack_sum_ms = 0;
+static uint32_t s_ack_count = 0;
+
+// Copy of the counters and outbox fill for other tasks (httpd), refreshed by weather_task
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static app_mqtt_stats_t s_stats_published = {};
+
+typedef struct
+{
+    char *buf;
+    size_t len;
+    bool overflow;
+} mqtt_text_t;
+
+static void mqtt_appendf(mqtt_text_t *t, const char *fmt, ...)
+{
+    if (t->overflow)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(t->buf + t->len, APP_MQTT_PAYLOAD_MAX - t->len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= APP_MQTT_PAYLOAD_MAX - t->len)
+    {
+        t->overflow = true;
+        return;
+    }
+    t->len += (size_t)n;
+}
+
+static void mqtt_append_str(mqtt_text_t *t, const char *key, const char *value)
+{
+    mqtt_appendf(t, "\"%s\":\"", key);
+    for (const char *p = value; *p != '\0' && !t->overflow; ++p)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\')
+        {
+            mqtt_appendf(t, "\\%c", c);
+        }
+        else if (c < 0x20)
+        {
+            mqtt_appendf(t, "\\u%04x", c);
+        }
+        else
+        {
+            mqtt_appendf(t, "%c", c);
+        }
+    }
+    mqtt_appendf(t, "\",");
+}
+
+static bool mqtt_ring_fits(size_t len, uint32_t *offset)
+{
+    if (s_msg_count == 0)
+    {
+        s_ring_tail = 0;
+        *offset = 0;
+        return len <= s_ring_size;
+    }
+
+    size_t head = s_msgs[s_msg_head].offset;
+    if (s_ring_tail > head)
+    {
+        // Live bytes are [head, tail): append, or wrap to the front
+        if (s_ring_tail + len <= s_ring_size)
+        {
+            *offset = (uint32_t)s_ring_tail;
+            return true;
+        }
+        if (len <= head)
+        {
+            *offset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // Wrapped: live bytes are [head, size) and [0, tail)
+    if (s_ring_tail + len <= head)
+    {
+        *offset = (uint32_t)s_ring_tail;
+        return true;
+    }
+    return false;
+}
+
+static void mqtt_outbox_pop(void)
+{
+    mqtt_msg_t *m = &s_msgs[s_msg_head];
+    if (m->state == MQTT_MSG_PENDING)
+    {
+        s_stats.dropped++;
+    }
+    else if (m->state == MQTT_MSG_INFLIGHT)
+    {
+        // esp-mqtt still holds its own copy; we just stop tracking it
+        s_inflight--;
+    }
+    s_msg_head = (uint16_t)((s_msg_head + 1) % APP_MQTT_OUTBOX_SLOTS);
+    s_msg_count--;
+}
+
+static void mqtt_outbox_reclaim(void)
+{
+    while (s_msg_count > 0 && s_msgs[s_msg_head].state == MQTT_MSG_DONE)
+    {
+        mqtt_outbox_pop();
+    }
+}
+
+static void mqtt_outbox_push(mqtt_topic_t topic, const char *payload, size_t len)
+{
+    if (s_ring == NULL || len == 0 || len > s_ring_size || len > UINT16_MAX)
+    {
+        s_stats.dropped++;
+        return;
+    }
+
+    // Outdoor and status are retained: only the newest unsent one matters
+    if (topic != MQTT_TOPIC_INDOOR)
+    {
+        for (uint16_t i = 0; i < s_msg_count; ++i)
+        {
+            mqtt_msg_t *m = &s_msgs[(s_msg_head + i) % APP_MQTT_OUTBOX_SLOTS];
+            if (m->topic == topic && m->state == MQTT_MSG_PENDING)
+            {
+                m->state = MQTT_MSG_DONE;
+            }
+        }
+        mqtt_outbox_reclaim();
+    }
+
+    uint32_t offset = 0;
+    while (s_msg_count >= APP_MQTT_OUTBOX_SLOTS || !mqtt_ring_fits(len, &offset))
+    {
+        mqtt_outbox_pop();
+        mqtt_outbox_reclaim();
+    }
+
+    mqtt_msg_t *m = &s_msgs[(s_msg_head + s_msg_count) % APP_MQTT_OUTBOX_SLOTS];
+    memcpy(s_ring + offset, payload, len);
+    m->offset = offset;
+    m->len = (uint16_t)len;
+    m->topic = (uint8_t)topic;
+    m->state = MQTT_MSG_PENDING;
+    m->msg_id = -1;
+    m->sent_ms = 0;
+    s_ring_tail = offset + len;
+    s_msg_count++;
+}
+
+static mqtt_msg_t *mqtt_outbox_find_inflight(int msg_id)
+{
+    for (uint16_t i = 0; i < s_msg_count; ++i)
+    {
+        mqtt_msg_t *m = &s_msgs[(s_msg_head + i) % APP_MQTT_OUTBOX_SLOTS];
+        if (m->state == MQTT_MSG_INFLIGHT && m->msg_id == msg_id)
+        {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+static void mqtt_drain_events(uint32_t now_ms)
+{
+    mqtt_event_t ev = {};
+    while (xQueueReceive(s_events, &ev, 0) == pdTRUE)
+    {
+        if (ev.id == MQTT_EVENT_CONNECTED)
+        {
+            if (s_ever_connected)
+            {
+                s_stats.reconnects++;
+            }
+            s_ever_connected = true;
+            s_link_up = true;
+            ESP_LOGI(APP_TAG, "mqtt: connected, %u queued", (unsigned)s_msg_count);
+            mqtt_outbox_push(MQTT_TOPIC_STATUS, "online", 6);
+            continue;
+        }
+        if (ev.id == MQTT_EVENT_DISCONNECTED)
+        {
+            // Also posted for every failed reconnect attempt; only log the edge
+            if (s_link_up)
+            {
+                ESP_LOGW(APP_TAG, "mqtt: disconnected, %u queued", (unsigned)s_msg_count);
+            }
+            s_link_up = false;
+            continue;
+        }
+
+        mqtt_msg_t *m = mqtt_outbox_find_inflight(ev.msg_id);
+        if (m == NULL)
+        {
+            continue;
+        }
+        s_inflight--;
+        if (ev.id == MQTT_EVENT_PUBLISHED)
+        {
+            uint32_t ack_ms = now_ms - m->sent_ms;
+            s_ack_sum_ms += ack_ms;
+            s_ack_count++;
+            if (ack_ms > s_stats.ack_max_ms)
+            {
+                s_stats.ack_max_ms = ack_ms;
+            }
+            s_stats.published++;
+            s_stats.published_bytes += m->len;
+            m->state = MQTT_MSG_DONE;
+        }
+        else
+        {
+            // MQTT_EVENT_DELETED: esp-mqtt expired it unacknowledged, send it again
+            s_stats.resent++;
+            m->state = MQTT_MSG_PENDING;
+        }
+    }
+    mqtt_outbox_reclaim();
+}
+
+static void mqtt_expire_inflight(uint32_t now_ms)
+{
+    // Covers acks lost to a full event queue or a broker that forgot the session
+    for (uint16_t i = 0; i < s_msg_count && s_inflight > 0; ++i)
+    {
+        mqtt_msg_t *m = &s_msgs[(s_msg_head + i) % APP_MQTT_OUTBOX_SLOTS];
+        if (m->state == MQTT_MSG_INFLIGHT && (uint32_t)(now_ms - m->sent_ms) >= APP_MQTT_INFLIGHT_TIMEOUT_MS)
+        {
+            m->state = MQTT_MSG_PENDING;
+            s_inflight--;
+            s_stats.resent++;
+        }
+    }
+}
+
+static void mqtt_handoff(uint32_t now_ms)
+{
+    const app_mqtt_tuning_t *tuning = app_config_mqtt_tuning();
+    uint32_t burst = (uint32_t)tuning->rate_per_s * 1000U;
+    s_credit += (now_ms - s_credit_ms) * tuning->rate_per_s;
+    if (s_credit > burst)
+    {
+        s_credit = burst;
+    }
+    s_credit_ms = now_ms;
+
+    char topic[APP_MQTT_TOPIC_MAX_LEN + 16];
+    for (uint16_t i = 0; i < s_msg_count && s_inflight < tuning->inflight && s_credit >= 1000U; ++i)
+    {
+        mqtt_msg_t *m = &s_msgs[(s_msg_head + i) % APP_MQTT_OUTBOX_SLOTS];
+        if (m->state != MQTT_MSG_PENDING)
+        {
+            continue;
+        }
+
+        snprintf(topic, sizeof(topic), "%s/%s", app_config_mqtt_topic(), MQTT_TOPIC_SUFFIX[m->topic]);
+        int retain = (m->topic != MQTT_TOPIC_INDOOR) ? 1 : 0;
+        int msg_id = esp_mqtt_client_enqueue(s_client, topic, (const char *)s_ring + m->offset, m->len,
+                                             tuning->qos, retain, true);
+        if (msg_id < 0)
+        {
+            // Client outbox at its limit; retry next tick
+            break;
+        }
+        s_credit -= 1000U;
+
+        if (tuning->qos == 0)
+        {
+            // No ack at QoS 0: once esp-mqtt has it, it is as delivered as it gets
+            s_stats.published++;
+            s_stats.published_bytes += m->len;
+            m->state = MQTT_MSG_DONE;
+            continue;
+        }
+        m->state = MQTT_MSG_INFLIGHT;
+        m->msg_id = msg_id;
+        m->sent_ms = now_ms;
+        s_inflight++;
+    }
+    mqtt_outbox_reclaim();
+}
+
+static void mqtt_flush_batch(uint32_t now_ms)
+{
+    if (s_batch_count == 0)
+    {
+        return;
+    }
+
+    int32_t temp_sum = 0;
+    uint32_t rh_sum = 0;
+    uint32_t hpa_sum = 0;
+    for (uint16_t i = 0; i < s_batch_count; ++i)
+    {
+        temp_sum += s_batch[i].temp_f_x10;
+        rh_sum += s_batch[i].humidity_x10;
+        hpa_sum += s_batch[i].pressure_hpa_x10;
+    }
+
+    // Samples go out as rows of x10 integers; a 60 s window is ~250 bytes
+    mqtt_text_t t = {s_scratch, 0, false};
+    time_t ts = time(NULL);
+    mqtt_appendf(&t, "{\"ts\":%lld,\"uptime_s\":%u,\"window_s\":%u,\"n\":%u,",
+                 (long long)(ts > 1600000000 ? ts : 0), (unsigned)(now_ms / 1000U),
+                 (unsigned)((now_ms - s_batch_start_ms) / 1000U), (unsigned)s_batch_count);
+    mqtt_appendf(&t, "\"avg\":{\"temp_f\":%.1f,\"humidity\":%.1f,\"pressure_hpa\":%.1f},",
+                 temp_sum / 10.0 / s_batch_count, rh_sum / 10.0 / s_batch_count, hpa_sum / 10.0 / s_batch_count);
+    mqtt_appendf(&t, "\"fields\":[\"uptime_s\",\"temp_f_x10\",\"humidity_x10\",\"pressure_hpa_x10\"],\"samples\":[");
+    for (uint16_t i = 0; i < s_batch_count; ++i)
+    {
+        const app_indoor_sample_t *s = &s_batch[i];
+        mqtt_appendf(&t, "%s[%u,%d,%u,%u]", i == 0 ? "" : ",", (unsigned)s->uptime_s, (int)s->temp_f_x10,
+                     (unsigned)s->humidity_x10, (unsigned)s->pressure_hpa_x10);
+    }
+    mqtt_appendf(&t, "]}");
+
+    if (t.overflow)
+    {
+        ESP_LOGW(APP_TAG, "mqtt: indoor batch of %u samples does not fit %u bytes",
+                 (unsigned)s_batch_count, (unsigned)APP_MQTT_PAYLOAD_MAX);
+        s_stats.dropped++;
+    }
+    else
+    {
+        mqtt_outbox_push(MQTT_TOPIC_INDOOR, t.buf, t.len);
+    }
+    s_batch_count = 0;
+}
+
+static void mqtt_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    (void)arg;
+    (void)base;
+    esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)event_data;
+    switch ((esp_mqtt_event_id_t)event_id)
+    {
+    case MQTT_EVENT_CONNECTED:
+        s_connected = true;
+        break;
+    case MQTT_EVENT_DISCONNECTED:
+        s_connected = false;
+        break;
+    case MQTT_EVENT_PUBLISHED:
+    case MQTT_EVENT_DELETED:
+        break;
+    case MQTT_EVENT_ERROR:
+        if (event->error_handle != NULL && event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT)
+        {
+            ESP_LOGW(APP_TAG, "mqtt: transport error %s (errno %d)",
+                     esp_err_to_name(event->error_handle->esp_tls_last_esp_err),
+                     event->error_handle->esp_transport_sock_errno);
+        }
+        return;
+    default:
+        return;
+    }
+
+    // A lost ack is picked up again by the inflight timeout
+    mqtt_event_t ev = {event_id, event->msg_id};
+    xQueueSend(s_events, &ev, 0);
+}
+
+esp_err_t app_mqtt_start(void)
+{
+    if (s_client != NULL)
+    {
+        return ESP_OK;
+    }
+
+    const char *uri = app_config_mqtt_uri();
+    if (uri == NULL || uri[0] == '\0')
+    {
+        ESP_LOGI(APP_TAG, "mqtt: disabled (no broker URI)");
+        return ESP_OK;
+    }
+
+    const app_mqtt_tuning_t *tuning = app_config_mqtt_tuning();
+    if (s_ring == NULL)
+    {
+        s_ring_size = (size_t)tuning->outbox_kb * 1024U;
+        s_ring = (uint8_t *)heap_caps_malloc(s_ring_size, MALLOC_CAP_SPIRAM);
+        s_scratch = (char *)heap_caps_malloc(APP_MQTT_PAYLOAD_MAX, MALLOC_CAP_SPIRAM);
+        s_events = xQueueCreate(APP_MQTT_EVENT_QUEUE_LEN, sizeof(mqtt_event_t));
+        if (s_ring == NULL || s_scratch == NULL || s_events == NULL)
+        {
+            ESP_LOGE(APP_TAG, "mqtt: no memory for a %u KB outbox", (unsigned)tuning->outbox_kb);
+            heap_caps_free(s_ring);
+            heap_caps_free(s_scratch);
+            if (s_events != NULL)
+            {
+                vQueueDelete(s_events);
+            }
+            s_ring = NULL;
+            s_scratch = NULL;
+            s_events = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    uint8_t mac[6] = {0};
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    char client_id[24];
+    snprintf(client_id, sizeof(client_id), "wxdisp-%02x%02x%02x", mac[3], mac[4], mac[5]);
+    snprintf(s_status_topic, sizeof(s_status_topic), "%s/%s", app_config_mqtt_topic(),
+             MQTT_TOPIC_SUFFIX[MQTT_TOPIC_STATUS]);
+
+    esp_mqtt_client_config_t config = {};
+    config.broker.address.uri = uri;
+    if (strncmp(uri, "mqtts://", 8) == 0)
+    {
+        config.broker.verification.crt_bundle_attach = esp_crt_bundle_attach;
+    }
+    config.credentials.client_id = client_id;
+    // One long-lived connection carries every publish, so the TLS handshake is paid
+    // once per (re)connect rather than once per message.
+    config.session.keepalive = APP_MQTT_KEEPALIVE_S;
+    config.session.last_will.topic = s_status_topic;
+    config.session.last_will.msg = "offline";
+    config.session.last_will.qos = 1;
+    config.session.last_will.retain = 1;
+    config.network.reconnect_timeout_ms = 5000;
+    config.network.timeout_ms = 10000;
+    // The PSRAM ring is the outbox of record; esp-mqtt's own copy only needs to hold
+    // what is in flight, plus copies left behind by inflight timeouts.
+    config.outbox.limit = (uint64_t)APP_MQTT_PAYLOAD_MAX * 16U * 2U;
+    config.buffer.out_size = APP_MQTT_PAYLOAD_MAX + 256;
+    config.task.priority = 2;
+    config.task.stack_size = APP_MQTT_TASK_STACK;
+
+    s_client = esp_mqtt_client_init(&config);
+    if (s_client == NULL)
+    {
+        ESP_LOGE(APP_TAG, "mqtt: client init failed");
+        return ESP_FAIL;
+    }
+    esp_mqtt_client_register_event(s_client, MQTT_EVENT_ANY, mqtt_event_handler, NULL);
+    esp_err_t err = esp_mqtt_client_start(s_client);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(APP_TAG, "mqtt: start failed: %s", esp_err_to_name(err));
+        esp_mqtt_client_destroy(s_client);
+        s_client = NULL;
+        return err;
+    }
+
+    s_credit_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+    s_stats.enabled = true;
+    ESP_LOGI(APP_TAG, "mqtt: %s as %s, topics %s/*, outbox %u KB", uri, client_id, app_config_mqtt_topic(),
+             (unsigned)tuning->outbox_kb);
+    return ESP_OK;
+}
+
+// End of each poll: httpd reads this copy instead of the live outbox
+static void mqtt_publish_stats(void)
+{
+    app_mqtt_stats_t snap = s_stats;
+    snap.connected = s_connected;
+    snap.queued = s_msg_count;
+    snap.inflight = s_inflight;
+    snap.outbox_size = s_ring_size;
+    snap.ack_avg_ms = (s_ack_count > 0) ? s_ack_sum_ms / s_ack_count : 0;
+    if (s_msg_count > 0)
+    {
+        size_t head = s_msgs[s_msg_head].offset;
+        snap.outbox_used = (s_ring_tail > head) ? s_ring_tail - head : s_ring_size - head + s_ring_tail;
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats_published = snap;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+void app_mqtt_poll(uint32_t now_ms)
+{
+    if (s_client == NULL)
+    {
+        return;
+    }
+
+    mqtt_drain_events(now_ms);
+    if (s_batch_count > 0 &&
+        (uint32_t)(now_ms - s_batch_start_ms) >= (uint32_t)app_config_mqtt_tuning()->window_s * 1000U)
+    {
+        mqtt_flush_batch(now_ms);
+    }
+    mqtt_expire_inflight(now_ms);
+    if (s_connected)
+    {
+        mqtt_handoff(now_ms);
+    }
+    else
+    {
+        s_credit_ms = now_ms;
+    }
+    mqtt_publish_stats();
+}
+
+void app_mqtt_note_indoor(const bsp_bme280_data_t *indoor, uint32_t now_ms)
+{
+    if (s_client == NULL || indoor == NULL)
+    {
+        return;
+    }
+
+    // Close a due window before this sample so each batch spans window_s, not window_s + period
+    const uint32_t window_ms = (uint32_t)app_config_mqtt_tuning()->window_s * 1000U;
+    if (s_batch_count > 0 && (uint32_t)(now_ms - s_batch_start_ms) >= window_ms)
+    {
+        mqtt_flush_batch(now_ms);
+    }
+    if (s_batch_count == 0)
+    {
+        s_batch_start_ms = now_ms;
+    }
+    app_indoor_sample_t *sample = &s_batch[s_batch_count++];
+    sample->uptime_s = now_ms / 1000U;
+    sample->temp_f_x10 = (int16_t)lroundf(indoor->temperature_f * 10.0f);
+    sample->humidity_x10 = (uint16_t)lroundf(indoor->humidity_pct * 10.0f);
+    sample->pressure_hpa_x10 = (uint16_t)lroundf(indoor->pressure_hpa * 10.0f);
+    if (s_batch_count >= APP_MQTT_BATCH_MAX)
+    {
+        mqtt_flush_batch(now_ms);
+    }
+}
+
+void app_mqtt_note_weather(const weather_payload_t *wx)
+{
+    if (s_client == NULL || wx == NULL)
+    {
+        return;
+    }
+
+    mqtt_text_t t = {s_scratch, 0, false};
+    time_t ts = time(NULL);
+    mqtt_appendf(&t, "{\"ts\":%lld,", (long long)(ts > 1600000000 ? ts : 0));
+    mqtt_append_str(&t, "city", wx->city);
+    mqtt_append_str(&t, "country", wx->country);
+    mqtt_append_str(&t, "condition", wx->condition);
+    mqtt_appendf(&t, "\"temp_f\":%.1f,\"feels_f\":%.1f,\"wind_mph\":%.1f,\"humidity\":%d,\"pressure_hpa\":%d,\"icon\":%d}",
+                 wx->temp_f, wx->feels_f, wx->wind_mph, wx->humidity, wx->pressure_hpa, (int)wx->icon);
+    if (!t.overflow)
+    {
+        mqtt_outbox_push(MQTT_TOPIC_OUTDOOR, t.buf, t.len);
+    }
+}
+
+void app_mqtt_stats(app_mqtt_stats_t *out)
+{
+    if (out == NULL)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats_published;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
@@ -0,0 +1,231 @@
+#include "app_priv.h"
+
+#include <stdlib.h>
+
+#include "esp_timer.h"
+
+#include "bsp_qmi8658.h"
+
+typedef struct
+{
+    bool pending;
+    lv_disp_rot_t rotation;
+    int64_t first_seen_us; // candidate first classified
+    int64_t detect_us;     // dwell satisfied, request posted
+} app_orientation_request_t;
+
+// The detector task posts requests; weather_task (which also owns touch polling and
+// rendering) consumes them, so the display, touch mapping and swipe state always
+// change together between two loop iterations.
+static portMUX_TYPE s_orientation_lock = portMUX_INITIALIZER_UNLOCKED;
+static app_orientation_request_t s_request = {};
+static lv_disp_rot_t s_rotation = EXAMPLE_DISPLAY_ROTATION;
+static uint32_t s_changes = 0;
+static uint32_t s_max_latency_ms = 0;
+static uint32_t s_over_target = 0;
+
+static bool app_orientation_is_landscape(lv_disp_rot_t rotation)
+{
+    return rotation == LV_DISP_ROT_90 || rotation == LV_DISP_ROT_270;
+}
+
+// The drawing layer lays out one fixed canvas, so only the rotation that keeps the
+// boot aspect (the 180-degree flip) is offered; the metrics stay valid across it.
+static bool app_orientation_fits_layout(lv_disp_rot_t rotation)
+{
+    return app_orientation_is_landscape(rotation) == app_orientation_is_landscape(EXAMPLE_DISPLAY_ROTATION);
+}
+
+// Gravity in mg along the IMU axes -> rotation that keeps "down" at the bottom of
+// the screen. The signs follow how the QMI8658 sits under this panel. Tilts between
+// the enter threshold and the margin, and a flat board, give no decision so the
+// current rotation is kept (hysteresis band around 45 degrees).
+static bool app_orientation_classify(int32_t ax_mg, int32_t ay_mg, int32_t az_mg, lv_disp_rot_t *out)
+{
+    int32_t abs_x = abs(ax_mg);
+    int32_t abs_y = abs(ay_mg);
+    if (abs(az_mg) > APP_ORIENTATION_FLAT_MG)
+    {
+        return false;
+    }
+
+    if (abs_x >= abs_y)
+    {
+        if (abs_x < APP_ORIENTATION_ENTER_MG || abs_x - abs_y < APP_ORIENTATION_MARGIN_MG)
+        {
+            return false;
+        }
+        *out = (ax_mg > 0) ? LV_DISP_ROT_270 : LV_DISP_ROT_90;
+    }
+    else
+    {
+        if (abs_y < APP_ORIENTATION_ENTER_MG || abs_y - abs_x < APP_ORIENTATION_MARGIN_MG)
+        {
+            return false;
+        }
+        *out = (ay_mg > 0) ? LV_DISP_ROT_180 : LV_DISP_ROT_NONE;
+    }
+    return true;
+}
+
+static void app_orientation_task(void *arg)
+{
+    (void)arg;
+    lv_disp_rot_t reported = EXAMPLE_DISPLAY_ROTATION;
+    lv_disp_rot_t candidate = reported;
+    int64_t candidate_since_us = 0;
+    uint32_t last_batch = 0;
+
+    while (true)
+    {
+        vTaskDelay(pdMS_TO_TICKS(app_power_display_dark() ? APP_ORIENTATION_POLL_DARK_MS : APP_ORIENTATION_POLL_MS));
+
+        // The IMU service averages each FIFO batch, which filters hand shake without extra reads
+        bsp_qmi8658_attitude_t att = {};
+        if (!bsp_qmi8658_get_attitude(&att) || att.batches == last_batch)
+        {
+            continue;
+        }
+        last_batch = att.batches;
+        int32_t mg[3] = {att.acc_mg[0], att.acc_mg[1], att.acc_mg[2]};
+
+        lv_disp_rot_t rotation;
+        if (!app_orientation_classify(mg[0], mg[1], mg[2], &rotation) || !app_orientation_fits_layout(rotation) ||
+            rotation == reported)
+        {
+            candidate = reported;
+            continue;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        if (rotation != candidate)
+        {
+            candidate = rotation;
+            candidate_since_us = now_us;
+            continue;
+        }
+        if (now_us - candidate_since_us < (int64_t)APP_ORIENTATION_DWELL_MS * 1000)
+        {
+            continue;
+        }
+
+        reported = rotation;
+        portENTER_CRITICAL(&s_orientation_lock);
+        s_request.pending = true;
+        s_request.rotation = rotation;
+        s_request.first_seen_us = candidate_since_us;
+        s_request.detect_us = now_us;
+        portEXIT_CRITICAL(&s_orientation_lock);
+        ESP_LOGI(APP_TAG, "orientation: detected rot=%d (%ld/%ld/%ld mg, %u frames)", (int)rotation, (long)mg[0],
+                 (long)mg[1], (long)mg[2], (unsigned)att.batch_frames);
+    }
+}
+
+lv_disp_rot_t app_orientation_rotation(void)
+{
+    return s_rotation;
+}
+
+void app_orientation_touch_size(lv_disp_rot_t rotation, uint16_t *width, uint16_t *height)
+{
+    if (app_orientation_is_landscape(rotation))
+    {
+        *width = EXAMPLE_LCD_V_RES;
+        *height = EXAMPLE_LCD_H_RES;
+    }
+    else
+    {
+        *width = EXAMPLE_LCD_H_RES;
+        *height = EXAMPLE_LCD_V_RES;
+    }
+}
+
+void app_orientation_start(void)
+{
+    if (bsp_qmi8658_service_start() != ESP_OK)
+    {
+        ESP_LOGW(APP_TAG, "orientation: IMU service unavailable, auto-rotation disabled");
+        return;
+    }
+    xTaskCreate(app_orientation_task, "orientation", 3072, NULL, 2, NULL);
+}
+
+// Called from weather_task. Display rotation, touch mapping and gesture state are
+// swapped under the LVGL lock, then the screen is refreshed exactly once. While the
+// panel is dark the swap is done without a refresh; waking repaints it anyway.
+void app_orientation_apply_pending(void)
+{
+    app_orientation_request_t req;
+    portENTER_CRITICAL(&s_orientation_lock);
+    req = s_request;
+    s_request.pending = false;
+    portEXIT_CRITICAL(&s_orientation_lock);
+    if (!req.pending || req.rotation == s_rotation)
+    {
+        return;
+    }
+
+    if (!lvgl_lock_with_retry(pdMS_TO_TICKS(100), 3, "rotating display"))
+    {
+        portENTER_CRITICAL(&s_orientation_lock);
+        if (!s_request.pending)
+        {
+            s_request = req;
+        }
+        portEXIT_CRITICAL(&s_orientation_lock);
+        return;
+    }
+
+    bool dark = app_power_display_dark();
+    lv_disp_rot_t previous = s_rotation;
+    esp_err_t err = lvgl_port_set_rotation(lvgl_disp, req.rotation);
+    if (err == ESP_OK)
+    {
+        uint16_t touch_w = 0;
+        uint16_t touch_h = 0;
+        app_orientation_touch_size(req.rotation, &touch_w, &touch_h);
+        bsp_touch_set_rotation(touch_w, touch_h, display_rotation_to_touch_rotation(req.rotation));
+        g_touch_swipe.pressed = false;
+        s_rotation = req.rotation;
+        if (!dark)
+        {
+            lv_refr_now(lvgl_disp);
+        }
+    }
+    lvgl_port_unlock();
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(APP_TAG, "orientation: rotate failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    s_changes++;
+    if (dark)
+    {
+        ESP_LOGI(APP_TAG, "orientation: rot %d -> %d applied while dark", (int)previous, (int)req.rotation);
+        return;
+    }
+
+    int64_t done_us = esp_timer_get_time();
+    uint32_t latency_ms = (uint32_t)((done_us - req.detect_us) / 1000);
+    uint32_t tilt_ms = (uint32_t)((done_us - req.first_seen_us) / 1000);
+    if (latency_ms > s_max_latency_ms)
+    {
+        s_max_latency_ms = latency_ms;
+    }
+    if (latency_ms > APP_ORIENTATION_LATENCY_TARGET_MS)
+    {
+        s_over_target++;
+        ESP_LOGW(APP_TAG, "orientation: rot %d -> %d painted in %lu ms (target %d ms, tilt-to-paint %lu ms)",
+                 (int)previous, (int)req.rotation, (unsigned long)latency_ms, APP_ORIENTATION_LATENCY_TARGET_MS,
+                 (unsigned long)tilt_ms);
+    }
+    else
+    {
+        ESP_LOGI(APP_TAG, "orientation: rot %d -> %d painted in %lu ms (tilt-to-paint %lu ms)", (int)previous,
+                 (int)req.rotation, (unsigned long)latency_ms, (unsigned long)tilt_ms);
+    }
+    ESP_LOGD(APP_TAG, "orientation: %lu changes, max %lu ms, %lu over target", (unsigned long)s_changes,
+             (unsigned long)s_max_latency_ms, (unsigned long)s_over_target);
+}
@@ -0,0 +1,588 @@
+#include "app_priv.h"
+
+#include "esp_pm.h"
+
+#include "bsp_qmi8658.h"
+
+typedef struct
+{
+    uint64_t dwell_ms;
+    uint64_t gauge_ms;
+    int32_t gauge_pct_drop;
+    int32_t vbat_drop_mv;
+} app_power_mode_stats_t;
+
+typedef struct
+{
+    const char *name;
+    int max_freq_mhz;
+    int min_freq_mhz;
+    bool light_sleep;
+    wifi_ps_type_t wifi_ps;
+    uint16_t listen_interval;
+    uint32_t wake_window_ms;
+} app_power_profile_desc_t;
+
+// Light sleep stops the LEDC clock, so it is only allowed while the panel is dark
+// (s_power.awake_lock). Wake windows batch timed jobs while dark so the radio and
+// CPU come up once per window instead of once per job; weather_task itself sleeps
+// from one window to the next (app_power_wait).
+static const app_power_profile_desc_t APP_POWER_PROFILES[APP_POWER_PROFILE_COUNT] = {
+    {"performance", 240, 240, false, WIFI_PS_NONE, 0, 0},
+    {"balanced", 240, 80, true, WIFI_PS_MIN_MODEM, 0, 5000},
+    {"saver", 160, 40, true, WIFI_PS_MAX_MODEM, 10, 15000},
+};
+
+typedef struct
+{
+    app_power_mode_t mode;
+    app_power_profile_t profile;
+    esp_pm_lock_handle_t awake_lock;
+    esp_pm_lock_handle_t console_lock;
+    bool awake_lock_held;
+    uint32_t last_activity_ms;
+    uint32_t mode_entered_ms;
+    uint32_t next_gauge_ms;
+    uint32_t next_stats_log_ms;
+    bool gauge_valid;
+    uint32_t gauge_ms;
+    int gauge_percent;
+    uint16_t gauge_vbat_mv;
+    uint32_t battery_seq;
+    app_power_mode_stats_t stats[APP_POWER_PROFILE_COUNT][APP_POWER_MODE_COUNT];
+} app_power_state_t;
+
+// s_power belongs to weather_task. Other tasks only post a profile request, which
+// app_power_update() applies there.
+static app_power_state_t s_power = {};
+static TaskHandle_t volatile s_power_task = NULL;
+static portMUX_TYPE s_power_request_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_profile_request_pending = false;
+static app_power_profile_t s_profile_request = APP_POWER_PROFILE_DEFAULT;
+
+static const char *app_power_mode_name(app_power_mode_t mode)
+{
+    switch (mode)
+    {
+    case APP_POWER_MODE_ACTIVE:
+        return "active";
+    case APP_POWER_MODE_DIMMED:
+        return "dimmed";
+    case APP_POWER_MODE_DARK:
+        return "dark";
+    default:
+        break;
+    }
+    return "?";
+}
+
+// Charge the battery delta since the previous gauge sample to the mode that was
+// in effect for that span. Spans on USB power are skipped: the gauge only moves
+// with the charger there and says nothing about our own draw. Readings come from
+// the PMU service snapshot, so this never touches I2C.
+static void app_power_sample_gauge(uint32_t now_ms)
+{
+    (void)now_ms;
+    bsp_axp2101_snapshot_t batt = {};
+    if (!bsp_axp2101_get_snapshot(&batt) || batt.updated_ms == s_power.gauge_ms)
+    {
+        return;
+    }
+
+    bool on_battery = batt.battery_present && !batt.vbus_present && batt.battery_percent >= 0;
+    if (!on_battery)
+    {
+        s_power.gauge_valid = false;
+        return;
+    }
+
+    if (s_power.gauge_valid)
+    {
+        app_power_mode_stats_t *st = &s_power.stats[s_power.profile][s_power.mode];
+        st->gauge_ms += (uint32_t)(batt.updated_ms - s_power.gauge_ms);
+        st->gauge_pct_drop += s_power.gauge_percent - batt.battery_percent;
+        st->vbat_drop_mv += (int32_t)s_power.gauge_vbat_mv - (int32_t)batt.vbat_mv;
+    }
+
+    s_power.gauge_valid = true;
+    s_power.gauge_ms = batt.updated_ms;
+    s_power.gauge_percent = batt.battery_percent;
+    s_power.gauge_vbat_mv = batt.vbat_mv;
+}
+
+static void app_power_close_dwell(uint32_t now_ms)
+{
+    s_power.stats[s_power.profile][s_power.mode].dwell_ms += (uint32_t)(now_ms - s_power.mode_entered_ms);
+    s_power.mode_entered_ms = now_ms;
+}
+
+static void app_power_set_awake_lock(bool hold)
+{
+    if (s_power.awake_lock == NULL || hold == s_power.awake_lock_held)
+    {
+        return;
+    }
+    if (hold)
+    {
+        esp_pm_lock_acquire(s_power.awake_lock);
+    }
+    else
+    {
+        esp_pm_lock_release(s_power.awake_lock);
+    }
+    s_power.awake_lock_held = hold;
+}
+
+static void app_power_apply_lvgl_profile(app_power_mode_t mode)
+{
+    if (!lvgl_lock_with_retry(pdMS_TO_TICKS(250), 4, "changing LVGL power profile"))
+    {
+        return;
+    }
+
+    if (mode == APP_POWER_MODE_DARK)
+    {
+        lvgl_port_stop();
+    }
+    else
+    {
+        lvgl_port_set_frame_period((mode == APP_POWER_MODE_ACTIVE) ? LVGL_FRAME_ACTIVE_MS : LVGL_FRAME_DIMMED_MS);
+        // Icon animation only runs at full backlight
+        drawing_screen_icon_anim_enable(mode == APP_POWER_MODE_ACTIVE);
+        if (s_power.mode == APP_POWER_MODE_DARK)
+        {
+            lvgl_port_resume();
+            // Labels changed while dark were only recorded in g_app; repaint everything.
+            lv_obj_invalidate(lv_scr_act());
+        }
+    }
+    lvgl_port_unlock();
+}
+
+static void app_power_enter(app_power_mode_t mode, uint32_t now_ms)
+{
+    if (mode == s_power.mode)
+    {
+        return;
+    }
+
+    app_power_sample_gauge(now_ms);
+    app_power_close_dwell(now_ms);
+
+    app_power_mode_t prev = s_power.mode;
+    switch (mode)
+    {
+    case APP_POWER_MODE_ACTIVE:
+        if (prev == APP_POWER_MODE_DARK)
+        {
+            app_power_set_awake_lock(true);
+            bsp_display_sleep(false);
+            app_power_apply_lvgl_profile(mode);
+            s_power.mode = mode;
+            app_mark_dirty(true, true, true, true);
+            app_render_if_dirty();
+        }
+        else
+        {
+            app_power_apply_lvgl_profile(mode);
+        }
+        bsp_display_fade_brightness(APP_POWER_ACTIVE_BRIGHTNESS, APP_POWER_WAKE_FADE_MS);
+        break;
+    case APP_POWER_MODE_DIMMED:
+        app_power_apply_lvgl_profile(mode);
+        bsp_display_fade_brightness(APP_POWER_DIM_BRIGHTNESS, APP_POWER_FADE_MS);
+        break;
+    case APP_POWER_MODE_DARK:
+        bsp_display_fade_brightness(0, 0);
+        app_power_apply_lvgl_profile(mode);
+        bsp_display_sleep(true);
+        app_power_set_awake_lock(false);
+        break;
+    default:
+        return;
+    }
+
+    s_power.mode = mode;
+    bsp_axp2101_service_set_period((mode == APP_POWER_MODE_ACTIVE) ? APP_PMU_SAMPLE_ACTIVE_MS : APP_PMU_SAMPLE_IDLE_MS);
+    // While dark only orientation needs the IMU; one batch per second (at a reduced ODR) is plenty for that
+    bsp_qmi8658_service_set_period((mode == APP_POWER_MODE_DARK) ? APP_ORIENTATION_POLL_DARK_MS : 0);
+    ESP_LOGI(APP_TAG, "power: %s -> %s (idle %lu s)",
+             app_power_mode_name(prev),
+             app_power_mode_name(mode),
+             (unsigned long)((now_ms - s_power.last_activity_ms) / 1000U));
+}
+
+static esp_err_t app_power_apply_profile(app_power_profile_t profile)
+{
+    uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+    const app_power_profile_desc_t *desc = &APP_POWER_PROFILES[profile];
+
+    // Close out the old profile's books before switching.
+    app_power_sample_gauge(now_ms);
+    app_power_close_dwell(now_ms);
+    s_power.profile = profile;
+
+    esp_pm_config_t pm_cfg = {};
+    pm_cfg.max_freq_mhz = desc->max_freq_mhz;
+    pm_cfg.min_freq_mhz = desc->min_freq_mhz;
+    pm_cfg.light_sleep_enable = desc->light_sleep;
+    esp_err_t err = esp_pm_configure(&pm_cfg);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(APP_TAG, "power: esp_pm_configure failed: %s (is CONFIG_PM_ENABLE set?)", esp_err_to_name(err));
+    }
+
+    bsp_wifi_set_power_save(desc->wifi_ps, desc->listen_interval);
+
+    ESP_LOGI(APP_TAG, "power: profile %s (cpu %d-%d MHz, light sleep %s, wifi ps %d, listen %u, window %lu ms)",
+             desc->name, desc->min_freq_mhz, desc->max_freq_mhz,
+             desc->light_sleep ? "on" : "off",
+             (int)desc->wifi_ps, (unsigned)desc->listen_interval,
+             (unsigned long)desc->wake_window_ms);
+    return err;
+}
+
+void app_power_init(void)
+{
+    uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    memset(&s_power, 0, sizeof(s_power));
+    s_power.mode = APP_POWER_MODE_ACTIVE;
+    s_power.profile = APP_POWER_PROFILE_PERFORMANCE;
+    s_power.last_activity_ms = now_ms;
+    s_power.mode_entered_ms = now_ms;
+    s_power.next_gauge_ms = now_ms;
+    s_power.battery_seq = 0;
+    s_power.next_stats_log_ms = now_ms + APP_POWER_STATS_LOG_MS;
+
+    esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "display", &s_power.awake_lock);
+    if (err == ESP_OK)
+    {
+        err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "console", &s_power.console_lock);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(APP_TAG, "power: PM locks unavailable (%s), light sleep disabled", esp_err_to_name(err));
+    }
+    app_power_set_awake_lock(true);
+
+    app_power_apply_profile(app_config_power_profile());
+}
+
+esp_err_t app_power_set_profile(app_power_profile_t profile)
+{
+    if (profile >= APP_POWER_PROFILE_COUNT)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&s_power_request_lock);
+    s_profile_request = profile;
+    s_profile_request_pending = true;
+    taskEXIT_CRITICAL(&s_power_request_lock);
+
+    // Pull weather_task out of a dark-panel wait so the switch is not held for a window
+    TaskHandle_t task = s_power_task;
+    if (task != NULL)
+    {
+        xTaskNotifyGive(task);
+    }
+    return ESP_OK;
+}
+
+static void app_power_apply_pending_profile(void)
+{
+    bool pending = false;
+    app_power_profile_t profile = APP_POWER_PROFILE_DEFAULT;
+    taskENTER_CRITICAL(&s_power_request_lock);
+    if (s_profile_request_pending)
+    {
+        pending = true;
+        profile = s_profile_request;
+        s_profile_request_pending = false;
+    }
+    taskEXIT_CRITICAL(&s_power_request_lock);
+
+    if (pending && profile != s_power.profile)
+    {
+        app_power_apply_profile(profile);
+    }
+}
+
+app_power_profile_t app_power_profile(void)
+{
+    return s_power.profile;
+}
+
+const char *app_power_profile_name(app_power_profile_t profile)
+{
+    if (profile >= APP_POWER_PROFILE_COUNT)
+    {
+        return "?";
+    }
+    return APP_POWER_PROFILES[profile].name;
+}
+
+bool app_power_profile_from_name(const char *name, app_power_profile_t *out)
+{
+    for (int i = 0; i < APP_POWER_PROFILE_COUNT; ++i)
+    {
+        if (name != NULL && strcmp(name, APP_POWER_PROFILES[i].name) == 0)
+        {
+            *out = (app_power_profile_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void app_power_console_hold(bool hold)
+{
+    if (s_power.console_lock == NULL)
+    {
+        return;
+    }
+    if (hold)
+    {
+        esp_pm_lock_acquire(s_power.console_lock);
+    }
+    else
+    {
+        esp_pm_lock_release(s_power.console_lock);
+    }
+}
+
+uint32_t app_power_align_deadline(uint32_t deadline_ms)
+{
+    uint32_t window_ms = APP_POWER_PROFILES[s_power.profile].wake_window_ms;
+    if (window_ms == 0 || s_power.mode != APP_POWER_MODE_DARK)
+    {
+        return deadline_ms;
+    }
+
+    uint32_t rem = deadline_ms % window_ms;
+    return (rem == 0) ? deadline_ms : (deadline_ms + (window_ms - rem));
+}
+
+bool app_power_note_activity(uint32_t now_ms)
+{
+    s_power.last_activity_ms = now_ms;
+    if (s_power.mode == APP_POWER_MODE_ACTIVE)
+    {
+        return false;
+    }
+
+    bool was_dark = (s_power.mode == APP_POWER_MODE_DARK);
+    app_power_enter(APP_POWER_MODE_ACTIVE, now_ms);
+    return was_dark;
+}
+
+static void app_power_handle_pmu_events(uint32_t now_ms)
+{
+    bsp_pmu_event_t evt = {};
+    while (bsp_axp2101_get_event(&evt, 0))
+    {
+        ESP_LOGI(APP_TAG, "power: pmu event %s", bsp_axp2101_event_name(evt.type));
+        switch (evt.type)
+        {
+        case BSP_PMU_EVENT_VBUS_INSERT:
+            app_set_status_fmt("power: USB connected");
+            app_power_note_activity(now_ms);
+            break;
+        case BSP_PMU_EVENT_VBUS_REMOVE:
+            app_set_status_fmt("power: on battery");
+            app_power_note_activity(now_ms);
+            break;
+        case BSP_PMU_EVENT_CHARGE_DONE:
+            app_set_status_fmt("power: battery full");
+            break;
+        case BSP_PMU_EVENT_LOW_BATTERY:
+            app_set_status_fmt("power: battery low (<%d%%)", BSP_PMU_LOW_BATTERY_WARN_PCT);
+            break;
+        case BSP_PMU_EVENT_CRITICAL_BATTERY:
+            app_set_status_fmt("power: battery critical (<%d%%)", BSP_PMU_LOW_BATTERY_CRIT_PCT);
+            // Not persisted: the saved profile comes back once the board is charged and rebooted.
+            if (s_power.profile != APP_POWER_PROFILE_SAVER)
+            {
+                app_power_apply_profile(APP_POWER_PROFILE_SAVER);
+            }
+            break;
+        case BSP_PMU_EVENT_PKEY_SHORT:
+            app_power_note_activity(now_ms);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void app_power_publish_battery(void)
+{
+    bsp_axp2101_snapshot_t batt = {};
+    if (!bsp_axp2101_get_snapshot(&batt) || batt.seq == s_power.battery_seq)
+    {
+        return;
+    }
+    s_power.battery_seq = batt.seq;
+
+    char text[sizeof(g_app.battery_text)] = {0};
+    if (!batt.battery_present)
+    {
+        snprintf(text, sizeof(text), "Battery: none (USB %u.%02u V)",
+                 (unsigned)(batt.vbus_mv / 1000U), (unsigned)((batt.vbus_mv % 1000U) / 10U));
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "Battery: %d%% %u.%02u V%s",
+                 batt.battery_percent,
+                 (unsigned)(batt.vbat_mv / 1000U), (unsigned)((batt.vbat_mv % 1000U) / 10U),
+                 batt.charging ? " (charging)" : (batt.vbus_present ? " (USB)" : ""));
+    }
+
+    if (strcmp(text, g_app.battery_text) != 0)
+    {
+        snprintf(g_app.battery_text, sizeof(g_app.battery_text), "%s", text);
+        if (g_app.view == DRAWING_SCREEN_VIEW_ABOUT)
+        {
+            app_mark_dirty(false, true, false, false);
+        }
+    }
+}
+
+void app_power_update(uint32_t now_ms)
+{
+    app_power_apply_pending_profile();
+    app_power_handle_pmu_events(now_ms);
+    app_power_publish_battery();
+
+    uint32_t idle_ms = now_ms - s_power.last_activity_ms;
+
+    if (s_power.mode == APP_POWER_MODE_ACTIVE && idle_ms >= APP_POWER_DIM_AFTER_MS)
+    {
+        app_power_enter(APP_POWER_MODE_DIMMED, now_ms);
+    }
+    else if (s_power.mode == APP_POWER_MODE_DIMMED && idle_ms >= APP_POWER_DARK_AFTER_MS)
+    {
+        app_power_enter(APP_POWER_MODE_DARK, now_ms);
+    }
+
+    if ((int32_t)(now_ms - s_power.next_gauge_ms) >= 0)
+    {
+        app_power_sample_gauge(now_ms);
+        s_power.next_gauge_ms = app_power_align_deadline(now_ms + APP_POWER_GAUGE_SAMPLE_MS);
+    }
+
+    if ((int32_t)(now_ms - s_power.next_stats_log_ms) >= 0)
+    {
+        app_power_close_dwell(now_ms);
+        app_power_log_stats();
+        s_power.next_stats_log_ms = now_ms + APP_POWER_STATS_LOG_MS;
+    }
+}
+
+app_power_mode_t app_power_mode(void)
+{
+    return s_power.mode;
+}
+
+bool app_power_display_dark(void)
+{
+    return s_power.mode == APP_POWER_MODE_DARK;
+}
+
+static uint32_t app_power_ui_tick_ms(void)
+{
+    switch (s_power.mode)
+    {
+    case APP_POWER_MODE_DIMMED:
+        return UI_TICK_DIMMED_MS;
+    case APP_POWER_MODE_DARK:
+        return UI_TICK_DARK_MS;
+    case APP_POWER_MODE_ACTIVE:
+    default:
+        return UI_TICK_MS;
+    }
+}
+
+// weather_task's end-of-loop sleep. While dark with a wake window the loop sleeps to
+// the next window boundary, so its timed jobs run once per window. The touch
+// controller has no interrupt line on this board, so the wait itself samples touch
+// every UI_TICK_DARK_MS and returns early on a press; the loop then handles the wake.
+// PMU events (power key, USB) and profile requests notify the task and also end the
+// wait early.
+void app_power_wait(TickType_t *loop_tick)
+{
+    if (s_power_task == NULL)
+    {
+        s_power_task = xTaskGetCurrentTaskHandle();
+        bsp_axp2101_service_set_event_notify(s_power_task);
+    }
+
+    uint32_t window_ms = APP_POWER_PROFILES[s_power.profile].wake_window_ms;
+    if (s_power.mode != APP_POWER_MODE_DARK || window_ms == 0)
+    {
+        vTaskDelayUntil(loop_tick, pdMS_TO_TICKS(app_power_ui_tick_ms()));
+        return;
+    }
+
+    uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint32_t deadline_ms = app_power_align_deadline(now_ms + 1U);
+    while ((int32_t)(deadline_ms - now_ms) > 0)
+    {
+        uint32_t wait_ms = deadline_ms - now_ms;
+        if (wait_ms > UI_TICK_DARK_MS)
+        {
+            wait_ms = UI_TICK_DARK_MS;
+        }
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms)) != 0)
+        {
+            break;
+        }
+        touch_data_t touch = {};
+        bsp_touch_read();
+        if (bsp_touch_get_coordinates(&touch))
+        {
+            break;
+        }
+        now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+    }
+    *loop_tick = xTaskGetTickCount();
+}
+
+void app_power_log_stats(void)
+{
+    for (int p = 0; p < APP_POWER_PROFILE_COUNT; ++p)
+    {
+        for (int i = 0; i < APP_POWER_MODE_COUNT; ++i)
+        {
+            const app_power_mode_stats_t *st = &s_power.stats[p][i];
+            if (st->dwell_ms == 0)
+            {
+                continue;
+            }
+            if (st->gauge_ms < APP_POWER_GAUGE_SAMPLE_MS)
+            {
+                ESP_LOGI(APP_TAG, "power: %-11s %-6s dwell %llu s, no battery samples yet",
+                         app_power_profile_name((app_power_profile_t)p),
+                         app_power_mode_name((app_power_mode_t)i),
+                         (unsigned long long)(st->dwell_ms / 1000U));
+                continue;
+            }
+
+            // The AXP2101 has no current ADC; derive average draw from the fuel gauge
+            // slope against the nominal pack capacity. VBAT slope is logged alongside
+            // since it resolves short spans better than the 1% gauge step.
+            int64_t est_ma = ((int64_t)st->gauge_pct_drop * APP_BATTERY_CAPACITY_MAH * 3600000LL) /
+                             (100LL * (int64_t)st->gauge_ms);
+            int64_t mv_per_hour = ((int64_t)st->vbat_drop_mv * 3600000LL) / (int64_t)st->gauge_ms;
+            ESP_LOGI(APP_TAG, "power: %-11s %-6s dwell %llu s, on-batt %llu s, gauge -%ld%%, vbat %lld mV/h, est %lld mA",
+                     app_power_profile_name((app_power_profile_t)p),
+                     app_power_mode_name((app_power_mode_t)i),
+                     (unsigned long long)(st->dwell_ms / 1000U),
+                     (unsigned long long)(st->gauge_ms / 1000U),
+                     (long)st->gauge_pct_drop,
+                     (long long)-mv_per_hour,
+                     (long long)est_ma);
+        }
+    }
+}
@@ -28,9 +28,12 @@
 #include "bsp_i2c.h"
 #include "bsp_touch.h"
 #include "bsp_wifi.h"
+#include "bsp_wifi_survey.h"
 #include "drawing_screen.h"
 #include "lv_port.h"
+#include "lv_port_mem.h"
 
+// Boot rotation. The IMU may flip it at runtime within the same aspect (see app_orientation.cpp).
 #define EXAMPLE_DISPLAY_ROTATION LV_DISP_ROT_90
 #define EXAMPLE_LCD_H_RES 320
 #define EXAMPLE_LCD_V_RES 480
@@ -47,9 +50,35 @@
 #define NTP_SYNC_POLL_MS 250
 #define BME280_REFRESH_MS 5000
 #define BME280_RETRY_MS 5000
-#define I2C_SCAN_REFRESH_MS 10000
-#define WIFI_SCAN_REFRESH_MS 15000
+#define BME280_REINIT_MS 60000
+#define I2C_TOPOLOGY_PAGE_MS 10000
+#define I2C_TOPOLOGY_IDLE_MS 60000
+#define WIFI_SURVEY_PAGE_STEP_MS 1500   // one channel per step: a full sweep in ~20 s
+#define WIFI_SURVEY_IDLE_STEP_MS 20000
 #define UI_TICK_MS 100
+#define UI_TICK_DIMMED_MS 200
+#define UI_TICK_DARK_MS 300
+
+#define APP_POWER_DIM_AFTER_MS (30 * 1000)
+#define APP_POWER_DARK_AFTER_MS (2 * 60 * 1000)
+#define APP_POWER_ACTIVE_BRIGHTNESS 100
+#define APP_POWER_DIM_BRIGHTNESS 12
+#define APP_POWER_FADE_MS 800
+#define APP_POWER_WAKE_FADE_MS 150
+#define APP_POWER_GAUGE_SAMPLE_MS (60 * 1000)
+#define APP_PMU_SAMPLE_ACTIVE_MS 2000
+#define APP_PMU_SAMPLE_IDLE_MS (30 * 1000)
+#define APP_POWER_STATS_LOG_MS (10 * 60 * 1000)
+#define LVGL_FRAME_ACTIVE_MS 16
+#define LVGL_FRAME_DIMMED_MS 33
+
+#define APP_ORIENTATION_POLL_MS 100
+#define APP_ORIENTATION_POLL_DARK_MS 1000
+#define APP_ORIENTATION_DWELL_MS 400
+#define APP_ORIENTATION_ENTER_MG 700
+#define APP_ORIENTATION_MARGIN_MG 300
+#define APP_ORIENTATION_FLAT_MG 800
+#define APP_ORIENTATION_LATENCY_TARGET_MS 250
 
 #define TOUCH_SWIPE_MIN_X_PX 64
 #define TOUCH_SWIPE_MAX_Y_PX 80
@@ -57,17 +86,68 @@
 #define TOUCH_SWIPE_MAX_X_PX 96
 #define TOUCH_SWIPE_COOLDOWN_MS 300
 #define TOUCH_TAP_MAX_MOVE_PX 18
+#define TOUCH_SLIDE_START_PX 24
+// A finger held still this long before lifting ends a drag without a fling
+#define TOUCH_FLING_HOLD_MS 80
 
 #define APP_FORECAST_ROWS DRAWING_SCREEN_FORECAST_ROWS
 #define APP_PREVIEW_DAYS 3
 #define APP_FORECAST_MAX_DAYS 8
-#define APP_FORECAST_HOURLY_MAX 12
+#define APP_FORECAST_SLOTS 40 // OWM 5 day / 3 hour forecast
+#define APP_FORECAST_CACHE_VERSION 1
+#define APP_FORECAST_PERSIST_MS (3 * 60 * 60 * 1000)
 #define APP_WIFI_SCAN_MAX_APS 12
 #define APP_WIFI_SCAN_VISIBLE_APS 8
 #define APP_WIFI_SSID_MAX_LEN 32
 #define APP_WIFI_PASS_MAX_LEN 64
 #define APP_WEATHER_API_KEY_MAX_LEN 96
 #define APP_WEATHER_QUERY_MAX_LEN 96
+#define APP_RADAR_URL_MAX_LEN 160
+#define APP_LOCATION_MAX 6
+#define APP_LOCATION_LIST_MAX_LEN ((APP_LOCATION_MAX - 1) * (APP_WEATHER_QUERY_MAX_LEN + 1))
+
+#define APP_WEATHER_CALLS_PER_MIN 20
+#define APP_WEATHER_STAGGER_MS 5000
+#define APP_WEATHER_IDLE_CLOSE_MS 30000
+#define APP_WEATHER_TASK_STACK 12288
+
+#define APP_RADAR_CACHE_SLOTS 24
+#define APP_RADAR_CACHE_BUDGET_BYTES (1024 * 1024)
+#define APP_RADAR_TILE_MAX_BYTES (96 * 1024)
+#define APP_RADAR_MAX_VISIBLE 12
+#define APP_RADAR_FRAME_PERIOD_S 600
+#define APP_RADAR_FRAME_LAG_S 600
+#define APP_RADAR_HTTP_TIMEOUT_MS 8000
+#define APP_RADAR_RETRY_MS 10000
+#define APP_RADAR_IDLE_CLOSE_MS 30000
+#define APP_RADAR_TASK_STACK 8192
+#define APP_RADAR_EDGE_SWIPE_PX 40
+#define APP_RADAR_PAN_MIN_PX 4
+
+#define APP_INDOOR_HISTORY_LEN 96
+#define APP_INDOOR_HISTORY_PERIOD_MS (5 * 60 * 1000)
+
+#define APP_HTTP_MAX_SOCKETS 6
+#define APP_HTTP_TASK_STACK 6144
+#define APP_HTTP_JSON_BUF_BYTES 4096
+#define APP_HTTP_BMP_STRIPE_ROWS 16
+#define APP_HTTP_LATENCY_SAMPLES 256
+#define APP_HTTP_SNAPSHOT_MAX_AGE_MS 1000
+
+#define APP_MQTT_URI_MAX_LEN 128
+#define APP_MQTT_TOPIC_MAX_LEN 64
+#define APP_MQTT_OUTBOX_SLOTS 64
+#define APP_MQTT_BATCH_MAX 128
+#define APP_MQTT_PAYLOAD_MAX 4096
+#define APP_MQTT_EVENT_QUEUE_LEN 32
+#define APP_MQTT_INFLIGHT_TIMEOUT_MS (30 * 1000)
+#define APP_MQTT_KEEPALIVE_S 60
+#define APP_MQTT_TASK_STACK 6144
+#define APP_MQTT_WINDOW_S_DEFAULT 60
+#define APP_MQTT_OUTBOX_KB_DEFAULT 64
+#define APP_MQTT_RATE_DEFAULT 5
+#define APP_MQTT_INFLIGHT_DEFAULT 4
+#define APP_MQTT_QOS_DEFAULT 1
 
 #if __has_include("wifi_local.h")
 #include "wifi_local.h"
@@ -81,6 +161,23 @@
 #define WIFI_PASS_LOCAL ""
 #endif
 
+// Fixed address instead of DHCP (optional), dotted quads; empty keeps DHCP
+#ifndef WIFI_STATIC_IP_LOCAL
+#define WIFI_STATIC_IP_LOCAL ""
+#endif
+
+#ifndef WIFI_STATIC_GATEWAY_LOCAL
+#define WIFI_STATIC_GATEWAY_LOCAL ""
+#endif
+
+#ifndef WIFI_STATIC_NETMASK_LOCAL
+#define WIFI_STATIC_NETMASK_LOCAL "255.255.255.0"
+#endif
+
+#ifndef WIFI_STATIC_DNS_LOCAL
+#define WIFI_STATIC_DNS_LOCAL ""
+#endif
+
 #ifndef WEATHER_API_KEY_LOCAL
 #define WEATHER_API_KEY_LOCAL ""
 #endif
@@ -89,6 +186,54 @@
 #define WEATHER_QUERY_LOCAL "q=New York,US"
 #endif
 
+// Extra locations after WEATHER_QUERY_LOCAL, ';'-separated, e.g. "q=Chicago,US;zip=10001,US"
+#ifndef WEATHER_LOCATIONS_LOCAL
+#define WEATHER_LOCATIONS_LOCAL ""
+#endif
+
+// Seconds between automatic location changes, 0 = swipe only
+#ifndef WEATHER_LOCATION_ROTATE_S_LOCAL
+#define WEATHER_LOCATION_ROTATE_S_LOCAL 0
+#endif
+
+// Tile URL template: {z} {x} {y} and {ts} (frame time, unix seconds) are substituted.
+#ifndef RADAR_TILE_URL_LOCAL
+#define RADAR_TILE_URL_LOCAL "https://tilecache.rainviewer.com/v2/radar/{ts}/256/{z}/{x}/{y}/2/1_1.png"
+#endif
+
+#ifndef RADAR_CENTER_LAT_LOCAL
+#define RADAR_CENTER_LAT_LOCAL 40.71
+#endif
+
+#ifndef RADAR_CENTER_LON_LOCAL
+#define RADAR_CENTER_LON_LOCAL -74.01
+#endif
+
+#ifndef RADAR_ZOOM_LOCAL
+#define RADAR_ZOOM_LOCAL 6
+#endif
+
+#ifndef HTTP_SERVER_PORT_LOCAL
+#define HTTP_SERVER_PORT_LOCAL 80
+#endif
+
+// MQTT publisher (optional), disabled while the URI is empty: "mqtt://host:1883" or "mqtts://host:8883"
+#ifndef MQTT_BROKER_URI_LOCAL
+#define MQTT_BROKER_URI_LOCAL ""
+#endif
+
+#ifndef MQTT_TOPIC_PREFIX_LOCAL
+#define MQTT_TOPIC_PREFIX_LOCAL "weather-display"
+#endif
+
+#ifndef APP_POWER_PROFILE_DEFAULT
+#define APP_POWER_PROFILE_DEFAULT APP_POWER_PROFILE_BALANCED
+#endif
+
+#ifndef APP_BATTERY_CAPACITY_MAH
+#define APP_BATTERY_CAPACITY_MAH 1000
+#endif
+
 #ifndef LOCAL_TIMEZONE_TZ
 #define LOCAL_TIMEZONE_TZ "CST6CDT,M3.2.0/2,M11.1.0/2"
 #endif
@@ -112,37 +257,54 @@ typedef struct {
     char condition[96];
 } weather_payload_t;
 
+// Forecast model: integers only, formatted into g_app for the visible rows when it is
+// applied or scrolled. No pointers or padding-sensitive fields, so the same bytes are
+// the per-location PSRAM cache and the NVS cache blob.
 typedef struct {
-    int temp_f;
-    int feels_f;
-    int wind_mph;
-    drawing_weather_icon_t icon;
-    char title[24];
-    char detail[48];
-    char temp_text[12];
-} forecast_row_payload_t;
+    uint16_t offset_min; // after forecast_payload_t.base_utc
+    int8_t temp_f;
+    int8_t feels_f;
+    uint8_t wind_mph;
+    uint8_t icon; // drawing_weather_icon_t
+} forecast_slot_t;
 
 typedef struct {
-    int temp_f;
-    int feels_f;
-    int wind_mph;
-    drawing_weather_icon_t icon;
-    char time_text[24];
-    char detail[48];
-    char temp_text[12];
-} forecast_hourly_payload_t;
+    uint16_t day_num; // local days since 1970-01-01
+    uint16_t weather_id; // OWM condition id of the representative slot
+    int8_t high_f;
+    int8_t low_f;
+    uint8_t wind_mph; // daily peak
+    uint8_t icon;
+    uint8_t first_slot;
+    uint8_t slot_count;
+} forecast_day_t;
 
 typedef struct {
-    uint8_t count;
-    forecast_hourly_payload_t entries[APP_FORECAST_HOURLY_MAX];
-} forecast_day_payload_t;
+    uint8_t version;
+    uint8_t day_count;
+    uint8_t slot_count;
+    uint8_t reserved;
+    int32_t tz_offset_s;
+    uint32_t base_utc; // dt of slots[0]
+    forecast_day_t days[APP_FORECAST_ROWS];
+    forecast_slot_t slots[APP_FORECAST_SLOTS];
+} forecast_payload_t;
+
+typedef enum {
+    APP_POWER_PROFILE_PERFORMANCE = 0,
+    APP_POWER_PROFILE_BALANCED,
+    APP_POWER_PROFILE_SAVER,
+    APP_POWER_PROFILE_COUNT,
+} app_power_profile_t;
 
 typedef struct {
-    uint8_t row_count;
-    forecast_row_payload_t rows[APP_FORECAST_ROWS];
-    forecast_day_payload_t days[APP_FORECAST_ROWS];
-    char preview_text[96];
-} forecast_payload_t;
+    uint16_t window_s;
+    uint16_t outbox_kb;
+    uint8_t rate_per_s;
+    uint8_t inflight;
+    uint8_t qos;
+    uint8_t reserved;
+} app_mqtt_tuning_t;
 
 typedef struct {
     char wifi_ssid[APP_WIFI_SSID_MAX_LEN + 1];
@@ -152,11 +314,41 @@ typedef struct {
     char weather_query[APP_WEATHER_QUERY_MAX_LEN + 1];
     bool weather_api_override_active;
     bool weather_query_override_active;
+    char weather_locations[APP_LOCATION_MAX - 1][APP_WEATHER_QUERY_MAX_LEN + 1];
+    uint8_t weather_location_count;
+    bool weather_locations_override_active;
+    uint16_t location_rotate_s;
+    char radar_url[APP_RADAR_URL_MAX_LEN + 1];
+    bool radar_url_override_active;
+    char mqtt_uri[APP_MQTT_URI_MAX_LEN + 1];
+    char mqtt_topic[APP_MQTT_TOPIC_MAX_LEN + 1];
+    bool mqtt_override_active;
+    app_mqtt_tuning_t mqtt_tuning;
+    app_power_profile_t power_profile;
 } app_wifi_config_t;
 
 typedef struct {
+    uint32_t uptime_s;
+    int16_t temp_f_x10;
+    uint16_t humidity_x10;
+    uint16_t pressure_hpa_x10;
+} app_indoor_sample_t;
+
+typedef struct {
+    char ssid[APP_WIFI_SSID_MAX_LEN + 1];
+    uint8_t bssid[6];
+    int8_t rssi;            // survey EWMA
+    uint8_t channel;
+    uint8_t authmode;
+    uint32_t seen_ms;
+} app_wifi_ap_t;
+
+typedef struct {
+    uint32_t seq;
     drawing_screen_view_t view;
     uint8_t forecast_page;
+    uint8_t location_index;
+    uint8_t location_count;
     bool has_weather;
     char time_text[16];
     char now_time_text[16];
@@ -186,16 +378,29 @@ typedef struct {
     drawing_weather_icon_t forecast_row_icon[APP_FORECAST_ROWS];
     bool forecast_hourly_open;
     uint8_t forecast_hourly_day;
-    uint8_t forecast_hourly_offset;
+    uint8_t forecast_hourly_start;
     uint8_t forecast_hourly_count;
-    char forecast_hourly_day_title[24];
-    char forecast_hourly_time[APP_FORECAST_ROWS][24];
-    char forecast_hourly_detail[APP_FORECAST_ROWS][48];
-    char forecast_hourly_temp[APP_FORECAST_ROWS][12];
-    drawing_weather_icon_t forecast_hourly_icon[APP_FORECAST_ROWS];
-    char i2c_scan_text[640];
+    uint32_t forecast_hourly_seq;
+    drawing_hourly_item_t forecast_hourly_items[APP_FORECAST_SLOTS];
+    uint32_t i2c_scan_ms;
+    uint32_t i2c_scan_rounds;
+    uint32_t i2c_scan_seq;
+    uint8_t i2c_found_count;
+    uint8_t i2c_found_map[16];
     char wifi_scan_text[1024];
+    uint32_t wifi_scan_ms;
+    uint16_t wifi_ap_total;
+    uint8_t wifi_ap_count;
+    uint32_t wifi_survey_seq;
+    uint32_t wifi_scan_text_seq;
+    app_wifi_ap_t wifi_aps[APP_WIFI_SCAN_MAX_APS];
+    uint8_t indoor_history_count;
+    uint8_t indoor_history_head;
+    uint32_t indoor_history_next_ms;
+    app_indoor_sample_t indoor_history[APP_INDOOR_HISTORY_LEN];
+    char radar_text[64];
     char bottom_text[96];
+    char battery_text[48];
     drawing_screen_dirty_t dirty;
 } app_state_t;
 
@@ -206,8 +411,42 @@ typedef struct {
     int16_t last_x;
     int16_t last_y;
     uint32_t last_swipe_ms;
+    bool wake_gesture;
+    bool radar_drag;
+    bool hourly_hit;    // pressed on the open list; becomes hourly_drag once the move is vertical
+    bool hourly_drag;
+    bool hourly_at_top; // list was scrolled to the first slot when pressed
+    int16_t hourly_pending_dy;
+    uint32_t last_move_ms;
+    int32_t velocity_y; // px/s, smoothed over the last few samples
+    bool page_drag;
+    bool page_drag_tried;
+    int8_t page_side; // +1 when the next page slides in from the right
 } touch_swipe_state_t;
 
+typedef struct {
+    bool enabled;
+    bool connected;
+    uint32_t reconnects;
+    uint32_t published;
+    uint32_t published_bytes;
+    uint32_t dropped;
+    uint32_t resent;
+    uint16_t queued;
+    uint16_t inflight;
+    size_t outbox_used;
+    size_t outbox_size;
+    uint32_t ack_avg_ms;
+    uint32_t ack_max_ms;
+} app_mqtt_stats_t;
+
+typedef enum {
+    APP_POWER_MODE_ACTIVE = 0,
+    APP_POWER_MODE_DIMMED,
+    APP_POWER_MODE_DARK,
+    APP_POWER_MODE_COUNT,
+} app_power_mode_t;
+
 extern const char *OPENWEATHER_CA_CERT_PEM;
 
 extern esp_io_expander_handle_t expander_handle;
@@ -238,25 +477,27 @@ void app_update_connect_time(uint32_t now_ms);
 bool app_sync_time_with_ntp(void);
 
 void app_set_screen(drawing_screen_view_t view);
-void app_build_forecast_hourly_visible(void);
+bool app_slide_begin(drawing_screen_view_t view, int side);
+void app_slide_follow(int dx);
+void app_slide_finish(bool commit);
 void app_close_forecast_hourly(void);
 void app_open_forecast_hourly(uint8_t day_row);
-void app_scroll_forecast_hourly(int dir);
 uint16_t display_rotation_to_touch_rotation(lv_disp_rot_t display_rotation);
 void app_poll_touch_swipe(uint32_t now_ms);
 
 const char *weekday_name(int wday);
-void format_hour_label(int hour24, char *out, size_t out_size);
 drawing_weather_icon_t map_owm_condition_to_icon(int weather_id, const char *icon_code);
+const char *forecast_condition_short(int weather_id);
 bool parse_weather_json(const char *json_text, weather_payload_t *out);
 bool parse_forecast_json(const char *json_text, forecast_payload_t *out);
 
 void app_set_forecast_placeholders(void);
 void app_set_indoor_placeholders(void);
-void app_set_i2c_scan_placeholder(void);
 void app_set_wifi_scan_placeholder(void);
-void app_run_i2c_scan(i2c_master_bus_handle_t bus_handle);
-void app_run_wifi_scan(void);
+bool app_poll_i2c_topology(uint32_t now_ms);
+void app_poll_wifi_survey(uint32_t now_ms);
+const char *app_wifi_auth_mode_name(uint8_t authmode);
+const char *app_view_name(drawing_screen_view_t view);
 
 void app_apply_indoor_data(const bsp_bme280_data_t *indoor);
 void app_apply_forecast_payload(const forecast_payload_t *fc);
@@ -275,11 +516,75 @@ bool app_config_weather_query_override_active(void);
 esp_err_t app_config_set_weather_api_key(const char *api_key);
 esp_err_t app_config_set_weather_query(const char *query);
 esp_err_t app_config_clear_weather_override(void);
+uint8_t app_config_location_count(void);
+const char *app_config_location_query(uint8_t index);
+esp_err_t app_config_add_location(const char *query);
+esp_err_t app_config_remove_location(uint8_t index);
+esp_err_t app_config_clear_locations(void);
+uint16_t app_config_location_rotate_s(void);
+esp_err_t app_config_set_location_rotate_s(uint16_t seconds);
+bool app_config_load_forecast_cache(uint32_t query_hash, forecast_payload_t *out);
+esp_err_t app_config_save_forecast_cache(uint32_t query_hash, const forecast_payload_t *fc);
+const char *app_config_radar_url(void);
+bool app_config_radar_url_override_active(void);
+esp_err_t app_config_set_radar_url(const char *url_template);
+esp_err_t app_config_clear_radar_url(void);
+const char *app_config_mqtt_uri(void);
+const char *app_config_mqtt_topic(void);
+bool app_config_mqtt_override_active(void);
+const app_mqtt_tuning_t *app_config_mqtt_tuning(void);
+esp_err_t app_config_set_mqtt_uri(const char *uri);
+esp_err_t app_config_set_mqtt_topic(const char *prefix);
+esp_err_t app_config_set_mqtt_tuning(const app_mqtt_tuning_t *tuning);
+esp_err_t app_config_clear_mqtt(void);
+app_power_profile_t app_config_power_profile(void);
+esp_err_t app_config_set_power_profile(app_power_profile_t profile);
 void app_config_boot_console_window(uint32_t timeout_ms);
 void app_config_interactive_console(void);
 
+void app_power_init(void);
+bool app_power_note_activity(uint32_t now_ms);
+void app_power_update(uint32_t now_ms);
+app_power_mode_t app_power_mode(void);
+bool app_power_display_dark(void);
+void app_power_wait(TickType_t *loop_tick);
+void app_power_log_stats(void);
+esp_err_t app_power_set_profile(app_power_profile_t profile);
+app_power_profile_t app_power_profile(void);
+const char *app_power_profile_name(app_power_profile_t profile);
+bool app_power_profile_from_name(const char *name, app_power_profile_t *out);
+void app_power_console_hold(bool hold);
+uint32_t app_power_align_deadline(uint32_t deadline_ms);
+
+lv_disp_rot_t app_orientation_rotation(void);
+void app_orientation_touch_size(lv_disp_rot_t rotation, uint16_t *width, uint16_t *height);
+void app_orientation_start(void);
+void app_orientation_apply_pending(void);
+
+bool app_radar_hit(int16_t x, int16_t y);
+void app_radar_pan(int dx, int dy);
+void app_radar_invalidate(void);
+void app_radar_poll(void);
+void app_radar_stats(uint32_t *tiles, uint32_t *avg_ms, uint32_t *max_ms, size_t *cache_bytes);
+
+void app_locations_init(void);
+void app_locations_poll(uint32_t now_ms, bool online);
+void app_locations_step(int dir, uint32_t now_ms);
+void app_locations_stats(uint8_t *feeds, uint32_t *fetches, uint32_t *coalesced, uint32_t *budget_waits);
+
+esp_err_t app_http_server_start(void);
+void app_http_server_publish(uint32_t now_ms);
+
+esp_err_t app_mqtt_start(void);
+void app_mqtt_poll(uint32_t now_ms);
+void app_mqtt_note_indoor(const bsp_bme280_data_t *indoor, uint32_t now_ms);
+void app_mqtt_note_weather(const weather_payload_t *wx);
+void app_mqtt_stats(app_mqtt_stats_t *out);
+
 void io_expander_init(i2c_master_bus_handle_t bus_handle);
 void lv_port_init_local(void);
 bool wait_for_wifi_ip(const char *ssid, char *ip_out, size_t ip_out_size);
-bool weather_fetch_once(void);
+esp_http_client_handle_t app_http_client_create(const char *url);
+bool weather_fetch_query(esp_http_client_handle_t *client, const char *query, weather_payload_t *wx,
+                         forecast_payload_t *fc, bool *forecast_ok, char *error, size_t error_size);
 void weather_task(void *arg);
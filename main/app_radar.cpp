@@ -0,0 +1,785 @@
+#include "app_priv.h"
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+
+// Unwrapped tile position; x wraps around the antimeridian when it becomes a key.
+typedef struct
+{
+    int32_t tx;
+    int32_t ty;
+} radar_tile_pos_t;
+
+typedef struct
+{
+    uint8_t z;
+    uint32_t x;
+    uint32_t y;
+    uint32_t ts;
+} radar_tile_key_t;
+
+// Encoded tile as downloaded. len == 0 marks a tile the server does not have (e.g. 404).
+// pinned is set while weather_task decodes data outside s_radar_lock; eviction skips it.
+typedef struct
+{
+    radar_tile_key_t key;
+    uint8_t *data;
+    size_t len;
+    bool used;
+    bool drawn;
+    bool pinned;
+    uint32_t last_use;
+    int64_t fetch_start_us;
+    uint32_t fetch_ms;
+} radar_cache_slot_t;
+
+// Shared with the fetch task, guarded by s_radar_lock
+static SemaphoreHandle_t s_radar_lock = NULL;
+static TaskHandle_t s_radar_task = NULL;
+static radar_cache_slot_t s_cache[APP_RADAR_CACHE_SLOTS] = {};
+static size_t s_cache_bytes = 0;
+static uint32_t s_use_clock = 0;
+static radar_tile_key_t s_want[APP_RADAR_MAX_VISIBLE] = {};
+static int s_want_count = 0;
+static volatile bool s_tiles_arrived = false;
+
+// weather_task only
+static bool s_view_ready = false;
+static bool s_shown = false;
+static bool s_full_redraw = true;
+static uint8_t s_zoom = 0;
+static int32_t s_origin_x = 0; // world pixel at the map area's top-left corner
+static int32_t s_origin_y = 0;
+static uint32_t s_frame_ts = 0;
+static int s_pan_dx = 0;
+static int s_pan_dy = 0;
+static radar_tile_pos_t s_missing[APP_RADAR_MAX_VISIBLE] = {};
+static int s_missing_count = 0;
+static uint32_t s_latency_count = 0;
+static uint32_t s_latency_sum_ms = 0;
+static uint32_t s_latency_max_ms = 0;
+
+static int32_t floor_div(int32_t v, int32_t d)
+{
+    return (v >= 0) ? (v / d) : -((-v + d - 1) / d);
+}
+
+static bool radar_key_equal(const radar_tile_key_t *a, const radar_tile_key_t *b)
+{
+    return a->z == b->z && a->x == b->x && a->y == b->y && a->ts == b->ts;
+}
+
+static bool radar_tile_key(const radar_tile_pos_t *pos, radar_tile_key_t *key)
+{
+    int32_t n = (int32_t)1 << s_zoom;
+    if (pos->ty < 0 || pos->ty >= n)
+    {
+        return false;
+    }
+    key->z = s_zoom;
+    key->x = (uint32_t)(((pos->tx % n) + n) % n);
+    key->y = (uint32_t)pos->ty;
+    key->ts = s_frame_ts;
+    return true;
+}
+
+static void radar_tile_origin(const radar_tile_pos_t *pos, int *x, int *y)
+{
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    *x = map.x1 + (int)(pos->tx * DRAWING_SCREEN_RADAR_TILE_SIZE - s_origin_x);
+    *y = map.y1 + (int)(pos->ty * DRAWING_SCREEN_RADAR_TILE_SIZE - s_origin_y);
+}
+
+static int radar_visible_tiles(radar_tile_pos_t *out, int max)
+{
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    int32_t tx0 = floor_div(s_origin_x, DRAWING_SCREEN_RADAR_TILE_SIZE);
+    int32_t tx1 = floor_div(s_origin_x + lv_area_get_width(&map) - 1, DRAWING_SCREEN_RADAR_TILE_SIZE);
+    int32_t ty0 = floor_div(s_origin_y, DRAWING_SCREEN_RADAR_TILE_SIZE);
+    int32_t ty1 = floor_div(s_origin_y + lv_area_get_height(&map) - 1, DRAWING_SCREEN_RADAR_TILE_SIZE);
+
+    int count = 0;
+    for (int32_t ty = ty0; ty <= ty1; ++ty)
+    {
+        for (int32_t tx = tx0; tx <= tx1 && count < max; ++tx)
+        {
+            out[count].tx = tx;
+            out[count].ty = ty;
+            count++;
+        }
+    }
+    return count;
+}
+
+static radar_cache_slot_t *radar_cache_find(const radar_tile_key_t *key)
+{
+    for (int i = 0; i < APP_RADAR_CACHE_SLOTS; ++i)
+    {
+        if (s_cache[i].used && radar_key_equal(&s_cache[i].key, key))
+        {
+            return &s_cache[i];
+        }
+    }
+    return NULL;
+}
+
+static void radar_cache_drop(radar_cache_slot_t *slot)
+{
+    heap_caps_free(slot->data);
+    s_cache_bytes -= slot->len;
+    memset(slot, 0, sizeof(*slot));
+}
+
+// Takes ownership of data. Evicts least recently drawn tiles until the slot count and byte budget fit.
+static void radar_cache_insert(const radar_tile_key_t *key, uint8_t *data, size_t len, int64_t fetch_start_us, uint32_t fetch_ms)
+{
+    radar_cache_slot_t *slot = radar_cache_find(key);
+    if (slot != NULL)
+    {
+        if (slot->pinned)
+        {
+            // Same key, same bytes: keep the copy being decoded
+            heap_caps_free(data);
+            return;
+        }
+        radar_cache_drop(slot);
+    }
+
+    while (true)
+    {
+        radar_cache_slot_t *free_slot = NULL;
+        radar_cache_slot_t *lru = NULL;
+        for (int i = 0; i < APP_RADAR_CACHE_SLOTS; ++i)
+        {
+            if (!s_cache[i].used)
+            {
+                free_slot = (free_slot == NULL) ? &s_cache[i] : free_slot;
+            }
+            else if (!s_cache[i].pinned && (lru == NULL || (int32_t)(s_cache[i].last_use - lru->last_use) < 0))
+            {
+                lru = &s_cache[i];
+            }
+        }
+        if (free_slot != NULL && s_cache_bytes + len <= APP_RADAR_CACHE_BUDGET_BYTES)
+        {
+            slot = free_slot;
+            break;
+        }
+        if (lru == NULL)
+        {
+            heap_caps_free(data);
+            return;
+        }
+        radar_cache_drop(lru);
+    }
+
+    slot->key = *key;
+    slot->data = data;
+    slot->len = len;
+    slot->used = true;
+    slot->drawn = false;
+    slot->last_use = ++s_use_clock;
+    slot->fetch_start_us = fetch_start_us;
+    slot->fetch_ms = fetch_ms;
+    s_cache_bytes += len;
+}
+
+static bool radar_build_url(const radar_tile_key_t *key, char *out, size_t out_size)
+{
+    const char *tpl = app_config_radar_url();
+    size_t n = 0;
+    while (*tpl != '\0')
+    {
+        char value[16] = {0};
+        const char *tag_end = NULL;
+        if (*tpl == '{')
+        {
+            tag_end = strchr(tpl, '}');
+        }
+        if (tag_end != NULL)
+        {
+            size_t tag_len = (size_t)(tag_end - tpl - 1);
+            if (tag_len == 1 && tpl[1] == 'z')
+            {
+                snprintf(value, sizeof(value), "%u", (unsigned)key->z);
+            }
+            else if (tag_len == 1 && tpl[1] == 'x')
+            {
+                snprintf(value, sizeof(value), "%lu", (unsigned long)key->x);
+            }
+            else if (tag_len == 1 && tpl[1] == 'y')
+            {
+                snprintf(value, sizeof(value), "%lu", (unsigned long)key->y);
+            }
+            else if (tag_len == 2 && strncmp(tpl + 1, "ts", 2) == 0)
+            {
+                snprintf(value, sizeof(value), "%lu", (unsigned long)key->ts);
+            }
+            else
+            {
+                tag_end = NULL;
+            }
+        }
+
+        if (tag_end != NULL)
+        {
+            size_t value_len = strlen(value);
+            if (n + value_len >= out_size)
+            {
+                return false;
+            }
+            memcpy(out + n, value, value_len);
+            n += value_len;
+            tpl = tag_end + 1;
+        }
+        else
+        {
+            if (n + 1 >= out_size)
+            {
+                return false;
+            }
+            out[n++] = *tpl++;
+        }
+    }
+    out[n] = '\0';
+    return n > 0;
+}
+
+// Downloads one tile into scratch. Returns ESP_OK with *len == 0 when the server answered without a tile.
+static esp_err_t radar_fetch_tile(esp_http_client_handle_t client, const char *url, uint8_t *scratch, size_t *len)
+{
+    *len = 0;
+    esp_err_t err = esp_http_client_set_url(client, url);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    esp_http_client_set_method(client, HTTP_METHOD_GET);
+    esp_http_client_set_timeout_ms(client, APP_RADAR_HTTP_TIMEOUT_MS);
+
+    err = esp_http_client_open(client, 0);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    int64_t content_length = esp_http_client_fetch_headers(client);
+    int status = esp_http_client_get_status_code(client);
+    if (status != 200 || content_length > APP_RADAR_TILE_MAX_BYTES)
+    {
+        // Missing or oversized tiles are cached as empty for this frame; server errors are retried
+        ESP_LOGW(APP_TAG, "radar: %s -> HTTP %d (%lld bytes)", url, status, (long long)content_length);
+        esp_http_client_close(client);
+        return (status >= 500 || status < 200) ? ESP_FAIL : ESP_OK;
+    }
+
+    size_t total = 0;
+    while (total < APP_RADAR_TILE_MAX_BYTES)
+    {
+        int n = esp_http_client_read(client, (char *)scratch + total, (int)(APP_RADAR_TILE_MAX_BYTES - total));
+        if (n < 0)
+        {
+            err = ESP_FAIL;
+            break;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        total += (size_t)n;
+    }
+    if (err == ESP_OK && total >= APP_RADAR_TILE_MAX_BYTES && !esp_http_client_is_complete_data_received(client))
+    {
+        ESP_LOGW(APP_TAG, "radar: %s is larger than %u bytes", url, (unsigned)APP_RADAR_TILE_MAX_BYTES);
+        total = 0;
+    }
+    esp_http_client_close(client);
+
+    *len = (err == ESP_OK) ? total : 0;
+    return err;
+}
+
+static bool radar_next_wanted(radar_tile_key_t *key)
+{
+    bool found = false;
+    xSemaphoreTake(s_radar_lock, portMAX_DELAY);
+    for (int i = 0; i < s_want_count; ++i)
+    {
+        if (radar_cache_find(&s_want[i]) == NULL)
+        {
+            *key = s_want[i];
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(s_radar_lock);
+    return found;
+}
+
+static void radar_task(void *arg)
+{
+    (void)arg;
+    uint8_t *scratch = (uint8_t *)heap_caps_malloc(APP_RADAR_TILE_MAX_BYTES, MALLOC_CAP_SPIRAM);
+    if (scratch == NULL)
+    {
+        ESP_LOGE(APP_TAG, "radar: no memory for the %u byte download buffer", (unsigned)APP_RADAR_TILE_MAX_BYTES);
+        s_radar_task = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    esp_http_client_handle_t client = NULL;
+    char url[APP_RADAR_URL_MAX_LEN + 48];
+    while (true)
+    {
+        // Keep the connection while tiles keep coming; drop it (and its TLS buffers) once idle.
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(APP_RADAR_IDLE_CLOSE_MS)) == 0 && client != NULL)
+        {
+            esp_http_client_cleanup(client);
+            client = NULL;
+        }
+
+        radar_tile_key_t key = {};
+        while (bsp_wifi_is_connected() && radar_next_wanted(&key))
+        {
+            if (!radar_build_url(&key, url, sizeof(url)))
+            {
+                ESP_LOGW(APP_TAG, "radar: tile URL too long, check 'radar set-url'");
+                break;
+            }
+            if (client == NULL)
+            {
+                client = app_http_client_create(url);
+                if (client == NULL)
+                {
+                    break;
+                }
+            }
+
+            int64_t start_us = esp_timer_get_time();
+            size_t len = 0;
+            esp_err_t err = radar_fetch_tile(client, url, scratch, &len);
+            uint32_t fetch_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+            if (err != ESP_OK)
+            {
+                ESP_LOGW(APP_TAG, "radar: fetch z%u/%lu/%lu failed: %s", (unsigned)key.z, (unsigned long)key.x,
+                         (unsigned long)key.y, esp_err_to_name(err));
+                esp_http_client_cleanup(client);
+                client = NULL;
+                vTaskDelay(pdMS_TO_TICKS(APP_RADAR_RETRY_MS));
+                break;
+            }
+
+            uint8_t *blob = NULL;
+            if (len > 0)
+            {
+                blob = (uint8_t *)heap_caps_malloc(len, MALLOC_CAP_SPIRAM);
+                if (blob == NULL)
+                {
+                    ESP_LOGW(APP_TAG, "radar: no PSRAM for a %u byte tile", (unsigned)len);
+                    vTaskDelay(pdMS_TO_TICKS(APP_RADAR_RETRY_MS));
+                    break;
+                }
+                memcpy(blob, scratch, len);
+            }
+
+            xSemaphoreTake(s_radar_lock, portMAX_DELAY);
+            radar_cache_insert(&key, blob, len, start_us, fetch_ms);
+            xSemaphoreGive(s_radar_lock);
+            s_tiles_arrived = true;
+        }
+    }
+}
+
+static bool radar_start(void)
+{
+    if (s_radar_lock == NULL)
+    {
+        s_radar_lock = xSemaphoreCreateMutex();
+        if (s_radar_lock == NULL)
+        {
+            return false;
+        }
+    }
+    if (s_radar_task == NULL &&
+        xTaskCreate(radar_task, "radar", APP_RADAR_TASK_STACK, NULL, 2, &s_radar_task) != pdPASS)
+    {
+        s_radar_task = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void radar_init_view(void)
+{
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+
+    s_zoom = (RADAR_ZOOM_LOCAL < 1) ? 1 : ((RADAR_ZOOM_LOCAL > 16) ? 16 : RADAR_ZOOM_LOCAL);
+    double world = (double)DRAWING_SCREEN_RADAR_TILE_SIZE * (double)((int32_t)1 << s_zoom);
+    double lat = (double)RADAR_CENTER_LAT_LOCAL * M_PI / 180.0;
+    double wx = ((double)RADAR_CENTER_LON_LOCAL + 180.0) / 360.0 * world;
+    double wy = (1.0 - asinh(tan(lat)) / M_PI) / 2.0 * world;
+    s_origin_x = (int32_t)wx - lv_area_get_width(&map) / 2;
+    s_origin_y = (int32_t)wy - lv_area_get_height(&map) / 2;
+    s_view_ready = true;
+}
+
+// Newest frame the server should have: wall clock minus the publish lag, rounded down to the frame period.
+static uint32_t radar_frame_ts(void)
+{
+    time_t now = time(NULL);
+    if (now < 1600000000)
+    {
+        return 0;
+    }
+    uint32_t t = (uint32_t)now - APP_RADAR_FRAME_LAG_S;
+    return t - (t % APP_RADAR_FRAME_PERIOD_S);
+}
+
+static bool radar_pos_visible(const radar_tile_pos_t *pos, const radar_tile_pos_t *visible, int visible_count)
+{
+    for (int i = 0; i < visible_count; ++i)
+    {
+        if (visible[i].tx == pos->tx && visible[i].ty == pos->ty)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void radar_missing_add(const radar_tile_pos_t *pos)
+{
+    if (radar_pos_visible(pos, s_missing, s_missing_count) || s_missing_count >= APP_RADAR_MAX_VISIBLE)
+    {
+        return;
+    }
+    s_missing[s_missing_count++] = *pos;
+}
+
+static void radar_log_latency(const radar_cache_slot_t *slot, uint32_t decode_ms)
+{
+    uint32_t latency_ms = (uint32_t)((esp_timer_get_time() - slot->fetch_start_us) / 1000);
+    s_latency_count++;
+    s_latency_sum_ms += latency_ms;
+    s_latency_max_ms = (latency_ms > s_latency_max_ms) ? latency_ms : s_latency_max_ms;
+    ESP_LOGI(APP_TAG, "radar: z%u/%lu/%lu %u B fetch %lu ms decode %lu ms fetch->pixel %lu ms",
+             (unsigned)slot->key.z, (unsigned long)slot->key.x, (unsigned long)slot->key.y, (unsigned)slot->len,
+             (unsigned long)slot->fetch_ms, (unsigned long)decode_ms, (unsigned long)latency_ms);
+    if ((s_latency_count % 16) == 0)
+    {
+        ESP_LOGI(APP_TAG, "radar: fetch->pixel avg %lu ms max %lu ms over %lu tiles, cache %u KB",
+                 (unsigned long)(s_latency_sum_ms / s_latency_count), (unsigned long)s_latency_max_ms,
+                 (unsigned long)s_latency_count, (unsigned)(s_cache_bytes / 1024));
+    }
+}
+
+// Paints one tile into clip from the cache. Returns false (placeholder painted) if it is not cached yet.
+static bool radar_paint_tile(const radar_tile_pos_t *pos, const lv_area_t *clip)
+{
+    int x = 0;
+    int y = 0;
+    radar_tile_origin(pos, &x, &y);
+
+    radar_tile_key_t key = {};
+    if (!radar_tile_key(pos, &key))
+    {
+        drawing_screen_radar_clear_tile(x, y, clip);
+        return true;
+    }
+
+    // Pin the slot and decode from a copy of its header, so the fetch task can keep
+    // inserting (and evicting other slots) while the PNG is being decoded.
+    xSemaphoreTake(s_radar_lock, portMAX_DELAY);
+    radar_cache_slot_t *slot = radar_cache_find(&key);
+    if (slot == NULL)
+    {
+        xSemaphoreGive(s_radar_lock);
+        drawing_screen_radar_clear_tile(x, y, clip);
+        return false;
+    }
+    slot->last_use = ++s_use_clock;
+    slot->pinned = true;
+    radar_cache_slot_t tile = *slot;
+    xSemaphoreGive(s_radar_lock);
+
+    uint32_t decode_ms = 0;
+    if (tile.len == 0)
+    {
+        drawing_screen_radar_clear_tile(x, y, clip);
+    }
+    else
+    {
+        int64_t t0 = esp_timer_get_time();
+        drawing_screen_radar_draw_tile(tile.data, tile.len, x, y, clip);
+        decode_ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+    }
+
+    xSemaphoreTake(s_radar_lock, portMAX_DELAY);
+    slot->pinned = false;
+    if (tile.len != 0 && !slot->drawn)
+    {
+        slot->drawn = true;
+        radar_log_latency(&tile, decode_ms);
+    }
+    xSemaphoreGive(s_radar_lock);
+    return true;
+}
+
+// Repaints every visible tile overlapping region (newly exposed strips, or the whole map).
+static void radar_paint_region(const lv_area_t *region)
+{
+    radar_tile_pos_t visible[APP_RADAR_MAX_VISIBLE];
+    int visible_count = radar_visible_tiles(visible, APP_RADAR_MAX_VISIBLE);
+    for (int i = 0; i < visible_count; ++i)
+    {
+        int x = 0;
+        int y = 0;
+        radar_tile_origin(&visible[i], &x, &y);
+        lv_area_t tile = {(lv_coord_t)x, (lv_coord_t)y, (lv_coord_t)(x + DRAWING_SCREEN_RADAR_TILE_SIZE - 1),
+                          (lv_coord_t)(y + DRAWING_SCREEN_RADAR_TILE_SIZE - 1)};
+        lv_area_t clip;
+        if (!_lv_area_intersect(&clip, &tile, region))
+        {
+            continue;
+        }
+        if (!radar_paint_tile(&visible[i], &clip))
+        {
+            radar_missing_add(&visible[i]);
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < s_missing_count; ++i)
+    {
+        if (radar_pos_visible(&s_missing[i], visible, visible_count))
+        {
+            s_missing[kept++] = s_missing[i];
+        }
+    }
+    s_missing_count = kept;
+}
+
+static void radar_paint_arrived(void)
+{
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    int kept = 0;
+    for (int i = 0; i < s_missing_count; ++i)
+    {
+        radar_tile_key_t key = {};
+        bool cached = true;
+        if (radar_tile_key(&s_missing[i], &key))
+        {
+            xSemaphoreTake(s_radar_lock, portMAX_DELAY);
+            cached = (radar_cache_find(&key) != NULL);
+            xSemaphoreGive(s_radar_lock);
+        }
+        if (!cached || !radar_paint_tile(&s_missing[i], &map))
+        {
+            s_missing[kept++] = s_missing[i];
+        }
+    }
+    s_missing_count = kept;
+}
+
+static void radar_publish_want(void)
+{
+    xSemaphoreTake(s_radar_lock, portMAX_DELAY);
+    s_want_count = 0;
+    for (int i = 0; i < s_missing_count; ++i)
+    {
+        if (radar_tile_key(&s_missing[i], &s_want[s_want_count]))
+        {
+            s_want_count++;
+        }
+    }
+    xSemaphoreGive(s_radar_lock);
+
+    if (s_want_count > 0 && s_radar_task != NULL)
+    {
+        xTaskNotifyGive(s_radar_task);
+    }
+}
+
+static void radar_update_text(int visible_count)
+{
+    char text[sizeof(g_app.radar_text)];
+    if (s_frame_ts == 0)
+    {
+        snprintf(text, sizeof(text), "(drag to pan) waiting for clock sync");
+    }
+    else
+    {
+        time_t frame = (time_t)s_frame_ts;
+        struct tm frame_tm = {};
+        localtime_r(&frame, &frame_tm);
+        snprintf(text, sizeof(text), "(drag to pan) z%u  %d/%d tiles  frame %02d:%02d", (unsigned)s_zoom,
+                 visible_count - s_missing_count, visible_count, frame_tm.tm_hour, frame_tm.tm_min);
+    }
+    if (strcmp(text, g_app.radar_text) != 0)
+    {
+        snprintf(g_app.radar_text, sizeof(g_app.radar_text), "%s", text);
+        app_mark_dirty(false, false, false, true);
+    }
+}
+
+bool app_radar_hit(int16_t x, int16_t y)
+{
+    if (g_app.view != DRAWING_SCREEN_VIEW_RADAR)
+    {
+        return false;
+    }
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    // Drags that start at the side edges still switch pages
+    return x >= map.x1 + APP_RADAR_EDGE_SWIPE_PX && x <= map.x2 - APP_RADAR_EDGE_SWIPE_PX && y >= map.y1 && y <= map.y2;
+}
+
+void app_radar_pan(int dx, int dy)
+{
+    s_pan_dx += dx;
+    s_pan_dy += dy;
+}
+
+void app_radar_invalidate(void)
+{
+    s_full_redraw = true;
+}
+
+void app_radar_poll(void)
+{
+    if (g_app.view != DRAWING_SCREEN_VIEW_RADAR || app_power_display_dark())
+    {
+        s_shown = false;
+        s_pan_dx = 0;
+        s_pan_dy = 0;
+        return;
+    }
+    if (!radar_start())
+    {
+        return;
+    }
+    if (!s_view_ready)
+    {
+        radar_init_view();
+    }
+    if (!s_shown)
+    {
+        s_shown = true;
+        s_full_redraw = true;
+    }
+
+    uint32_t frame_ts = radar_frame_ts();
+    bool frame_changed = (frame_ts != s_frame_ts);
+    bool arrived = s_tiles_arrived;
+    int dx = s_pan_dx;
+    int dy = s_pan_dy;
+    bool pan = (dx >= APP_RADAR_PAN_MIN_PX || dx <= -APP_RADAR_PAN_MIN_PX ||
+                dy >= APP_RADAR_PAN_MIN_PX || dy <= -APP_RADAR_PAN_MIN_PX);
+    if (!s_full_redraw && !frame_changed && !arrived && !pan)
+    {
+        return;
+    }
+    if (!lvgl_lock_with_retry(pdMS_TO_TICKS(100), 2, "radar"))
+    {
+        return;
+    }
+    s_tiles_arrived = false;
+
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    radar_tile_pos_t visible[APP_RADAR_MAX_VISIBLE];
+    int visible_count = radar_visible_tiles(visible, APP_RADAR_MAX_VISIBLE);
+
+    if (frame_changed)
+    {
+        // Old frame stays on screen until each tile of the new one lands
+        s_frame_ts = frame_ts;
+        for (int i = 0; i < visible_count; ++i)
+        {
+            radar_missing_add(&visible[i]);
+        }
+    }
+
+    if (pan)
+    {
+        s_pan_dx = 0;
+        s_pan_dy = 0;
+        int32_t world_h = (int32_t)DRAWING_SCREEN_RADAR_TILE_SIZE << s_zoom;
+        int32_t max_y = world_h - lv_area_get_height(&map);
+        int32_t new_y = s_origin_y - dy;
+        new_y = (new_y < 0) ? 0 : ((new_y > max_y) ? max_y : new_y);
+        dy = (int)(s_origin_y - new_y);
+        s_origin_x -= dx;
+        s_origin_y = new_y;
+
+        if (!s_full_redraw)
+        {
+            // Keep the pixels that stay on screen; only the uncovered strips need tiles
+            drawing_screen_radar_scroll(dx, dy);
+            if (dx != 0)
+            {
+                lv_area_t strip = map;
+                if (dx > 0)
+                {
+                    strip.x2 = (lv_coord_t)(map.x1 + dx - 1);
+                }
+                else
+                {
+                    strip.x1 = (lv_coord_t)(map.x2 + 1 + dx);
+                }
+                radar_paint_region(&strip);
+            }
+            if (dy != 0)
+            {
+                lv_area_t strip = map;
+                if (dy > 0)
+                {
+                    strip.y2 = (lv_coord_t)(map.y1 + dy - 1);
+                }
+                else
+                {
+                    strip.y1 = (lv_coord_t)(map.y2 + 1 + dy);
+                }
+                radar_paint_region(&strip);
+            }
+        }
+        visible_count = radar_visible_tiles(visible, APP_RADAR_MAX_VISIBLE);
+    }
+
+    if (s_full_redraw)
+    {
+        s_full_redraw = false;
+        radar_paint_region(&map);
+    }
+
+    radar_paint_arrived();
+    lvgl_port_unlock();
+
+    if (s_frame_ts != 0)
+    {
+        radar_publish_want();
+    }
+    radar_update_text(visible_count);
+}
+
+// weather_task only: the latency counters are written by the painter on that task
+void app_radar_stats(uint32_t *tiles, uint32_t *avg_ms, uint32_t *max_ms, size_t *cache_bytes)
+{
+    uint32_t count = s_latency_count;
+    *tiles = count;
+    *avg_ms = (count > 0) ? (s_latency_sum_ms / count) : 0;
+    *max_ms = s_latency_max_ms;
+    *cache_bytes = 0;
+    if (s_radar_lock != NULL)
+    {
+        xSemaphoreTake(s_radar_lock, portMAX_DELAY);
+        *cache_bytes = s_cache_bytes;
+        xSemaphoreGive(s_radar_lock);
+    }
+}
@@ -1,90 +1,45 @@
 #include "app_priv.h"
 
-void app_run_i2c_scan(i2c_master_bus_handle_t bus_handle)
-{
-    if (bus_handle == NULL)
-    {
-        snprintf(g_app.i2c_scan_text, sizeof(g_app.i2c_scan_text), "I2C bus not initialized");
-        app_mark_dirty(false, true, false, false);
-        return;
-    }
-
-    char text[640] = {0};
-    char found_line[192] = {0};
-    size_t used = 0;
-    size_t found_used = 0;
-    int found_count = 0;
-    bool found_bme_addr = false;
-
-    used += snprintf(text + used, sizeof(text) - used,
-                     "I2C Scan (0x03-0x77)\n"
-                     "SDA=%d SCL=%d\n",
-                     (int)EXAMPLE_PIN_I2C_SDA, (int)EXAMPLE_PIN_I2C_SCL);
+#include "esp_timer.h"
 
-    for (uint8_t addr = 0x03; addr <= 0x77; ++addr)
+// Mirrors the bus topology service into g_app; returns true when a BME280 address
+// came back so the caller can retry the driver without waiting out BME280_REINIT_MS.
+bool app_poll_i2c_topology(uint32_t now_ms)
+{
+    bool bme_appeared = false;
+    bsp_i2c_topology_event_t evt = {};
+    while (bsp_i2c_topology_get_event(&evt, 0))
     {
-        esp_err_t ret = ESP_FAIL;
-        if (bsp_i2c_lock(50))
-        {
-            ret = i2c_master_probe(bus_handle, addr, 20);
-            bsp_i2c_unlock();
-        }
-
-        if (ret == ESP_OK)
+        app_set_status_fmt("i2c: 0x%02X %s", evt.addr, evt.present ? "connected" : "removed");
+        if (evt.present && (evt.addr == 0x76 || evt.addr == 0x77))
         {
-            if (found_count == 0)
-            {
-                used += snprintf(text + used, sizeof(text) - used, "Found:\n");
-            }
-            if (found_count > 0 && (found_count % 8) == 0)
-            {
-                used += snprintf(text + used, sizeof(text) - used, "\n");
-            }
-            used += snprintf(text + used, sizeof(text) - used, "0x%02X ", addr);
-            if (found_used + 6 < sizeof(found_line))
-            {
-                found_used += snprintf(found_line + found_used, sizeof(found_line) - found_used, "0x%02X ", addr);
-            }
-            found_count++;
-            if (addr == 0x76 || addr == 0x77)
-            {
-                found_bme_addr = true;
-            }
+            bme_appeared = true;
         }
     }
 
-    if (found_count == 0)
+    bsp_i2c_topology_t topo = {};
+    if (!bsp_i2c_topology_get(&topo) || topo.rounds == g_app.i2c_scan_rounds)
     {
-        snprintf(text, sizeof(text),
-                 "I2C Scan (0x03-0x77)\n"
-                 "SDA=%d SCL=%d\n"
-                 "No devices found.\n\n"
-                 "Check sensor power, GND, SDA, SCL.\n"
-                 "BME280 should appear at 0x76 or 0x77.",
-                 (int)EXAMPLE_PIN_I2C_SDA, (int)EXAMPLE_PIN_I2C_SCL);
+        return bme_appeared;
     }
-    else
+    g_app.i2c_scan_rounds = topo.rounds;
+    g_app.i2c_scan_ms = now_ms;
+    if (topo.seq != g_app.i2c_scan_seq)
     {
-        (void)snprintf(text + used, sizeof(text) - used,
-                       "\n\nTotal: %d\nBME280 addr: %s\nDriver: %s",
-                       found_count,
-                       found_bme_addr ? "present" : "missing",
-                       bsp_bme280_is_available() ? "initialized" : "not initialized");
+        g_app.i2c_scan_seq = topo.seq;
+        memcpy(g_app.i2c_found_map, topo.map, sizeof(g_app.i2c_found_map));
+        g_app.i2c_found_count = topo.count;
+        if (g_app.view == DRAWING_SCREEN_VIEW_I2C_SCAN)
+        {
+            app_mark_dirty(false, true, false, false);
+        }
     }
-
-    ESP_LOGI(APP_TAG, "i2c scan: found=%d bme_addr=%s driver=%s addrs=[%s]",
-             found_count,
-             found_bme_addr ? "yes" : "no",
-             bsp_bme280_is_available() ? "ready" : "not-ready",
-             (found_line[0] != '\0') ? found_line : "(none)");
-
-    snprintf(g_app.i2c_scan_text, sizeof(g_app.i2c_scan_text), "%s", text);
-    app_mark_dirty(false, true, false, false);
+    return bme_appeared;
 }
 
-static const char *wifi_auth_mode_name(wifi_auth_mode_t authmode)
+const char *app_wifi_auth_mode_name(uint8_t authmode)
 {
-    switch (authmode)
+    switch ((wifi_auth_mode_t)authmode)
     {
     case WIFI_AUTH_OPEN:
         return "Open";
@@ -110,53 +65,107 @@ static const char *wifi_auth_mode_name(wifi_auth_mode_t authmode)
     return "?";
 }
 
-void app_run_wifi_scan(void)
+static void app_build_wifi_survey_text(void)
 {
-    wifi_ap_record_t ap_info[APP_WIFI_SCAN_MAX_APS] = {};
-    uint16_t ap_count = 0;
+    bsp_wifi_survey_channel_t channels[BSP_WIFI_SURVEY_CHANNELS];
+    bsp_wifi_survey_stats_t stats = {};
+    bsp_wifi_survey_get_channels(channels);
+    bsp_wifi_survey_get_stats(&stats);
 
-    bool ok = bsp_wifi_scan(ap_info, &ap_count, APP_WIFI_SCAN_MAX_APS);
-    if (!ok)
+    if (stats.scans == 0)
     {
         snprintf(g_app.wifi_scan_text, sizeof(g_app.wifi_scan_text),
-                 "Wi-Fi scan failed or timed out.\n"
-                 "Make sure station mode is initialized.");
-        app_mark_dirty(false, true, false, false);
+                 "Wi-Fi survey pending...\n"
+                 "Channels are sampled in the background once Wi-Fi connects.");
         return;
     }
 
     char text[1024] = {0};
     size_t used = 0;
-    uint16_t shown = (ap_count > APP_WIFI_SCAN_VISIBLE_APS) ? APP_WIFI_SCAN_VISIBLE_APS : ap_count;
-    used += snprintf(text + used, sizeof(text) - used, "Found %u APs\n", (unsigned)ap_count);
+    used += snprintf(text + used, sizeof(text) - used, "%u APs, %lu sweeps",
+                     (unsigned)g_app.wifi_ap_total, (unsigned long)stats.sweeps);
 
+    // Three busiest channels by beacons heard on the last visit
+    int busiest[3] = {-1, -1, -1};
+    for (int i = 0; i < BSP_WIFI_SURVEY_CHANNELS; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            if (channels[i].ap_count > 0 && (busiest[k] < 0 || channels[i].ap_count > channels[busiest[k]].ap_count))
+            {
+                for (int m = 2; m > k; --m)
+                {
+                    busiest[m] = busiest[m - 1];
+                }
+                busiest[k] = i;
+                break;
+            }
+        }
+    }
+    for (int k = 0; k < 3 && busiest[k] >= 0; ++k)
+    {
+        used += snprintf(text + used, sizeof(text) - used, "%s ch%u:%u", (k == 0) ? "  busy" : "",
+                         (unsigned)channels[busiest[k]].channel, (unsigned)channels[busiest[k]].ap_count);
+    }
+    used += snprintf(text + used, sizeof(text) - used, "\n");
+
+    uint16_t shown = (g_app.wifi_ap_count > APP_WIFI_SCAN_VISIBLE_APS) ? APP_WIFI_SCAN_VISIBLE_APS : g_app.wifi_ap_count;
     if (shown == 0)
     {
         (void)snprintf(text + used, sizeof(text) - used, "No networks in range.");
     }
-    else
+    for (uint16_t i = 0; i < shown && used < sizeof(text); ++i)
     {
-        for (uint16_t i = 0; i < shown && used < sizeof(text); ++i)
-        {
-            const wifi_ap_record_t *ap = &ap_info[i];
-            const char *ssid = ((const char *)ap->ssid)[0] != '\0' ? (const char *)ap->ssid : "<hidden>";
-            used += snprintf(text + used, sizeof(text) - used,
-                             "%u) %.16s  %d dBm  ch%u  %s\n",
-                             (unsigned)(i + 1),
-                             ssid,
-                             (int)ap->rssi,
-                             (unsigned)ap->primary,
-                             wifi_auth_mode_name(ap->authmode));
-        }
-        if (ap_count > shown && used < sizeof(text))
+        const app_wifi_ap_t *ap = &g_app.wifi_aps[i];
+        used += snprintf(text + used, sizeof(text) - used,
+                         "%u) %.16s  %d dBm  ch%u  %s\n",
+                         (unsigned)(i + 1),
+                         (ap->ssid[0] != '\0') ? ap->ssid : "<hidden>",
+                         (int)ap->rssi,
+                         (unsigned)ap->channel,
+                         app_wifi_auth_mode_name(ap->authmode));
+    }
+    if (g_app.wifi_ap_total > shown && shown > 0 && used < sizeof(text))
+    {
+        (void)snprintf(text + used, sizeof(text) - used, "...and %u more",
+                       (unsigned)(g_app.wifi_ap_total - shown));
+    }
+    snprintf(g_app.wifi_scan_text, sizeof(g_app.wifi_scan_text), "%s", text);
+}
+
+// Copies the survey table when a scan has been merged, and rebuilds the page text
+// only while the page is on screen. Never waits on the radio.
+void app_poll_wifi_survey(uint32_t now_ms)
+{
+    uint32_t seq = bsp_wifi_survey_seq();
+    if (seq != g_app.wifi_survey_seq)
+    {
+        bsp_wifi_survey_ap_t aps[APP_WIFI_SCAN_MAX_APS];
+        size_t total = 0;
+        size_t kept = bsp_wifi_survey_get_aps(aps, APP_WIFI_SCAN_MAX_APS, &total);
+        uint32_t survey_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        for (size_t i = 0; i < kept; ++i)
         {
-            (void)snprintf(text + used, sizeof(text) - used, "...and %u more",
-                           (unsigned)(ap_count - shown));
+            app_wifi_ap_t *out = &g_app.wifi_aps[i];
+            snprintf(out->ssid, sizeof(out->ssid), "%s", aps[i].ssid);
+            memcpy(out->bssid, aps[i].bssid, sizeof(out->bssid));
+            out->rssi = aps[i].rssi;
+            out->channel = aps[i].channel;
+            out->authmode = aps[i].authmode;
+            out->seen_ms = now_ms - (survey_ms - aps[i].last_seen_ms);
         }
+        g_app.wifi_ap_count = (uint8_t)kept;
+        g_app.wifi_ap_total = (uint16_t)total;
+        g_app.wifi_scan_ms = now_ms;
+        g_app.wifi_survey_seq = seq;
     }
 
-    snprintf(g_app.wifi_scan_text, sizeof(g_app.wifi_scan_text), "%s", text);
-    app_mark_dirty(false, true, false, false);
+    if (g_app.view == DRAWING_SCREEN_VIEW_WIFI_SCAN && g_app.wifi_scan_text_seq != seq)
+    {
+        g_app.wifi_scan_text_seq = seq;
+        app_build_wifi_survey_text();
+        app_mark_dirty(false, true, false, false);
+    }
 }
 
 void io_expander_init(i2c_master_bus_handle_t bus_handle)
@@ -175,19 +184,20 @@ void lv_port_init_local(void)
     port_cfg.task_priority = 4;
     port_cfg.task_stack = 1024 * 5;
     port_cfg.task_affinity = 1;
-    port_cfg.task_max_sleep_ms = 500;
-    port_cfg.timer_period_ms = 5;
+    port_cfg.task_max_sleep_ms = 0; // idle until a state publish or input wakes it
+    port_cfg.frame_period_ms = LVGL_FRAME_ACTIVE_MS;
     lvgl_port_init(&port_cfg);
 
     lvgl_port_display_cfg_t disp_cfg = {};
     disp_cfg.io_handle = io_handle;
     disp_cfg.panel_handle = panel_handle;
     disp_cfg.buffer_size = LCD_BUFFER_SIZE;
-    disp_cfg.sw_rotate = EXAMPLE_DISPLAY_ROTATION;
+    disp_cfg.sw_rotate = app_orientation_rotation();
     disp_cfg.hres = EXAMPLE_LCD_H_RES;
     disp_cfg.vres = EXAMPLE_LCD_V_RES;
     disp_cfg.trans_size = LCD_BUFFER_SIZE / 10;
-    disp_cfg.draw_wait_cb = NULL;
+    // Pace flushes to the panel's TE output when the board wires it
+    disp_cfg.draw_wait_cb = (bsp_display_te_init() == ESP_OK) ? bsp_display_wait_te : NULL;
     disp_cfg.flags.buff_dma = false;
     disp_cfg.flags.buff_spiram = true;
 
@@ -208,28 +218,22 @@ void lv_port_init_local(void)
 
 bool wait_for_wifi_ip(const char *ssid, char *ip_out, size_t ip_out_size)
 {
-    const int poll_ms = 500;
-    int waited_ms = 0;
+    const int slice_ms = 5000;
 
-    while (waited_ms < WIFI_WAIT_TIMEOUT_MS)
+    for (int waited_ms = 0; waited_ms < WIFI_WAIT_TIMEOUT_MS; waited_ms += slice_ms)
     {
-        char ip[32] = {0};
-        bsp_wifi_get_ip(ip);
-        if (ip[0] != '\0' && strcmp(ip, "0.0.0.0") != 0)
+        app_set_status_fmt("wifi: connecting... %d s", waited_ms / 1000);
+        app_set_bottom_fmt("ssid: %s", (ssid != NULL && ssid[0] != '\0') ? ssid : "(unset)");
+        app_render_if_dirty();
+
+        // Wakes on the GOT_IP event rather than polling the netif
+        if (bsp_wifi_wait_connected(pdMS_TO_TICKS(slice_ms)))
         {
+            char ip[16] = {0};
+            bsp_wifi_get_ip(ip);
             snprintf(ip_out, ip_out_size, "%s", ip);
             return true;
         }
-
-        if ((waited_ms % 5000) == 0)
-        {
-            app_set_status_fmt("wifi: connecting... %d s", waited_ms / 1000);
-            app_set_bottom_fmt("ssid: %s", (ssid != NULL && ssid[0] != '\0') ? ssid : "(unset)");
-            app_render_if_dirty();
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(poll_ms));
-        waited_ms += poll_ms;
     }
 
     return false;
@@ -240,11 +244,10 @@ void weather_task(void *arg)
     (void)arg;
 
     TickType_t loop_tick = xTaskGetTickCount();
-    uint32_t last_time_sec = UINT32_MAX;
-    uint32_t next_weather_sync_ms = 0;
+    uint32_t next_clock_ms = 0;
+    bool was_dark = false;
+    bool was_i2c_page = false;
     uint32_t next_indoor_sample_ms = 0;
-    uint32_t next_i2c_scan_ms = 0;
-    uint32_t next_wifi_scan_ms = 0;
     uint32_t next_wifi_status_ms = 0;
 
     const char *wifi_ssid = app_config_wifi_ssid();
@@ -267,13 +270,13 @@ void weather_task(void *arg)
     }
 
     uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
-    next_weather_sync_ms = now_ms;
     next_indoor_sample_ms = now_ms;
-    next_i2c_scan_ms = now_ms;
-    next_wifi_scan_ms = now_ms;
     next_wifi_status_ms = now_ms;
 
+    app_locations_init();
+
     bool wifi_ready = false;
+    bool wifi_services_started = false;
     bool wifi_timeout_logged = false;
     bool ntp_checked = false;
     uint32_t wifi_connect_started_ms = now_ms;
@@ -283,7 +286,11 @@ void weather_task(void *arg)
     app_set_bottom_fmt("network bring-up");
     app_render_if_dirty();
 
+    bsp_wifi_set_static_ip(WIFI_STATIC_IP_LOCAL, WIFI_STATIC_GATEWAY_LOCAL, WIFI_STATIC_NETMASK_LOCAL,
+                           WIFI_STATIC_DNS_LOCAL);
     bsp_wifi_init(wifi_ssid, wifi_pass);
+    // Before the first connect, so the Wi-Fi page works while the AP is missing
+    bsp_wifi_survey_start(WIFI_SURVEY_IDLE_STEP_MS);
 
     app_set_status_fmt("wifi: connect -> %s", wifi_ssid);
     app_set_bottom_fmt("network connect pending");
@@ -299,32 +306,63 @@ void weather_task(void *arg)
         }
 
         now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
-        uint32_t now_sec = now_ms / 1000U;
 
-        if (now_sec != last_time_sec)
+        // Jobs below snap their deadlines to shared wake windows while the panel is dark;
+        // pull the clock forward on wake so the first frame is not stale.
+        bool dark = app_power_display_dark();
+        if (was_dark && !dark)
+        {
+            next_clock_ms = now_ms;
+        }
+        was_dark = dark;
+
+        if ((int32_t)(now_ms - next_clock_ms) >= 0)
         {
-            last_time_sec = now_sec;
             app_update_connect_time(now_ms);
             app_update_local_time();
+            next_clock_ms = app_power_align_deadline(now_ms - (now_ms % 1000U) + 1000U);
+        }
+
+        // The BSP reconnects on its own with backoff; this only follows its event bits
+        bool link_up = bsp_wifi_is_connected();
+        if (!link_up && wifi_ready)
+        {
+            wifi_ready = false;
+            wifi_timeout_logged = false;
+            g_wifi_connected = false;
+            wifi_connect_started_ms = now_ms;
+            next_wifi_status_ms = now_ms + 5000;
+            app_set_status_fmt("wifi: link lost, reconnecting");
+            app_set_bottom_fmt("offline, retrying connect");
         }
 
         if (!wifi_ready)
         {
-            char ip[32] = {0};
-            bsp_wifi_get_ip(ip);
-            if (ip[0] != '\0' && strcmp(ip, "0.0.0.0") != 0)
+            if (link_up)
             {
-                snprintf(wifi_ip, sizeof(wifi_ip), "%s", ip);
+                bsp_wifi_stats_t wifi_stats = {};
+                bsp_wifi_get_stats(&wifi_stats);
+                bsp_wifi_get_ip(wifi_ip);
                 wifi_ready = true;
                 g_wifi_connected = true;
                 g_wifi_connected_ms = now_ms;
                 app_update_connect_time(g_wifi_connected_ms);
-                app_set_status_fmt("wifi: connected ip %s", wifi_ip);
-                app_set_bottom_fmt("online %s (%s)",
-                                   weather_query_text,
-                                   app_config_wifi_override_active() ? "saved Wi-Fi" : "default Wi-Fi");
-                app_render_if_dirty();
-                next_weather_sync_ms = now_ms;
+                if (!wifi_services_started)
+                {
+                    app_set_status_fmt("wifi: connected ip %s (%u ms)", wifi_ip, (unsigned)wifi_stats.cold_connect_ms);
+                    app_set_bottom_fmt("online %s (%s)",
+                                       weather_query_text,
+                                       app_config_wifi_override_active() ? "saved Wi-Fi" : "default Wi-Fi");
+                    app_render_if_dirty();
+                    app_http_server_start();
+                    app_mqtt_start();
+                    wifi_services_started = true;
+                }
+                else
+                {
+                    app_set_status_fmt("wifi: reconnected ip %s (%u ms)", wifi_ip, (unsigned)wifi_stats.last_recovery_ms);
+                    app_set_bottom_fmt("online %s", weather_query_text);
+                }
             }
             else
             {
@@ -363,11 +401,20 @@ void weather_task(void *arg)
         {
             if (!bsp_bme280_is_available())
             {
-                // Startup does multi-attempt init. Avoid repeated runtime re-init loops:
-                // they can wedge I2C if the sensor/bus is not healthy.
-                app_set_indoor_placeholders();
-                app_mark_dirty(false, true, true, false);
-                next_indoor_sample_ms = now_ms + 30000;
+                // Clear a slave holding SDA first so a re-init cannot wedge the bus; slow
+                // retries since each attempt probes both BME280 addresses. A free bus is
+                // not reset, so boards without the sensor see no recoveries
+                bsp_i2c_recover_if_stuck();
+                if (bsp_bme280_init(g_i2c_bus_handle) == ESP_OK)
+                {
+                    next_indoor_sample_ms = now_ms;
+                }
+                else
+                {
+                    app_set_indoor_placeholders();
+                    app_mark_dirty(false, true, true, false);
+                    next_indoor_sample_ms = app_power_align_deadline(now_ms + BME280_REINIT_MS);
+                }
             }
             else
             {
@@ -386,55 +433,44 @@ void weather_task(void *arg)
                 if (indoor_ok)
                 {
                     app_apply_indoor_data(&indoor);
-                    next_indoor_sample_ms = now_ms + BME280_REFRESH_MS;
+                    app_mqtt_note_indoor(&indoor, now_ms);
+                    next_indoor_sample_ms = app_power_align_deadline(now_ms + BME280_REFRESH_MS);
                 }
                 else
                 {
                     app_set_indoor_placeholders();
                     app_mark_dirty(false, true, true, false);
-                    next_indoor_sample_ms = now_ms + BME280_RETRY_MS;
+                    next_indoor_sample_ms = app_power_align_deadline(now_ms + BME280_RETRY_MS);
                 }
             }
         }
 
-        if (g_app.view == DRAWING_SCREEN_VIEW_I2C_SCAN && (int32_t)(now_ms - next_i2c_scan_ms) >= 0)
+        // Opening the I2C page runs one full scan; after that it only speeds up the incremental rounds
+        bool i2c_page = (g_app.view == DRAWING_SCREEN_VIEW_I2C_SCAN);
+        bsp_i2c_topology_set_period(i2c_page ? I2C_TOPOLOGY_PAGE_MS : I2C_TOPOLOGY_IDLE_MS);
+        if (i2c_page && !was_i2c_page)
         {
-            app_run_i2c_scan(g_i2c_bus_handle);
-            next_i2c_scan_ms = now_ms + I2C_SCAN_REFRESH_MS;
+            bsp_i2c_topology_rescan();
         }
-
-        if (g_app.view == DRAWING_SCREEN_VIEW_WIFI_SCAN && (int32_t)(now_ms - next_wifi_scan_ms) >= 0)
+        was_i2c_page = i2c_page;
+        if (app_poll_i2c_topology(now_ms) && !bsp_bme280_is_available())
         {
-            app_run_wifi_scan();
-            next_wifi_scan_ms = now_ms + WIFI_SCAN_REFRESH_MS;
+            next_indoor_sample_ms = now_ms;
         }
 
-        if ((int32_t)(now_ms - next_weather_sync_ms) >= 0)
-        {
-            if (!wifi_ready)
-            {
-                next_weather_sync_ms = now_ms + WEATHER_RETRY_MS;
-            }
-            else
-            {
-                char local_time[16] = {0};
-                if (!app_format_local_time(local_time, sizeof(local_time)))
-                {
-                    app_set_status_fmt("time: waiting for NTP");
-                    app_set_bottom_fmt("HTTPS blocked until clock sync");
-                    next_weather_sync_ms = now_ms + 10000;
-                }
-                else
-                {
-                    bool ok = weather_fetch_once();
-                    next_weather_sync_ms = now_ms + (ok ? WEATHER_REFRESH_MS : WEATHER_RETRY_MS);
-                }
-            }
-        }
+        bsp_wifi_survey_set_step((g_app.view == DRAWING_SCREEN_VIEW_WIFI_SCAN) ? WIFI_SURVEY_PAGE_STEP_MS : WIFI_SURVEY_IDLE_STEP_MS);
+        app_poll_wifi_survey(now_ms);
+
+        app_locations_poll(now_ms, wifi_ready);
 
+        app_orientation_apply_pending();
         app_poll_touch_swipe(now_ms);
+        app_power_update(now_ms);
 
         app_render_if_dirty();
-        vTaskDelayUntil(&loop_tick, pdMS_TO_TICKS(UI_TICK_MS));
+        app_radar_poll();
+        app_http_server_publish(now_ms);
+        app_mqtt_poll(now_ms);
+        app_power_wait(&loop_tick);
     }
 }
@@ -34,6 +34,8 @@ bool lvgl_lock_with_retry(TickType_t timeout_ticks, int max_attempts, const char
 
 void app_mark_dirty(bool header, bool main, bool stats, bool bottom)
 {
+    // Every view-model change passes through here; the HTTP snapshot keys off the bump.
+    g_app.seq++;
     if (header)
     {
         g_app.dirty.header = true;
@@ -64,12 +66,20 @@ void app_render_if_dirty(void)
         return;
     }
 
+    // Panel is asleep: keep the dirty flags so the wake path repaints once.
+    if (app_power_display_dark())
+    {
+        return;
+    }
+
     drawing_screen_data_t data = {};
     data.view = g_app.view;
     data.forecast_page = g_app.forecast_page;
     data.forecast_hourly_open = g_app.forecast_hourly_open;
-    data.forecast_hourly_offset = g_app.forecast_hourly_offset;
+    data.forecast_hourly_seq = g_app.forecast_hourly_seq;
+    data.forecast_hourly_start = g_app.forecast_hourly_start;
     data.forecast_hourly_count = g_app.forecast_hourly_count;
+    data.forecast_hourly_items = g_app.forecast_hourly_items;
     data.has_weather = g_app.has_weather;
     data.time_text = g_app.time_text;
     data.now_time_text = g_app.now_time_text;
@@ -101,15 +111,15 @@ void app_render_if_dirty(void)
         data.forecast_row_detail[i] = g_app.forecast_row_detail[i];
         data.forecast_row_temp[i] = g_app.forecast_row_temp[i];
         data.forecast_row_icon[i] = g_app.forecast_row_icon[i];
-        data.forecast_hourly_time[i] = g_app.forecast_hourly_time[i];
-        data.forecast_hourly_detail[i] = g_app.forecast_hourly_detail[i];
-        data.forecast_hourly_temp[i] = g_app.forecast_hourly_temp[i];
-        data.forecast_hourly_icon[i] = g_app.forecast_hourly_icon[i];
     }
-    data.forecast_hourly_day_title = g_app.forecast_hourly_day_title;
-    data.i2c_scan_text = g_app.i2c_scan_text;
+    data.i2c_found_map = g_app.i2c_found_map;
+    data.i2c_found_count = g_app.i2c_found_count;
+    data.i2c_scanned = (g_app.i2c_scan_seq != 0);
+    data.i2c_bme_ready = bsp_bme280_is_available();
     data.wifi_scan_text = g_app.wifi_scan_text;
+    data.radar_text = g_app.radar_text;
     data.bottom_text = g_app.bottom_text;
+    data.battery_text = g_app.battery_text;
 
     drawing_screen_dirty_t dirty = g_app.dirty;
 
@@ -118,6 +128,11 @@ void app_render_if_dirty(void)
         drawing_screen_render(&data, &dirty);
         lvgl_port_unlock();
         memset(&g_app.dirty, 0, sizeof(g_app.dirty));
+        if (dirty.main && g_app.view == DRAWING_SCREEN_VIEW_RADAR)
+        {
+            // The page background was repainted; tiles go back on top in app_radar_poll()
+            app_radar_invalidate();
+        }
     }
 }
 
@@ -262,15 +277,103 @@ void app_set_screen(drawing_screen_view_t view)
         if (g_app.view == DRAWING_SCREEN_VIEW_FORECAST && view != DRAWING_SCREEN_VIEW_FORECAST)
         {
             g_app.forecast_hourly_open = false;
-            g_app.forecast_hourly_offset = 0;
-            g_app.forecast_hourly_count = 0;
-            g_app.forecast_hourly_day_title[0] = '\0';
         }
         g_app.view = view;
         app_mark_dirty(true, true, true, true);
     }
 }
 
+// Where a slide started, so a cancelled one can put the old page back under the overlay
+static drawing_screen_view_t s_slide_from = DRAWING_SCREEN_VIEW_NOW;
+static bool s_slide_from_hourly = false;
+
+bool app_slide_begin(drawing_screen_view_t view, int side)
+{
+    if (view == g_app.view || app_power_display_dark())
+    {
+        return false;
+    }
+
+    bool started = false;
+    if (lvgl_lock_with_retry(pdMS_TO_TICKS(50), 2, "slide begin"))
+    {
+        started = drawing_screen_slide_begin(side);
+        lvgl_port_unlock();
+    }
+    if (!started)
+    {
+        return false;
+    }
+
+    s_slide_from = g_app.view;
+    s_slide_from_hourly = g_app.forecast_hourly_open;
+
+    // The new page renders into the hidden widgets, radar tiles included, then is snapshotted
+    app_set_screen(view);
+    app_render_if_dirty();
+    app_radar_poll();
+    if (lvgl_lock_with_retry(pdMS_TO_TICKS(250), 6, "slide target"))
+    {
+        drawing_screen_slide_set_target();
+        lvgl_port_unlock();
+    }
+    return true;
+}
+
+void app_slide_follow(int dx)
+{
+    // Best effort like the hourly drag: a missed sample is covered by the next one
+    if (!lvgl_port_lock(pdMS_TO_TICKS(5)))
+    {
+        return;
+    }
+    drawing_screen_slide_follow(dx);
+    lvgl_port_unlock();
+}
+
+void app_slide_finish(bool commit)
+{
+    if (!commit)
+    {
+        app_set_screen(s_slide_from);
+        if (s_slide_from_hourly)
+        {
+            g_app.forecast_hourly_open = true;
+        }
+        app_render_if_dirty();
+        app_radar_poll();
+    }
+    if (lvgl_lock_with_retry(pdMS_TO_TICKS(250), 6, "slide finish"))
+    {
+        drawing_screen_slide_finish(commit);
+        lvgl_port_unlock();
+    }
+}
+
+const char *app_view_name(drawing_screen_view_t view)
+{
+    switch (view)
+    {
+    case DRAWING_SCREEN_VIEW_NOW:
+        return "now";
+    case DRAWING_SCREEN_VIEW_INDOOR:
+        return "indoor";
+    case DRAWING_SCREEN_VIEW_FORECAST:
+        return "forecast";
+    case DRAWING_SCREEN_VIEW_I2C_SCAN:
+        return "i2c";
+    case DRAWING_SCREEN_VIEW_WIFI_SCAN:
+        return "wifi";
+    case DRAWING_SCREEN_VIEW_ABOUT:
+        return "about";
+    case DRAWING_SCREEN_VIEW_RADAR:
+        return "radar";
+    default:
+        break;
+    }
+    return "?";
+}
+
 void app_set_forecast_placeholders(void)
 {
     static const char *default_titles[APP_FORECAST_ROWS] = {
@@ -288,9 +391,8 @@ void app_set_forecast_placeholders(void)
     g_app.forecast_row_count = APP_FORECAST_ROWS;
     g_app.forecast_hourly_open = false;
     g_app.forecast_hourly_day = 0;
-    g_app.forecast_hourly_offset = 0;
+    g_app.forecast_hourly_start = 0;
     g_app.forecast_hourly_count = 0;
-    g_app.forecast_hourly_day_title[0] = '\0';
     memset(&g_forecast_cache, 0, sizeof(g_forecast_cache));
 
     for (int i = 0; i < APP_FORECAST_ROWS; ++i)
@@ -299,10 +401,6 @@ void app_set_forecast_placeholders(void)
         snprintf(g_app.forecast_row_detail[i], sizeof(g_app.forecast_row_detail[i]), "%s", default_details[i]);
         snprintf(g_app.forecast_row_temp[i], sizeof(g_app.forecast_row_temp[i]), "%s", default_temps[i]);
         g_app.forecast_row_icon[i] = DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
-        snprintf(g_app.forecast_hourly_time[i], sizeof(g_app.forecast_hourly_time[i]), "--");
-        g_app.forecast_hourly_detail[i][0] = '\0';
-        snprintf(g_app.forecast_hourly_temp[i], sizeof(g_app.forecast_hourly_temp[i]), "--°");
-        g_app.forecast_hourly_icon[i] = DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
     }
     for (int i = 0; i < APP_PREVIEW_DAYS; ++i)
     {
@@ -320,19 +418,11 @@ void app_set_indoor_placeholders(void)
     snprintf(g_app.indoor_line_3, sizeof(g_app.indoor_line_3), "-- hPa");
 }
 
-void app_set_i2c_scan_placeholder(void)
-{
-    snprintf(g_app.i2c_scan_text, sizeof(g_app.i2c_scan_text),
-             "I2C scan pending...\n"
-             "Range: 0x03-0x77\n"
-             "BME280 expected at 0x76 or 0x77");
-}
-
 void app_set_wifi_scan_placeholder(void)
 {
     snprintf(g_app.wifi_scan_text, sizeof(g_app.wifi_scan_text),
-             "Wi-Fi scan pending...\n"
-             "Swipe to this page after Wi-Fi connects.");
+             "Wi-Fi survey pending...\n"
+             "Channels are sampled in the background once Wi-Fi connects.");
 }
 
 void app_apply_indoor_data(const bsp_bme280_data_t *indoor)
@@ -345,6 +435,22 @@ void app_apply_indoor_data(const bsp_bme280_data_t *indoor)
     snprintf(g_app.indoor_line_1, sizeof(g_app.indoor_line_1), "Indoor %.1f\xC2\xB0" "F", indoor->temperature_f);
     snprintf(g_app.indoor_line_2, sizeof(g_app.indoor_line_2), "%.0f%% RH", indoor->humidity_pct);
     snprintf(g_app.indoor_line_3, sizeof(g_app.indoor_line_3), "%.0f hPa", indoor->pressure_hpa);
+
+    uint32_t now_ms = (uint32_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+    if (g_app.indoor_history_count == 0 || (int32_t)(now_ms - g_app.indoor_history_next_ms) >= 0)
+    {
+        app_indoor_sample_t *sample = &g_app.indoor_history[g_app.indoor_history_head];
+        sample->uptime_s = now_ms / 1000U;
+        sample->temp_f_x10 = (int16_t)lroundf(indoor->temperature_f * 10.0f);
+        sample->humidity_x10 = (uint16_t)lroundf(indoor->humidity_pct * 10.0f);
+        sample->pressure_hpa_x10 = (uint16_t)lroundf(indoor->pressure_hpa * 10.0f);
+        g_app.indoor_history_head = (uint8_t)((g_app.indoor_history_head + 1) % APP_INDOOR_HISTORY_LEN);
+        if (g_app.indoor_history_count < APP_INDOOR_HISTORY_LEN)
+        {
+            g_app.indoor_history_count++;
+        }
+        g_app.indoor_history_next_ms = now_ms + APP_INDOOR_HISTORY_PERIOD_MS;
+    }
     app_mark_dirty(false, true, true, false);
 }
 
@@ -384,7 +490,6 @@ void app_state_init_defaults(void)
     snprintf(g_app.stats_line_2, sizeof(g_app.stats_line_2), "Humidity --");
     snprintf(g_app.stats_line_3, sizeof(g_app.stats_line_3), "Pressure --");
     app_set_indoor_placeholders();
-    app_set_i2c_scan_placeholder();
     app_set_wifi_scan_placeholder();
     g_app.now_icon = DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
     snprintf(g_app.bottom_text, sizeof(g_app.bottom_text), "Swipe left/right to switch views");
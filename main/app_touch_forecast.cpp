@@ -36,6 +36,50 @@ static bool app_is_hourly_close_tap(int16_t x, int16_t y)
     return x >= close_x_min;
 }
 
+static drawing_screen_view_t app_next_view(drawing_screen_view_t v)
+{
+    switch (v)
+    {
+    case DRAWING_SCREEN_VIEW_NOW:
+        return DRAWING_SCREEN_VIEW_FORECAST;
+    case DRAWING_SCREEN_VIEW_INDOOR:
+        return DRAWING_SCREEN_VIEW_NOW;
+    case DRAWING_SCREEN_VIEW_FORECAST:
+        return DRAWING_SCREEN_VIEW_RADAR;
+    case DRAWING_SCREEN_VIEW_RADAR:
+        return DRAWING_SCREEN_VIEW_I2C_SCAN;
+    case DRAWING_SCREEN_VIEW_I2C_SCAN:
+        return DRAWING_SCREEN_VIEW_WIFI_SCAN;
+    case DRAWING_SCREEN_VIEW_WIFI_SCAN:
+        return DRAWING_SCREEN_VIEW_ABOUT;
+    case DRAWING_SCREEN_VIEW_ABOUT:
+    default:
+        return DRAWING_SCREEN_VIEW_INDOOR;
+    }
+}
+
+static drawing_screen_view_t app_prev_view(drawing_screen_view_t v)
+{
+    switch (v)
+    {
+    case DRAWING_SCREEN_VIEW_NOW:
+        return DRAWING_SCREEN_VIEW_INDOOR;
+    case DRAWING_SCREEN_VIEW_INDOOR:
+        return DRAWING_SCREEN_VIEW_ABOUT;
+    case DRAWING_SCREEN_VIEW_FORECAST:
+        return DRAWING_SCREEN_VIEW_NOW;
+    case DRAWING_SCREEN_VIEW_RADAR:
+        return DRAWING_SCREEN_VIEW_FORECAST;
+    case DRAWING_SCREEN_VIEW_I2C_SCAN:
+        return DRAWING_SCREEN_VIEW_RADAR;
+    case DRAWING_SCREEN_VIEW_WIFI_SCAN:
+        return DRAWING_SCREEN_VIEW_I2C_SCAN;
+    case DRAWING_SCREEN_VIEW_ABOUT:
+    default:
+        return DRAWING_SCREEN_VIEW_WIFI_SCAN;
+    }
+}
+
 static bool app_handle_edge_nav_tap(int16_t x, int16_t y)
 {
     lv_disp_t *disp = lv_disp_get_default();
@@ -66,90 +110,51 @@ static bool app_handle_edge_nav_tap(int16_t x, int16_t y)
         return false;
     }
 
-    auto next_view = [](drawing_screen_view_t v) {
-        switch (v)
-        {
-        case DRAWING_SCREEN_VIEW_NOW:
-            return DRAWING_SCREEN_VIEW_FORECAST;
-        case DRAWING_SCREEN_VIEW_INDOOR:
-            return DRAWING_SCREEN_VIEW_NOW;
-        case DRAWING_SCREEN_VIEW_FORECAST:
-            return DRAWING_SCREEN_VIEW_I2C_SCAN;
-        case DRAWING_SCREEN_VIEW_I2C_SCAN:
-            return DRAWING_SCREEN_VIEW_WIFI_SCAN;
-        case DRAWING_SCREEN_VIEW_WIFI_SCAN:
-            return DRAWING_SCREEN_VIEW_ABOUT;
-        case DRAWING_SCREEN_VIEW_ABOUT:
-        default:
-            return DRAWING_SCREEN_VIEW_INDOOR;
-        }
-    };
-    auto prev_view = [](drawing_screen_view_t v) {
-        switch (v)
-        {
-        case DRAWING_SCREEN_VIEW_NOW:
-            return DRAWING_SCREEN_VIEW_INDOOR;
-        case DRAWING_SCREEN_VIEW_INDOOR:
-            return DRAWING_SCREEN_VIEW_ABOUT;
-        case DRAWING_SCREEN_VIEW_FORECAST:
-            return DRAWING_SCREEN_VIEW_NOW;
-        case DRAWING_SCREEN_VIEW_I2C_SCAN:
-            return DRAWING_SCREEN_VIEW_FORECAST;
-        case DRAWING_SCREEN_VIEW_WIFI_SCAN:
-            return DRAWING_SCREEN_VIEW_I2C_SCAN;
-        case DRAWING_SCREEN_VIEW_ABOUT:
-        default:
-            return DRAWING_SCREEN_VIEW_WIFI_SCAN;
-        }
-    };
-    app_set_screen((step > 0) ? next_view(g_app.view) : prev_view(g_app.view));
-    return true;
-}
-
-void app_build_forecast_hourly_visible(void)
-{
-    if (!g_app.forecast_hourly_open || g_app.forecast_hourly_day >= g_app.forecast_row_count)
-    {
-        g_app.forecast_hourly_count = 0;
-        return;
-    }
-
-    uint8_t day = g_app.forecast_hourly_day;
-    uint8_t count = g_forecast_cache.days[day].count;
-    g_app.forecast_hourly_count = count;
-
-    uint8_t max_start = 0;
-    if (count > APP_FORECAST_ROWS)
+    drawing_screen_view_t target = (step > 0) ? app_next_view(g_app.view) : app_prev_view(g_app.view);
+    if (app_slide_begin(target, step))
     {
-        max_start = (uint8_t)(count - APP_FORECAST_ROWS);
+        app_slide_finish(true);
     }
-    if (g_app.forecast_hourly_offset > max_start)
+    else
     {
-        g_app.forecast_hourly_offset = max_start;
+        app_set_screen(target);
     }
+    return true;
+}
 
-    snprintf(g_app.forecast_hourly_day_title, sizeof(g_app.forecast_hourly_day_title),
-             "%.16s Hourly", g_app.forecast_row_title[day]);
+static int forecast_slot_local_hour(const forecast_payload_t *fc, const forecast_slot_t *slot)
+{
+    int64_t local_epoch = (int64_t)fc->base_utc + (int64_t)slot->offset_min * 60 + fc->tz_offset_s;
+    return (int)((local_epoch % 86400 + 86400) % 86400 / 3600);
+}
 
-    for (int i = 0; i < APP_FORECAST_ROWS; ++i)
+static const char *forecast_day_name(const forecast_day_t *day)
+{
+    // 1970-01-01 was a Thursday
+    return weekday_name((day->day_num + 4) % 7);
+}
+
+// The hourly list covers every slot of the shown days as one strip; the drawing layer
+// formats only the rows that scroll into view, so nothing here is text
+static void app_build_forecast_hourly_items(void)
+{
+    uint8_t count = 0;
+    for (int d = 0; d < g_app.forecast_row_count; ++d)
     {
-        int src = (int)g_app.forecast_hourly_offset + i;
-        if (src < count)
-        {
-            const forecast_hourly_payload_t *entry = &g_forecast_cache.days[day].entries[src];
-            snprintf(g_app.forecast_hourly_time[i], sizeof(g_app.forecast_hourly_time[i]), "%s", entry->time_text);
-            snprintf(g_app.forecast_hourly_detail[i], sizeof(g_app.forecast_hourly_detail[i]), "%s", entry->detail);
-            snprintf(g_app.forecast_hourly_temp[i], sizeof(g_app.forecast_hourly_temp[i]), "%s", entry->temp_text);
-            g_app.forecast_hourly_icon[i] = entry->icon;
-        }
-        else
+        const forecast_day_t *day = &g_forecast_cache.days[d];
+        for (int i = 0; i < day->slot_count && count < APP_FORECAST_SLOTS; ++i)
         {
-            snprintf(g_app.forecast_hourly_time[i], sizeof(g_app.forecast_hourly_time[i]), "--");
-            g_app.forecast_hourly_detail[i][0] = '\0';
-            snprintf(g_app.forecast_hourly_temp[i], sizeof(g_app.forecast_hourly_temp[i]), "--°");
-            g_app.forecast_hourly_icon[i] = DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
+            const forecast_slot_t *slot = &g_forecast_cache.slots[day->first_slot + i];
+            drawing_hourly_item_t *item = &g_app.forecast_hourly_items[count++];
+            item->wday = (uint8_t)((day->day_num + 4) % 7);
+            item->hour = (uint8_t)forecast_slot_local_hour(&g_forecast_cache, slot);
+            item->temp_f = slot->temp_f;
+            item->feels_f = slot->feels_f;
+            item->wind_mph = slot->wind_mph;
+            item->icon = slot->icon;
         }
     }
+    g_app.forecast_hourly_count = count;
 }
 
 void app_close_forecast_hourly(void)
@@ -159,9 +164,6 @@ void app_close_forecast_hourly(void)
         return;
     }
     g_app.forecast_hourly_open = false;
-    g_app.forecast_hourly_offset = 0;
-    g_app.forecast_hourly_count = 0;
-    g_app.forecast_hourly_day_title[0] = '\0';
     app_mark_dirty(true, true, false, true);
 }
 
@@ -171,92 +173,92 @@ void app_open_forecast_hourly(uint8_t day_row)
     {
         return;
     }
-    if (g_forecast_cache.days[day_row].count == 0)
+    if (g_forecast_cache.days[day_row].slot_count == 0)
     {
         return;
     }
 
+    // The list opens scrolled to the tapped day's first slot
+    uint8_t start = 0;
+    for (int d = 0; d < day_row; ++d)
+    {
+        start = (uint8_t)(start + g_forecast_cache.days[d].slot_count);
+    }
     g_app.forecast_hourly_open = true;
     g_app.forecast_hourly_day = day_row;
-    g_app.forecast_hourly_offset = 0;
-    app_build_forecast_hourly_visible();
+    g_app.forecast_hourly_start = start;
+    g_app.forecast_hourly_seq++;
     app_mark_dirty(true, true, false, true);
 }
 
-void app_scroll_forecast_hourly(int dir)
+// Hands the finger movement gathered since the last poll to the list. The lock is only
+// tried briefly; if the LVGL task is mid-frame the delta waits for the next sample.
+static void app_flush_hourly_drag(void)
 {
-    if (!g_app.forecast_hourly_open || g_app.forecast_hourly_day >= g_app.forecast_row_count)
+    if (g_touch_swipe.hourly_pending_dy == 0)
     {
         return;
     }
-
-    uint8_t day = g_app.forecast_hourly_day;
-    uint8_t count = g_forecast_cache.days[day].count;
-    int max_start = 0;
-    if (count > APP_FORECAST_ROWS)
-    {
-        max_start = (int)count - APP_FORECAST_ROWS;
-    }
-
-    int next_offset = (int)g_app.forecast_hourly_offset + (dir * APP_FORECAST_ROWS);
-    if (next_offset < 0)
-    {
-        next_offset = 0;
-    }
-    else if (next_offset > max_start)
+    if (!lvgl_port_lock(pdMS_TO_TICKS(5)))
     {
-        next_offset = max_start;
+        return;
     }
+    drawing_screen_hourly_drag(g_touch_swipe.hourly_pending_dy);
+    lvgl_port_unlock();
+    g_touch_swipe.hourly_pending_dy = 0;
+}
 
-    if (next_offset != (int)g_app.forecast_hourly_offset)
+// A press on the open hourly list only becomes a list drag once the finger has left the
+// tap slop mostly vertically. A mostly horizontal move releases it to the page slide, so
+// the list never swallows a page swipe.
+static void app_claim_hourly_drag(int16_t x, int16_t y)
+{
+    int dx = (int)x - (int)g_touch_swipe.start_x;
+    int dy = (int)y - (int)g_touch_swipe.start_y;
+    int abs_dx = (dx >= 0) ? dx : -dx;
+    int abs_dy = (dy >= 0) ? dy : -dy;
+    if (abs_dx <= TOUCH_TAP_MAX_MOVE_PX && abs_dy <= TOUCH_TAP_MAX_MOVE_PX)
     {
-        g_app.forecast_hourly_offset = (uint8_t)next_offset;
-        app_build_forecast_hourly_visible();
-        app_mark_dirty(false, true, false, true);
         return;
     }
-
-    // At the day boundary: vertical swipe can move across days.
-    if (dir > 0)
+    if (abs_dy <= abs_dx)
     {
-        for (int next_day = (int)day + 1; next_day < g_app.forecast_row_count; ++next_day)
-        {
-            if (g_forecast_cache.days[next_day].count == 0)
-            {
-                continue;
-            }
-            g_app.forecast_hourly_day = (uint8_t)next_day;
-            g_app.forecast_hourly_offset = 0;
-            app_build_forecast_hourly_visible();
-            app_mark_dirty(true, true, false, true);
-            return;
-        }
+        g_touch_swipe.hourly_hit = false;
         return;
     }
+    g_touch_swipe.hourly_drag = true;
+    // Rewind to the press point so the list takes up the movement made inside the slop
+    g_touch_swipe.last_y = g_touch_swipe.start_y;
+}
 
-    for (int prev_day = (int)day - 1; prev_day >= 0; --prev_day)
-    {
-        uint8_t prev_count = g_forecast_cache.days[prev_day].count;
-        if (prev_count == 0)
+// Horizontal drags that neither the radar nor the hourly list claimed slide the pages.
+// The neighbour on the side the finger moves away from is prepared once the drag is
+// clearly horizontal; after that the old page follows the finger.
+static void app_track_page_drag(int16_t x, int16_t y, uint32_t now_ms)
+{
+    int dx = (int)x - (int)g_touch_swipe.start_x;
+    if (!g_touch_swipe.page_drag)
+    {
+        int dy = (int)y - (int)g_touch_swipe.start_y;
+        int abs_dx = (dx >= 0) ? dx : -dx;
+        int abs_dy = (dy >= 0) ? dy : -dy;
+        if (g_touch_swipe.page_drag_tried || abs_dx < TOUCH_SLIDE_START_PX || abs_dy >= abs_dx ||
+            (uint32_t)(now_ms - g_touch_swipe.last_swipe_ms) < TOUCH_SWIPE_COOLDOWN_MS)
         {
-            continue;
+            return;
         }
-        g_app.forecast_hourly_day = (uint8_t)prev_day;
-        if (prev_count > APP_FORECAST_ROWS)
+        // One attempt per touch; without surfaces the release falls back to a cut
+        g_touch_swipe.page_drag_tried = true;
+        int side = (dx < 0) ? 1 : -1;
+        drawing_screen_view_t target = (side > 0) ? app_next_view(g_app.view) : app_prev_view(g_app.view);
+        if (!app_slide_begin(target, side))
         {
-            g_app.forecast_hourly_offset = (uint8_t)(prev_count - APP_FORECAST_ROWS);
-        }
-        else
-        {
-            g_app.forecast_hourly_offset = 0;
+            return;
         }
-        app_build_forecast_hourly_visible();
-        app_mark_dirty(true, true, false, true);
-        return;
+        g_touch_swipe.page_drag = true;
+        g_touch_swipe.page_side = (int8_t)side;
     }
-
-    // Swiping earlier from the first day exits hourly to the main forecast view.
-    app_close_forecast_hourly();
+    app_slide_follow(dx);
 }
 
 static void app_handle_touch_tap(int16_t x, int16_t y)
@@ -323,6 +325,49 @@ void app_poll_touch_swipe(uint32_t now_ms)
             g_touch_swipe.pressed = true;
             g_touch_swipe.start_x = x;
             g_touch_swipe.start_y = y;
+            // A touch that wakes a dark panel is consumed; the user cannot see what they hit.
+            g_touch_swipe.wake_gesture = app_power_note_activity(now_ms);
+            g_touch_swipe.radar_drag = !g_touch_swipe.wake_gesture && app_radar_hit(x, y);
+            g_touch_swipe.hourly_hit = !g_touch_swipe.wake_gesture && g_app.view == DRAWING_SCREEN_VIEW_FORECAST &&
+                                       g_app.forecast_hourly_open && drawing_screen_hourly_hit(x, y);
+            g_touch_swipe.hourly_drag = false;
+            g_touch_swipe.hourly_at_top = g_touch_swipe.hourly_hit && drawing_screen_hourly_at_top();
+            g_touch_swipe.hourly_pending_dy = 0;
+            g_touch_swipe.velocity_y = 0;
+            g_touch_swipe.last_move_ms = now_ms;
+            g_touch_swipe.page_drag = false;
+            g_touch_swipe.page_drag_tried = false;
+        }
+        else
+        {
+            app_power_note_activity(now_ms);
+            if (g_touch_swipe.hourly_hit && !g_touch_swipe.hourly_drag)
+            {
+                app_claim_hourly_drag(x, y);
+            }
+            if (g_touch_swipe.radar_drag)
+            {
+                // The map follows the finger; app_radar_poll() scrolls by the accumulated delta
+                app_radar_pan(x - g_touch_swipe.last_x, y - g_touch_swipe.last_y);
+            }
+            else if (g_touch_swipe.hourly_drag && y != g_touch_swipe.last_y)
+            {
+                int dy = y - g_touch_swipe.last_y;
+                uint32_t dt = now_ms - g_touch_swipe.last_move_ms;
+                if (dt > 0)
+                {
+                    // Halve towards each new sample so one noisy poll does not set the fling speed
+                    int32_t sample = (int32_t)dy * 1000 / (int32_t)dt;
+                    g_touch_swipe.velocity_y = (g_touch_swipe.velocity_y + sample) / 2;
+                }
+                g_touch_swipe.last_move_ms = now_ms;
+                g_touch_swipe.hourly_pending_dy = (int16_t)(g_touch_swipe.hourly_pending_dy + dy);
+                app_flush_hourly_drag();
+            }
+            else if (!g_touch_swipe.wake_gesture && !g_touch_swipe.hourly_hit)
+            {
+                app_track_page_drag(x, y, now_ms);
+            }
         }
 
         g_touch_swipe.last_x = x;
@@ -339,7 +384,30 @@ void app_poll_touch_swipe(uint32_t now_ms)
     int delta_y = (int)g_touch_swipe.last_y - (int)g_touch_swipe.start_y;
     int abs_delta_x = (delta_x >= 0) ? delta_x : -delta_x;
     int abs_delta_y = (delta_y >= 0) ? delta_y : -delta_y;
+    bool radar_drag = g_touch_swipe.radar_drag;
+    bool hourly_drag = g_touch_swipe.hourly_drag;
+    bool page_drag = g_touch_swipe.page_drag;
     g_touch_swipe.pressed = false;
+    g_touch_swipe.radar_drag = false;
+    g_touch_swipe.hourly_hit = false;
+    g_touch_swipe.hourly_drag = false;
+    g_touch_swipe.page_drag = false;
+
+    if (g_touch_swipe.wake_gesture)
+    {
+        g_touch_swipe.wake_gesture = false;
+        return;
+    }
+
+    if (page_drag)
+    {
+        // Settles onto the new page past the swipe distance, otherwise slides back
+        bool commit = (g_touch_swipe.page_side > 0) ? (delta_x <= -TOUCH_SWIPE_MIN_X_PX) : (delta_x >= TOUCH_SWIPE_MIN_X_PX);
+        g_touch_swipe.last_swipe_ms = now_ms;
+        app_slide_finish(commit);
+        ESP_LOGI(APP_TAG, "touch: page drag dx=%d %s -> view=%d", delta_x, commit ? "commit" : "cancel", (int)g_app.view);
+        return;
+    }
 
     if (abs_delta_x <= TOUCH_TAP_MAX_MOVE_PX && abs_delta_y <= TOUCH_TAP_MAX_MOVE_PX)
     {
@@ -348,19 +416,58 @@ void app_poll_touch_swipe(uint32_t now_ms)
         return;
     }
 
+    if (radar_drag)
+    {
+        return;
+    }
+
+    if (hourly_drag && g_touch_swipe.hourly_at_top && delta_y >= TOUCH_SWIPE_MIN_Y_PX)
+    {
+        // Pulling down on the first hour goes back to the day rows, as swiping earlier
+        // from the first day always did
+        g_touch_swipe.hourly_pending_dy = 0;
+        g_touch_swipe.last_swipe_ms = now_ms;
+        app_close_forecast_hourly();
+        ESP_LOGI(APP_TAG, "touch: hourly pull down dy=%d -> close", delta_y);
+        return;
+    }
+
+    if (hourly_drag)
+    {
+        int32_t velocity = g_touch_swipe.velocity_y;
+        if ((uint32_t)(now_ms - g_touch_swipe.last_move_ms) > TOUCH_FLING_HOLD_MS)
+        {
+            velocity = 0;
+        }
+        if (lvgl_lock_with_retry(pdMS_TO_TICKS(50), 2, "hourly fling"))
+        {
+            if (g_touch_swipe.hourly_pending_dy != 0)
+            {
+                drawing_screen_hourly_drag(g_touch_swipe.hourly_pending_dy);
+            }
+            drawing_screen_hourly_fling((int)velocity);
+            lvgl_port_unlock();
+        }
+        g_touch_swipe.hourly_pending_dy = 0;
+        ESP_LOGI(APP_TAG, "touch: hourly drag dy=%d fling=%d px/s", delta_y, (int)velocity);
+        return;
+    }
+
     if ((uint32_t)(now_ms - g_touch_swipe.last_swipe_ms) < TOUCH_SWIPE_COOLDOWN_MS)
     {
         return;
     }
 
-    if (g_app.view == DRAWING_SCREEN_VIEW_FORECAST && g_app.forecast_hourly_open)
+    if (!(g_app.view == DRAWING_SCREEN_VIEW_FORECAST && g_app.forecast_hourly_open) &&
+        (g_app.view == DRAWING_SCREEN_VIEW_NOW || g_app.view == DRAWING_SCREEN_VIEW_FORECAST) &&
+        g_app.location_count > 1)
     {
-        if (abs_delta_y >= TOUCH_SWIPE_MIN_Y_PX && abs_delta_y >= abs_delta_x)
+        if (abs_delta_y >= TOUCH_SWIPE_MIN_Y_PX && abs_delta_y > abs_delta_x)
         {
             g_touch_swipe.last_swipe_ms = now_ms;
-            // Swipe up shows later hours; swipe down shows earlier hours.
-            app_scroll_forecast_hourly((delta_y < 0) ? 1 : -1);
-            ESP_LOGI(APP_TAG, "touch: hourly swipe dx=%d dy=%d", delta_x, delta_y);
+            // Swipe up shows the next saved location; swipe down the previous one.
+            app_locations_step((delta_y < 0) ? 1 : -1, now_ms);
+            ESP_LOGI(APP_TAG, "touch: location swipe dx=%d dy=%d", delta_x, delta_y);
             return;
         }
     }
@@ -372,44 +479,8 @@ void app_poll_touch_swipe(uint32_t now_ms)
 
     g_touch_swipe.last_swipe_ms = now_ms;
 
-    auto next_view = [](drawing_screen_view_t v) {
-        switch (v)
-        {
-        case DRAWING_SCREEN_VIEW_NOW:
-            return DRAWING_SCREEN_VIEW_FORECAST;
-        case DRAWING_SCREEN_VIEW_INDOOR:
-            return DRAWING_SCREEN_VIEW_NOW;
-        case DRAWING_SCREEN_VIEW_FORECAST:
-            return DRAWING_SCREEN_VIEW_I2C_SCAN;
-        case DRAWING_SCREEN_VIEW_I2C_SCAN:
-            return DRAWING_SCREEN_VIEW_WIFI_SCAN;
-        case DRAWING_SCREEN_VIEW_WIFI_SCAN:
-            return DRAWING_SCREEN_VIEW_ABOUT;
-        case DRAWING_SCREEN_VIEW_ABOUT:
-        default:
-            return DRAWING_SCREEN_VIEW_INDOOR;
-        }
-    };
-    auto prev_view = [](drawing_screen_view_t v) {
-        switch (v)
-        {
-        case DRAWING_SCREEN_VIEW_NOW:
-            return DRAWING_SCREEN_VIEW_INDOOR;
-        case DRAWING_SCREEN_VIEW_INDOOR:
-            return DRAWING_SCREEN_VIEW_ABOUT;
-        case DRAWING_SCREEN_VIEW_FORECAST:
-            return DRAWING_SCREEN_VIEW_NOW;
-        case DRAWING_SCREEN_VIEW_I2C_SCAN:
-            return DRAWING_SCREEN_VIEW_FORECAST;
-        case DRAWING_SCREEN_VIEW_WIFI_SCAN:
-            return DRAWING_SCREEN_VIEW_I2C_SCAN;
-        case DRAWING_SCREEN_VIEW_ABOUT:
-        default:
-            return DRAWING_SCREEN_VIEW_WIFI_SCAN;
-        }
-    };
-
-    drawing_screen_view_t next = (delta_x < 0) ? next_view(g_app.view) : prev_view(g_app.view);
+    // Only reached when no slide could start (surfaces unavailable): cut straight to the page
+    drawing_screen_view_t next = (delta_x < 0) ? app_next_view(g_app.view) : app_prev_view(g_app.view);
     app_set_screen(next);
     ESP_LOGI(APP_TAG, "touch: page swipe dx=%d dy=%d -> view=%d", delta_x, delta_y, (int)next);
 }
@@ -423,27 +494,65 @@ void app_apply_forecast_payload(const forecast_payload_t *fc)
 
     g_forecast_cache = *fc;
 
+    // A cache restored from NVS can start in the past; drop the days that are over
+    time_t now = time(NULL);
+    struct tm tm_now = {};
+    gmtime_r(&now, &tm_now);
+    if (tm_now.tm_year >= (2024 - 1900))
+    {
+        int64_t today = ((int64_t)now + g_forecast_cache.tz_offset_s) / 86400;
+        uint8_t stale = 0;
+        while (stale < g_forecast_cache.day_count && g_forecast_cache.days[stale].day_num < today)
+        {
+            ++stale;
+        }
+        if (stale > 0)
+        {
+            g_forecast_cache.day_count -= stale;
+            memmove(&g_forecast_cache.days[0], &g_forecast_cache.days[stale],
+                    g_forecast_cache.day_count * sizeof(g_forecast_cache.days[0]));
+        }
+    }
+    const forecast_payload_t *model = &g_forecast_cache;
+
     snprintf(g_app.forecast_title_text, sizeof(g_app.forecast_title_text), "Forecast");
     snprintf(g_app.forecast_body_text, sizeof(g_app.forecast_body_text), "Daily highs/lows");
-    snprintf(g_app.forecast_preview_text, sizeof(g_app.forecast_preview_text), "%s", fc->preview_text);
-    g_app.forecast_row_count = (fc->row_count > APP_FORECAST_ROWS) ? APP_FORECAST_ROWS : fc->row_count;
+    g_app.forecast_row_count = (model->day_count > APP_FORECAST_ROWS) ? APP_FORECAST_ROWS : model->day_count;
     g_app.forecast_preview_count = (g_app.forecast_row_count > APP_PREVIEW_DAYS) ? APP_PREVIEW_DAYS : g_app.forecast_row_count;
 
     for (int i = 0; i < APP_FORECAST_ROWS; ++i)
     {
-        snprintf(g_app.forecast_row_title[i], sizeof(g_app.forecast_row_title[i]), "%s", fc->rows[i].title);
-        snprintf(g_app.forecast_row_detail[i], sizeof(g_app.forecast_row_detail[i]), "%s", fc->rows[i].detail);
-        snprintf(g_app.forecast_row_temp[i], sizeof(g_app.forecast_row_temp[i]), "%s", fc->rows[i].temp_text);
-        g_app.forecast_row_icon[i] = fc->rows[i].icon;
+        if (i < g_app.forecast_row_count)
+        {
+            const forecast_day_t *day = &model->days[i];
+            snprintf(g_app.forecast_row_title[i], sizeof(g_app.forecast_row_title[i]), "%s", forecast_day_name(day));
+            snprintf(g_app.forecast_row_detail[i], sizeof(g_app.forecast_row_detail[i]), "%s Low %d° Wind %u",
+                     forecast_condition_short(day->weather_id), day->low_f, (unsigned)day->wind_mph);
+            snprintf(g_app.forecast_row_temp[i], sizeof(g_app.forecast_row_temp[i]), "%d°", day->high_f);
+            g_app.forecast_row_icon[i] = (drawing_weather_icon_t)day->icon;
+        }
+        else
+        {
+            snprintf(g_app.forecast_row_title[i], sizeof(g_app.forecast_row_title[i]), "--");
+            snprintf(g_app.forecast_row_detail[i], sizeof(g_app.forecast_row_detail[i]), "Low --° Wind --");
+            snprintf(g_app.forecast_row_temp[i], sizeof(g_app.forecast_row_temp[i]), "--°");
+            g_app.forecast_row_icon[i] = DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
+        }
     }
+
+    g_app.forecast_preview_text[0] = '\0';
     for (int i = 0; i < APP_PREVIEW_DAYS; ++i)
     {
         if (i < g_app.forecast_preview_count)
         {
-            snprintf(g_app.forecast_preview_day[i], sizeof(g_app.forecast_preview_day[i]), "%.7s", fc->rows[i].title);
-            snprintf(g_app.forecast_preview_hi[i], sizeof(g_app.forecast_preview_hi[i]), "%d°", fc->rows[i].temp_f);
-            snprintf(g_app.forecast_preview_low[i], sizeof(g_app.forecast_preview_low[i]), "%d°", fc->rows[i].feels_f);
-            g_app.forecast_preview_icon[i] = fc->rows[i].icon;
+            const forecast_day_t *day = &model->days[i];
+            size_t len = strlen(g_app.forecast_preview_text);
+            snprintf(g_app.forecast_preview_text + len, sizeof(g_app.forecast_preview_text) - len, "%s%s %d°",
+                     (i > 0) ? "   " : "", forecast_day_name(day), day->high_f);
+            snprintf(g_app.forecast_preview_day[i], sizeof(g_app.forecast_preview_day[i]), "%s", forecast_day_name(day));
+            snprintf(g_app.forecast_preview_hi[i], sizeof(g_app.forecast_preview_hi[i]), "%d°", day->high_f);
+            snprintf(g_app.forecast_preview_low[i], sizeof(g_app.forecast_preview_low[i]), "%d°", day->low_f);
+            g_app.forecast_preview_icon[i] = (drawing_weather_icon_t)day->icon;
         }
         else
         {
@@ -454,16 +563,15 @@ void app_apply_forecast_payload(const forecast_payload_t *fc)
         }
     }
 
+    app_build_forecast_hourly_items();
     if (g_app.forecast_hourly_open)
     {
-        if (g_app.forecast_hourly_day >= g_app.forecast_row_count ||
-            g_forecast_cache.days[g_app.forecast_hourly_day].count == 0)
+        if (g_app.forecast_hourly_count == 0)
         {
             app_close_forecast_hourly();
         }
         else
         {
-            app_build_forecast_hourly_visible();
             app_mark_dirty(true, false, false, true);
         }
     }
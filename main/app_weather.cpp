@@ -9,23 +9,12 @@ const char *weekday_name(int wday)
     return WEEKDAY_SHORT[wday];
 }
 
-void format_hour_label(int hour24, char *out, size_t out_size)
-{
-    int hour12 = hour24 % 12;
-    if (hour12 == 0)
-    {
-        hour12 = 12;
-    }
-    const char *ampm = (hour24 >= 12) ? "PM" : "AM";
-    snprintf(out, out_size, "%d%s", hour12, ampm);
-}
-
 static bool owm_icon_is_night(const char *icon_code)
 {
     return (icon_code != NULL && strlen(icon_code) >= 3 && icon_code[2] == 'n');
 }
 
-static const char *forecast_condition_short(int weather_id)
+const char *forecast_condition_short(int weather_id)
 {
     if (weather_id >= 200 && weather_id < 300)
     {
@@ -236,23 +225,32 @@ bool parse_weather_json(const char *json_text, weather_payload_t *out)
     return true;
 }
 
-static void forecast_payload_set_defaults(forecast_payload_t *out)
+static int8_t forecast_clamp_i8(float value)
+{
+    long v = lroundf(value);
+    if (v < INT8_MIN)
+    {
+        return INT8_MIN;
+    }
+    if (v > INT8_MAX)
+    {
+        return INT8_MAX;
+    }
+    return (int8_t)v;
+}
+
+static uint8_t forecast_clamp_u8(float value)
 {
-    static const char *default_titles[APP_FORECAST_ROWS] = {
-        "Tue", "Wed", "Thu", "Fri"};
-    out->row_count = APP_FORECAST_ROWS;
-    for (int i = 0; i < APP_FORECAST_ROWS; ++i)
-    {
-        snprintf(out->rows[i].title, sizeof(out->rows[i].title), "%s", default_titles[i]);
-        snprintf(out->rows[i].detail, sizeof(out->rows[i].detail), "Low --° Wind --");
-        snprintf(out->rows[i].temp_text, sizeof(out->rows[i].temp_text), "--°");
-        out->rows[i].temp_f = 0;
-        out->rows[i].feels_f = 0;
-        out->rows[i].wind_mph = 0;
-        out->rows[i].icon = DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
-        out->days[i].count = 0;
-    }
-    snprintf(out->preview_text, sizeof(out->preview_text), "Tue --°   Wed --°   Thu --°");
+    long v = lroundf(value);
+    if (v < 0)
+    {
+        return 0;
+    }
+    if (v > UINT8_MAX)
+    {
+        return UINT8_MAX;
+    }
+    return (uint8_t)v;
 }
 
 bool parse_forecast_json(const char *json_text, forecast_payload_t *out)
@@ -262,7 +260,8 @@ bool parse_forecast_json(const char *json_text, forecast_payload_t *out)
         return false;
     }
 
-    forecast_payload_set_defaults(out);
+    memset(out, 0, sizeof(*out));
+    out->version = APP_FORECAST_CACHE_VERSION;
 
     cJSON *root = cJSON_Parse(json_text);
     if (root == NULL)
@@ -280,27 +279,24 @@ bool parse_forecast_json(const char *json_text, forecast_payload_t *out)
     cJSON *city = cJSON_GetObjectItemCaseSensitive(root, "city");
     cJSON *timezone = (city != NULL) ? cJSON_GetObjectItemCaseSensitive(city, "timezone") : NULL;
     int tz_offset = json_read_int(timezone, 0);
+    out->tz_offset_s = tz_offset;
 
     typedef struct {
-        int year;
-        int yday;
-        int wday;
+        int day_num;
         float high_f;
         float low_f;
         float wind_peak_mph;
         drawing_weather_icon_t icon;
-        char condition_short[20];
+        int weather_id;
         int icon_score;
-        forecast_hourly_payload_t hourly[APP_FORECAST_HOURLY_MAX];
-        bool set;
-        bool icon_set;
-        uint8_t hourly_count;
+        uint8_t first_slot;
+        uint8_t slot_count;
     } day_summary_t;
 
-    static day_summary_t days[APP_FORECAST_MAX_DAYS];
-    memset(days, 0, sizeof(days));
+    day_summary_t days[APP_FORECAST_MAX_DAYS] = {};
     int day_count = 0;
     int first_entry_hour = -1;
+    int64_t base_utc = 0;
 
     int list_count = cJSON_GetArraySize(list);
     for (int i = 0; i < list_count; ++i)
@@ -331,42 +327,32 @@ bool parse_forecast_json(const char *json_text, forecast_payload_t *out)
         float wind_speed_f = 0.0f;
         bool has_wind_speed = json_read_float(wind_speed, &wind_speed_f);
 
-        time_t local_epoch = (time_t)(dt_value + (int64_t)tz_offset);
-        struct tm tm_local = {};
-        gmtime_r(&local_epoch, &tm_local);
+        int64_t local_epoch = dt_value + (int64_t)tz_offset;
+        int day_num = (int)(local_epoch / 86400);
+        int hour = (int)((local_epoch % 86400) / 3600);
         if (first_entry_hour < 0)
         {
-            first_entry_hour = tm_local.tm_hour;
+            first_entry_hour = hour;
+            base_utc = dt_value;
         }
 
-        int idx = -1;
-        for (int d = 0; d < day_count; ++d)
-        {
-            if (days[d].set && days[d].year == tm_local.tm_year && days[d].yday == tm_local.tm_yday)
-            {
-                idx = d;
-                break;
-            }
-        }
-        if (idx < 0)
+        // Entries are in time order, so each day's slots are contiguous
+        int idx = day_count - 1;
+        if (idx < 0 || days[idx].day_num != day_num)
         {
             if (day_count >= APP_FORECAST_MAX_DAYS)
             {
                 continue;
             }
             idx = day_count++;
-            days[idx].set = true;
-            days[idx].year = tm_local.tm_year;
-            days[idx].yday = tm_local.tm_yday;
-            days[idx].wday = tm_local.tm_wday;
+            days[idx].day_num = day_num;
             days[idx].high_f = temp_f;
             days[idx].low_f = temp_f;
             days[idx].wind_peak_mph = has_wind_speed ? wind_speed_f : 0.0f;
             days[idx].icon = DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
-            snprintf(days[idx].condition_short, sizeof(days[idx].condition_short), "Cloudy");
-            days[idx].icon_set = false;
+            days[idx].weather_id = 802;
             days[idx].icon_score = -1;
-            days[idx].hourly_count = 0;
+            days[idx].first_slot = out->slot_count;
         }
         if (temp_f > days[idx].high_f)
         {
@@ -392,11 +378,11 @@ bool parse_forecast_json(const char *json_text, forecast_payload_t *out)
             weather_icon_value);
 
         int icon_score = 0;
-        if (tm_local.tm_hour == 12)
+        if (hour == 12)
         {
             icon_score = 3;
         }
-        else if (tm_local.tm_hour == 9 || tm_local.tm_hour == 15)
+        else if (hour == 9 || hour == 15)
         {
             icon_score = 2;
         }
@@ -404,41 +390,37 @@ bool parse_forecast_json(const char *json_text, forecast_payload_t *out)
         {
             icon_score = 1;
         }
-        if (!days[idx].icon_set || icon_score > days[idx].icon_score)
+        if (icon_score > days[idx].icon_score)
         {
             days[idx].icon = mapped_icon;
-            snprintf(days[idx].condition_short, sizeof(days[idx].condition_short), "%s",
-                     forecast_condition_short(weather_id_value));
-            days[idx].icon_set = true;
+            days[idx].weather_id = weather_id_value;
             days[idx].icon_score = icon_score;
         }
 
-        if (days[idx].hourly_count < APP_FORECAST_HOURLY_MAX)
+        int64_t offset_min = (dt_value - base_utc) / 60;
+        if (out->slot_count < APP_FORECAST_SLOTS && offset_min >= 0 && offset_min <= UINT16_MAX)
         {
-            forecast_hourly_payload_t *slot = &days[idx].hourly[days[idx].hourly_count];
-            int temp_i = (int)lroundf(temp_f);
+            forecast_slot_t *slot = &out->slots[out->slot_count++];
             cJSON *feels_like = cJSON_GetObjectItemCaseSensitive(main_obj, "feels_like");
             float feels_like_f = temp_f;
             (void)json_read_float(feels_like, &feels_like_f);
-            int feels_i = (int)lroundf(feels_like_f);
-            int wind_i = has_wind_speed ? (int)lroundf(wind_speed_f) : 0;
-
-            slot->temp_f = temp_i;
-            slot->feels_f = feels_i;
-            slot->wind_mph = wind_i;
-            slot->icon = mapped_icon;
-            format_hour_label(tm_local.tm_hour, slot->time_text, sizeof(slot->time_text));
-            snprintf(slot->detail, sizeof(slot->detail), "Feels %d° Wind %d", feels_i, wind_i);
-            snprintf(slot->temp_text, sizeof(slot->temp_text), "%d°", temp_i);
-            days[idx].hourly_count++;
+
+            slot->offset_min = (uint16_t)offset_min;
+            slot->temp_f = forecast_clamp_i8(temp_f);
+            slot->feels_f = forecast_clamp_i8(feels_like_f);
+            slot->wind_mph = has_wind_speed ? forecast_clamp_u8(wind_speed_f) : 0;
+            slot->icon = (uint8_t)mapped_icon;
+            days[idx].slot_count++;
         }
     }
+    out->base_utc = (uint32_t)base_utc;
 
     int start_day = 0;
     if (day_count > 1 && first_entry_hour > 0)
     {
         // OWM 5-day forecast starts from the next 3h slot; if it is not midnight,
         // the first grouped day is a partial "today" bucket. Skip it for day-ahead UI.
+        // Its slots stay in the model for the hourly horizon.
         start_day = 1;
     }
 
@@ -449,49 +431,19 @@ bool parse_forecast_json(const char *json_text, forecast_payload_t *out)
     }
 
     int row_count = (available_days < APP_FORECAST_ROWS) ? available_days : APP_FORECAST_ROWS;
-    out->row_count = (uint8_t)row_count;
+    out->day_count = (uint8_t)row_count;
     for (int i = 0; i < row_count; ++i)
     {
         const day_summary_t *day = &days[start_day + i];
-        forecast_row_payload_t *row = &out->rows[i];
-        int high_i = (int)lroundf(day->high_f);
-        int low_i = (int)lroundf(day->low_f);
-        int wind_i = (int)lroundf(day->wind_peak_mph);
-
-        row->temp_f = high_i;
-        row->feels_f = low_i;
-        row->wind_mph = wind_i;
-        row->icon = day->icon_set ? day->icon : DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY;
-
-        snprintf(row->title, sizeof(row->title), "%s", weekday_name(day->wday));
-        snprintf(row->detail, sizeof(row->detail), "%s Low %d° Wind %d",
-                 day->condition_short, low_i, wind_i);
-        snprintf(row->temp_text, sizeof(row->temp_text), "%d°", high_i);
-
-        out->days[i].count = day->hourly_count;
-        for (int h = 0; h < day->hourly_count && h < APP_FORECAST_HOURLY_MAX; ++h)
-        {
-            out->days[i].entries[h] = day->hourly[h];
-        }
-    }
-
-    int preview_count = (available_days < APP_PREVIEW_DAYS) ? available_days : APP_PREVIEW_DAYS;
-    if (preview_count > 0)
-    {
-        out->preview_text[0] = '\0';
-        for (int i = 0; i < preview_count; ++i)
-        {
-            char day_chunk[32] = {0};
-            const day_summary_t *day = &days[start_day + i];
-            int high_i = (int)lroundf(day->high_f);
-            snprintf(day_chunk, sizeof(day_chunk), "%s %d°", weekday_name(day->wday), high_i);
-
-            if (i > 0)
-            {
-                strncat(out->preview_text, "   ", sizeof(out->preview_text) - strlen(out->preview_text) - 1);
-            }
-            strncat(out->preview_text, day_chunk, sizeof(out->preview_text) - strlen(out->preview_text) - 1);
-        }
+        forecast_day_t *row = &out->days[i];
+        row->day_num = (uint16_t)day->day_num;
+        row->weather_id = (uint16_t)day->weather_id;
+        row->high_f = forecast_clamp_i8(day->high_f);
+        row->low_f = forecast_clamp_i8(day->low_f);
+        row->wind_mph = forecast_clamp_u8(day->wind_peak_mph);
+        row->icon = (uint8_t)day->icon;
+        row->first_slot = day->first_slot;
+        row->slot_count = day->slot_count;
     }
 
     cJSON_Delete(root);
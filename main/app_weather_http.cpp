@@ -5,7 +5,7 @@ static bool is_https_url(const char *url)
     return (url != NULL) && (strncmp(url, "https://", 8) == 0);
 }
 
-static esp_http_client_handle_t http_client_create(const char *url)
+esp_http_client_handle_t app_http_client_create(const char *url)
 {
     esp_http_client_config_t config = {};
     config.url = url;
@@ -94,126 +94,103 @@ static esp_err_t http_get_text_once(esp_http_client_handle_t client, const char
     return err;
 }
 
-bool weather_fetch_once(void)
+// Runs on the weather fetch task: no g_app access, failures are described in error.
+// *client is created on first use and kept for keep-alive; it is cleaned up and
+// cleared after a transport error. Returns true once wx holds the current conditions;
+// *forecast_ok says whether fc was fetched too, so a failed forecast call does not
+// throw away a good current-weather parse.
+bool weather_fetch_query(esp_http_client_handle_t *client, const char *query, weather_payload_t *wx,
+                         forecast_payload_t *fc, bool *forecast_ok, char *error, size_t error_size)
 {
-    const char *weather_query = app_config_weather_query();
+    *forecast_ok = false;
     const char *weather_api_key = app_config_weather_api_key();
-    if (weather_query == NULL || weather_query[0] == '\0' || weather_api_key == NULL || weather_api_key[0] == '\0')
+    if (query == NULL || query[0] == '\0' || weather_api_key == NULL || weather_api_key[0] == '\0')
     {
-        app_set_status_fmt("https: missing weather query or API key");
-        app_set_bottom_fmt("set API/query config");
+        snprintf(error, error_size, "https: missing weather query or API key");
         return false;
     }
 
     char weather_url[512] = {0};
     int weather_url_len = snprintf(weather_url, sizeof(weather_url),
                                    "https://api.openweathermap.org/data/2.5/weather?%s&units=imperial&appid=%s",
-                                   weather_query, weather_api_key);
+                                   query, weather_api_key);
     if (weather_url_len <= 0 || weather_url_len >= (int)sizeof(weather_url))
     {
-        app_set_status_fmt("https: url build failed");
-        app_set_bottom_fmt("weather URL error");
+        snprintf(error, error_size, "https: url build failed");
         return false;
     }
 
     char forecast_url[512] = {0};
     int forecast_url_len = snprintf(forecast_url, sizeof(forecast_url),
                                     "https://api.openweathermap.org/data/2.5/forecast?%s&units=imperial&appid=%s",
-                                    weather_query, weather_api_key);
+                                    query, weather_api_key);
     if (forecast_url_len <= 0 || forecast_url_len >= (int)sizeof(forecast_url))
     {
-        app_set_status_fmt("https: forecast url build failed");
-        app_set_bottom_fmt("forecast URL error");
+        snprintf(error, error_size, "https: forecast url build failed");
         return false;
     }
 
-    esp_http_client_handle_t client = http_client_create(weather_url);
-    if (client == NULL)
+    if (*client == NULL)
     {
-        app_set_status_fmt("https: client init failed");
-        app_set_bottom_fmt("retry in %u s", (unsigned)(WEATHER_RETRY_MS / 1000));
-        return false;
-    }
-    struct http_client_guard_t {
-        esp_http_client_handle_t handle;
-        ~http_client_guard_t()
+        *client = app_http_client_create(weather_url);
+        if (*client == NULL)
         {
-            if (handle != NULL)
-            {
-                esp_http_client_cleanup(handle);
-            }
+            snprintf(error, error_size, "https: client init failed");
+            return false;
         }
-    } client_guard = {client};
-
-    app_set_status_fmt("https: GET weather (%s)", weather_query);
-    app_set_bottom_fmt("fetching current conditions...");
-    app_render_if_dirty();
+    }
 
     static char weather_response[WEATHER_HTTP_BUFFER_SIZE] = {0};
     int http_status = 0;
     int http_bytes = 0;
-    esp_err_t err = http_get_text_once(client, weather_url, weather_response, sizeof(weather_response), &http_status, &http_bytes);
-
+    esp_err_t err = http_get_text_once(*client, weather_url, weather_response, sizeof(weather_response), &http_status, &http_bytes);
     if (err != ESP_OK)
     {
-        app_set_status_fmt("https: transport error %s", esp_err_to_name(err));
-        app_set_bottom_fmt("retry in %u s", (unsigned)(WEATHER_RETRY_MS / 1000));
+        snprintf(error, error_size, "https: transport error %s", esp_err_to_name(err));
+        esp_http_client_cleanup(*client);
+        *client = NULL;
         return false;
     }
 
-    app_set_status_fmt("https: status %d bytes %d", http_status, http_bytes);
-
     if (http_status != 200)
     {
-        snprintf(g_app.weather_text, sizeof(g_app.weather_text), "API returned status %d", http_status);
-        app_mark_dirty(false, true, false, false);
-        app_set_bottom_fmt("retry in %u s", (unsigned)(WEATHER_RETRY_MS / 1000));
+        snprintf(error, error_size, "API returned status %d", http_status);
         return false;
     }
 
-    weather_payload_t wx = {};
-    if (!parse_weather_json(weather_response, &wx))
+    memset(wx, 0, sizeof(*wx));
+    if (!parse_weather_json(weather_response, wx))
     {
-        app_set_status_fmt("json: parse failed");
-        snprintf(g_app.weather_text, sizeof(g_app.weather_text), "weather JSON parse failed");
-        app_mark_dirty(false, true, false, false);
-        app_set_bottom_fmt("retry in %u s", (unsigned)(WEATHER_RETRY_MS / 1000));
+        snprintf(error, error_size, "weather JSON parse failed");
         return false;
     }
 
-    app_apply_weather(&wx);
-
-    app_set_status_fmt("https: GET forecast");
-    app_render_if_dirty();
-
     static char forecast_response[WEATHER_FORECAST_HTTP_BUFFER_SIZE] = {0};
     int fc_status = 0;
     int fc_bytes = 0;
-    err = http_get_text_once(client, forecast_url, forecast_response, sizeof(forecast_response), &fc_status, &fc_bytes);
+    err = http_get_text_once(*client, forecast_url, forecast_response, sizeof(forecast_response), &fc_status, &fc_bytes);
     if (err != ESP_OK)
     {
-        app_set_status_fmt("https: forecast transport %s", esp_err_to_name(err));
-        app_set_bottom_fmt("forecast retry in %u s", (unsigned)(WEATHER_RETRY_MS / 1000));
-        return false;
+        snprintf(error, error_size, "https: forecast transport %s", esp_err_to_name(err));
+        esp_http_client_cleanup(*client);
+        *client = NULL;
+        return true;
     }
 
     if (fc_status != 200)
     {
-        app_set_status_fmt("https: forecast status %d", fc_status);
-        app_set_bottom_fmt("forecast retry in %u s", (unsigned)(WEATHER_RETRY_MS / 1000));
-        return false;
+        snprintf(error, error_size, "https: forecast status %d", fc_status);
+        return true;
     }
 
-    memset(&g_forecast_cache, 0, sizeof(g_forecast_cache));
-    if (!parse_forecast_json(forecast_response, &g_forecast_cache))
+    memset(fc, 0, sizeof(*fc));
+    if (!parse_forecast_json(forecast_response, fc))
     {
-        app_set_status_fmt("json: forecast parse failed");
-        app_set_bottom_fmt("forecast retry in %u s", (unsigned)(WEATHER_RETRY_MS / 1000));
-        return false;
+        snprintf(error, error_size, "json: forecast parse failed");
+        return true;
     }
 
-    app_apply_forecast_payload(&g_forecast_cache);
-    app_set_status_fmt("sync: ok %s %s", wx.city, wx.country);
-    app_set_bottom_fmt("next sync in %u min", (unsigned)(WEATHER_REFRESH_MS / 60000));
+    *forecast_ok = true;
+    ESP_LOGI(APP_TAG, "weather: %s -> %s, %s (%d + %d bytes)", query, wx->city, wx->country, http_bytes, fc_bytes);
     return true;
 }
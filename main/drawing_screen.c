@@ -5,6 +5,7 @@
 
 #include "esp_app_desc.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #ifndef PROJECT_VER
 #define PROJECT_VER "dev"
@@ -253,6 +254,8 @@ void drawing_screen_init(void)
         lv_obj_set_pos(forecast_row_temp_labels[i], screen_w - 94, 50 + i * 64);
     }
 
+    hourly_list_create(screen);
+
     if (i2c_scan_title_label == NULL)
     {
         i2c_scan_title_label = lv_label_create(screen);
@@ -302,35 +305,35 @@ void drawing_screen_init(void)
     apply_view_visibility(DRAWING_SCREEN_VIEW_NOW);
     draw_now_background(DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY);
 
-    lv_label_set_text(header_time_label, "10:42 AM");
-    lv_label_set_text(header_title_label, "St Charles, MO");
-    lv_label_set_text(status_label, "Wi-Fi");
-    lv_label_set_text(now_temp_label, "72°");
-    lv_label_set_text(now_time_label, "10:42 AM");
-    lv_label_set_text(now_condition_label, "FEELS 69°");
-    lv_label_set_text(now_weather_label, "(Partly Cloudy)");
-    lv_label_set_text(now_stats_1_label, "Indoor --°F");
-    lv_label_set_text(now_stats_2_label, "--% RH");
-    lv_label_set_text(now_stats_3_label, "-- hPa");
-    lv_label_set_text(indoor_temp_label, "Indoor --.-°F");
-    lv_label_set_text(indoor_humidity_label, "--% RH");
-    lv_label_set_text(indoor_pressure_label, "-- hPa");
-    lv_label_set_text(bottom_label, "(swipe right for indoor, left for forecast)");
+    set_label_text(header_time_label, "10:42 AM");
+    set_label_text(header_title_label, "St Charles, MO");
+    set_label_text(status_label, "Wi-Fi");
+    set_label_text(now_temp_label, "72°");
+    set_label_text(now_time_label, "10:42 AM");
+    set_label_text(now_condition_label, "FEELS 69°");
+    set_label_text(now_weather_label, "(Partly Cloudy)");
+    set_label_text(now_stats_1_label, "Indoor --°F");
+    set_label_text(now_stats_2_label, "--% RH");
+    set_label_text(now_stats_3_label, "-- hPa");
+    set_label_text(indoor_temp_label, "Indoor --.-°F");
+    set_label_text(indoor_humidity_label, "--% RH");
+    set_label_text(indoor_pressure_label, "-- hPa");
+    set_label_text(bottom_label, "(swipe right for indoor, left for forecast)");
     for (int i = 0; i < DRAWING_SCREEN_PREVIEW_DAYS; ++i)
     {
-        lv_label_set_text(now_preview_labels[i], "Tue\n--°/--°");
+        set_label_text(now_preview_labels[i], "Tue\n--°/--°");
     }
 
     for (int i = 0; i < FORECAST_ROWS; ++i)
     {
-        lv_label_set_text(forecast_row_title_labels[i], MOCK_FORECAST_TITLES[i]);
-        lv_label_set_text(forecast_row_detail_labels[i], FALLBACK_FORECAST_DETAILS[i]);
-        lv_label_set_text(forecast_row_temp_labels[i], "--°");
+        set_label_text(forecast_row_title_labels[i], MOCK_FORECAST_TITLES[i]);
+        set_label_text(forecast_row_detail_labels[i], FALLBACK_FORECAST_DETAILS[i]);
+        set_label_text(forecast_row_temp_labels[i], "--°");
     }
-    lv_label_set_text(i2c_scan_title_label, "I2C Bus Scan");
-    lv_label_set_text(i2c_scan_body_label, "Scan pending...");
-    lv_label_set_text(wifi_scan_title_label, "Wi-Fi Networks");
-    lv_label_set_text(wifi_scan_body_label, "Scan pending...");
+    set_label_text(i2c_scan_title_label, "I2C Bus Scan");
+    set_label_text(i2c_scan_body_label, "Scan pending...");
+    set_label_text(wifi_scan_title_label, "Wi-Fi Networks");
+    set_label_text(wifi_scan_body_label, "Scan pending...");
 
     ESP_LOGI(DRAWING_TAG, "rendered mock-matched weather screen (%dx%d)", screen_w, screen_h);
 }
@@ -341,17 +344,24 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
     {
         return;
     }
+    int64_t render_start_us = esp_timer_get_time();
 
     bool refresh_header = (dirty == NULL) ? true : dirty->header;
     bool refresh_main = (dirty == NULL) ? true : dirty->main;
     bool refresh_stats = (dirty == NULL) ? true : dirty->stats;
     bool refresh_bottom = (dirty == NULL) ? true : dirty->bottom;
 
+    hourly_list_sync(data);
+
     bool view_changed = (data->view != current_view);
     if (view_changed)
     {
         current_view = data->view;
         apply_view_visibility(current_view);
+        if (current_view != DRAWING_SCREEN_VIEW_NOW)
+        {
+            icon_anim_stop();
+        }
         refresh_header = true;
         refresh_main = true;
         refresh_stats = true;
@@ -365,10 +375,10 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
             char signal[24] = {0};
             build_signal_text(data->status_text, signal, sizeof(signal));
 
-            lv_label_set_text(header_time_label, text_or_fallback(data->time_text, "--:-- --"));
-            lv_label_set_text(header_title_label, text_or_fallback(data->weather_text, "St Charles, MO"));
-            lv_label_set_text(status_label, signal);
-            lv_label_set_text(now_time_label, text_or_fallback(data->now_time_text, "--:--"));
+            set_label_text(header_time_label, text_or_fallback(data->time_text, "--:-- --"));
+            set_label_text(header_title_label, text_or_fallback(data->weather_text, "St Charles, MO"));
+            set_label_text(status_label, signal);
+            set_label_text(now_time_label, text_or_fallback(data->now_time_text, "--:--"));
 
             lv_obj_set_pos(header_time_label, 14, 4);
             lv_obj_align(header_title_label, LV_ALIGN_TOP_MID, 0, 4);
@@ -376,9 +386,9 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
         }
         else if (current_view == DRAWING_SCREEN_VIEW_INDOOR)
         {
-            lv_label_set_text(header_time_label, "Indoor Sensor");
-            lv_label_set_text(header_title_label, "");
-            lv_label_set_text(status_label, "< Main  > Forecast");
+            set_label_text(header_time_label, "Indoor Sensor");
+            set_label_text(header_title_label, "");
+            set_label_text(status_label, "< Main  > Forecast");
 
             lv_obj_set_pos(header_time_label, 14, 4);
             lv_obj_align(status_label, LV_ALIGN_TOP_RIGHT, -12, 8);
@@ -387,42 +397,53 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
         {
             if (data->forecast_hourly_open)
             {
-                lv_label_set_text(header_time_label, text_or_fallback(data->forecast_hourly_day_title, "Hourly"));
-                lv_label_set_text(status_label, "◀ Main");
+                char title[24];
+                hourly_list_title(title, sizeof(title));
+                set_label_text(header_time_label, title);
+                set_label_text(status_label, "◀ Main");
             }
             else
             {
-                lv_label_set_text(header_time_label, "Forecast");
-                lv_label_set_text(status_label, "> I2C");
+                set_label_text(header_time_label, "Forecast");
+                set_label_text(status_label, "> Radar");
             }
-            lv_label_set_text(header_title_label, "");
+            set_label_text(header_title_label, "");
+
+            lv_obj_set_pos(header_time_label, 14, 4);
+            lv_obj_align(status_label, LV_ALIGN_TOP_RIGHT, -12, 8);
+        }
+        else if (current_view == DRAWING_SCREEN_VIEW_RADAR)
+        {
+            set_label_text(header_time_label, "Radar");
+            set_label_text(header_title_label, "");
+            set_label_text(status_label, "> I2C");
 
             lv_obj_set_pos(header_time_label, 14, 4);
             lv_obj_align(status_label, LV_ALIGN_TOP_RIGHT, -12, 8);
         }
         else if (current_view == DRAWING_SCREEN_VIEW_I2C_SCAN)
         {
-            lv_label_set_text(header_time_label, "I2C Scan");
-            lv_label_set_text(header_title_label, "");
-            lv_label_set_text(status_label, "> WiFi");
+            set_label_text(header_time_label, "I2C Scan");
+            set_label_text(header_title_label, "");
+            set_label_text(status_label, "> WiFi");
 
             lv_obj_set_pos(header_time_label, 14, 4);
             lv_obj_align(status_label, LV_ALIGN_TOP_RIGHT, -12, 8);
         }
         else if (current_view == DRAWING_SCREEN_VIEW_WIFI_SCAN)
         {
-            lv_label_set_text(header_time_label, "Wi-Fi Scan");
-            lv_label_set_text(header_title_label, "");
-            lv_label_set_text(status_label, "> About");
+            set_label_text(header_time_label, "Wi-Fi Scan");
+            set_label_text(header_title_label, "");
+            set_label_text(status_label, "> About");
 
             lv_obj_set_pos(header_time_label, 14, 4);
             lv_obj_align(status_label, LV_ALIGN_TOP_RIGHT, -12, 8);
         }
         else
         {
-            lv_label_set_text(header_time_label, "About");
-            lv_label_set_text(header_title_label, "");
-            lv_label_set_text(status_label, "> Main");
+            set_label_text(header_time_label, "About");
+            set_label_text(header_title_label, "");
+            set_label_text(status_label, "> Main");
 
             lv_obj_set_pos(header_time_label, 14, 4);
             lv_obj_align(status_label, LV_ALIGN_TOP_RIGHT, -12, 8);
@@ -447,14 +468,14 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
             lv_obj_set_pos(now_condition_label, 168, 132);
             lv_obj_set_pos(now_weather_label, 168, 168);
 
-            lv_label_set_text(now_temp_label, temp_compact);
-            lv_label_set_text(now_time_label, text_or_fallback(data->now_time_text, "--:--"));
-            lv_label_set_text(now_condition_label, feels_line);
-            lv_label_set_text(now_weather_label, condition_line);
+            set_label_text(now_temp_label, temp_compact);
+            set_label_text(now_time_label, text_or_fallback(data->now_time_text, "--:--"));
+            set_label_text(now_condition_label, feels_line);
+            set_label_text(now_weather_label, condition_line);
 
             lv_obj_set_width(bottom_label, screen_w - 24);
             lv_obj_set_pos(bottom_label, 12, screen_h - 22);
-            lv_label_set_text(bottom_label, "(swipe: right Indoor | left Forecast)");
+            set_label_text(bottom_label, "(swipe: right Indoor | left Forecast)");
             for (int i = 0; i < DRAWING_SCREEN_PREVIEW_DAYS; ++i)
             {
                 char row_line[40] = {0};
@@ -472,7 +493,7 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
                     snprintf(row_line, sizeof(row_line), "--\n--°/--°");
                 }
                 lv_obj_set_pos(now_preview_labels[i], card_x + 58, 244);
-                lv_label_set_text(now_preview_labels[i], row_line);
+                set_label_text(now_preview_labels[i], row_line);
             }
         }
         else if (current_view == DRAWING_SCREEN_VIEW_INDOOR)
@@ -488,87 +509,108 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
             lv_obj_set_pos(indoor_temp_label, 24, 76);
             lv_obj_set_pos(indoor_humidity_label, 24, 154);
             lv_obj_set_pos(indoor_pressure_label, 24, 232);
-            lv_label_set_text(indoor_temp_label, indoor_temp);
-            lv_label_set_text(indoor_humidity_label, text_or_fallback(data->indoor_line_2, "--% RH"));
-            lv_label_set_text(indoor_pressure_label, text_or_fallback(data->indoor_line_3, "-- hPa"));
+            set_label_text(indoor_temp_label, indoor_temp);
+            set_label_text(indoor_humidity_label, text_or_fallback(data->indoor_line_2, "--% RH"));
+            set_label_text(indoor_pressure_label, text_or_fallback(data->indoor_line_3, "-- hPa"));
 
             lv_obj_set_width(bottom_label, screen_w - 24);
             lv_obj_set_pos(bottom_label, 12, screen_h - 22);
-            lv_label_set_text(bottom_label, "(BME280 live data)");
+            set_label_text(bottom_label, "(BME280 live data)");
         }
         else if (current_view == DRAWING_SCREEN_VIEW_FORECAST)
         {
-            draw_forecast_background();
-
-            for (int i = 0; i < FORECAST_ROWS; ++i)
+            if (data->forecast_hourly_open)
             {
-                if (data->forecast_hourly_open)
+                // The hourly list owns the canvas and its own row labels while open
+                for (int i = 0; i < FORECAST_ROWS; ++i)
                 {
-                    draw_icon_scaled(data->forecast_hourly_icon[i], 19, 62 + i * 64, 36, 34);
-                    lv_label_set_text(forecast_row_title_labels[i], text_or_fallback(data->forecast_hourly_time[i], "--"));
-                    lv_label_set_text(forecast_row_detail_labels[i], text_or_fallback(data->forecast_hourly_detail[i], ""));
-                    lv_label_set_text(forecast_row_temp_labels[i], text_or_fallback(data->forecast_hourly_temp[i], "--°"));
+                    set_obj_hidden(forecast_row_title_labels[i], true);
+                    set_obj_hidden(forecast_row_detail_labels[i], true);
+                    set_obj_hidden(forecast_row_temp_labels[i], true);
                 }
-                else
+                draw_hourly_list();
+            }
+            else
+            {
+                hourly_list_hide();
+                draw_forecast_background();
+
+                for (int i = 0; i < FORECAST_ROWS; ++i)
                 {
+                    set_obj_hidden(forecast_row_title_labels[i], false);
+                    set_obj_hidden(forecast_row_detail_labels[i], false);
+                    set_obj_hidden(forecast_row_temp_labels[i], false);
                     draw_icon_scaled(data->forecast_row_icon[i], 19, 62 + i * 64, 36, 34);
-                    lv_label_set_text(forecast_row_title_labels[i], text_or_fallback(data->forecast_row_title[i], MOCK_FORECAST_TITLES[i]));
-                    lv_label_set_text(forecast_row_detail_labels[i], text_or_fallback(data->forecast_row_detail[i], FALLBACK_FORECAST_DETAILS[i]));
-                    lv_label_set_text(forecast_row_temp_labels[i], text_or_fallback(data->forecast_row_temp[i], "--°"));
+                    set_label_text(forecast_row_title_labels[i], text_or_fallback(data->forecast_row_title[i], MOCK_FORECAST_TITLES[i]));
+                    set_label_text(forecast_row_detail_labels[i], text_or_fallback(data->forecast_row_detail[i], FALLBACK_FORECAST_DETAILS[i]));
+                    set_label_text(forecast_row_temp_labels[i], text_or_fallback(data->forecast_row_temp[i], "--°"));
                 }
+                lv_obj_invalidate(canvas);
             }
-            lv_obj_invalidate(canvas);
 
             lv_obj_set_width(bottom_label, screen_w - 24);
             lv_obj_set_pos(bottom_label, 12, screen_h - 22);
             if (data->forecast_hourly_open)
             {
-                lv_label_set_text(bottom_label, "(tap ◀ Main, swipe up/down hours, left/right pages)");
+                set_label_text(bottom_label, "(tap ◀ Main, drag or flick to scroll hours)");
             }
             else
             {
-                lv_label_set_text(bottom_label, "(tap a day for hourly, swipe left/right pages)");
+                set_label_text(bottom_label, "(tap a day for hourly, swipe left/right pages)");
             }
         }
+        else if (current_view == DRAWING_SCREEN_VIEW_RADAR)
+        {
+            // Tiles are painted afterwards by app_radar_poll(), straight into the canvas
+            draw_radar_background();
+
+            lv_obj_set_width(bottom_label, screen_w - 24);
+            lv_obj_set_pos(bottom_label, 12, screen_h - 22);
+            set_label_text(bottom_label, text_or_fallback(data->radar_text, "(drag to pan, swipe from the edge for pages)"));
+        }
         else if (current_view == DRAWING_SCREEN_VIEW_I2C_SCAN)
         {
+            char i2c_body[320] = {0};
             draw_i2c_background();
-            lv_label_set_text(i2c_scan_title_label, "Detected Devices");
-            lv_label_set_text(i2c_scan_body_label, text_or_fallback(data->i2c_scan_text, "I2C scan pending..."));
+            build_i2c_scan_text(data, i2c_body, sizeof(i2c_body));
+            set_label_text(i2c_scan_title_label, "Detected Devices");
+            set_label_text(i2c_scan_body_label, i2c_body);
 
             lv_obj_set_width(bottom_label, screen_w - 24);
             lv_obj_set_pos(bottom_label, 12, screen_h - 22);
-            lv_label_set_text(bottom_label, "(swipe left/right to switch pages)");
+            set_label_text(bottom_label, "(swipe left/right to switch pages)");
         }
         else if (current_view == DRAWING_SCREEN_VIEW_WIFI_SCAN)
         {
             draw_wifi_background();
-            lv_label_set_text(wifi_scan_title_label, "Nearby Networks");
-            lv_label_set_text(wifi_scan_body_label, text_or_fallback(data->wifi_scan_text, "Wi-Fi scan pending..."));
+            set_label_text(wifi_scan_title_label, "Nearby Networks");
+            set_label_text(wifi_scan_body_label, text_or_fallback(data->wifi_scan_text, "Wi-Fi scan pending..."));
 
             lv_obj_set_width(bottom_label, screen_w - 24);
             lv_obj_set_pos(bottom_label, 12, screen_h - 22);
-            lv_label_set_text(bottom_label, "(swipe left/right to switch pages)");
+            set_label_text(bottom_label, "(swipe left/right to switch pages)");
         }
         else
         {
             char about_body[320] = {0};
             draw_i2c_background();
-            lv_label_set_text(i2c_scan_title_label, ABOUT_APP_NAME);
+            set_label_text(i2c_scan_title_label, ABOUT_APP_NAME);
             snprintf(about_body, sizeof(about_body),
                      "Author: %s\n"
                      "GitHub: %s\n"
                      "Handle: %s\n"
-                     "Version: %s",
+                     "Version: %s\n"
+                     "%s",
                      ABOUT_AUTHOR,
                      ABOUT_GITHUB,
                      ABOUT_GITHUB_HANDLE,
-                     app_version_string());
-            lv_label_set_text(i2c_scan_body_label, about_body);
+                     app_version_string(),
+                     text_or_fallback(data->battery_text, "Battery: --"));
+            set_label_text(i2c_scan_body_label, about_body);
 
             lv_obj_set_width(bottom_label, screen_w - 24);
             lv_obj_set_pos(bottom_label, 12, screen_h - 22);
-            lv_label_set_text(bottom_label, "(swipe left/right to switch pages)");
+            set_label_text(bottom_label, "(swipe left/right to switch pages)");
         }
     }
 
@@ -578,12 +620,12 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
         {
             char feels_line[32] = {0};
             build_feels_text(data->stats_line_1, feels_line, sizeof(feels_line));
-            lv_label_set_text(now_condition_label, feels_line);
+            set_label_text(now_condition_label, feels_line);
         }
         else if (current_view == DRAWING_SCREEN_VIEW_INDOOR)
         {
-            lv_label_set_text(indoor_humidity_label, text_or_fallback(data->indoor_line_2, "--% RH"));
-            lv_label_set_text(indoor_pressure_label, text_or_fallback(data->indoor_line_3, "-- hPa"));
+            set_label_text(indoor_humidity_label, text_or_fallback(data->indoor_line_2, "--% RH"));
+            set_label_text(indoor_pressure_label, text_or_fallback(data->indoor_line_3, "-- hPa"));
         }
     }
 
@@ -591,7 +633,13 @@ void drawing_screen_render(const drawing_screen_data_t *data, const drawing_scre
     {
         if (current_view == DRAWING_SCREEN_VIEW_FORECAST && data->bottom_text != NULL && data->bottom_text[0] != '\0')
         {
-            lv_label_set_text(bottom_label, data->bottom_text);
+            set_label_text(bottom_label, data->bottom_text);
+        }
+        else if (current_view == DRAWING_SCREEN_VIEW_RADAR && data->radar_text != NULL && data->radar_text[0] != '\0')
+        {
+            set_label_text(bottom_label, data->radar_text);
         }
     }
+
+    note_render_time((uint32_t)(esp_timer_get_time() - render_start_us));
 }
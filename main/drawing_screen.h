@@ -2,8 +2,10 @@
 #define __DRAWING_SCREEN_H__
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "esp_err.h"
 #include "lvgl.h"
 
 extern lv_obj_t *canvas;
@@ -11,6 +13,8 @@ extern bool canvas_exit;
 
 #define DRAWING_SCREEN_FORECAST_ROWS 4
 #define DRAWING_SCREEN_PREVIEW_DAYS 3
+#define DRAWING_SCREEN_RADAR_TILE_SIZE 256
+#define DRAWING_SCREEN_HOURLY_MAX 40
 
 typedef enum {
     DRAWING_SCREEN_VIEW_NOW = 0,
@@ -19,6 +23,7 @@ typedef enum {
     DRAWING_SCREEN_VIEW_I2C_SCAN = 3,
     DRAWING_SCREEN_VIEW_WIFI_SCAN = 4,
     DRAWING_SCREEN_VIEW_ABOUT = 5,
+    DRAWING_SCREEN_VIEW_RADAR = 6,
 } drawing_screen_view_t;
 
 typedef enum {
@@ -38,6 +43,17 @@ typedef enum {
     DRAWING_WEATHER_ICON_COUNT,
 } drawing_weather_icon_t;
 
+// One forecast slot for the hourly list. Copied into the drawing layer on render, so
+// the list can scroll from the LVGL task without touching app state.
+typedef struct {
+    uint8_t wday;
+    uint8_t hour;
+    int8_t temp_f;
+    int8_t feels_f;
+    uint8_t wind_mph;
+    uint8_t icon; // drawing_weather_icon_t
+} drawing_hourly_item_t;
+
 typedef struct {
     bool header;
     bool main;
@@ -49,8 +65,10 @@ typedef struct {
     drawing_screen_view_t view;
     uint8_t forecast_page;
     bool forecast_hourly_open;
-    uint8_t forecast_hourly_offset;
+    uint32_t forecast_hourly_seq; // changes on each open; the list then scrolls to forecast_hourly_start
+    uint8_t forecast_hourly_start;
     uint8_t forecast_hourly_count;
+    const drawing_hourly_item_t *forecast_hourly_items;
     bool has_weather;
     const char *time_text;
     const char *now_time_text;
@@ -77,14 +95,14 @@ typedef struct {
     const char *forecast_row_detail[DRAWING_SCREEN_FORECAST_ROWS];
     const char *forecast_row_temp[DRAWING_SCREEN_FORECAST_ROWS];
     drawing_weather_icon_t forecast_row_icon[DRAWING_SCREEN_FORECAST_ROWS];
-    const char *forecast_hourly_day_title;
-    const char *forecast_hourly_time[DRAWING_SCREEN_FORECAST_ROWS];
-    const char *forecast_hourly_detail[DRAWING_SCREEN_FORECAST_ROWS];
-    const char *forecast_hourly_temp[DRAWING_SCREEN_FORECAST_ROWS];
-    drawing_weather_icon_t forecast_hourly_icon[DRAWING_SCREEN_FORECAST_ROWS];
-    const char *i2c_scan_text;
+    const uint8_t *i2c_found_map;       // 128-bit presence bitmap, NULL before the boot scan
+    uint8_t i2c_found_count;
+    bool i2c_scanned;
+    bool i2c_bme_ready;
     const char *wifi_scan_text;
+    const char *radar_text;
     const char *bottom_text;
+    const char *battery_text;
 } drawing_screen_data_t;
 
 #ifdef __cplusplus
@@ -94,6 +112,91 @@ extern "C" {
 void drawing_screen_init(void);
 void drawing_screen_render(const drawing_screen_data_t *data, const drawing_screen_dirty_t *dirty);
 
+// Radar page map painting, canvas coordinates. Call with the LVGL lock held.
+void drawing_screen_radar_area(lv_area_t *area);
+void drawing_screen_radar_scroll(int dx, int dy);
+void drawing_screen_radar_clear_tile(int x, int y, const lv_area_t *clip);
+esp_err_t drawing_screen_radar_draw_tile(const uint8_t *data, size_t len, int x, int y, const lv_area_t *clip);
+
+// Hourly list: finger drag in pixels, release velocity in px/s (both positive downwards).
+// The list eases and flings on an LVGL timer. Call with the LVGL lock held, except the two
+// queries, which only read state the touch poll needs before it takes the lock.
+bool drawing_screen_hourly_hit(int x, int y);
+bool drawing_screen_hourly_at_top(void);
+void drawing_screen_hourly_drag(int dy);
+void drawing_screen_hourly_fling(int velocity_px_s);
+
+// Raw canvas readout (RGB565 in LV_COLOR_16_SWAP order, labels not included). Call with the LVGL lock held.
+bool drawing_screen_canvas_size(int *w, int *h);
+int drawing_screen_canvas_copy_rows(int y, int rows, uint16_t *dst);
+
+// Cached page chrome: renders draw it with LVGL and encode it, restores decode the cached runs.
+typedef struct {
+    uint32_t renders;
+    uint32_t restores;
+    uint32_t render_us_last;
+    uint32_t render_us_max;
+    uint32_t restore_us_last;
+    uint32_t restore_us_max;
+    size_t cache_bytes;
+} drawing_screen_layer_stats_t;
+
+void drawing_screen_layer_stats(drawing_screen_layer_stats_t *out);
+
+// Page slide: side > 0 brings the next page in from the right. Call begin with the old page
+// still rendered, render the new page, then set_target. follow() tracks the finger (x of the
+// old page), finish() settles to the new page or back. Call with the LVGL lock held.
+typedef struct {
+    uint32_t slides;
+    uint32_t cancels;
+    uint32_t prepare_ms_last;  // snapshots plus the new page's render, before the first moved frame
+    uint32_t settle_ms_last;
+    uint32_t frames_last;
+    uint32_t fps_last;
+    uint32_t fps_min;
+    uint32_t frame_ms_max;     // render + flush of the slowest settle frame
+    size_t surface_bytes;
+} drawing_screen_slide_stats_t;
+
+bool drawing_screen_slide_begin(int side);
+bool drawing_screen_slide_set_target(void);
+void drawing_screen_slide_follow(int dx);
+void drawing_screen_slide_finish(bool commit);
+bool drawing_screen_slide_active(void);
+void drawing_screen_slide_stats(drawing_screen_slide_stats_t *out);
+
+// Animated Now icon: runs on a low-rate LVGL timer while enabled (backlight at full) and the
+// Now page is shown. Call with the LVGL lock held.
+typedef struct {
+    uint32_t frames;
+    uint32_t budget_us;
+    uint32_t over_budget;      // frames whose copy took longer than budget_us
+    uint32_t apply_us_last;
+    uint32_t apply_us_avg;
+    uint32_t apply_us_max;
+    uint32_t flush_bytes_last; // box invalidated by the last frame
+    uint32_t flush_bytes_max;
+    uint32_t build_us_last;    // composing and delta-encoding all frames
+    size_t delta_bytes;
+    bool running;
+} drawing_screen_icon_anim_stats_t;
+
+void drawing_screen_icon_anim_enable(bool enable);
+void drawing_screen_icon_anim_stats(drawing_screen_icon_anim_stats_t *out);
+
+// Label updates whose text already matched are skipped before reaching LVGL.
+typedef struct {
+    uint32_t applied;
+    uint32_t skipped;
+    uint32_t set_us_avg;       // per applied update: realloc, re-measure, invalidate
+    uint32_t renders;
+    uint32_t render_us_last;   // drawing_screen_render, labels and canvas work together
+    uint32_t render_us_avg;
+    uint32_t render_us_max;
+} drawing_screen_label_stats_t;
+
+void drawing_screen_label_stats(drawing_screen_label_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
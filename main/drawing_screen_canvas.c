@@ -5,6 +5,7 @@
 
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 extern const uint8_t _binary_clear_day_128_rgb565_start[] asm("_binary_clear_day_128_rgb565_start");
 extern const uint8_t _binary_clear_day_128_rgb565_end[] asm("_binary_clear_day_128_rgb565_end");
@@ -81,6 +82,31 @@ bool ensure_canvas_buffer(int w, int h)
     return true;
 }
 
+bool drawing_screen_canvas_size(int *w, int *h)
+{
+    if (canvas_buf == NULL)
+    {
+        return false;
+    }
+    *w = screen_w;
+    *h = screen_h;
+    return true;
+}
+
+int drawing_screen_canvas_copy_rows(int y, int rows, uint16_t *dst)
+{
+    if (canvas_buf == NULL || y < 0 || y >= screen_h || rows <= 0)
+    {
+        return 0;
+    }
+    if (rows > screen_h - y)
+    {
+        rows = screen_h - y;
+    }
+    memcpy(dst, &canvas_buf[(size_t)y * screen_w], (size_t)rows * screen_w * sizeof(lv_color_t));
+    return rows;
+}
+
 lv_color_t rgb565_to_lv_color(uint16_t rgb565)
 {
     uint8_t r5 = (rgb565 >> 11) & 0x1F;
@@ -94,6 +120,13 @@ lv_color_t rgb565_to_lv_color(uint16_t rgb565)
     return lv_color_make(r8, g8, b8);
 }
 
+void invalidate_canvas_area(const lv_area_t *area)
+{
+    lv_area_t abs = *area;
+    lv_area_move(&abs, canvas->coords.x1, canvas->coords.y1);
+    lv_obj_invalidate_area(canvas, &abs);
+}
+
 void fill_rect(int x, int y, int w, int h, lv_color_t color)
 {
     if (canvas_buf == NULL || w <= 0 || h <= 0)
@@ -131,7 +164,13 @@ void fill_rect(int x, int y, int w, int h, lv_color_t color)
 
 void canvas_draw_card(int x, int y, int w, int h, int radius, lv_color_t fill, lv_color_t border, int border_w)
 {
-    if (canvas == NULL)
+    canvas_draw_card_on(canvas, x, y, w, h, radius, fill, border, border_w);
+}
+
+void canvas_draw_card_on(lv_obj_t *target, int x, int y, int w, int h, int radius, lv_color_t fill, lv_color_t border,
+                         int border_w)
+{
+    if (target == NULL)
     {
         return;
     }
@@ -144,7 +183,7 @@ void canvas_draw_card(int x, int y, int w, int h, int radius, lv_color_t fill, l
     rect.border_opa = (border_w > 0) ? LV_OPA_COVER : LV_OPA_TRANSP;
     rect.border_width = border_w;
     rect.border_color = border;
-    lv_canvas_draw_rect(canvas, x, y, w, h, &rect);
+    lv_canvas_draw_rect(target, x, y, w, h, &rect);
 }
 
 static const icon_asset_t *get_icon_asset(drawing_weather_icon_t icon)
@@ -156,9 +195,10 @@ static const icon_asset_t *get_icon_asset(drawing_weather_icon_t icon)
     return &ICON_ASSETS[icon];
 }
 
-void draw_icon_scaled(drawing_weather_icon_t icon, int dst_x, int dst_y, int dst_w, int dst_h)
+void draw_icon_scaled_into(lv_color_t *dst, int dst_stride, int clip_w, int clip_h, drawing_weather_icon_t icon,
+                           int dst_x, int dst_y, int dst_w, int dst_h)
 {
-    if (canvas_buf == NULL || dst_w <= 0 || dst_h <= 0)
+    if (dst == NULL || dst_w <= 0 || dst_h <= 0)
     {
         return;
     }
@@ -176,7 +216,7 @@ void draw_icon_scaled(drawing_weather_icon_t icon, int dst_x, int dst_y, int dst
     for (int y = 0; y < dst_h; ++y)
     {
         int py = dst_y + y;
-        if (py < 0 || py >= screen_h)
+        if (py < 0 || py >= clip_h)
         {
             continue;
         }
@@ -185,7 +225,7 @@ void draw_icon_scaled(drawing_weather_icon_t icon, int dst_x, int dst_y, int dst
         for (int x = 0; x < dst_w; ++x)
         {
             int px = dst_x + x;
-            if (px < 0 || px >= screen_w)
+            if (px < 0 || px >= clip_w)
             {
                 continue;
             }
@@ -198,68 +238,253 @@ void draw_icon_scaled(drawing_weather_icon_t icon, int dst_x, int dst_y, int dst
                 continue;
             }
 
-            canvas_buf[(size_t)py * (size_t)screen_w + (size_t)px] = rgb565_to_lv_color(rgb565);
+            dst[(size_t)py * (size_t)dst_stride + (size_t)px] = rgb565_to_lv_color(rgb565);
         }
     }
 }
 
-void draw_now_background(drawing_weather_icon_t now_icon)
+void draw_icon_scaled(drawing_weather_icon_t icon, int dst_x, int dst_y, int dst_w, int dst_h)
 {
-    lv_color_t bg = lv_color_make(27, 31, 39);
-    lv_color_t line = lv_color_make(56, 63, 76);
-    lv_color_t card_fill = lv_color_make(20, 25, 35);
-    lv_color_t card_border = lv_color_make(63, 75, 95);
-    lv_color_t forecast_fill = lv_color_make(23, 29, 40);
-    lv_color_t forecast_border = lv_color_make(66, 86, 108);
+    draw_icon_scaled_into(canvas_buf, screen_w, screen_w, screen_h, icon, dst_x, dst_y, dst_w, dst_h);
+}
 
-    lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+// Page chrome (background, rules, cards) only changes with the screen size, but
+// lv_canvas_draw_rect recomputes every rounded corner and border on each refresh.
+// The first draw of a page is run-length encoded into PSRAM; later draws decode
+// the runs straight into canvas_buf and only the dynamic content is redrawn.
+typedef enum {
+    STATIC_LAYER_NOW = 0,
+    STATIC_LAYER_INDOOR,
+    STATIC_LAYER_FORECAST,
+    STATIC_LAYER_I2C,
+    STATIC_LAYER_WIFI,
+    STATIC_LAYER_COUNT,
+} static_layer_id_t;
 
-    fill_rect(0, 34, screen_w, 1, line);
-    fill_rect(0, 44, screen_w, 1, lv_color_make(45, 52, 64));
+typedef struct {
+    uint16_t len;
+    uint16_t color;
+} static_layer_run_t;
 
-    canvas_draw_card(10, 52, screen_w - 20, 164, 14, card_fill, card_border, 2);
-    draw_icon_scaled(now_icon, 30, 72, 118, 118);
+typedef struct {
+    static_layer_run_t *runs;
+    size_t run_count;
+    int w;
+    int h;
+} static_layer_t;
 
-    fill_rect(0, 224, screen_w, 1, line);
+static static_layer_t s_layers[STATIC_LAYER_COUNT];
+static drawing_screen_layer_stats_t s_layer_stats;
+static int64_t s_layer_render_start_us;
 
-    const int card_w = (screen_w - 40) / 3;
-    const int gap = 10;
-    for (int i = 0; i < 3; ++i)
+static size_t static_layer_run_at(size_t pos, size_t pixels)
+{
+    uint16_t color = canvas_buf[pos].full;
+    size_t end = pos + 1;
+    size_t limit = (pixels - pos > UINT16_MAX) ? pos + UINT16_MAX : pixels;
+    while (end < limit && canvas_buf[end].full == color)
     {
-        int x = 10 + i * (card_w + gap);
-        canvas_draw_card(x, 232, card_w, 80, 12, forecast_fill, forecast_border, 2);
+        ++end;
     }
+    return end - pos;
+}
 
+static void static_layer_drop(static_layer_t *layer)
+{
+    if (layer->runs != NULL)
+    {
+        s_layer_stats.cache_bytes -= layer->run_count * sizeof(static_layer_run_t);
+        heap_caps_free(layer->runs);
+    }
+    memset(layer, 0, sizeof(*layer));
+}
+
+static void static_layer_fill_span(lv_color_t *dst, size_t len, lv_color_t color)
+{
+    // PSRAM write bandwidth is the cost here, so pair pixels into 32-bit stores
+    if (((uintptr_t)dst & 2U) != 0 && len > 0)
+    {
+        *dst++ = color;
+        --len;
+    }
+    uint32_t pair = (uint32_t)color.full | ((uint32_t)color.full << 16);
+    uint32_t *dst32 = (uint32_t *)dst;
+    for (size_t i = 0; i < len / 2; ++i)
+    {
+        dst32[i] = pair;
+    }
+    if ((len & 1U) != 0)
+    {
+        dst[len - 1] = color;
+    }
+}
+
+// Returns true when the chrome was restored from cache. Otherwise the caller
+// draws it and finishes with static_layer_capture().
+static bool static_layer_restore(static_layer_id_t id)
+{
+    static_layer_t *layer = &s_layers[id];
+    s_layer_render_start_us = esp_timer_get_time();
+    if (canvas_buf == NULL || layer->runs == NULL)
+    {
+        return false;
+    }
+    if (layer->w != screen_w || layer->h != screen_h)
+    {
+        static_layer_drop(layer);
+        return false;
+    }
+
+    lv_color_t *dst = canvas_buf;
+    for (size_t i = 0; i < layer->run_count; ++i)
+    {
+        lv_color_t color;
+        color.full = layer->runs[i].color;
+        static_layer_fill_span(dst, layer->runs[i].len, color);
+        dst += layer->runs[i].len;
+    }
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - s_layer_render_start_us);
+    s_layer_stats.restores++;
+    s_layer_stats.restore_us_last = us;
+    if (us > s_layer_stats.restore_us_max)
+    {
+        s_layer_stats.restore_us_max = us;
+    }
+    return true;
+}
+
+static void static_layer_capture(static_layer_id_t id)
+{
+    uint32_t us = (uint32_t)(esp_timer_get_time() - s_layer_render_start_us);
+    s_layer_stats.renders++;
+    s_layer_stats.render_us_last = us;
+    if (us > s_layer_stats.render_us_max)
+    {
+        s_layer_stats.render_us_max = us;
+    }
+
+    static_layer_t *layer = &s_layers[id];
+    static_layer_drop(layer);
+    if (canvas_buf == NULL)
+    {
+        return;
+    }
+
+    size_t pixels = (size_t)screen_w * (size_t)screen_h;
+    size_t run_count = 0;
+    for (size_t pos = 0; pos < pixels; pos += static_layer_run_at(pos, pixels))
+    {
+        ++run_count;
+    }
+    // Not worth keeping if the runs outgrow the raw frame
+    if (run_count * sizeof(static_layer_run_t) > pixels * sizeof(lv_color_t))
+    {
+        return;
+    }
+
+    layer->runs = (static_layer_run_t *)heap_caps_malloc(run_count * sizeof(static_layer_run_t), MALLOC_CAP_SPIRAM);
+    if (layer->runs == NULL)
+    {
+        ESP_LOGW(DRAWING_TAG, "static layer %d not cached (%u runs)", (int)id, (unsigned)run_count);
+        return;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < run_count; ++i)
+    {
+        size_t len = static_layer_run_at(pos, pixels);
+        layer->runs[i].len = (uint16_t)len;
+        layer->runs[i].color = canvas_buf[pos].full;
+        pos += len;
+    }
+    layer->run_count = run_count;
+    layer->w = screen_w;
+    layer->h = screen_h;
+    s_layer_stats.cache_bytes += run_count * sizeof(static_layer_run_t);
+    ESP_LOGD(DRAWING_TAG, "static layer %d: %u runs, %u bytes, drawn in %u us",
+             (int)id, (unsigned)run_count, (unsigned)(run_count * sizeof(static_layer_run_t)), (unsigned)us);
+}
+
+void drawing_screen_layer_stats(drawing_screen_layer_stats_t *out)
+{
+    *out = s_layer_stats;
+}
+
+void draw_now_background(drawing_weather_icon_t now_icon)
+{
+    if (!static_layer_restore(STATIC_LAYER_NOW))
+    {
+        lv_color_t bg = lv_color_make(27, 31, 39);
+        lv_color_t line = lv_color_make(56, 63, 76);
+        lv_color_t card_fill = lv_color_make(20, 25, 35);
+        lv_color_t card_border = lv_color_make(63, 75, 95);
+        lv_color_t forecast_fill = lv_color_make(23, 29, 40);
+        lv_color_t forecast_border = lv_color_make(66, 86, 108);
+
+        lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+
+        fill_rect(0, 34, screen_w, 1, line);
+        fill_rect(0, 44, screen_w, 1, lv_color_make(45, 52, 64));
+
+        canvas_draw_card(10, 52, screen_w - 20, 164, 14, card_fill, card_border, 2);
+
+        fill_rect(0, 224, screen_w, 1, line);
+
+        const int card_w = (screen_w - 40) / 3;
+        const int gap = 10;
+        for (int i = 0; i < 3; ++i)
+        {
+            int x = 10 + i * (card_w + gap);
+            canvas_draw_card(x, 232, card_w, 80, 12, forecast_fill, forecast_border, 2);
+        }
+        static_layer_capture(STATIC_LAYER_NOW);
+    }
+
+    // Sits inside the main card, clear of the forecast cards, so it goes on top of the layer.
+    // Animated conditions put their first frame there instead of the static icon.
+    if (!icon_anim_prepare(now_icon, 30, 72, 118, 118))
+    {
+        draw_icon_scaled(now_icon, 30, 72, 118, 118);
+    }
     lv_obj_invalidate(canvas);
 }
 
 void draw_indoor_background(void)
 {
-    lv_color_t bg = lv_color_make(22, 28, 38);
-    lv_color_t line = lv_color_make(58, 70, 84);
-    lv_color_t card_fill = lv_color_make(20, 29, 40);
-    lv_color_t card_border = lv_color_make(66, 86, 108);
-
-    lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
-    fill_rect(0, 34, screen_w, 1, line);
-    canvas_draw_card(10, 52, screen_w - 20, screen_h - 64, 16, card_fill, card_border, 2);
+    if (!static_layer_restore(STATIC_LAYER_INDOOR))
+    {
+        lv_color_t bg = lv_color_make(22, 28, 38);
+        lv_color_t line = lv_color_make(58, 70, 84);
+        lv_color_t card_fill = lv_color_make(20, 29, 40);
+        lv_color_t card_border = lv_color_make(66, 86, 108);
+
+        lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+        fill_rect(0, 34, screen_w, 1, line);
+        canvas_draw_card(10, 52, screen_w - 20, screen_h - 64, 16, card_fill, card_border, 2);
+        static_layer_capture(STATIC_LAYER_INDOOR);
+    }
     lv_obj_invalidate(canvas);
 }
 
 void draw_forecast_background(void)
 {
-    lv_color_t bg = lv_color_make(27, 31, 39);
-    lv_color_t line = lv_color_make(56, 63, 76);
-    lv_color_t card_fill = lv_color_make(24, 29, 39);
-    lv_color_t card_border = lv_color_make(63, 75, 95);
+    if (!static_layer_restore(STATIC_LAYER_FORECAST))
+    {
+        lv_color_t bg = lv_color_make(27, 31, 39);
+        lv_color_t line = lv_color_make(56, 63, 76);
+        lv_color_t card_fill = lv_color_make(24, 29, 39);
+        lv_color_t card_border = lv_color_make(63, 75, 95);
 
-    lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
-    fill_rect(0, 34, screen_w, 1, line);
+        lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+        fill_rect(0, 34, screen_w, 1, line);
 
-    for (int i = 0; i < FORECAST_ROWS; ++i)
-    {
-        int y = 52 + i * 64;
-        canvas_draw_card(10, y, screen_w - 20, 56, 14, card_fill, card_border, 2);
+        for (int i = 0; i < FORECAST_ROWS; ++i)
+        {
+            int y = 52 + i * 64;
+            canvas_draw_card(10, y, screen_w - 20, 56, 14, card_fill, card_border, 2);
+        }
+        static_layer_capture(STATIC_LAYER_FORECAST);
     }
 
     lv_obj_invalidate(canvas);
@@ -267,26 +492,34 @@ void draw_forecast_background(void)
 
 void draw_i2c_background(void)
 {
-    lv_color_t bg = lv_color_make(27, 31, 39);
-    lv_color_t line = lv_color_make(56, 63, 76);
-    lv_color_t card_fill = lv_color_make(22, 27, 37);
-    lv_color_t card_border = lv_color_make(63, 75, 95);
-
-    lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
-    fill_rect(0, 34, screen_w, 1, line);
-    canvas_draw_card(10, 52, screen_w - 20, screen_h - 86, 14, card_fill, card_border, 2);
+    if (!static_layer_restore(STATIC_LAYER_I2C))
+    {
+        lv_color_t bg = lv_color_make(27, 31, 39);
+        lv_color_t line = lv_color_make(56, 63, 76);
+        lv_color_t card_fill = lv_color_make(22, 27, 37);
+        lv_color_t card_border = lv_color_make(63, 75, 95);
+
+        lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+        fill_rect(0, 34, screen_w, 1, line);
+        canvas_draw_card(10, 52, screen_w - 20, screen_h - 86, 14, card_fill, card_border, 2);
+        static_layer_capture(STATIC_LAYER_I2C);
+    }
     lv_obj_invalidate(canvas);
 }
 
 void draw_wifi_background(void)
 {
-    lv_color_t bg = lv_color_make(24, 30, 39);
-    lv_color_t line = lv_color_make(58, 70, 84);
-    lv_color_t card_fill = lv_color_make(20, 29, 40);
-    lv_color_t card_border = lv_color_make(66, 86, 108);
-
-    lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
-    fill_rect(0, 34, screen_w, 1, line);
-    canvas_draw_card(10, 52, screen_w - 20, screen_h - 86, 14, card_fill, card_border, 2);
+    if (!static_layer_restore(STATIC_LAYER_WIFI))
+    {
+        lv_color_t bg = lv_color_make(24, 30, 39);
+        lv_color_t line = lv_color_make(58, 70, 84);
+        lv_color_t card_fill = lv_color_make(20, 29, 40);
+        lv_color_t card_border = lv_color_make(66, 86, 108);
+
+        lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+        fill_rect(0, 34, screen_w, 1, line);
+        canvas_draw_card(10, 52, screen_w - 20, screen_h - 86, 14, card_fill, card_border, 2);
+        static_layer_capture(STATIC_LAYER_WIFI);
+    }
     lv_obj_invalidate(canvas);
 }
@@ -0,0 +1,484 @@
+#include "drawing_screen_priv.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+// Hourly list on the forecast page. Rows are 64 px apart like the day cards; the canvas
+// strip between the header and the bottom line scrolls by memmove and only rows that
+// enter the viewport are painted. Row text lives in a small pool of label triples that
+// is rebound as rows scroll in, so at most HOURLY_POOL rows are ever formatted at once.
+// Every card looks the same, so one is drawn into a sprite and bands copy only the rows
+// of it they cover; nothing is ever drawn outside the band being painted.
+#define HOURLY_TOP 44
+#define HOURLY_BOTTOM_MARGIN 28
+#define HOURLY_STRIDE 64
+#define HOURLY_CARD_OFFSET 8
+#define HOURLY_CARD_H 56
+#define HOURLY_POOL 8
+#define HOURLY_FRAME_MS 16
+// Fling decay per 16 ms frame (x/256), and the speed below which it stops
+#define HOURLY_FRICTION_Q8 243
+#define HOURLY_MIN_VELOCITY 40
+#define HOURLY_MAX_VELOCITY 4000
+
+typedef struct
+{
+    lv_obj_t *title;
+    lv_obj_t *detail;
+    lv_obj_t *temp;
+    int item;
+} hourly_row_t;
+
+static lv_obj_t *s_list_obj = NULL;
+static hourly_row_t s_rows[HOURLY_POOL];
+static int s_pool = 0;
+static lv_timer_t *s_timer = NULL;
+
+static lv_obj_t *s_card_canvas = NULL; // hidden, only used to draw into s_card_buf
+static lv_color_t *s_card_buf = NULL;
+static int s_card_w = 0;
+
+static drawing_hourly_item_t s_items[DRAWING_SCREEN_HOURLY_MAX];
+static int s_count = 0;
+static uint32_t s_open_seq = 0;
+static bool s_open = false;
+
+static int s_scroll = 0;       // px from the top of the list to the top of the viewport
+static int32_t s_target_q8 = 0; // where drags and flings want s_scroll to be, 1/256 px
+static int32_t s_velocity = 0;  // px/s, positive scrolls towards later hours
+static uint32_t s_last_tick = 0;
+
+static int hourly_view_h(void)
+{
+    return screen_h - HOURLY_BOTTOM_MARGIN - HOURLY_TOP;
+}
+
+static int hourly_max_scroll(void)
+{
+    int content_h = s_count * HOURLY_STRIDE + HOURLY_CARD_OFFSET;
+    int max_scroll = content_h - hourly_view_h();
+    return (max_scroll > 0) ? max_scroll : 0;
+}
+
+static int hourly_clamp(int scroll)
+{
+    int max_scroll = hourly_max_scroll();
+    if (scroll < 0)
+    {
+        return 0;
+    }
+    return (scroll > max_scroll) ? max_scroll : scroll;
+}
+
+static lv_color_t hourly_bg(void)
+{
+    return lv_color_make(27, 31, 39);
+}
+
+static void hourly_paint_chrome(void)
+{
+    fill_rect(0, 0, screen_w, HOURLY_TOP, hourly_bg());
+    fill_rect(0, 34, screen_w, 1, lv_color_make(56, 63, 76));
+    fill_rect(0, HOURLY_TOP + hourly_view_h(), screen_w, HOURLY_BOTTOM_MARGIN, hourly_bg());
+}
+
+// Card on the list background, corners included, so a band can copy its rows verbatim
+static bool hourly_card_sprite(void)
+{
+    int w = screen_w - 20;
+    if (s_card_buf != NULL && s_card_w == w)
+    {
+        return true;
+    }
+    if (s_card_buf != NULL)
+    {
+        heap_caps_free(s_card_buf);
+        s_card_buf = NULL;
+    }
+    s_card_buf = (lv_color_t *)heap_caps_malloc(LV_CANVAS_BUF_SIZE_TRUE_COLOR(w, HOURLY_CARD_H), MALLOC_CAP_SPIRAM);
+    if (s_card_buf == NULL)
+    {
+        ESP_LOGE(DRAWING_TAG, "hourly: no memory for the card sprite");
+        return false;
+    }
+    if (s_card_canvas == NULL)
+    {
+        s_card_canvas = lv_canvas_create(lv_layer_sys());
+        lv_obj_add_flag(s_card_canvas, LV_OBJ_FLAG_HIDDEN);
+    }
+    s_card_w = w;
+    lv_canvas_set_buffer(s_card_canvas, s_card_buf, w, HOURLY_CARD_H, LV_IMG_CF_TRUE_COLOR);
+    lv_canvas_fill_bg(s_card_canvas, hourly_bg(), LV_OPA_COVER);
+    canvas_draw_card_on(s_card_canvas, 0, 0, w, HOURLY_CARD_H, 14, lv_color_make(24, 29, 39),
+                        lv_color_make(63, 75, 95), 2);
+    return true;
+}
+
+// Canvas rows y0..y1-1 (clamped to the viewport) from scratch; cards and icons that
+// cross the band edges are clipped to it
+static void hourly_paint_band(int y0, int y1)
+{
+    int view_top = HOURLY_TOP;
+    int view_bottom = HOURLY_TOP + hourly_view_h();
+    y0 = (y0 < view_top) ? view_top : y0;
+    y1 = (y1 > view_bottom) ? view_bottom : y1;
+    if (y0 >= y1)
+    {
+        return;
+    }
+
+    fill_rect(0, y0, screen_w, y1 - y0, hourly_bg());
+    if (!hourly_card_sprite())
+    {
+        return;
+    }
+
+    int first = (y0 - view_top + s_scroll) / HOURLY_STRIDE;
+    int last = (y1 - 1 - view_top + s_scroll) / HOURLY_STRIDE;
+    for (int i = first; i <= last && i < s_count; ++i)
+    {
+        int card_y = view_top + i * HOURLY_STRIDE - s_scroll + HOURLY_CARD_OFFSET;
+        int top = (card_y > y0) ? card_y : y0;
+        int bottom = (card_y + HOURLY_CARD_H < y1) ? card_y + HOURLY_CARD_H : y1;
+        for (int y = top; y < bottom; ++y)
+        {
+            memcpy(&canvas_buf[(size_t)y * screen_w + 10], &s_card_buf[(size_t)(y - card_y) * s_card_w],
+                   (size_t)s_card_w * sizeof(lv_color_t));
+        }
+        if (top < bottom)
+        {
+            draw_icon_scaled_into(&canvas_buf[(size_t)y0 * screen_w], screen_w, screen_w, y1 - y0,
+                                  (drawing_weather_icon_t)s_items[i].icon, 19, card_y + 10 - y0, 36, 34);
+        }
+    }
+}
+
+static void hourly_format_row(hourly_row_t *row, int item)
+{
+    const drawing_hourly_item_t *it = &s_items[item];
+    int hour12 = (it->hour % 12 == 0) ? 12 : it->hour % 12;
+    const char *ampm = (it->hour >= 12) ? "PM" : "AM";
+    char text[32];
+
+    // The first slot of each day carries the weekday so day boundaries stay visible
+    if (item == 0 || s_items[item - 1].wday != it->wday)
+    {
+        snprintf(text, sizeof(text), "%s %d%s", weekday_short(it->wday), hour12, ampm);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%d%s", hour12, ampm);
+    }
+    set_label_text(row->title, text);
+    snprintf(text, sizeof(text), "Feels %d° Wind %u", it->feels_f, (unsigned)it->wind_mph);
+    set_label_text(row->detail, text);
+    snprintf(text, sizeof(text), "%d°", it->temp_f);
+    set_label_text(row->temp, text);
+    row->item = item;
+}
+
+static void hourly_layout_rows(void)
+{
+    int first = s_scroll / HOURLY_STRIDE;
+    int last = (s_scroll + hourly_view_h() - 1) / HOURLY_STRIDE;
+    if (last >= s_count)
+    {
+        last = s_count - 1;
+    }
+
+    bool used[HOURLY_POOL] = {false};
+    for (int i = first; i <= last; ++i)
+    {
+        int slot = i % s_pool;
+        hourly_row_t *row = &s_rows[slot];
+        if (row->item != i)
+        {
+            hourly_format_row(row, i);
+        }
+        int card_y = i * HOURLY_STRIDE - s_scroll + HOURLY_CARD_OFFSET;
+        lv_obj_set_pos(row->title, 80, card_y + 4);
+        lv_obj_set_pos(row->detail, 80, card_y + 34);
+        lv_obj_set_pos(row->temp, screen_w - 94, card_y - 2);
+        set_obj_hidden(row->title, false);
+        set_obj_hidden(row->detail, false);
+        set_obj_hidden(row->temp, false);
+        used[slot] = true;
+    }
+    for (int slot = 0; slot < s_pool; ++slot)
+    {
+        if (!used[slot])
+        {
+            set_obj_hidden(s_rows[slot].title, true);
+            set_obj_hidden(s_rows[slot].detail, true);
+            set_obj_hidden(s_rows[slot].temp, true);
+        }
+    }
+}
+
+static void hourly_update_title(void)
+{
+    char title[24];
+    hourly_list_title(title, sizeof(title));
+    if (strcmp(lv_label_get_text(header_time_label), title) != 0)
+    {
+        set_label_text(header_time_label, title);
+    }
+}
+
+static void hourly_scroll_to(int scroll)
+{
+    scroll = hourly_clamp(scroll);
+    int dy = s_scroll - scroll; // > 0: content moves down
+    if (dy == 0 || canvas_buf == NULL)
+    {
+        return;
+    }
+    s_scroll = scroll;
+
+    int view_h = hourly_view_h();
+    int ady = abs(dy);
+    if (ady >= view_h)
+    {
+        hourly_paint_band(HOURLY_TOP, HOURLY_TOP + view_h);
+    }
+    else
+    {
+        // One memmove for the rows that stay visible, then paint the strip that came in
+        int src_y = HOURLY_TOP + ((dy < 0) ? ady : 0);
+        int dst_y = HOURLY_TOP + ((dy > 0) ? dy : 0);
+        memmove(&canvas_buf[(size_t)dst_y * screen_w], &canvas_buf[(size_t)src_y * screen_w],
+                (size_t)(view_h - ady) * screen_w * sizeof(lv_color_t));
+        if (dy > 0)
+        {
+            hourly_paint_band(HOURLY_TOP, HOURLY_TOP + dy);
+        }
+        else
+        {
+            hourly_paint_band(HOURLY_TOP + view_h - ady, HOURLY_TOP + view_h);
+        }
+    }
+
+    // Only the viewport moved; the header and bottom strip are never drawn over
+    lv_area_t area = {0, HOURLY_TOP, (lv_coord_t)(screen_w - 1), (lv_coord_t)(HOURLY_TOP + view_h - 1)};
+    invalidate_canvas_area(&area);
+    hourly_layout_rows();
+    hourly_update_title();
+}
+
+static void hourly_timer_cb(lv_timer_t *timer)
+{
+    uint32_t dt = lv_tick_elaps(s_last_tick);
+    s_last_tick = lv_tick_get();
+    if (dt > 4 * HOURLY_FRAME_MS)
+    {
+        dt = 4 * HOURLY_FRAME_MS;
+    }
+
+    if (s_velocity != 0)
+    {
+        s_target_q8 += (int32_t)(((int64_t)s_velocity * 256 * dt) / 1000);
+        for (uint32_t t = HOURLY_FRAME_MS; t <= dt; t += HOURLY_FRAME_MS)
+        {
+            s_velocity = (s_velocity * HOURLY_FRICTION_Q8) / 256;
+        }
+        if (abs(s_velocity) < HOURLY_MIN_VELOCITY)
+        {
+            s_velocity = 0;
+        }
+    }
+
+    int target = hourly_clamp(s_target_q8 / 256);
+    if (target * 256 != s_target_q8 && (target == 0 || target == hourly_max_scroll()))
+    {
+        // Ran into an end: stop there rather than winding up past it
+        s_target_q8 = target * 256;
+        s_velocity = 0;
+    }
+
+    // Ease towards the target: drag samples only arrive at the touch poll rate
+    int diff = target - s_scroll;
+    int step = (s_velocity != 0) ? diff : diff / 2;
+    if (step == 0 && diff != 0)
+    {
+        step = (diff > 0) ? 1 : -1;
+    }
+    hourly_scroll_to(s_scroll + step);
+
+    if (s_velocity == 0 && s_scroll == target)
+    {
+        lv_timer_pause(timer);
+    }
+}
+
+static void hourly_kick(void)
+{
+    if (s_timer == NULL)
+    {
+        return;
+    }
+    if (s_timer->paused)
+    {
+        s_last_tick = lv_tick_get();
+        lv_timer_resume(s_timer);
+    }
+}
+
+void hourly_list_create(lv_obj_t *screen)
+{
+    if (s_list_obj == NULL)
+    {
+        // Transparent container over the viewport: clips the row labels at both ends
+        s_list_obj = lv_obj_create(screen);
+        lv_obj_remove_style_all(s_list_obj);
+        lv_obj_clear_flag(s_list_obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    }
+    lv_obj_set_pos(s_list_obj, 0, HOURLY_TOP);
+    lv_obj_set_size(s_list_obj, screen_w, hourly_view_h());
+
+    int pool = hourly_view_h() / HOURLY_STRIDE + 2;
+    s_pool = (pool > HOURLY_POOL) ? HOURLY_POOL : pool;
+    for (int i = 0; i < HOURLY_POOL; ++i)
+    {
+        hourly_row_t *row = &s_rows[i];
+        if (row->title == NULL)
+        {
+            row->title = lv_label_create(s_list_obj);
+            lv_obj_set_style_text_font(row->title, &lv_font_montserrat_20, 0);
+            lv_obj_set_style_text_color(row->title, lv_color_make(225, 228, 233), 0);
+
+            row->detail = lv_label_create(s_list_obj);
+            lv_obj_set_style_text_font(row->detail, &lv_font_montserrat_16, 0);
+            lv_obj_set_style_text_color(row->detail, lv_color_make(175, 181, 191), 0);
+
+            row->temp = lv_label_create(s_list_obj);
+            lv_obj_set_style_text_font(row->temp, &lv_font_montserrat_48, 0);
+            lv_obj_set_style_text_color(row->temp, lv_color_make(225, 228, 233), 0);
+        }
+        row->item = -1;
+        set_obj_hidden(row->title, true);
+        set_obj_hidden(row->detail, true);
+        set_obj_hidden(row->temp, true);
+    }
+
+    if (s_timer == NULL)
+    {
+        s_timer = lv_timer_create(hourly_timer_cb, HOURLY_FRAME_MS, NULL);
+        lv_timer_pause(s_timer);
+    }
+    set_obj_hidden(s_list_obj, true);
+}
+
+void hourly_list_sync(const drawing_screen_data_t *data)
+{
+    if (!data->forecast_hourly_open || data->view != DRAWING_SCREEN_VIEW_FORECAST)
+    {
+        s_open = false;
+        return;
+    }
+
+    int count = (data->forecast_hourly_count > DRAWING_SCREEN_HOURLY_MAX) ? DRAWING_SCREEN_HOURLY_MAX
+                                                                          : data->forecast_hourly_count;
+    bool items_changed = count != s_count ||
+                         (count > 0 && memcmp(s_items, data->forecast_hourly_items, count * sizeof(s_items[0])) != 0);
+    if (items_changed)
+    {
+        memcpy(s_items, data->forecast_hourly_items, count * sizeof(s_items[0]));
+        s_count = count;
+        for (int i = 0; i < HOURLY_POOL; ++i)
+        {
+            s_rows[i].item = -1;
+        }
+    }
+
+    if (!s_open || data->forecast_hourly_seq != s_open_seq)
+    {
+        s_open = true;
+        s_open_seq = data->forecast_hourly_seq;
+        s_scroll = hourly_clamp(data->forecast_hourly_start * HOURLY_STRIDE);
+        s_velocity = 0;
+    }
+    else
+    {
+        s_scroll = hourly_clamp(s_scroll);
+    }
+    s_target_q8 = s_scroll * 256;
+}
+
+void draw_hourly_list(void)
+{
+    lv_canvas_fill_bg(canvas, hourly_bg(), LV_OPA_COVER);
+    hourly_paint_band(HOURLY_TOP, HOURLY_TOP + hourly_view_h());
+    hourly_paint_chrome();
+    lv_obj_invalidate(canvas);
+
+    set_obj_hidden(s_list_obj, false);
+    hourly_layout_rows();
+}
+
+void hourly_list_hide(void)
+{
+    s_open = false;
+    s_velocity = 0;
+    if (s_timer != NULL)
+    {
+        lv_timer_pause(s_timer);
+    }
+    set_obj_hidden(s_list_obj, true);
+}
+
+void hourly_list_title(char *out, size_t out_size)
+{
+    int top = (s_scroll + HOURLY_CARD_OFFSET) / HOURLY_STRIDE;
+    if (!s_open || top >= s_count)
+    {
+        snprintf(out, out_size, "Hourly");
+        return;
+    }
+    snprintf(out, out_size, "%s Hourly", weekday_short(s_items[top].wday));
+}
+
+bool drawing_screen_hourly_hit(int x, int y)
+{
+    (void)x;
+    return s_open && y >= HOURLY_TOP && y < HOURLY_TOP + hourly_view_h();
+}
+
+bool drawing_screen_hourly_at_top(void)
+{
+    return s_open && s_target_q8 <= 0;
+}
+
+void drawing_screen_hourly_drag(int dy)
+{
+    if (!s_open)
+    {
+        return;
+    }
+    s_velocity = 0;
+    s_target_q8 = hourly_clamp(s_target_q8 / 256 - dy) * 256;
+    hourly_kick();
+}
+
+void drawing_screen_hourly_fling(int velocity_px_s)
+{
+    if (!s_open)
+    {
+        return;
+    }
+    // A finger moving up (negative velocity) scrolls towards later hours
+    int32_t v = -velocity_px_s;
+    if (v > HOURLY_MAX_VELOCITY)
+    {
+        v = HOURLY_MAX_VELOCITY;
+    }
+    else if (v < -HOURLY_MAX_VELOCITY)
+    {
+        v = -HOURLY_MAX_VELOCITY;
+    }
+    s_velocity = (abs(v) >= HOURLY_MIN_VELOCITY) ? v : 0;
+    hourly_kick();
+}
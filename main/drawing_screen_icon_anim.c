@@ -0,0 +1,432 @@
+#include "drawing_screen_priv.h"
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// Animated Now icon. When the icon is drawn, ICON_ANIM_FRAMES frames are composed from the
+// static asset and the card pixels under it (drift for clouds and haze, falling drops or
+// flakes, a lightning flash). Each frame is kept only as the pixel runs that differ from
+// the frame before, plus the bounding box of those runs. A low-rate LVGL timer copies
+// one frame's runs into the canvas and invalidates just that box.
+// Budget per animated icon: ICON_ANIM_BUDGET_US of CPU per frame (under 1% at 8 fps) and
+// at most one 118x118 box (28 KB) flushed per frame, about 220 KB/s.
+#define ICON_ANIM_FRAMES 8
+#define ICON_ANIM_PERIOD_MS 125
+#define ICON_ANIM_BUDGET_US 1000
+
+typedef enum
+{
+    ICON_ANIM_NONE = 0,
+    ICON_ANIM_DRIFT,
+    ICON_ANIM_RAIN,
+    ICON_ANIM_SNOW,
+    ICON_ANIM_STORM,
+} icon_anim_kind_t;
+
+// Horizontal offset of drifting icons per frame; the cycle eases through both ends
+static const int8_t DRIFT_DX[ICON_ANIM_FRAMES] = {0, 1, 2, 3, 3, 2, 1, 0};
+
+static lv_timer_t *s_timer = NULL;
+static bool s_enabled = true; // cleared while the backlight is dimmed or off
+static bool s_ready = false;  // frame s_next - 1 is on the canvas
+static bool s_built = false;
+
+static drawing_weather_icon_t s_icon;
+static icon_anim_kind_t s_kind = ICON_ANIM_NONE;
+static int s_x;
+static int s_y;
+static int s_w;
+static int s_h;
+static size_t s_px = 0;
+
+static lv_color_t *s_bg = NULL;     // card pixels under the icon
+static lv_color_t *s_frame0 = NULL; // drawn in place of the static icon
+static lv_color_t *s_scratch[2] = {NULL, NULL};
+
+// Per frame: [pos, count, count pixels]... where pos indexes the box and runs never wrap a row
+static uint16_t *s_delta = NULL;
+static size_t s_delta_len = 0;
+static size_t s_delta_cap = 0;
+static size_t s_frame_off[ICON_ANIM_FRAMES];
+static size_t s_frame_len[ICON_ANIM_FRAMES];
+static lv_area_t s_frame_box[ICON_ANIM_FRAMES];
+static int s_next = 0;
+
+static drawing_screen_icon_anim_stats_t s_stats;
+static uint64_t s_apply_us_total = 0;
+
+static icon_anim_kind_t icon_anim_kind(drawing_weather_icon_t icon)
+{
+    switch (icon)
+    {
+    case DRAWING_WEATHER_ICON_FEW_CLOUDS_DAY:
+    case DRAWING_WEATHER_ICON_FEW_CLOUDS_NIGHT:
+    case DRAWING_WEATHER_ICON_CLOUDS:
+    case DRAWING_WEATHER_ICON_OVERCAST:
+    case DRAWING_WEATHER_ICON_MIST:
+    case DRAWING_WEATHER_ICON_FOG:
+        return ICON_ANIM_DRIFT;
+    case DRAWING_WEATHER_ICON_SHOWER_RAIN:
+    case DRAWING_WEATHER_ICON_RAIN:
+    case DRAWING_WEATHER_ICON_SLEET:
+        return ICON_ANIM_RAIN;
+    case DRAWING_WEATHER_ICON_SNOW:
+        return ICON_ANIM_SNOW;
+    case DRAWING_WEATHER_ICON_THUNDERSTORM:
+        return ICON_ANIM_STORM;
+    default:
+        return ICON_ANIM_NONE;
+    }
+}
+
+static void icon_anim_update_timer(void)
+{
+    bool run = s_ready && s_enabled;
+    s_stats.running = run;
+    if (s_timer == NULL)
+    {
+        return;
+    }
+    if (run)
+    {
+        lv_timer_resume(s_timer);
+    }
+    else
+    {
+        lv_timer_pause(s_timer);
+    }
+}
+
+static bool icon_anim_buffers(int w, int h)
+{
+    size_t px = (size_t)w * (size_t)h;
+    if (s_bg != NULL && s_px == px)
+    {
+        return true;
+    }
+
+    lv_color_t **bufs[] = {&s_bg, &s_frame0, &s_scratch[0], &s_scratch[1]};
+    for (size_t i = 0; i < sizeof(bufs) / sizeof(bufs[0]); ++i)
+    {
+        heap_caps_free(*bufs[i]);
+        *bufs[i] = NULL;
+    }
+    s_px = 0;
+    s_built = false;
+
+    for (size_t i = 0; i < sizeof(bufs) / sizeof(bufs[0]); ++i)
+    {
+        *bufs[i] = (lv_color_t *)heap_caps_malloc(px * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+        if (*bufs[i] == NULL)
+        {
+            ESP_LOGW(DRAWING_TAG, "icon animation buffers unavailable, icon stays static");
+            return false;
+        }
+    }
+    s_px = px;
+    return true;
+}
+
+static void icon_anim_rect(lv_color_t *out, int x, int y, int w, int h, lv_color_t color)
+{
+    int x0 = (x < 0) ? 0 : x;
+    int y0 = (y < 0) ? 0 : y;
+    int x1 = (x + w > s_w) ? s_w : x + w;
+    int y1 = (y + h > s_h) ? s_h : y + h;
+    for (int py = y0; py < y1; ++py)
+    {
+        for (int px = x0; px < x1; ++px)
+        {
+            out[(size_t)py * s_w + px] = color;
+        }
+    }
+}
+
+// Drops or flakes fall through the lower part of the box; the fall span is a whole number
+// of per-frame steps so the last frame leads seamlessly back into the first
+static void icon_anim_precipitation(lv_color_t *out, int frame, bool snow)
+{
+    int top = s_h * 58 / 100;
+    int step = (s_h - top) / ICON_ANIM_FRAMES;
+    int span = step * ICON_ANIM_FRAMES;
+    int count = snow ? 4 : 5;
+    lv_color_t color = snow ? lv_color_make(235, 240, 250) : lv_color_make(128, 180, 240);
+
+    for (int i = 0; i < count; ++i)
+    {
+        int fall = (i * 23 + frame * step) % span;
+        int x = s_w * (i * 2 + 1) / (count * 2);
+        if (snow)
+        {
+            x += (((frame + i) & 2) != 0) ? 1 : -1;
+            icon_anim_rect(out, x - 1, top + fall, 3, 3, color);
+        }
+        else
+        {
+            // Slanted streak, drifting left as it falls
+            for (int seg = 0; seg < 7; ++seg)
+            {
+                int y = top + fall + seg;
+                icon_anim_rect(out, x - (fall + seg) / 8, y, 2, 1, color);
+            }
+        }
+    }
+}
+
+static void icon_anim_bolt(lv_color_t *out)
+{
+    static const int16_t BOLT[][2] = {{56, 52}, {46, 72}, {56, 72}, {44, 96}}; // % of the box
+    lv_color_t color = lv_color_make(255, 226, 110);
+    for (size_t i = 0; i + 1 < sizeof(BOLT) / sizeof(BOLT[0]); ++i)
+    {
+        int x0 = s_w * BOLT[i][0] / 100;
+        int y0 = s_h * BOLT[i][1] / 100;
+        int x1 = s_w * BOLT[i + 1][0] / 100;
+        int y1 = s_h * BOLT[i + 1][1] / 100;
+        int steps = (y1 - y0 > 0) ? (y1 - y0) : 1;
+        for (int t = 0; t <= steps; ++t)
+        {
+            int x = x0 + (x1 - x0) * t / steps;
+            int y = y0 + (y1 - y0) * t / steps;
+            icon_anim_rect(out, x - 1, y - 1, 3, 3, color);
+        }
+    }
+}
+
+static void icon_anim_compose(lv_color_t *out, int frame)
+{
+    memcpy(out, s_bg, s_px * sizeof(lv_color_t));
+    int dx = (s_kind == ICON_ANIM_DRIFT) ? DRIFT_DX[frame] : 0;
+    draw_icon_scaled_into(out, s_w, s_w, s_h, s_icon, dx, 0, s_w, s_h);
+
+    if (s_kind == ICON_ANIM_RAIN || s_kind == ICON_ANIM_SNOW)
+    {
+        icon_anim_precipitation(out, frame, s_kind == ICON_ANIM_SNOW);
+    }
+    else if (s_kind == ICON_ANIM_STORM && (frame == 5 || frame == 6))
+    {
+        icon_anim_bolt(out);
+    }
+}
+
+static bool icon_anim_reserve(size_t extra)
+{
+    if (s_delta_len + extra <= s_delta_cap)
+    {
+        return true;
+    }
+    size_t cap = (s_delta_cap == 0) ? 4096 : s_delta_cap;
+    while (cap < s_delta_len + extra)
+    {
+        cap *= 2;
+    }
+    uint16_t *grown = (uint16_t *)heap_caps_realloc(s_delta, cap * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    if (grown == NULL)
+    {
+        return false;
+    }
+    s_delta = grown;
+    s_delta_cap = cap;
+    return true;
+}
+
+static bool icon_anim_encode(const lv_color_t *prev, const lv_color_t *cur, int frame)
+{
+    lv_area_t box = {s_w, s_h, -1, -1};
+    s_frame_off[frame] = s_delta_len;
+
+    for (int y = 0; y < s_h; ++y)
+    {
+        const lv_color_t *p = &prev[(size_t)y * s_w];
+        const lv_color_t *c = &cur[(size_t)y * s_w];
+        int x = 0;
+        while (x < s_w)
+        {
+            if (c[x].full == p[x].full)
+            {
+                ++x;
+                continue;
+            }
+            int start = x;
+            while (x < s_w && c[x].full != p[x].full)
+            {
+                ++x;
+            }
+            int count = x - start;
+            if (!icon_anim_reserve(2 + (size_t)count))
+            {
+                return false;
+            }
+            s_delta[s_delta_len++] = (uint16_t)(y * s_w + start);
+            s_delta[s_delta_len++] = (uint16_t)count;
+            memcpy(&s_delta[s_delta_len], &c[start], (size_t)count * sizeof(lv_color_t));
+            s_delta_len += (size_t)count;
+
+            box.x1 = (start < box.x1) ? start : box.x1;
+            box.x2 = (x - 1 > box.x2) ? x - 1 : box.x2;
+            box.y1 = (y < box.y1) ? y : box.y1;
+            box.y2 = y;
+        }
+    }
+
+    s_frame_len[frame] = s_delta_len - s_frame_off[frame];
+    s_frame_box[frame] = box;
+    return true;
+}
+
+static bool icon_anim_build(void)
+{
+    int64_t start_us = esp_timer_get_time();
+    s_delta_len = 0;
+
+    icon_anim_compose(s_frame0, 0);
+    const lv_color_t *prev = s_frame0;
+    for (int k = 1; k < ICON_ANIM_FRAMES; ++k)
+    {
+        lv_color_t *cur = s_scratch[k & 1];
+        icon_anim_compose(cur, k);
+        if (!icon_anim_encode(prev, cur, k))
+        {
+            return false;
+        }
+        prev = cur;
+    }
+    if (!icon_anim_encode(prev, s_frame0, 0))
+    {
+        return false;
+    }
+
+    s_stats.build_us_last = (uint32_t)(esp_timer_get_time() - start_us);
+    s_stats.delta_bytes = s_delta_len * sizeof(uint16_t);
+    return true;
+}
+
+static void icon_anim_tick(lv_timer_t *timer)
+{
+    (void)timer;
+    // A page slide hides the page; hold the frame rather than paint under the overlay
+    if (!s_ready || canvas_buf == NULL || drawing_screen_slide_active())
+    {
+        return;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    int frame = s_next;
+    const uint16_t *p = &s_delta[s_frame_off[frame]];
+    const uint16_t *end = p + s_frame_len[frame];
+    while (p < end)
+    {
+        int pos = p[0];
+        int count = p[1];
+        p += 2;
+        lv_color_t *dst = &canvas_buf[(size_t)(s_y + pos / s_w) * screen_w + (size_t)(s_x + pos % s_w)];
+        memcpy(dst, p, (size_t)count * sizeof(lv_color_t));
+        p += count;
+    }
+
+    const lv_area_t *box = &s_frame_box[frame];
+    uint32_t flush_bytes = 0;
+    if (box->x2 >= box->x1)
+    {
+        lv_area_t area = *box;
+        lv_area_move(&area, s_x, s_y);
+        invalidate_canvas_area(&area);
+        flush_bytes = (uint32_t)lv_area_get_size(&area) * sizeof(lv_color_t);
+    }
+    s_next = (frame + 1) % ICON_ANIM_FRAMES;
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_stats.frames++;
+    s_stats.apply_us_last = us;
+    if (us > s_stats.apply_us_max)
+    {
+        s_stats.apply_us_max = us;
+    }
+    if (us > ICON_ANIM_BUDGET_US)
+    {
+        s_stats.over_budget++;
+    }
+    s_apply_us_total += us;
+    s_stats.apply_us_avg = (uint32_t)(s_apply_us_total / s_stats.frames);
+    s_stats.flush_bytes_last = flush_bytes;
+    if (flush_bytes > s_stats.flush_bytes_max)
+    {
+        s_stats.flush_bytes_max = flush_bytes;
+    }
+}
+
+bool icon_anim_prepare(drawing_weather_icon_t icon, int x, int y, int w, int h)
+{
+    s_ready = false;
+    icon_anim_update_timer();
+
+    icon_anim_kind_t kind = icon_anim_kind(icon);
+    if (kind == ICON_ANIM_NONE || canvas_buf == NULL || x < 0 || y < 0 || x + w > screen_w || y + h > screen_h ||
+        w * h > UINT16_MAX)
+    {
+        return false;
+    }
+    if (!icon_anim_buffers(w, h))
+    {
+        return false;
+    }
+
+    // The card under the icon normally comes from the same cached layer; rebuild only on change
+    lv_color_t *bg = s_scratch[0];
+    for (int row = 0; row < h; ++row)
+    {
+        memcpy(&bg[(size_t)row * w], &canvas_buf[(size_t)(y + row) * screen_w + x], (size_t)w * sizeof(lv_color_t));
+    }
+    bool same = s_built && s_icon == icon && s_w == w && s_h == h &&
+                memcmp(bg, s_bg, s_px * sizeof(lv_color_t)) == 0;
+    s_x = x;
+    s_y = y;
+    if (!same)
+    {
+        memcpy(s_bg, bg, s_px * sizeof(lv_color_t));
+        s_icon = icon;
+        s_kind = kind;
+        s_w = w;
+        s_h = h;
+        s_built = icon_anim_build();
+        if (!s_built)
+        {
+            ESP_LOGW(DRAWING_TAG, "icon animation frames unavailable, icon stays static");
+            return false;
+        }
+    }
+
+    for (int row = 0; row < h; ++row)
+    {
+        memcpy(&canvas_buf[(size_t)(y + row) * screen_w + x], &s_frame0[(size_t)row * w], (size_t)w * sizeof(lv_color_t));
+    }
+    s_next = 1;
+    s_ready = true;
+    if (s_timer == NULL)
+    {
+        s_timer = lv_timer_create(icon_anim_tick, ICON_ANIM_PERIOD_MS, NULL);
+    }
+    icon_anim_update_timer();
+    return true;
+}
+
+void icon_anim_stop(void)
+{
+    s_ready = false;
+    icon_anim_update_timer();
+}
+
+void drawing_screen_icon_anim_enable(bool enable)
+{
+    s_enabled = enable;
+    icon_anim_update_timer();
+}
+
+void drawing_screen_icon_anim_stats(drawing_screen_icon_anim_stats_t *out)
+{
+    *out = s_stats;
+    out->budget_us = ICON_ANIM_BUDGET_US;
+}
@@ -44,23 +44,43 @@ extern lv_obj_t *wifi_scan_body_label;
 extern lv_obj_t *bottom_label;
 
 const char *text_or_fallback(const char *text, const char *fallback);
+const char *weekday_short(int wday);
 void set_obj_hidden(lv_obj_t *obj, bool hidden);
+void set_label_text(lv_obj_t *label, const char *text);
+void note_render_time(uint32_t us);
 
 bool ensure_canvas_buffer(int w, int h);
 lv_color_t rgb565_to_lv_color(uint16_t rgb565);
+void invalidate_canvas_area(const lv_area_t *area);
 void fill_rect(int x, int y, int w, int h, lv_color_t color);
 void canvas_draw_card(int x, int y, int w, int h, int radius, lv_color_t fill, lv_color_t border, int border_w);
+// Same card drawn into another canvas, e.g. a sprite that is blitted later
+void canvas_draw_card_on(lv_obj_t *target, int x, int y, int w, int h, int radius, lv_color_t fill, lv_color_t border,
+                         int border_w);
+void draw_icon_scaled_into(lv_color_t *dst, int dst_stride, int clip_w, int clip_h, drawing_weather_icon_t icon,
+                           int dst_x, int dst_y, int dst_w, int dst_h);
 void draw_icon_scaled(drawing_weather_icon_t icon, int dst_x, int dst_y, int dst_w, int dst_h);
 
 void build_signal_text(const char *status_text, char *out, size_t out_size);
 void copy_temp_compact(const char *temp_text, char *out, size_t out_size);
 void build_feels_text(const char *stats_line_1, char *out, size_t out_size);
 void build_condition_text(const char *condition_text, char *out, size_t out_size);
+void build_i2c_scan_text(const drawing_screen_data_t *data, char *out, size_t out_size);
 
 void draw_now_background(drawing_weather_icon_t now_icon);
 void draw_indoor_background(void);
 void draw_forecast_background(void);
 void draw_i2c_background(void);
 void draw_wifi_background(void);
+void draw_radar_background(void);
 
 void apply_view_visibility(drawing_screen_view_t view);
+
+bool icon_anim_prepare(drawing_weather_icon_t icon, int x, int y, int w, int h);
+void icon_anim_stop(void);
+
+void hourly_list_create(lv_obj_t *screen);
+void hourly_list_sync(const drawing_screen_data_t *data);
+void hourly_list_hide(void);
+void hourly_list_title(char *out, size_t out_size);
+void draw_hourly_list(void);
@@ -0,0 +1,215 @@
+#include "drawing_screen_priv.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "tile_decode.h"
+
+#if LV_COLOR_DEPTH != 16
+#error "radar tiles are blitted as RGB565 into the canvas"
+#endif
+
+#define RADAR_MAP_TOP 36
+#define RADAR_MAP_BOTTOM_MARGIN 28
+
+typedef struct
+{
+    int x;
+    int y;
+    lv_area_t clip;
+} radar_blit_t;
+
+static lv_color_t radar_map_bg(void)
+{
+    return lv_color_make(16, 22, 30);
+}
+
+static lv_color_t radar_grid_color(void)
+{
+    return lv_color_make(34, 44, 58);
+}
+
+static bool clip_to_map(lv_area_t *area)
+{
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    return _lv_area_intersect(area, area, &map);
+}
+
+void drawing_screen_radar_area(lv_area_t *area)
+{
+    area->x1 = 0;
+    area->y1 = RADAR_MAP_TOP;
+    area->x2 = (lv_coord_t)(screen_w - 1);
+    area->y2 = (lv_coord_t)(screen_h - RADAR_MAP_BOTTOM_MARGIN - 1);
+}
+
+void draw_radar_background(void)
+{
+    lv_color_t bg = lv_color_make(27, 31, 39);
+    lv_color_t line = lv_color_make(56, 63, 76);
+
+    lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+    fill_rect(0, 34, screen_w, 1, line);
+
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    fill_rect(map.x1, map.y1, lv_area_get_width(&map), lv_area_get_height(&map), radar_map_bg());
+    lv_obj_invalidate(canvas);
+}
+
+// Placeholder for a tile that is not cached yet: map background with the tile's top/left grid line.
+static void radar_paint_placeholder(int x, int y, const lv_area_t *clip)
+{
+    lv_area_t tile = {(lv_coord_t)x, (lv_coord_t)y, (lv_coord_t)(x + DRAWING_SCREEN_RADAR_TILE_SIZE - 1),
+                      (lv_coord_t)(y + DRAWING_SCREEN_RADAR_TILE_SIZE - 1)};
+    lv_area_t area;
+    if (!_lv_area_intersect(&area, &tile, clip))
+    {
+        return;
+    }
+
+    fill_rect(area.x1, area.y1, lv_area_get_width(&area), lv_area_get_height(&area), radar_map_bg());
+    if (y >= area.y1 && y <= area.y2)
+    {
+        fill_rect(area.x1, y, lv_area_get_width(&area), 1, radar_grid_color());
+    }
+    if (x >= area.x1 && x <= area.x2)
+    {
+        fill_rect(x, area.y1, 1, lv_area_get_height(&area), radar_grid_color());
+    }
+}
+
+void drawing_screen_radar_clear_tile(int x, int y, const lv_area_t *clip)
+{
+    if (canvas_buf == NULL || clip == NULL)
+    {
+        return;
+    }
+    lv_area_t area = *clip;
+    if (!clip_to_map(&area))
+    {
+        return;
+    }
+    radar_paint_placeholder(x, y, &area);
+    invalidate_canvas_area(&area);
+}
+
+void drawing_screen_radar_scroll(int dx, int dy)
+{
+    if (canvas_buf == NULL || (dx == 0 && dy == 0))
+    {
+        return;
+    }
+
+    lv_area_t map;
+    drawing_screen_radar_area(&map);
+    int w = lv_area_get_width(&map);
+    int h = lv_area_get_height(&map);
+    int adx = (dx >= 0) ? dx : -dx;
+    int ady = (dy >= 0) ? dy : -dy;
+    if (adx >= w || ady >= h)
+    {
+        fill_rect(map.x1, map.y1, w, h, radar_map_bg());
+        invalidate_canvas_area(&map);
+        return;
+    }
+
+    // Move the rows that stay visible instead of decoding their tiles again.
+    int copy_w = w - adx;
+    int src_x = map.x1 + ((dx < 0) ? adx : 0);
+    int dst_x = map.x1 + ((dx > 0) ? dx : 0);
+    for (int i = 0; i < h - ady; ++i)
+    {
+        int r = (dy > 0) ? (h - 1 - i) : i;
+        int dst_y = map.y1 + r;
+        int src_y = dst_y - dy;
+        memmove(&canvas_buf[(size_t)dst_y * screen_w + dst_x], &canvas_buf[(size_t)src_y * screen_w + src_x],
+                (size_t)copy_w * sizeof(lv_color_t));
+    }
+
+    if (dy > 0)
+    {
+        fill_rect(map.x1, map.y1, w, dy, radar_map_bg());
+    }
+    else if (dy < 0)
+    {
+        fill_rect(map.x1, map.y2 + 1 + dy, w, ady, radar_map_bg());
+    }
+    if (dx > 0)
+    {
+        fill_rect(map.x1, map.y1, dx, h, radar_map_bg());
+    }
+    else if (dx < 0)
+    {
+        fill_rect(map.x2 + 1 + dx, map.y1, adx, h, radar_map_bg());
+    }
+    invalidate_canvas_area(&map);
+}
+
+static bool radar_blit_row(void *arg, int row, int width, const void *pixels, tile_decode_format_t format)
+{
+    radar_blit_t *blit = (radar_blit_t *)arg;
+    int py = blit->y + row;
+    if (py < blit->clip.y1)
+    {
+        return true;
+    }
+    if (py > blit->clip.y2)
+    {
+        return false;
+    }
+
+    int x0 = (blit->clip.x1 > blit->x) ? blit->clip.x1 : blit->x;
+    int x1 = (blit->clip.x2 < blit->x + width - 1) ? blit->clip.x2 : blit->x + width - 1;
+    lv_color_t *dst = &canvas_buf[(size_t)py * screen_w];
+    if (format == TILE_DECODE_RGB565)
+    {
+        // Decoded with LV_COLOR_16_SWAP applied, so the words drop straight in
+        const uint16_t *src = (const uint16_t *)pixels;
+        for (int px = x0; px <= x1; ++px)
+        {
+            dst[px].full = src[px - blit->x];
+        }
+        return true;
+    }
+
+    const uint8_t *src = (const uint8_t *)pixels;
+    for (int px = x0; px <= x1; ++px)
+    {
+        const uint8_t *s = &src[(px - blit->x) * 4];
+        if (s[3] == 0)
+        {
+            continue;
+        }
+        lv_color_t c = lv_color_make(s[0], s[1], s[2]);
+        dst[px] = (s[3] == 255) ? c : lv_color_mix(c, dst[px], s[3]);
+    }
+    return true;
+}
+
+esp_err_t drawing_screen_radar_draw_tile(const uint8_t *data, size_t len, int x, int y, const lv_area_t *clip)
+{
+    if (canvas_buf == NULL || clip == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    radar_blit_t blit = {.x = x, .y = y, .clip = *clip};
+    lv_area_t tile = {(lv_coord_t)x, (lv_coord_t)y, (lv_coord_t)(x + DRAWING_SCREEN_RADAR_TILE_SIZE - 1),
+                      (lv_coord_t)(y + DRAWING_SCREEN_RADAR_TILE_SIZE - 1)};
+    if (!clip_to_map(&blit.clip) || !_lv_area_intersect(&blit.clip, &blit.clip, &tile))
+    {
+        return ESP_OK;
+    }
+
+    // Overlay tiles are mostly transparent: blend them over a fresh placeholder, never over the old frame.
+    radar_paint_placeholder(x, y, &blit.clip);
+    esp_err_t err = tile_decode(data, len, LV_COLOR_16_SWAP, radar_blit_row, &blit);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(DRAWING_TAG, "radar tile decode failed: %s", esp_err_to_name(err));
+    }
+    invalidate_canvas_area(&blit.clip);
+    return err;
+}
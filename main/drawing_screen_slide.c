@@ -0,0 +1,299 @@
+#include "drawing_screen_priv.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// Page slide. Every page shares one canvas and one set of labels, so two pages are never
+// live at once. Instead the outgoing page is snapshotted (canvas and labels) into a PSRAM
+// surface, the incoming page is rendered underneath and snapshotted into a second one,
+// and both are shown as images on the top layer, offset horizontally. The whole page
+// (the active screen: canvas and labels) is hidden meanwhile, so a frame is only the
+// two surface blits; label updates during the slide do not redraw under the overlay.
+// Budget: two full-screen RGB565 surfaces (300 KB each at 480x320), kept after first use.
+#define SLIDE_FULL_MS 240
+#define SLIDE_MIN_MS 80
+// Touch is polled every UI tick (100 ms); each drag sample is eased in over that window
+#define SLIDE_FOLLOW_MS 100
+
+typedef enum
+{
+    SLIDE_IDLE = 0,
+    SLIDE_DRAG,
+    SLIDE_SETTLE,
+} slide_phase_t;
+
+static lv_color_t *s_surface[2] = {NULL, NULL}; // 0 outgoing, 1 incoming
+static size_t s_surface_bytes = 0;
+static lv_img_dsc_t s_dsc[2];
+static lv_obj_t *s_overlay = NULL;
+static lv_obj_t *s_img[2] = {NULL, NULL};
+
+static slide_phase_t s_phase = SLIDE_IDLE;
+static int s_side = 1;   // +1: the incoming page enters from the right
+static int s_offset = 0; // x of the outgoing page
+static bool s_commit = false;
+static int64_t s_begin_us = 0;
+static int64_t s_settle_us = 0;
+static uint32_t s_frames = 0;
+static uint32_t s_frame_max_ms = 0;
+static drawing_screen_slide_stats_t s_stats;
+
+static void slide_monitor_cb(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px)
+{
+    (void)drv;
+    (void)px;
+    if (s_phase != SLIDE_SETTLE)
+    {
+        return;
+    }
+    s_frames++;
+    if (time_ms > s_frame_max_ms)
+    {
+        s_frame_max_ms = time_ms;
+    }
+}
+
+static bool slide_surfaces_ready(void)
+{
+    size_t bytes = (size_t)screen_w * (size_t)screen_h * sizeof(lv_color_t);
+    if (s_surface[0] != NULL && s_surface[1] != NULL && s_surface_bytes == bytes)
+    {
+        return true;
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (s_surface[i] != NULL)
+        {
+            heap_caps_free(s_surface[i]);
+            s_surface[i] = NULL;
+        }
+    }
+    s_surface_bytes = 0;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        s_surface[i] = (lv_color_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+        if (s_surface[i] == NULL)
+        {
+            ESP_LOGW(DRAWING_TAG, "slide surfaces unavailable (2 x %u bytes), pages will cut", (unsigned)bytes);
+            heap_caps_free(s_surface[0]);
+            s_surface[0] = NULL;
+            return false;
+        }
+    }
+    s_surface_bytes = bytes;
+    return true;
+}
+
+static void slide_overlay_create(void)
+{
+    if (s_overlay != NULL)
+    {
+        return;
+    }
+    s_overlay = lv_obj_create(lv_layer_top());
+    lv_obj_remove_style_all(s_overlay);
+    lv_obj_clear_flag(s_overlay, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(s_overlay, LV_OBJ_FLAG_HIDDEN);
+    for (int i = 0; i < 2; ++i)
+    {
+        s_img[i] = lv_img_create(s_overlay);
+        lv_obj_set_pos(s_img[i], 0, 0);
+    }
+}
+
+static bool slide_snapshot(int slot)
+{
+    lv_obj_t *screen = lv_scr_act();
+    // lv_snapshot does not run layout; labels changed since the last refresh would be captured stale
+    lv_obj_update_layout(screen);
+    if (lv_snapshot_buf_size_needed(screen, LV_IMG_CF_TRUE_COLOR) > s_surface_bytes)
+    {
+        return false;
+    }
+    if (lv_snapshot_take_to_buf(screen, LV_IMG_CF_TRUE_COLOR, &s_dsc[slot], s_surface[slot], s_surface_bytes) != LV_RES_OK)
+    {
+        return false;
+    }
+    // Same descriptor every time, new pixels: drop any cached decode of the old ones
+    lv_img_cache_invalidate_src(&s_dsc[slot]);
+    lv_img_set_src(s_img[slot], &s_dsc[slot]);
+    return true;
+}
+
+static void slide_place(int offset)
+{
+    s_offset = offset;
+    lv_obj_set_x(s_img[0], offset);
+    lv_obj_set_x(s_img[1], offset + s_side * screen_w);
+}
+
+static void slide_anim_cb(void *var, int32_t value)
+{
+    (void)var;
+    slide_place((int)value);
+}
+
+static void slide_end(void)
+{
+    lv_anim_del(s_overlay, slide_anim_cb);
+    lv_obj_clear_flag(lv_scr_act(), LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_flag(s_overlay, LV_OBJ_FLAG_HIDDEN);
+    s_phase = SLIDE_IDLE;
+}
+
+static void slide_settled_cb(lv_anim_t *a)
+{
+    (void)a;
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - s_settle_us) / 1000);
+    uint32_t fps = (ms > 0) ? (s_frames * 1000U) / ms : 0;
+
+    if (s_commit)
+    {
+        s_stats.slides++;
+    }
+    else
+    {
+        s_stats.cancels++;
+    }
+    s_stats.frames_last = s_frames;
+    s_stats.settle_ms_last = ms;
+    s_stats.fps_last = fps;
+    if (s_stats.fps_min == 0 || fps < s_stats.fps_min)
+    {
+        s_stats.fps_min = fps;
+    }
+    if (s_frame_max_ms > s_stats.frame_ms_max)
+    {
+        s_stats.frame_ms_max = s_frame_max_ms;
+    }
+    ESP_LOGD(DRAWING_TAG, "slide %s: %u frames in %u ms (%u fps, worst frame %u ms)", s_commit ? "done" : "cancelled",
+             (unsigned)s_frames, (unsigned)ms, (unsigned)fps, (unsigned)s_frame_max_ms);
+
+    slide_end();
+}
+
+static void slide_animate(int to, uint32_t ms, lv_anim_path_cb_t path, lv_anim_ready_cb_t ready_cb)
+{
+    lv_anim_del(s_overlay, slide_anim_cb);
+
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, s_overlay);
+    lv_anim_set_exec_cb(&a, slide_anim_cb);
+    lv_anim_set_values(&a, s_offset, to);
+    lv_anim_set_time(&a, ms);
+    lv_anim_set_path_cb(&a, path);
+    lv_anim_set_ready_cb(&a, ready_cb);
+    lv_anim_start(&a);
+}
+
+bool drawing_screen_slide_begin(int side)
+{
+    if (canvas == NULL || s_phase != SLIDE_IDLE || !slide_surfaces_ready())
+    {
+        return false;
+    }
+
+    s_begin_us = esp_timer_get_time();
+    slide_overlay_create();
+    if (!slide_snapshot(0))
+    {
+        return false;
+    }
+
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp != NULL && disp->driver->monitor_cb == NULL)
+    {
+        disp->driver->monitor_cb = slide_monitor_cb;
+    }
+
+    s_side = (side >= 0) ? 1 : -1;
+    s_commit = false;
+    lv_obj_set_size(s_overlay, screen_w, screen_h);
+    lv_obj_add_flag(s_img[1], LV_OBJ_FLAG_HIDDEN);
+    slide_place(0);
+    lv_obj_clear_flag(s_overlay, LV_OBJ_FLAG_HIDDEN);
+    // The next page renders into the hidden screen; nothing of it shows until it is snapshotted
+    lv_obj_add_flag(lv_scr_act(), LV_OBJ_FLAG_HIDDEN);
+    s_phase = SLIDE_DRAG;
+    return true;
+}
+
+bool drawing_screen_slide_set_target(void)
+{
+    if (s_phase == SLIDE_IDLE)
+    {
+        return false;
+    }
+
+    // lv_snapshot draws the screen object directly, so the hidden screen snapshots as is
+    bool ok = slide_snapshot(1);
+    if (!ok)
+    {
+        // The live widgets already show the new page; fall back to a cut
+        slide_end();
+        return false;
+    }
+
+    lv_obj_clear_flag(s_img[1], LV_OBJ_FLAG_HIDDEN);
+    slide_place(s_offset);
+    s_stats.prepare_ms_last = (uint32_t)((esp_timer_get_time() - s_begin_us) / 1000);
+    return true;
+}
+
+void drawing_screen_slide_follow(int dx)
+{
+    if (s_phase != SLIDE_DRAG)
+    {
+        return;
+    }
+
+    // The outgoing page only moves towards the side the incoming one leaves free
+    int lo = (s_side > 0) ? -screen_w : 0;
+    int hi = (s_side > 0) ? 0 : screen_w;
+    dx = (dx < lo) ? lo : ((dx > hi) ? hi : dx);
+    if (dx == s_offset)
+    {
+        return;
+    }
+    slide_animate(dx, SLIDE_FOLLOW_MS, lv_anim_path_linear, NULL);
+}
+
+void drawing_screen_slide_finish(bool commit)
+{
+    if (s_phase != SLIDE_DRAG)
+    {
+        return;
+    }
+
+    int to = commit ? -s_side * screen_w : 0;
+    uint32_t ms = (uint32_t)(SLIDE_FULL_MS * abs(to - s_offset) / screen_w);
+    if (ms < SLIDE_MIN_MS)
+    {
+        ms = SLIDE_MIN_MS;
+    }
+
+    s_commit = commit;
+    s_phase = SLIDE_SETTLE;
+    s_settle_us = esp_timer_get_time();
+    s_frames = 0;
+    s_frame_max_ms = 0;
+    slide_animate(to, ms, lv_anim_path_ease_out, slide_settled_cb);
+}
+
+bool drawing_screen_slide_active(void)
+{
+    return s_phase != SLIDE_IDLE;
+}
+
+void drawing_screen_slide_stats(drawing_screen_slide_stats_t *out)
+{
+    *out = s_stats;
+    out->surface_bytes = 2 * s_surface_bytes;
+}
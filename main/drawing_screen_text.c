@@ -3,11 +3,62 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "esp_timer.h"
+
+static drawing_screen_label_stats_t s_label_stats;
+static uint64_t s_label_set_us_total = 0;
+static uint64_t s_render_us_total = 0;
+
 const char *text_or_fallback(const char *text, const char *fallback)
 {
     return (text != NULL && text[0] != '\0') ? text : fallback;
 }
 
+const char *weekday_short(int wday)
+{
+    static const char *names[7] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    return (wday >= 0 && wday < 7) ? names[wday] : "?";
+}
+
+// lv_label_set_text reallocates, re-measures and invalidates even when the string is what
+// the label already shows; most refreshes rewrite a page whose text did not change.
+void set_label_text(lv_obj_t *label, const char *text)
+{
+    if (label == NULL || text == NULL)
+    {
+        return;
+    }
+    const char *current = lv_label_get_text(label);
+    if (current != NULL && strcmp(current, text) == 0)
+    {
+        s_label_stats.skipped++;
+        return;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    lv_label_set_text(label, text);
+    s_label_set_us_total += (uint64_t)(esp_timer_get_time() - start_us);
+    s_label_stats.applied++;
+    s_label_stats.set_us_avg = (uint32_t)(s_label_set_us_total / s_label_stats.applied);
+}
+
+void note_render_time(uint32_t us)
+{
+    s_label_stats.renders++;
+    s_label_stats.render_us_last = us;
+    if (us > s_label_stats.render_us_max)
+    {
+        s_label_stats.render_us_max = us;
+    }
+    s_render_us_total += us;
+    s_label_stats.render_us_avg = (uint32_t)(s_render_us_total / s_label_stats.renders);
+}
+
+void drawing_screen_label_stats(drawing_screen_label_stats_t *out)
+{
+    *out = s_label_stats;
+}
+
 void set_obj_hidden(lv_obj_t *obj, bool hidden)
 {
     if (obj == NULL)
@@ -127,8 +178,55 @@ void apply_view_visibility(drawing_screen_view_t view)
         set_obj_hidden(forecast_row_temp_labels[i], !forecast_visible);
     }
 
+    if (!forecast_visible)
+    {
+        hourly_list_hide();
+    }
+
     set_obj_hidden(i2c_scan_title_label, !(i2c_visible || about_visible));
     set_obj_hidden(i2c_scan_body_label, !(i2c_visible || about_visible));
     set_obj_hidden(wifi_scan_title_label, !wifi_visible);
     set_obj_hidden(wifi_scan_body_label, !wifi_visible);
 }
+
+void build_i2c_scan_text(const drawing_screen_data_t *data, char *out, size_t out_size)
+{
+    if (out == NULL || out_size == 0)
+    {
+        return;
+    }
+    if (data == NULL || !data->i2c_scanned || data->i2c_found_map == NULL)
+    {
+        snprintf(out, out_size, "I2C scan pending...\nRange: 0x03-0x77\nBME280 expected at 0x76 or 0x77");
+        return;
+    }
+    if (data->i2c_found_count == 0)
+    {
+        snprintf(out, out_size,
+                 "I2C Scan (0x03-0x77)\n"
+                 "No devices found.\n\n"
+                 "Check sensor power, GND, SDA, SCL.\n"
+                 "BME280 should appear at 0x76 or 0x77.");
+        return;
+    }
+
+    size_t used = (size_t)snprintf(out, out_size, "I2C Scan (0x03-0x77)\nFound:\n");
+    int shown = 0;
+    for (int addr = 0x03; addr <= 0x77 && used < out_size; ++addr)
+    {
+        if ((data->i2c_found_map[addr >> 3] & (1U << (addr & 7))) == 0)
+        {
+            continue;
+        }
+        used += (size_t)snprintf(out + used, out_size - used, "%s0x%02X", (shown == 0) ? "" : ((shown % 8) == 0) ? "\n" : " ", addr);
+        shown++;
+    }
+    if (used < out_size)
+    {
+        bool bme_addr = (data->i2c_found_map[0x76 >> 3] & (3U << (0x76 & 7))) != 0;
+        snprintf(out + used, out_size - used, "\n\nTotal: %d\nBME280 addr: %s\nDriver: %s",
+                 data->i2c_found_count,
+                 bme_addr ? "present" : "missing",
+                 data->i2c_bme_ready ? "initialized" : "not initialized");
+    }
+}
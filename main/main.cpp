@@ -1,5 +1,6 @@
 #include "app_priv.h"
 #include "driver/gpio.h"
+#include "bsp_qmi8658.h"
 
 // BOOT button on GPIO0 - LOW when pressed
 #define BOOT_BUTTON_GPIO GPIO_NUM_0
@@ -34,18 +35,23 @@ extern "C" void app_main(void)
     i2c_master_bus_handle_t i2c_bus_handle = bsp_i2c_init();
     g_i2c_bus_handle = i2c_bus_handle;
 
-    bsp_axp2101_init(i2c_bus_handle);
+    if (bsp_axp2101_init(i2c_bus_handle) == ESP_OK)
+    {
+        bsp_axp2101_service_start(APP_PMU_SAMPLE_ACTIVE_MS);
+    }
     io_expander_init(i2c_bus_handle);
 
     bsp_display_init(&io_handle, &panel_handle, LCD_BUFFER_SIZE);
-    uint16_t touch_w = EXAMPLE_LCD_H_RES;
-    uint16_t touch_h = EXAMPLE_LCD_V_RES;
-    if (EXAMPLE_DISPLAY_ROTATION != LV_DISP_ROT_180 && EXAMPLE_DISPLAY_ROTATION != LV_DISP_ROT_NONE)
+    uint16_t touch_w = 0;
+    uint16_t touch_h = 0;
+    app_orientation_touch_size(app_orientation_rotation(), &touch_w, &touch_h);
+    bsp_touch_init(i2c_bus_handle, touch_w, touch_h, display_rotation_to_touch_rotation(app_orientation_rotation()));
+
+    bool imu_ready = (bsp_qmi8658_init(i2c_bus_handle) == ESP_OK);
+    if (!imu_ready)
     {
-        touch_w = EXAMPLE_LCD_V_RES;
-        touch_h = EXAMPLE_LCD_H_RES;
+        ESP_LOGW(APP_TAG, "IMU not found, display rotation stays fixed");
     }
-    bsp_touch_init(i2c_bus_handle, touch_w, touch_h, display_rotation_to_touch_rotation(EXAMPLE_DISPLAY_ROTATION));
 
     // Give sensor rail time to settle and retry BME280 init to avoid sporadic boot-time misses.
     esp_err_t bme_err = ESP_FAIL;
@@ -67,8 +73,14 @@ extern "C" void app_main(void)
         ESP_LOGW(APP_TAG, "Indoor sensor not found: %s", esp_err_to_name(bme_err));
     }
 
+    // Boot-time full scan runs in the service task; later rounds only touch known addresses
+    if (bsp_i2c_topology_start(I2C_TOPOLOGY_IDLE_MS) != ESP_OK)
+    {
+        ESP_LOGW(APP_TAG, "I2C topology service not started");
+    }
+
     bsp_display_brightness_init();
-    bsp_display_set_brightness(100);
+    bsp_display_set_brightness(APP_POWER_ACTIVE_BRIGHTNESS);
 
     lv_port_init_local();
 
@@ -80,9 +92,15 @@ extern "C" void app_main(void)
         lvgl_port_unlock();
     }
     app_render_if_dirty();
+    app_power_init();
 
     ESP_LOGI(APP_TAG, "State-driven weather UI initialized");
 
+    if (imu_ready)
+    {
+        app_orientation_start();
+    }
+
     init_boot_button();
     xTaskCreatePinnedToCore(weather_task, "weather_task", 1024 * 16, NULL, 3, NULL, 1);
 
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Parallel-client load test for the device status server.
+
+Each worker keeps one HTTP/1.1 connection open and cycles through the
+endpoints, timing every request from send to the last body byte. At the end
+it prints per-endpoint p50/p90/p99/max client latency, then the device's own
+server-side numbers from /api/perf.
+
+    tools/http_load_test.py 192.168.1.50 --clients 4 --seconds 30
+    tools/http_load_test.py 192.168.1.50 --paths /api/state /screen.bmp
+
+Keep --clients at or below the device's socket limit (APP_HTTP_MAX_SOCKETS);
+extra connections push out the least recently used one.
+"""
+
+import argparse
+import http.client
+import json
+import threading
+import time
+from collections import defaultdict
+
+DEFAULT_PATHS = ["/api/state", "/api/indoor", "/api/i2c", "/api/wifi", "/api/perf", "/screen.bmp"]
+
+
+def percentile(sorted_values, pct):
+    if not sorted_values:
+        return float("nan")
+    index = min(len(sorted_values) - 1, int(len(sorted_values) * pct / 100.0))
+    return sorted_values[index]
+
+
+def worker(args, offset, deadline, results, errors, lock):
+    conn = None
+    i = offset
+    while time.monotonic() < deadline:
+        path = args.paths[i % len(args.paths)]
+        i += 1
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(args.host, args.port, timeout=args.timeout)
+            t0 = time.monotonic()
+            conn.request("GET", path)
+            resp = conn.getresponse()
+            body = resp.read()
+            elapsed_ms = (time.monotonic() - t0) * 1000.0
+            with lock:
+                if resp.status == 200:
+                    results[path].append((elapsed_ms, len(body)))
+                else:
+                    errors[path] += 1
+        except (OSError, http.client.HTTPException):
+            with lock:
+                errors[path] += 1
+            if conn is not None:
+                conn.close()
+            conn = None
+            time.sleep(0.05)
+    if conn is not None:
+        conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--seconds", type=float, default=20.0)
+    parser.add_argument("--timeout", type=float, default=10.0)
+    parser.add_argument("--paths", nargs="+", default=DEFAULT_PATHS)
+    args = parser.parse_args()
+
+    results = defaultdict(list)
+    errors = defaultdict(int)
+    lock = threading.Lock()
+    deadline = time.monotonic() + args.seconds
+    threads = [threading.Thread(target=worker, args=(args, n, deadline, results, errors, lock))
+               for n in range(args.clients)]
+    started = time.monotonic()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    wall = time.monotonic() - started
+
+    total = sum(len(v) for v in results.values())
+    print("%d clients, %.1f s, %d ok, %d errors, %.1f req/s" %
+          (args.clients, wall, total, sum(errors.values()), total / wall if wall > 0 else 0.0))
+    print("%-14s %6s %8s %8s %8s %8s %8s %6s" % ("path", "n", "p50 ms", "p90 ms", "p99 ms", "max ms", "KB/s", "err"))
+    for path in args.paths:
+        samples = results.get(path, [])
+        lat = sorted(s[0] for s in samples)
+        kbps = (sum(s[1] for s in samples) / 1024.0) / wall if wall > 0 else 0.0
+        print("%-14s %6d %8.1f %8.1f %8.1f %8.1f %8.1f %6d" %
+              (path, len(lat), percentile(lat, 50), percentile(lat, 90), percentile(lat, 99),
+               lat[-1] if lat else float("nan"), kbps, errors.get(path, 0)))
+
+    try:
+        conn = http.client.HTTPConnection(args.host, args.port, timeout=args.timeout)
+        conn.request("GET", "/api/perf")
+        perf = json.loads(conn.getresponse().read())
+        conn.close()
+    except (OSError, http.client.HTTPException, ValueError) as exc:
+        print("server stats unavailable: %s" % exc)
+        return
+    print("server side (last %s requests kept):" % sum(e["samples"] for e in perf["http"]["latency"]))
+    for e in perf["http"]["latency"]:
+        print("  %-14s %6d %8.1f %8s %8.1f %8.1f" % (e["uri"], e["samples"], e["p50_ms"], "", e["p99_ms"], e["max_ms"]))
+    heap = perf["heap"]
+    print("heap internal free %d (min %d), psram free %d (min %d)" %
+          (heap["internal_free"], heap["internal_min"], heap["psram_free"], heap["psram_min"]))
+
+
+if __name__ == "__main__":
+    main()
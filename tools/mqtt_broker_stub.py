@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Minimal MQTT 3.1.1 sink standing in for Mosquitto when testing the publisher.
+
+Accepts CONNECT, acks PUBLISH at QoS 1 and 2, answers PINGREQ, and prints one
+line per message (topic, size, QoS, retain, and the sample count of indoor
+batches). No auth, no TLS, no forwarding to subscribers.
+
+Point the device at it from the config console:
+    mqtt set-uri mqtt://<host>:1883
+
+To exercise the outbox across link drops, cut every Nth connection right after
+a PUBLISH arrives, before acking it:
+    tools/mqtt_broker_stub.py --drop-every 10
+
+The device should carry on with no gaps in the indoor `uptime_s` series. QoS 1
+is at-least-once, so a message that was in flight during a drop can show up
+twice; lines marked `dup` are ones the stub has already seen.
+"""
+
+import argparse
+import json
+import socket
+import struct
+import threading
+import time
+
+
+def read_exact(sock, n):
+    data = b""
+    while len(data) < n:
+        chunk = sock.recv(n - len(data))
+        if not chunk:
+            raise ConnectionError("peer closed")
+        data += chunk
+    return data
+
+
+def read_packet(sock):
+    header = read_exact(sock, 1)[0]
+    length = 0
+    shift = 0
+    while True:
+        byte = read_exact(sock, 1)[0]
+        length |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            break
+        shift += 7
+    return header, read_exact(sock, length) if length else b""
+
+
+def mqtt_str(data, pos):
+    (n,) = struct.unpack_from(">H", data, pos)
+    return data[pos + 2:pos + 2 + n].decode("utf-8", "replace"), pos + 2 + n
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.messages = 0
+        self.bytes = 0
+        self.dups = 0
+        self.seen = set()
+        self.started = time.monotonic()
+
+
+def describe(topic, payload):
+    if topic.endswith("/indoor"):
+        try:
+            doc = json.loads(payload)
+            samples = doc.get("samples", [])
+            span = "%s..%s" % (samples[0][0], samples[-1][0]) if samples else "-"
+            return "n=%s uptime_s %s" % (doc.get("n"), span)
+        except (ValueError, KeyError, IndexError, TypeError):
+            return "bad json"
+    text = payload.decode("utf-8", "replace")
+    return text if len(text) <= 80 else text[:77] + "..."
+
+
+def serve_client(conn, addr, args, stats, counter):
+    client_id = "?"
+    try:
+        while True:
+            header, body = read_packet(conn)
+            kind = header >> 4
+            if kind == 1:  # CONNECT
+                _, pos = mqtt_str(body, 0)
+                flags = body[pos + 1]
+                client_id, _ = mqtt_str(body, pos + 4)
+                print("%s connected from %s:%d (clean=%d)" % (client_id, addr[0], addr[1], (flags >> 1) & 1))
+                conn.sendall(b"\x20\x02\x00\x00")
+            elif kind == 3:  # PUBLISH
+                qos = (header >> 1) & 3
+                retain = header & 1
+                dup_flag = (header >> 3) & 1
+                topic, pos = mqtt_str(body, 0)
+                packet_id = None
+                if qos:
+                    (packet_id,) = struct.unpack_from(">H", body, pos)
+                    pos += 2
+                payload = body[pos:]
+                with stats.lock:
+                    counter[0] += 1
+                    n = counter[0]
+                    key = (topic, payload)
+                    dup = key in stats.seen
+                    stats.seen.add(key)
+                    stats.messages += 1
+                    stats.bytes += len(payload)
+                    stats.dups += dup
+                print("%8.1f %-28s %5d B q%d%s%s%s  %s" %
+                      (time.monotonic() - stats.started, topic, len(payload), qos, " retain" if retain else "",
+                       " DUP" if dup_flag else "", " dup" if dup else "", describe(topic, payload)))
+                if args.drop_every and n % args.drop_every == 0:
+                    print("-- dropping %s before ack (message %d)" % (client_id, n))
+                    return
+                if args.ack_delay_ms:
+                    time.sleep(args.ack_delay_ms / 1000.0)
+                if qos == 1:
+                    conn.sendall(struct.pack(">BBH", 0x40, 2, packet_id))
+                elif qos == 2:
+                    conn.sendall(struct.pack(">BBH", 0x50, 2, packet_id))
+            elif kind == 6:  # PUBREL
+                conn.sendall(b"\x70\x02" + body[:2])
+            elif kind == 8:  # SUBSCRIBE, granted as QoS 0
+                topics = 0
+                pos = 2
+                while pos < len(body):
+                    _, pos = mqtt_str(body, pos)
+                    pos += 1
+                    topics += 1
+                conn.sendall(bytes([0x90, 2 + topics]) + body[:2] + b"\x00" * topics)
+            elif kind == 12:  # PINGREQ
+                conn.sendall(b"\xd0\x00")
+            elif kind == 14:  # DISCONNECT
+                print("%s disconnected" % client_id)
+                return
+    except (ConnectionError, OSError, struct.error, IndexError) as exc:
+        print("%s dropped: %s" % (client_id, exc))
+    finally:
+        conn.close()
+
+
+def report(stats, interval):
+    while True:
+        time.sleep(interval)
+        with stats.lock:
+            wall = time.monotonic() - stats.started
+            print("== %d msgs, %d B, %d dup, %.2f msg/s" %
+                  (stats.messages, stats.bytes, stats.dups, stats.messages / wall if wall > 0 else 0.0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--drop-every", type=int, default=0, help="close the connection on every Nth PUBLISH")
+    parser.add_argument("--ack-delay-ms", type=int, default=0, help="delay before PUBACK, to emulate a slow broker")
+    parser.add_argument("--report-s", type=float, default=60.0)
+    args = parser.parse_args()
+
+    stats = Stats()
+    counter = [0]
+    threading.Thread(target=report, args=(stats, args.report_s), daemon=True).start()
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((args.bind, args.port))
+    server.listen(4)
+    print("mqtt sink on %s:%d" % (args.bind, args.port))
+    while True:
+        conn, addr = server.accept()
+        threading.Thread(target=serve_client, args=(conn, addr, args, stats, counter), daemon=True).start()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Local stand-in for a radar tile server, for offline fetch -> pixel benchmarking.
+
+Serves 256x256 tiles at /{z}/{x}/{y}.png or /{ts}/{z}/{x}/{y}.png (also .jpg
+when --dir has them). Without --dir it draws synthetic palette PNG "storm
+cells" laid out in world coordinates, so neighbouring tiles line up and the
+cells drift between frames.
+
+Point the device at it from the config console:
+    radar set-url http://<host>:8080/{ts}/{z}/{x}/{y}.png
+
+The device logs per tile `fetch N ms decode N ms fetch->pixel N ms`.
+"""
+
+import argparse
+import math
+import os
+import struct
+import time
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+TILE = 256
+
+# dBZ-like ramp, index 0 is transparent
+PALETTE = [
+    (0, 0, 0), (4, 233, 231), (1, 159, 244), (3, 0, 244), (2, 253, 2),
+    (1, 197, 1), (0, 142, 0), (253, 248, 2), (229, 188, 0), (253, 149, 0),
+    (253, 0, 0), (212, 0, 0), (188, 0, 0), (248, 0, 253), (152, 84, 198),
+]
+ALPHA = [0] + [200] * (len(PALETTE) - 1)
+
+
+def png_chunk(kind, data):
+    return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data) & 0xFFFFFFFF)
+
+
+def cells_for(z, ts):
+    """Deterministic storm cells in normalised world coordinates (0..1)."""
+    drift = (ts // 600) * 0.0004
+    cells = []
+    for i in range(48):
+        h = (i * 2654435761) & 0xFFFFFFFF
+        cx = ((h & 0xFFFF) / 65535.0 + drift) % 1.0
+        cy = 0.30 + ((h >> 16) / 65535.0) * 0.25
+        r = 0.004 + (i % 5) * 0.002
+        cells.append((cx, cy, r))
+    return cells
+
+
+def synth_tile(z, x, y, ts):
+    world = TILE << z
+    cells = cells_for(z, ts)
+    rows = bytearray()
+    prev_line = bytes(TILE)
+    for py in range(TILE):
+        line = bytearray(TILE)
+        wy = (y * TILE + py) / world
+        for cx, cy, r in cells:
+            dy = wy - cy
+            if abs(dy) > r:
+                continue
+            half = math.sqrt(r * r - dy * dy)
+            x0 = int(((cx - half) * world) - x * TILE)
+            x1 = int(((cx + half) * world) - x * TILE)
+            if x1 < 0 or x0 >= TILE:
+                continue
+            for px in range(max(0, x0), min(TILE, x1 + 1)):
+                wx = (x * TILE + px) / world
+                d = math.hypot(wx - cx, dy) / r
+                level = max(1, min(len(PALETTE) - 1, int((1.0 - d) * (len(PALETTE) - 1)) + 1))
+                line[px] = max(line[px], level)
+        # Alternate Sub/Up filters like a real encoder would, so the device exercises both
+        if py % 2:
+            rows.append(1)
+            rows += bytes((line[i] - (line[i - 1] if i else 0)) & 0xFF for i in range(TILE))
+        else:
+            rows.append(2)
+            rows += bytes((line[i] - prev_line[i]) & 0xFF for i in range(TILE))
+        prev_line = line
+    ihdr = struct.pack(">IIBBBBB", TILE, TILE, 8, 3, 0, 0, 0)
+    plte = b"".join(bytes(c) for c in PALETTE)
+    return (b"\x89PNG\r\n\x1a\n" + png_chunk(b"IHDR", ihdr) + png_chunk(b"PLTE", plte) +
+            png_chunk(b"tRNS", bytes(ALPHA)) + png_chunk(b"IDAT", zlib.compress(bytes(rows), 6)) +
+            png_chunk(b"IEND", b""))
+
+
+class TileHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive, like a CDN
+    args = None
+
+    def do_GET(self):
+        t0 = time.monotonic()
+        parts = self.path.split("?")[0].strip("/").split("/")
+        try:
+            if len(parts) == 4:
+                ts = int(parts[0])
+                parts = parts[1:]
+            else:
+                ts = int(time.time())
+            z, x = int(parts[0]), int(parts[1])
+            y, ext = parts[2].split(".")
+            y = int(y)
+        except (ValueError, IndexError):
+            self.send_error(400, "expected /{z}/{x}/{y}.png or /{ts}/{z}/{x}/{y}.png")
+            return
+
+        body = None
+        ctype = "image/png" if ext == "png" else "image/jpeg"
+        if self.args.dir:
+            path = os.path.join(self.args.dir, str(z), str(x), "%d.%s" % (y, ext))
+            if os.path.isfile(path):
+                with open(path, "rb") as f:
+                    body = f.read()
+        elif ext == "png" and 0 <= y < (1 << z):
+            body = synth_tile(z, x, y, ts)
+
+        if self.args.latency_ms > 0:
+            time.sleep(self.args.latency_ms / 1000.0)
+
+        if body is None:
+            self.send_error(404)
+            return
+        self.send_response(200)
+        self.send_header("Content-Type", ctype)
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("Cache-Control", "max-age=600")
+        self.end_headers()
+        self.wfile.write(body)
+        self.log_message("%s %d B in %.1f ms", self.path, len(body), (time.monotonic() - t0) * 1000.0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--dir", help="serve tiles from DIR/{z}/{x}/{y}.(png|jpg) instead of synthetic ones")
+    parser.add_argument("--latency-ms", type=int, default=0, help="added per-request delay to emulate a WAN")
+    args = parser.parse_args()
+
+    TileHandler.args = args
+    server = ThreadingHTTPServer((args.bind, args.port), TileHandler)
+    print("radar tiles on http://%s:%d/{ts}/{z}/{x}/{y}.png" % (args.bind, args.port))
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()